@@ -31,20 +31,38 @@ class PlayerPage extends StatefulWidget {
   State<PlayerPage> createState() => _PlayerPageState();
 }
 
-class _PlayerPageState extends State<PlayerPage> {
+class _PlayerPageState extends State<PlayerPage> with WidgetsBindingObserver {
   MpvNativeTextureController? _controller;
+  // Last opened file or URL; drives the seek-bar hover preview.
+  String? _source;
   final _urlCtrl = TextEditingController(
     text:
         'https://commondatastorage.googleapis.com/gtv-videos-bucket/sample/BigBuckBunny.mp4',
   );
 
+  @override
+  void initState() {
+    super.initState();
+    WidgetsBinding.instance.addObserver(this);
+  }
+
   @override
   void dispose() {
+    WidgetsBinding.instance.removeObserver(this);
     _controller?.dispose();
     _urlCtrl.dispose();
     super.dispose();
   }
 
+  @override
+  void didChangeAppLifecycleState(AppLifecycleState state) {
+    // Stop rendering while the window is minimized; audio keeps playing.
+    final hidden = state == AppLifecycleState.hidden ||
+        state == AppLifecycleState.paused;
+    _controller?.setVisibility(
+        hidden ? MpvVisibility.hidden : MpvVisibility.visible);
+  }
+
   Future<void> _ensureController() async {
     if (_controller != null) return;
     print(
@@ -96,6 +114,7 @@ class _PlayerPageState extends State<PlayerPage> {
         allowedExtensions: const ['mp4', 'mkv', 'mov', 'webm', 'avi']);
     if (res == null || res.files.single.path == null) return;
     await _controller!.open(res.files.single.path!);
+    setState(() => _source = res.files.single.path!);
     await _controller!.play();
   }
 
@@ -106,6 +125,7 @@ class _PlayerPageState extends State<PlayerPage> {
       final url = _urlCtrl.text.trim();
       if (url.isEmpty) return;
       await _controller!.open(url);
+      setState(() => _source = url);
       await _controller!.play();
     } catch (e) {
       print("Error opening URL: $e");
@@ -141,7 +161,8 @@ class _PlayerPageState extends State<PlayerPage> {
                               style: const TextStyle(color: Colors.white70),
                             ),
                           )
-                        : _VideoPlayerWithControls(controller: c),
+                        : _VideoPlayerWithControls(
+                            controller: c, source: _source),
                   ),
                 ),
               ),
@@ -212,11 +233,96 @@ class _PlayerPageState extends State<PlayerPage> {
   }
 }
 
+/// Shows a thumbnail from [preview] above the seek bar while hovering it.
+class _SeekBarPreview extends StatefulWidget {
+  final MpvSeekPreview? preview;
+  final double duration;
+  final String Function(double seconds) formatTime;
+  final Widget child;
+
+  const _SeekBarPreview({
+    required this.preview,
+    required this.duration,
+    required this.formatTime,
+    required this.child,
+  });
+
+  @override
+  State<_SeekBarPreview> createState() => _SeekBarPreviewState();
+}
+
+class _SeekBarPreviewState extends State<_SeekBarPreview> {
+  // Matches the slider's overlay radius: the track is inset by it.
+  static const double _trackInset = 12;
+  double? _hoverX;
+  double _hoverTime = 0;
+
+  void _onHover(Offset position, double width) {
+    final preview = widget.preview;
+    if (preview == null || widget.duration <= 0) return;
+    final track = (width - 2 * _trackInset).clamp(1.0, double.infinity);
+    final fraction =
+        ((position.dx - _trackInset) / track).clamp(0.0, 1.0);
+    setState(() {
+      _hoverX = position.dx;
+      _hoverTime = fraction * widget.duration;
+    });
+    preview.previewAt(_hoverTime);
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    final preview = widget.preview;
+    return LayoutBuilder(
+      builder: (context, constraints) => MouseRegion(
+        onHover: (event) =>
+            _onHover(event.localPosition, constraints.maxWidth),
+        onExit: (_) => setState(() => _hoverX = null),
+        child: Stack(
+          clipBehavior: Clip.none,
+          children: [
+            widget.child,
+            if (preview != null && _hoverX != null)
+              Positioned(
+                left: (_hoverX! - preview.width / 2).clamp(
+                    0.0,
+                    (constraints.maxWidth - preview.width)
+                        .clamp(0.0, double.infinity)),
+                bottom: 36,
+                child: IgnorePointer(
+                  child: Column(
+                    children: [
+                      Container(
+                        width: preview.width.toDouble(),
+                        height: preview.height.toDouble(),
+                        decoration: BoxDecoration(
+                          border: Border.all(color: Colors.white70),
+                        ),
+                        child: Texture(textureId: preview.textureId),
+                      ),
+                      const SizedBox(height: 4),
+                      Text(
+                        widget.formatTime(_hoverTime),
+                        style:
+                            const TextStyle(color: Colors.white, fontSize: 12),
+                      ),
+                    ],
+                  ),
+                ),
+              ),
+          ],
+        ),
+      ),
+    );
+  }
+}
+
 /// Video player widget with overlay controls (appears on hover)
 class _VideoPlayerWithControls extends StatefulWidget {
   final MpvNativeTextureController controller;
+  final String? source;
 
-  const _VideoPlayerWithControls({required this.controller});
+  const _VideoPlayerWithControls({required this.controller, this.source});
 
   @override
   State<_VideoPlayerWithControls> createState() =>
@@ -233,12 +339,40 @@ class _VideoPlayerWithControlsState extends State<_VideoPlayerWithControls> {
   double _duration = 100.0;
   double _volume = 100.0;
   double _playbackSpeed = 1.0;
+  MpvSeekPreview? _preview;
 
   @override
   void initState() {
     super.initState();
     // Start a timer to update position periodically from MPV
     _startPositionTimer();
+    _openPreview();
+  }
+
+  @override
+  void didUpdateWidget(_VideoPlayerWithControls oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (oldWidget.source != widget.source) _openPreview();
+  }
+
+  @override
+  void dispose() {
+    _preview?.dispose();
+    super.dispose();
+  }
+
+  Future<void> _openPreview() async {
+    final old = _preview;
+    _preview = null;
+    await old?.dispose();
+    final source = widget.source;
+    if (source == null) return;
+    final preview = await MpvSeekPreview.create(source);
+    if (!mounted || source != widget.source) {
+      await preview?.dispose();
+      return;
+    }
+    setState(() => _preview = preview);
   }
 
   void _startPositionTimer() {
@@ -407,29 +541,34 @@ class _VideoPlayerWithControlsState extends State<_VideoPlayerWithControls> {
                                 ),
                               ),
                               Expanded(
-                                child: SliderTheme(
-                                  data: SliderThemeData(
-                                    thumbShape: const RoundSliderThumbShape(
-                                      enabledThumbRadius: 6,
+                                child: _SeekBarPreview(
+                                  preview: _preview,
+                                  duration: _duration,
+                                  formatTime: _formatDuration,
+                                  child: SliderTheme(
+                                    data: SliderThemeData(
+                                      thumbShape: const RoundSliderThumbShape(
+                                        enabledThumbRadius: 6,
+                                      ),
+                                      overlayShape: const RoundSliderOverlayShape(
+                                        overlayRadius: 12,
+                                      ),
+                                      trackHeight: 3,
                                     ),
-                                    overlayShape: const RoundSliderOverlayShape(
-                                      overlayRadius: 12,
+                                    child: Slider(
+                                      value:
+                                          _currentPosition.clamp(0.0, _duration),
+                                      min: 0,
+                                      max: _duration,
+                                      activeColor: Colors.red,
+                                      inactiveColor: Colors.white24,
+                                      onChanged: (value) {
+                                        setState(() => _currentPosition = value);
+                                      },
+                                      onChangeEnd: (value) {
+                                        widget.controller.seekAbsolute(value);
+                                      },
                                     ),
-                                    trackHeight: 3,
-                                  ),
-                                  child: Slider(
-                                    value:
-                                        _currentPosition.clamp(0.0, _duration),
-                                    min: 0,
-                                    max: _duration,
-                                    activeColor: Colors.red,
-                                    inactiveColor: Colors.white24,
-                                    onChanged: (value) {
-                                      setState(() => _currentPosition = value);
-                                    },
-                                    onChangeEnd: (value) {
-                                      widget.controller.seekAbsolute(value);
-                                    },
                                   ),
                                 ),
                               ),
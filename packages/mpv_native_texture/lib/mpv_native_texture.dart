@@ -1,13 +1,1085 @@
 import 'dart:async';
+import 'dart:ffi';
 import 'dart:io';
+import 'dart:typed_data';
 
 import 'package:flutter/services.dart';
 import 'package:flutter/widgets.dart';
 
+/// How much of a player's output is currently on screen.
+enum MpvVisibility {
+  /// Nothing is shown: frames are skipped and, after a short grace period,
+  /// the video track is disabled while audio keeps playing.
+  hidden,
+
+  /// Shown as a small preview: frames are rendered at a reduced rate.
+  thumbnail,
+
+  /// Fully visible: every frame is rendered.
+  visible,
+}
+
+/// Render quality chosen by the adaptive quality governor, from best to
+/// cheapest. Each level includes the reductions of the ones before it.
+enum MpvQualityLevel {
+  /// Configured quality.
+  full,
+
+  /// Frame interpolation disabled.
+  noInterpolation,
+
+  /// Bilinear scalers instead of the configured ones.
+  bilinearScaling,
+
+  /// Rendered at half width and height; Flutter scales the texture up.
+  reducedResolution,
+
+  /// Only every other video frame is drawn.
+  fpsCap,
+}
+
+/// Image encoding for [MpvNativeTextureController.captureFrame].
+enum MpvCaptureFormat {
+  png,
+  jpeg,
+
+  /// Tightly packed 8-bit RGBA.
+  raw,
+}
+
+/// Where [MpvNativeTextureController.captureFrame] takes its pixels from.
+enum MpvCaptureSource {
+  /// The frame currently shown in the texture, at texture resolution.
+  texture,
+
+  /// mpv's `screenshot-raw` of the current video frame, at video resolution
+  /// and without any scaling applied by the texture.
+  video,
+}
+
+/// A frame grabbed by [MpvNativeTextureController.captureFrame].
+class MpvCapture {
+  final int width;
+  final int height;
+  final MpvCaptureFormat format;
+
+  /// Encoded image, or `null` when it was written to [path].
+  final Uint8List? bytes;
+  final String? path;
+
+  /// Time spent producing the pixels. For [MpvCaptureSource.texture] this is
+  /// the only part that can hold up the render thread.
+  final Duration sourceTime;
+
+  /// Scaling, encoding and file write time on the capture worker.
+  final Duration encodeTime;
+
+  /// Total time from the request reaching the player to completion.
+  final Duration totalTime;
+
+  const MpvCapture({
+    required this.width,
+    required this.height,
+    required this.format,
+    this.bytes,
+    this.path,
+    required this.sourceTime,
+    required this.encodeTime,
+    required this.totalTime,
+  });
+}
+
+/// Mirror of `MpvFrameTapFrame` in `mpv_frame_tap_c_api.h`.
+final class _MpvFrameTapFrame extends Struct {
+  external Pointer<Uint8> pixels;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int stride;
+  @Int32()
+  external int slot;
+  @Uint64()
+  external int sequence;
+  @Int64()
+  external int timestampUs;
+}
+
+typedef _FrameTapAcquireNative = Pointer<_MpvFrameTapFrame> Function(
+    Uint64 tapId, Uint64 afterSequence);
+typedef _FrameTapAcquire = Pointer<_MpvFrameTapFrame> Function(
+    int tapId, int afterSequence);
+typedef _FrameTapReleaseNative = Void Function(Uint64 tapId, Int32 slot);
+typedef _FrameTapRelease = void Function(int tapId, int slot);
+
+class _FrameTapBindings {
+  static final DynamicLibrary _lib =
+      DynamicLibrary.open('mpv_native_texture_plugin.dll');
+  static final _FrameTapAcquire acquire = _lib
+      .lookupFunction<_FrameTapAcquireNative, _FrameTapAcquire>(
+          'MpvFrameTapAcquire');
+  static final _FrameTapRelease release = _lib
+      .lookupFunction<_FrameTapReleaseNative, _FrameTapRelease>(
+          'MpvFrameTapRelease');
+}
+
+/// A frame held from a [MpvFrameTap]. [pixels] points straight into native
+/// memory; it must not be used after [release].
+class MpvTapFrame {
+  final int _tapId;
+  final int _slot;
+  bool _released = false;
+
+  /// RGBA pixels, [stride] bytes per row.
+  final Uint8List pixels;
+  final int width;
+  final int height;
+  final int stride;
+
+  /// Increases by one per frame the tap published; gaps mean frames were
+  /// replaced before being acquired.
+  final int sequence;
+
+  /// Monotonic publication time in microseconds.
+  final int timestampUs;
+
+  MpvTapFrame._(this._tapId, _MpvFrameTapFrame frame)
+      : _slot = frame.slot,
+        pixels = frame.pixels.asTypedList(frame.stride * frame.height),
+        width = frame.width,
+        height = frame.height,
+        stride = frame.stride,
+        sequence = frame.sequence,
+        timestampUs = frame.timestampUs;
+
+  /// Returns the slot to the tap. Frames that are never released eventually
+  /// stall the tap.
+  void release() {
+    if (_released) return;
+    _released = true;
+    _FrameTapBindings.release(_tapId, _slot);
+  }
+}
+
+/// A raw frame feed started by [MpvNativeTextureController.startFrameTap].
+///
+/// Frames are copied natively into a small ring of slots and read from Dart
+/// without another copy.
+class MpvFrameTap {
+  final MpvNativeTextureController _controller;
+  final int id;
+  int _lastSequence = 0;
+
+  MpvFrameTap._(this._controller, this.id);
+
+  /// Takes the newest frame not seen yet, or null. Call [MpvTapFrame.release]
+  /// when done with it.
+  MpvTapFrame? acquire() {
+    final frame = _FrameTapBindings.acquire(id, _lastSequence);
+    if (frame == nullptr) return null;
+    final result = MpvTapFrame._(id, frame.ref);
+    _lastSequence = result.sequence;
+    return result;
+  }
+
+  /// Frames as they are published. Each must be released by the listener.
+  Stream<MpvTapFrame> get frames => _controller.events
+      .where((event) => event['type'] == 'frameTap' && event['tapId'] == id)
+      .map((_) => acquire())
+      .where((frame) => frame != null)
+      .cast<MpvTapFrame>();
+
+  /// Stops the tap. Frames still held stay valid until released.
+  Future<void> stop() => _controller._stopFrameTap();
+}
+
+/// Tile placement of a mosaic opened with
+/// [MpvNativeTextureController.openMosaic].
+class MpvMosaicLayout {
+  final int columns;
+  final int rows;
+
+  /// Tile rectangles in input order, normalized to the texture (0..1), so
+  /// they can be scaled to whatever size the texture is displayed at.
+  final List<Rect> tiles;
+
+  const MpvMosaicLayout(this.columns, this.rows, this.tiles);
+
+  factory MpvMosaicLayout._fromMap(Map<Object?, Object?> map) {
+    final width = (map['width'] as int).toDouble();
+    final height = (map['height'] as int).toDouble();
+    final tiles = (map['tiles'] as List<Object?>).map((tile) {
+      final t = tile as Map<Object?, Object?>;
+      return Rect.fromLTWH(
+        (t['x'] as int) / width,
+        (t['y'] as int) / height,
+        (t['width'] as int) / width,
+        (t['height'] as int) / height,
+      );
+    }).toList();
+    return MpvMosaicLayout(map['columns'] as int, map['rows'] as int, tiles);
+  }
+
+  /// Index of the tile under [position] (normalized like [tiles]), or null.
+  int? tileAt(Offset position) {
+    for (var i = 0; i < tiles.length; i++) {
+      if (tiles[i].contains(position)) return i;
+    }
+    return null;
+  }
+}
+
+/// Minimum severity of mpv log messages to collect.
+enum MpvLogLevel { no, fatal, error, warn, info, v, debug, trace }
+
+/// One log line emitted by libmpv.
+class MpvLogMessage {
+  /// The mpv module that produced the line (e.g. `ffmpeg/demuxer`).
+  final String prefix;
+
+  /// The mpv level name (`error`, `warn`, `info`, ...).
+  final String level;
+
+  /// The message text without the trailing newline.
+  final String text;
+
+  const MpvLogMessage(this.prefix, this.level, this.text);
+
+  @override
+  String toString() => '[$prefix] $level: $text';
+}
+
+/// The player's playlist as reported by [MpvNativeTextureController.playlist].
+class MpvPlaylist {
+  /// Index of the current entry, -1 when none.
+  final int pos;
+  final List<MpvPlaylistEntry> entries;
+
+  const MpvPlaylist(this.pos, this.entries);
+
+  factory MpvPlaylist.fromEvent(Map<Object?, Object?> event) => MpvPlaylist(
+        event['pos'] as int? ?? -1,
+        (event['entries'] as List<Object?>? ?? const [])
+            .map((e) => e as Map<Object?, Object?>)
+            .map((e) => MpvPlaylistEntry(
+                e['filename'] as String? ?? '', e['title'] as String? ?? ''))
+            .toList(),
+      );
+}
+
+class MpvPlaylistEntry {
+  final String filename;
+
+  /// From the file's metadata or playlist file; often empty.
+  final String title;
+
+  const MpvPlaylistEntry(this.filename, this.title);
+}
+
+/// A snapshot of mpv's `demuxer-cache-state`, from
+/// [MpvNativeTextureController.getCacheState] or
+/// [MpvNativeTextureController.cacheStates].
+///
+/// Times are media positions in seconds; `-1` when mpv does not report them.
+class MpvCacheState {
+  /// Ranges that can be seeked to without touching the source, e.g. to draw
+  /// buffered segments on a seek bar.
+  final List<MpvCacheRange> seekableRanges;
+
+  /// End of the cached data after the reader position.
+  final double cacheEnd;
+
+  /// Demuxer read position.
+  final double readerPts;
+
+  /// Seconds cached ahead of [readerPts].
+  final double cacheDuration;
+
+  /// Bytes cached ahead of the reader position.
+  final int forwardBytes;
+
+  /// Bytes held by the demuxer cache in total, back buffer included.
+  final int totalBytes;
+
+  /// Source read rate in bytes per second.
+  final int rawInputRate;
+
+  /// The demuxer reached the end of the file.
+  final bool eof;
+
+  /// Playback is starved and waiting for the network.
+  final bool underrun;
+
+  /// The demuxer is not reading, e.g. because the cache is full.
+  final bool idle;
+
+  const MpvCacheState({
+    this.seekableRanges = const [],
+    this.cacheEnd = -1,
+    this.readerPts = -1,
+    this.cacheDuration = -1,
+    this.forwardBytes = 0,
+    this.totalBytes = 0,
+    this.rawInputRate = 0,
+    this.eof = false,
+    this.underrun = false,
+    this.idle = false,
+  });
+
+  factory MpvCacheState.fromMap(Map<Object?, Object?> map) => MpvCacheState(
+        seekableRanges: (map['seekableRanges'] as List<Object?>? ?? const [])
+            .map((e) => e as Map<Object?, Object?>)
+            .map((e) => MpvCacheRange(
+                (e['start'] as num? ?? 0).toDouble(),
+                (e['end'] as num? ?? 0).toDouble()))
+            .toList(),
+        cacheEnd: (map['cacheEnd'] as num? ?? -1).toDouble(),
+        readerPts: (map['readerPts'] as num? ?? -1).toDouble(),
+        cacheDuration: (map['cacheDuration'] as num? ?? -1).toDouble(),
+        forwardBytes: map['forwardBytes'] as int? ?? 0,
+        totalBytes: map['totalBytes'] as int? ?? 0,
+        rawInputRate: map['rawInputRate'] as int? ?? 0,
+        eof: map['eof'] as bool? ?? false,
+        underrun: map['underrun'] as bool? ?? false,
+        idle: map['idle'] as bool? ?? false,
+      );
+}
+
+class MpvCacheRange {
+  final double start;
+  final double end;
+
+  const MpvCacheRange(this.start, this.end);
+}
+
+/// Frame delivery and A/V sync counters of one player.
+///
+/// mpv's counters tell whether frames were lost in decode or VO timing; the
+/// plugin's counters tell whether they were lost between render and Flutter.
+/// mpv values are `-1` / `null` when the property is unavailable (e.g. before
+/// a file is loaded).
+class MpvTelemetry {
+  /// Monotonic timestamp of the sample in microseconds.
+  final int timestampUs;
+  final int framesRendered;
+  final int framesPublished;
+
+  /// Frames Flutter actually copied via `CopyPixelBuffer`.
+  final int framesConsumed;
+
+  /// Published frames replaced by a newer one before Flutter consumed them.
+  final int framesOverwritten;
+
+  /// mpv `frame-drop-count`.
+  final int mpvFrameDrops;
+
+  /// mpv `decoder-frame-drop-count`.
+  final int mpvDecoderFrameDrops;
+
+  /// mpv `vo-delayed-frame-count`.
+  final int mpvVoDelayedFrames;
+
+  /// mpv `avsync`: audio minus video position in seconds.
+  final double? avsync;
+
+  /// mpv `estimated-vf-fps`.
+  final double? estimatedVfFps;
+
+  /// Kernel + user CPU time of the whole process in microseconds. The
+  /// difference between two samples over their [timestampUs] difference is
+  /// the process CPU load, e.g. to compare trick play against plain speed
+  /// scaling.
+  final int processCpuUs;
+
+  /// Process CPU load (percent of one core) over this player's last hidden
+  /// interval, from [MpvNativeTextureController.setVisibility] to hidden until
+  /// it was shown again. `null` before the player was ever hidden.
+  final double? hiddenCpuPercent;
+
+  /// The same over the last interval the player was shown (visible or
+  /// thumbnail). Minus [hiddenCpuPercent], about what hiding it saves.
+  final double? shownCpuPercent;
+
+  const MpvTelemetry({
+    required this.timestampUs,
+    required this.framesRendered,
+    required this.framesPublished,
+    required this.framesConsumed,
+    required this.framesOverwritten,
+    required this.mpvFrameDrops,
+    required this.mpvDecoderFrameDrops,
+    required this.mpvVoDelayedFrames,
+    this.avsync,
+    this.estimatedVfFps,
+    this.processCpuUs = 0,
+    this.hiddenCpuPercent,
+    this.shownCpuPercent,
+  });
+
+  factory MpvTelemetry.fromMap(Map<Object?, Object?> map) => MpvTelemetry(
+        timestampUs: map['timestampUs'] as int? ?? 0,
+        framesRendered: map['framesRendered'] as int? ?? 0,
+        framesPublished: map['framesPublished'] as int? ?? 0,
+        framesConsumed: map['framesConsumed'] as int? ?? 0,
+        framesOverwritten: map['framesOverwritten'] as int? ?? 0,
+        mpvFrameDrops: map['mpvFrameDrops'] as int? ?? -1,
+        mpvDecoderFrameDrops: map['mpvDecoderFrameDrops'] as int? ?? -1,
+        mpvVoDelayedFrames: map['mpvVoDelayedFrames'] as int? ?? -1,
+        avsync: (map['avsync'] as num?)?.toDouble(),
+        estimatedVfFps: (map['estimatedVfFps'] as num?)?.toDouble(),
+        processCpuUs: map['processCpuUs'] as int? ?? 0,
+        hiddenCpuPercent: (map['hiddenCpuPercent'] as num?)?.toDouble(),
+        shownCpuPercent: (map['shownCpuPercent'] as num?)?.toDouble(),
+      );
+}
+
+/// Result of [MpvSeekPreview.previewAt].
+class MpvPreviewFrame {
+  /// Position of the keyframe shown, in seconds. Keyframe seeks land on or
+  /// before the requested time.
+  final double time;
+
+  /// Served from the thumbnail cache without decoding.
+  final bool cached;
+
+  /// Time from the request to the frame being on the texture.
+  final Duration latency;
+
+  const MpvPreviewFrame(this.time, this.cached, this.latency);
+}
+
+/// Seek-bar hover thumbnails for one media file (Windows only).
+///
+/// Runs a separate, audio-less mpv instance with the software renderer at
+/// thumbnail size, so hovering never seeks the main player. Decoded
+/// thumbnails are cached per [quantum] seconds (LRU, [cacheEntries] of
+/// them). The current thumbnail is shown on the texture [textureId]; show it
+/// with a `Texture` widget.
+class MpvSeekPreview {
+  final int textureId;
+  final int width;
+  final int height;
+
+  MpvSeekPreview._(this.textureId, this.width, this.height);
+
+  /// Opens [path] for previews. Returns null off Windows.
+  static Future<MpvSeekPreview?> create(
+    String path, {
+    int width = 160,
+    int height = 90,
+    double quantum = 2.0,
+    int cacheEntries = 256,
+  }) async {
+    if (!Platform.isWindows) return null;
+    final int id = await MpvNativeTextureController._channel
+        .invokeMethod('createPreview', <String, dynamic>{
+      'path': path,
+      'width': width,
+      'height': height,
+      'quantum': quantum,
+      'cacheEntries': cacheEntries,
+    });
+    return MpvSeekPreview._(id, width, height);
+  }
+
+  /// Shows the keyframe nearest before [seconds] on the texture. Returns null
+  /// when a newer call superseded this one before it was decoded, which is
+  /// the normal case while the pointer moves.
+  Future<MpvPreviewFrame?> previewAt(double seconds) async {
+    final result = await MpvNativeTextureController._channel
+        .invokeMapMethod<String, dynamic>('previewAt', <String, dynamic>{
+      'previewId': textureId,
+      'seconds': seconds,
+    });
+    if (result == null || result['superseded'] == true) return null;
+    return MpvPreviewFrame(
+      (result['time'] as num).toDouble(),
+      result['cached'] as bool,
+      Duration(microseconds: result['latencyUs'] as int),
+    );
+  }
+
+  /// Cache counters (`hits`, `misses`, `superseded`, `entries`) and the
+  /// keyframe `decode` timing (`count`, `meanUs`, `p50Us`, ...).
+  Future<Map<String, dynamic>> getStats() async {
+    final result = await MpvNativeTextureController._channel
+        .invokeMapMethod<String, dynamic>(
+            'getPreviewStats', <String, dynamic>{'previewId': textureId});
+    return result ?? <String, dynamic>{};
+  }
+
+  Future<void> dispose() => MpvNativeTextureController._channel
+      .invokeMethod('disposePreview', <String, dynamic>{'previewId': textureId});
+}
+
+/// One generated (or cached) timeline sprite sheet.
+class MpvSpriteSheet {
+  final String source;
+  final bool ok;
+
+  /// Served from the on-disk cache without decoding.
+  final bool cached;
+  final String error;
+
+  /// Atlas image (`.jpg` or `.png`) with [count] tiles packed row-major,
+  /// [columns] per row.
+  final String imagePath;
+
+  /// JSON index with the timestamp and tile origin of every thumbnail.
+  final String indexPath;
+  final int count;
+  final int columns;
+  final int rows;
+  final Duration elapsed;
+
+  const MpvSpriteSheet({
+    required this.source,
+    required this.ok,
+    required this.cached,
+    required this.error,
+    required this.imagePath,
+    required this.indexPath,
+    required this.count,
+    required this.columns,
+    required this.rows,
+    required this.elapsed,
+  });
+
+  factory MpvSpriteSheet.fromMap(Map<Object?, Object?> map) => MpvSpriteSheet(
+        source: map['source'] as String? ?? '',
+        ok: map['ok'] as bool? ?? false,
+        cached: map['cached'] as bool? ?? false,
+        error: map['error'] as String? ?? '',
+        imagePath: map['imagePath'] as String? ?? '',
+        indexPath: map['indexPath'] as String? ?? '',
+        count: map['count'] as int? ?? 0,
+        columns: map['columns'] as int? ?? 0,
+        rows: map['rows'] as int? ?? 0,
+        elapsed: Duration(microseconds: map['elapsedUs'] as int? ?? 0),
+      );
+}
+
+/// Result of [MpvSpriteSheetBatch.done].
+class MpvSpriteSheetSummary {
+  /// In the order the paths were given.
+  final List<MpvSpriteSheet> sheets;
+  final int workers;
+  final Duration elapsed;
+
+  /// Throughput of the whole batch, cache hits included.
+  final double filesPerMinute;
+
+  const MpvSpriteSheetSummary(
+      this.sheets, this.workers, this.elapsed, this.filesPerMinute);
+}
+
+/// A running batch of timeline sprite sheets (Windows only).
+///
+/// A pool of audio-less, software-rendered mpv instances decodes [count]
+/// keyframes per file, evenly spaced over its duration, and packs them into
+/// one atlas image plus a JSON index. Every file is split across all
+/// workers. Sheets are cached on disk, keyed by the file's path, size,
+/// modification time, first 64 KB and the sheet parameters, so repeated
+/// requests for an unchanged file return immediately.
+class MpvSpriteSheetBatch {
+  final int batchId;
+
+  /// One event per finished file.
+  final Stream<MpvSpriteSheet> progress;
+
+  /// Completes once every file has a sheet or an error.
+  final Future<MpvSpriteSheetSummary> done;
+
+  MpvSpriteSheetBatch._(this.batchId, this.progress, this.done);
+
+  /// Starts generating sheets for [paths]. [workers] of 0 uses one per CPU
+  /// core. [format] is `jpeg` or `png`. Returns null off Windows.
+  static Future<MpvSpriteSheetBatch?> start(
+    List<String> paths, {
+    int count = 100,
+    int tileWidth = 160,
+    int tileHeight = 90,
+    int columns = 10,
+    int workers = 0,
+    String format = 'jpeg',
+    int quality = 80,
+    String? cacheDir,
+  }) async {
+    if (!Platform.isWindows) return null;
+    final int batchId = await MpvNativeTextureController._channel
+        .invokeMethod('generateSpriteSheets', <String, dynamic>{
+      'paths': paths,
+      'count': count,
+      'tileWidth': tileWidth,
+      'tileHeight': tileHeight,
+      'columns': columns,
+      'workers': workers,
+      'format': format,
+      'quality': quality,
+      if (cacheDir != null) 'cacheDir': cacheDir,
+    });
+    // Events are posted to the platform thread after this reply, so nothing
+    // is missed by filtering only now.
+    final events = MpvNativeTextureController._allEvents
+        .where((event) => event['batchId'] == batchId);
+    final progress = events
+        .where((event) => event['type'] == 'spriteSheet')
+        .map(MpvSpriteSheet.fromMap);
+    final done = events
+        .firstWhere((event) => event['type'] == 'spriteSheetsDone')
+        .then((event) => MpvSpriteSheetSummary(
+              (event['sheets'] as List<Object?>)
+                  .map((s) => MpvSpriteSheet.fromMap(s as Map<Object?, Object?>))
+                  .toList(),
+              event['workers'] as int? ?? 0,
+              Duration(microseconds: event['elapsedUs'] as int? ?? 0),
+              (event['filesPerMinute'] as num?)?.toDouble() ?? 0.0,
+            ));
+    return MpvSpriteSheetBatch._(batchId, progress, done);
+  }
+
+  /// Stops decoding; files not finished yet report an error in [done].
+  Future<void> cancel() => MpvNativeTextureController._channel.invokeMethod(
+      'cancelSpriteSheets', <String, dynamic>{'batchId': batchId});
+}
+
+/// One entry of a probed file's track list. Fields a track type does not
+/// have are 0 or empty.
+class MpvMediaTrack {
+  /// `video`, `audio` or `sub`.
+  final String type;
+  final int id;
+  final String codec;
+  final String lang;
+  final String title;
+  final bool isDefault;
+  final bool external;
+  final int width;
+  final int height;
+  final double fps;
+  final int channels;
+  final int sampleRate;
+
+  /// Bits per second as reported by the demuxer, 0 when unknown.
+  final int bitrate;
+
+  const MpvMediaTrack({
+    required this.type,
+    required this.id,
+    required this.codec,
+    required this.lang,
+    required this.title,
+    required this.isDefault,
+    required this.external,
+    required this.width,
+    required this.height,
+    required this.fps,
+    required this.channels,
+    required this.sampleRate,
+    required this.bitrate,
+  });
+
+  factory MpvMediaTrack.fromMap(Map<Object?, Object?> map) => MpvMediaTrack(
+        type: map['type'] as String? ?? '',
+        id: map['id'] as int? ?? 0,
+        codec: map['codec'] as String? ?? '',
+        lang: map['lang'] as String? ?? '',
+        title: map['title'] as String? ?? '',
+        isDefault: map['default'] as bool? ?? false,
+        external: map['external'] as bool? ?? false,
+        width: map['width'] as int? ?? 0,
+        height: map['height'] as int? ?? 0,
+        fps: (map['fps'] as num?)?.toDouble() ?? 0.0,
+        channels: map['channels'] as int? ?? 0,
+        sampleRate: map['sampleRate'] as int? ?? 0,
+        bitrate: map['bitrate'] as int? ?? 0,
+      );
+}
+
+/// Metadata of one file from [MpvMediaProbe].
+class MpvMediaInfo {
+  final String path;
+  final bool ok;
+
+  /// Taken from the persistent index; the file was not opened.
+  final bool cached;
+  final String error;
+  final Duration duration;
+  final String fileFormat;
+  final int fileSize;
+
+  /// Average over the whole file, bits per second.
+  final int bitrate;
+  final int width;
+  final int height;
+
+  /// Only filled in when probed with `videoParams: true`.
+  final String pixelFormat;
+  final List<MpvMediaTrack> tracks;
+
+  const MpvMediaInfo({
+    required this.path,
+    required this.ok,
+    required this.cached,
+    required this.error,
+    required this.duration,
+    required this.fileFormat,
+    required this.fileSize,
+    required this.bitrate,
+    required this.width,
+    required this.height,
+    required this.pixelFormat,
+    required this.tracks,
+  });
+
+  factory MpvMediaInfo.fromEvent(Map<Object?, Object?> event) {
+    final info = event['info'] as Map<Object?, Object?>? ?? const {};
+    return MpvMediaInfo(
+      path: event['path'] as String? ?? '',
+      ok: event['ok'] as bool? ?? false,
+      cached: event['cached'] as bool? ?? false,
+      error: event['error'] as String? ?? '',
+      duration: Duration(
+          microseconds:
+              (((info['duration'] as num?) ?? 0) * 1e6).round()),
+      fileFormat: info['fileFormat'] as String? ?? '',
+      fileSize: info['fileSize'] as int? ?? 0,
+      bitrate: info['bitrate'] as int? ?? 0,
+      width: info['width'] as int? ?? 0,
+      height: info['height'] as int? ?? 0,
+      pixelFormat: info['pixelFormat'] as String? ?? '',
+      tracks: (info['tracks'] as List<Object?>? ?? const [])
+          .map((t) => MpvMediaTrack.fromMap(t as Map<Object?, Object?>))
+          .toList(),
+    );
+  }
+}
+
+/// Result of [MpvMediaProbe.done].
+class MpvMediaProbeSummary {
+  final int total;
+
+  /// Files actually opened; the rest were [cached] or [failed].
+  final int probed;
+  final int cached;
+  final int failed;
+  final int workers;
+  final Duration elapsed;
+  final double filesPerSecond;
+
+  /// Per-file open timing (`count`, `meanUs`, `p50Us`, ...).
+  final Map<Object?, Object?> probe;
+
+  /// Files known to the index after this batch.
+  final int indexRecords;
+
+  const MpvMediaProbeSummary({
+    required this.total,
+    required this.probed,
+    required this.cached,
+    required this.failed,
+    required this.workers,
+    required this.elapsed,
+    required this.filesPerSecond,
+    required this.probe,
+    required this.indexRecords,
+  });
+}
+
+/// A running media probe batch (Windows only).
+///
+/// A pool of demux-only mpv instances (no video or audio output, decoders
+/// off) reads duration, container format and track list of each file.
+/// Results for local files are kept in a memory-mapped index keyed by path,
+/// size and modification time, so rescanning a library only opens files
+/// that are new or changed.
+class MpvMediaProbe {
+  final int batchId;
+
+  /// One event per file, in completion order.
+  final Stream<MpvMediaInfo> results;
+
+  /// Completes once every file has a result.
+  final Future<MpvMediaProbeSummary> done;
+
+  MpvMediaProbe._(this.batchId, this.results, this.done);
+
+  /// Probes [paths] with [workers] mpv instances (0: one per CPU core).
+  /// [videoParams] decodes the first video frame to report the decoded size
+  /// and pixel format, which makes each file noticeably slower to probe.
+  /// Files indexed by a probe without [videoParams] are probed again (and
+  /// re-indexed) the first time [videoParams] is requested.
+  /// [indexPath] defaults to a file in the temp directory. Returns null off
+  /// Windows.
+  static Future<MpvMediaProbe?> start(
+    List<String> paths, {
+    int workers = 0,
+    bool videoParams = false,
+    Duration timeout = const Duration(seconds: 10),
+    String? indexPath,
+  }) async {
+    if (!Platform.isWindows) return null;
+    final int batchId = await MpvNativeTextureController._channel
+        .invokeMethod('probeMedia', <String, dynamic>{
+      'paths': paths,
+      'workers': workers,
+      'videoParams': videoParams,
+      'timeoutMs': timeout.inMilliseconds,
+      if (indexPath != null) 'indexPath': indexPath,
+    });
+    final events = MpvNativeTextureController._allEvents
+        .where((event) => event['batchId'] == batchId);
+    final results = events
+        .where((event) => event['type'] == 'mediaProbe')
+        .map(MpvMediaInfo.fromEvent);
+    final done = events
+        .firstWhere((event) => event['type'] == 'mediaProbeDone')
+        .then((event) => MpvMediaProbeSummary(
+              total: event['total'] as int? ?? 0,
+              probed: event['probed'] as int? ?? 0,
+              cached: event['cached'] as int? ?? 0,
+              failed: event['failed'] as int? ?? 0,
+              workers: event['workers'] as int? ?? 0,
+              elapsed: Duration(microseconds: event['elapsedUs'] as int? ?? 0),
+              filesPerSecond:
+                  (event['filesPerSecond'] as num?)?.toDouble() ?? 0.0,
+              probe: event['probe'] as Map<Object?, Object?>? ?? const {},
+              indexRecords: event['indexRecords'] as int? ?? 0,
+            ));
+    return MpvMediaProbe._(batchId, results, done);
+  }
+
+  /// Stops probing; files not reached yet report an error.
+  Future<void> cancel() => MpvNativeTextureController._channel
+      .invokeMethod('cancelProbe', <String, dynamic>{'batchId': batchId});
+}
+
+/// Counters of the persistent disk cache, from [MpvDiskCache.stats].
+class MpvDiskCacheStats {
+  final String directory;
+
+  /// Remote files opened from the cache, and opened from the network.
+  final int hits;
+  final int misses;
+  final double hitRate;
+
+  /// Sizes of the cached files served by [hits].
+  final int bytesSaved;
+
+  /// Bytes of files added to the cache since it was configured.
+  final int bytesStored;
+  final int evictions;
+
+  /// Recordings that could not be written, e.g. because the file was larger
+  /// than `maxFileBytes`.
+  final int storeFailures;
+  final int entries;
+  final int totalBytes;
+
+  const MpvDiskCacheStats({
+    required this.directory,
+    required this.hits,
+    required this.misses,
+    required this.hitRate,
+    required this.bytesSaved,
+    required this.bytesStored,
+    required this.evictions,
+    required this.storeFailures,
+    required this.entries,
+    required this.totalBytes,
+  });
+
+  factory MpvDiskCacheStats.fromMap(Map<Object?, Object?> map) =>
+      MpvDiskCacheStats(
+        directory: map['directory'] as String? ?? '',
+        hits: map['hits'] as int? ?? 0,
+        misses: map['misses'] as int? ?? 0,
+        hitRate: (map['hitRate'] as num?)?.toDouble() ?? 0.0,
+        bytesSaved: map['bytesSaved'] as int? ?? 0,
+        bytesStored: map['bytesStored'] as int? ?? 0,
+        evictions: map['evictions'] as int? ?? 0,
+        storeFailures: map['storeFailures'] as int? ?? 0,
+        entries: map['entries'] as int? ?? 0,
+        totalBytes: map['totalBytes'] as int? ?? 0,
+      );
+}
+
+/// Opt-in persistent cache for remote media, shared by all players
+/// (Windows only).
+///
+/// While a remote file plays, mpv keeps all of it in an on-disk demuxer
+/// cache. Once it has been read to the end in one piece it is saved to
+/// [configure]'s directory, and opening the same URL later plays it from
+/// disk without touching the network. The least recently used files are
+/// evicted to stay under `maxBytes`. Each save is reported on
+/// [MpvNativeTextureController.diskCacheStores].
+class MpvDiskCache {
+  MpvDiskCache._();
+
+  /// Turns the cache on, or off with `enabled: false`. [directory] defaults
+  /// to a folder in the temp directory; files larger than [maxFileBytes] are
+  /// only streamed.
+  static Future<void> configure({
+    bool enabled = true,
+    String? directory,
+    int maxBytes = 4 << 30,
+    int maxFileBytes = 1 << 30,
+  }) async {
+    if (!Platform.isWindows) return;
+    await MpvNativeTextureController._channel
+        .invokeMethod('configureDiskCache', <String, dynamic>{
+      'enabled': enabled,
+      if (directory != null) 'directory': directory,
+      'maxBytes': maxBytes,
+      'maxFileBytes': maxFileBytes,
+    });
+  }
+
+  /// Null while the cache is off.
+  static Future<MpvDiskCacheStats?> stats() async {
+    if (!Platform.isWindows) return null;
+    final result = await MpvNativeTextureController._channel
+        .invokeMapMethod<Object?, Object?>('getDiskCacheStats');
+    return result == null ? null : MpvDiskCacheStats.fromMap(result);
+  }
+
+  /// Deletes every cached file not in use.
+  static Future<void> clear() async {
+    if (!Platform.isWindows) return;
+    await MpvNativeTextureController._channel.invokeMethod('clearDiskCache');
+  }
+}
+
+/// Phase breakdown of one [MpvNativeTextureController.open], from
+/// [MpvNativeTextureController.openTimings] (Windows only).
+///
+/// [phases] holds the time from the `open` call to each phase reached, in
+/// order: `startFile` (mpv began loading), `preloaded` (connected and
+/// probed), `fileLoaded`, `firstRender` (first decoded frame rendered),
+/// `firstPublish` (handed to the texture) and `firstCopy` (picked up by the
+/// Flutter engine).
+class MpvOpenTiming {
+  /// False when the file failed to open; [error] then says why.
+  final bool ok;
+  final String? error;
+  final Map<String, Duration> phases;
+
+  /// Open to `firstCopy`; null for failed opens.
+  final Duration? total;
+
+  /// Only on the player's first open: how long
+  /// [MpvNativeTextureController.create] took, per phase (`registerTexture`,
+  /// `glInit`, `loadDll`, `mpvCreate`, `mpvInitialize`, `renderContext`) and
+  /// as `total`.
+  final Map<String, Duration>? create;
+
+  const MpvOpenTiming({
+    required this.ok,
+    this.error,
+    required this.phases,
+    this.total,
+    this.create,
+  });
+
+  static Map<String, Duration> _durations(Object? map) =>
+      (map as Map<Object?, Object?>? ?? const {}).map((key, value) =>
+          MapEntry(key as String, Duration(microseconds: value as int)));
+
+  factory MpvOpenTiming.fromMap(Map<Object?, Object?> map) => MpvOpenTiming(
+        ok: map['ok'] as bool? ?? false,
+        error: map['error'] as String?,
+        phases: _durations(map['phasesUs']),
+        total: map['totalUs'] == null
+            ? null
+            : Duration(microseconds: map['totalUs'] as int),
+        create: map['createUs'] == null ? null : _durations(map['createUs']),
+      );
+}
+
+/// One [MpvNativeTextureController.runBenchmark] run (Windows only).
+class MpvBenchmarkResult {
+  /// False when the source failed or another open cut the run short.
+  final bool ok;
+  final String? error;
+
+  /// Texture size the frames were rendered at.
+  final int width;
+  final int height;
+
+  /// From the file's first new frame to its last.
+  final Duration elapsed;
+  final int framesRendered;
+  final int framesPublished;
+
+  /// Published frames the engine copied, and ones it never got to before
+  /// the next replaced them.
+  final int framesConsumed;
+  final int framesDropped;
+  final double renderFps;
+  final double publishFps;
+
+  /// Process CPU time from the open to the last new frame, loading
+  /// included; 100 is one core.
+  final double cpuPercent;
+  final int peakWorkingSetBytes;
+  final int workingSetBytes;
+  final int privateBytes;
+
+  /// Per-stage timings of the run, as in
+  /// [MpvNativeTextureController.getStats]' `stages`.
+  final Map<String, dynamic> stages;
+
+  const MpvBenchmarkResult({
+    required this.ok,
+    this.error,
+    required this.width,
+    required this.height,
+    required this.elapsed,
+    required this.framesRendered,
+    required this.framesPublished,
+    required this.framesConsumed,
+    required this.framesDropped,
+    required this.renderFps,
+    required this.publishFps,
+    required this.cpuPercent,
+    required this.peakWorkingSetBytes,
+    required this.workingSetBytes,
+    required this.privateBytes,
+    required this.stages,
+  });
+
+  factory MpvBenchmarkResult.fromMap(
+          Map<Object?, Object?> map, Map<String, dynamic> stages) =>
+      MpvBenchmarkResult(
+        ok: map['ok'] as bool? ?? false,
+        error: map['error'] as String?,
+        width: map['width'] as int? ?? 0,
+        height: map['height'] as int? ?? 0,
+        elapsed: Duration(microseconds: map['elapsedUs'] as int? ?? 0),
+        framesRendered: map['framesRendered'] as int? ?? 0,
+        framesPublished: map['framesPublished'] as int? ?? 0,
+        framesConsumed: map['framesConsumed'] as int? ?? 0,
+        framesDropped: map['framesDropped'] as int? ?? 0,
+        renderFps: (map['renderFps'] as num?)?.toDouble() ?? 0.0,
+        publishFps: (map['publishFps'] as num?)?.toDouble() ?? 0.0,
+        cpuPercent: (map['cpuPercent'] as num?)?.toDouble() ?? 0.0,
+        peakWorkingSetBytes: map['peakWorkingSetBytes'] as int? ?? 0,
+        workingSetBytes: map['workingSetBytes'] as int? ?? 0,
+        privateBytes: map['privateBytes'] as int? ?? 0,
+        stages: stages,
+      );
+}
+
 /// A unified mpv instance rendered into a Flutter external texture.
 /// Automatically selects the correct implementation based on the platform.
 class MpvNativeTextureController {
   static const MethodChannel _channel = MethodChannel('mpv_native_texture');
+  static const EventChannel _eventChannel =
+      EventChannel('mpv_native_texture/events');
+  static final Stream<Map<Object?, Object?>> _allEvents = _eventChannel
+      .receiveBroadcastStream()
+      .map((event) => event as Map<Object?, Object?>);
 
   final int textureId;
   final bool _isWindows;
@@ -31,6 +1103,65 @@ class MpvNativeTextureController {
     return MpvNativeTextureController._(id, isWindows);
   }
 
+  /// Starts recording render, event, method-call and texture-copy spans into
+  /// per-thread ring buffers for all players (Windows only).
+  static Future<void> startTrace() => _channel.invokeMethod('startTrace');
+
+  /// Stops tracing and writes the recorded spans to [path] as Chrome
+  /// trace-event JSON, loadable in Perfetto or chrome://tracing.
+  static Future<void> stopTrace(String path) =>
+      _channel.invokeMethod('stopTrace', <String, dynamic>{'path': path});
+
+  /// Open and create timings aggregated over all players since the last
+  /// reset (Windows only; empty elsewhere).
+  ///
+  /// `open` is keyed by the [MpvOpenTiming.phases] names, each summarizing
+  /// the time since the previous phase, plus `total`; `create` likewise for
+  /// [MpvOpenTiming.create]. Summaries have `count`, `meanUs`, `p50Us`,
+  /// `p95Us`, `p99Us` and `maxUs`. `opensCompleted` and `opensFailed` count
+  /// opens and are never reset. When [reset] is true the histograms are
+  /// cleared after reading.
+  static Future<Map<String, dynamic>> getOpenStats({bool reset = false}) async {
+    if (!Platform.isWindows) return <String, dynamic>{};
+    final result = await _channel.invokeMapMethod<String, dynamic>(
+        'getOpenStats', <String, dynamic>{'reset': reset});
+    return result ?? <String, dynamic>{};
+  }
+
+  /// A synthetic lavfi source for [runBenchmark]: mpv's testsrc2 pattern,
+  /// identical on every machine.
+  static String benchmarkSource({
+    int width = 1280,
+    int height = 720,
+    int fps = 60,
+    Duration duration = const Duration(seconds: 10),
+  }) =>
+      'av://lavfi:testsrc2=size=${width}x$height:rate=$fps'
+      ':duration=${duration.inMilliseconds / 1000}';
+
+  /// Plays [source] once, as fast as decoding and the texture pipeline
+  /// allow, and reports the throughput (Windows only; null elsewhere).
+  ///
+  /// The file is opened untimed (`untimed`, `video-sync=desync`, no audio)
+  /// through the normal render and publish path. Frames are rendered at the
+  /// controller's size, so create it at the resolution to measure. Adaptive
+  /// quality is turned off first, as it would lower the resolution
+  /// mid-run, and the player must be visible.
+  Future<MpvBenchmarkResult?> runBenchmark(String source) async {
+    if (!_isWindows) return null;
+    await setAdaptiveQuality(false);
+    final done = events.firstWhere((event) => event['type'] == 'benchmark');
+    await _channel.invokeMethod('open', <String, dynamic>{
+      'textureId': textureId,
+      'path': source,
+      'benchmark': true,
+    });
+    final event = await done;
+    final stats = await getStats();
+    return MpvBenchmarkResult.fromMap(
+        event, Map<String, dynamic>.from(stats['stages'] as Map? ?? {}));
+  }
+
   /// Releases resources used by this controller.
   Future<void> dispose() async {
     await _channel
@@ -40,10 +1171,30 @@ class MpvNativeTextureController {
   /// Opens a video file or URL.
   ///
   /// [pathOrUrl] can be a local file path or a remote URL.
-  Future<void> open(String pathOrUrl) async {
+  ///
+  /// The remaining arguments apply to this file only (Windows only; ignored
+  /// elsewhere). [start] begins playback at that position right away, which
+  /// is much quicker than opening and then calling [seekAbsolute]: mpv
+  /// never decodes the beginning. [pause] opens the file paused (or
+  /// playing). [fastStart] shows the first frame as early as possible: a
+  /// shallower probe, little readahead, no waiting for the cache or for
+  /// audio sync. [options] sets any other mpv options, e.g.
+  /// `{'aid': 'no'}`, and wins over [fastStart]'s.
+  Future<void> open(
+    String pathOrUrl, {
+    Duration? start,
+    bool? pause,
+    bool fastStart = false,
+    Map<String, String> options = const {},
+  }) async {
     await _channel.invokeMethod('open', <String, dynamic>{
       'textureId': textureId,
       'path': pathOrUrl,
+      if (_isWindows && start != null)
+        'start': start.inMicroseconds / Duration.microsecondsPerSecond,
+      if (_isWindows && pause != null) 'pause': pause,
+      if (_isWindows && fastStart) 'fastStart': true,
+      if (_isWindows && options.isNotEmpty) 'options': options,
     });
   }
 
@@ -108,6 +1259,670 @@ class MpvNativeTextureController {
         'textureId': textureId,
         'speed': speed,
       });
+
+  /// Returns frame pipeline statistics (Windows only).
+  ///
+  /// The map contains `stages`, keyed by `wakeup`, `makeCurrent`, `render`,
+  /// `readback`, `publish` and `consume`, each with `count`, `meanUs`,
+  /// `p50Us`, `p95Us`, `p99Us` and `maxUs`. It also holds `fps` (published
+  /// frames per second since the previous call) and the frame counters
+  /// `framesRendered`, `framesSkipped`, `framesPublished`, `framesConsumed`,
+  /// `framesDropped` (overwritten before Flutter consumed them),
+  /// `mpvFrameDrops` and `mpvDecoderFrameDrops`.
+  ///
+  /// `quality` describes the adaptive quality governor: `enabled`, `level`
+  /// (an [MpvQualityLevel] name), `load` (smoothed render + readback time over
+  /// the frame budget), `stepDowns`, `stepUps` and the most recent
+  /// `transitions` (`timestampUs`, `from`, `to`, `load`).
+  ///
+  /// `capture` holds [captureFrame] counters (`captured`, `failed`) and
+  /// `source`, `encode` and `total` timings in the same form as the stages.
+  /// While a frame tap runs, `frameTap` has `published`, `acquired`,
+  /// `overwritten`, `skipped` and the render-thread `copy` timing.
+  /// With [setFrameCache] enabled, `frameCache` has `frames`, `bytes`,
+  /// `maxBytes`, `position` (frames behind live), `hits`, `misses` and
+  /// `hitRate`.
+  /// After [startTrickPlay], `trickPlay` has `active`, `rate`, `visualFps`,
+  /// `seeks`, `coalesced` (ticks folded into a later seek), the `seek`
+  /// latency and `cpuPercent` (process CPU over the session, 100 = one core).
+  ///
+  /// When [reset] is true the stage histograms are cleared after reading.
+  Future<Map<String, dynamic>> getStats({bool reset = false}) async {
+    final result = await _channel.invokeMapMethod<String, dynamic>(
+        'getStats', <String, dynamic>{
+      'textureId': textureId,
+      'reset': reset,
+    });
+    return result ?? <String, dynamic>{};
+  }
+
+  /// Asynchronous events of this player (Windows only). Each map carries a
+  /// `type` key; see [logMessages] for the `log` events.
+  Stream<Map<Object?, Object?>> get events =>
+      _allEvents.where((event) => event['textureId'] == textureId);
+
+  /// How each [open] went, once its first frame reached the Flutter engine
+  /// or it failed.
+  Stream<MpvOpenTiming> get openTimings => events
+      .where((event) => event['type'] == 'opened')
+      .map(MpvOpenTiming.fromMap);
+
+  /// mpv log lines forwarded by [setLogLevel] with `stream: true`.
+  Stream<MpvLogMessage> get logMessages => events
+      .where((event) => event['type'] == 'log')
+      .map((event) => MpvLogMessage(event['prefix'] as String,
+          event['level'] as String, event['text'] as String));
+
+  /// Grabs a frame and encodes it off the platform and render threads
+  /// (Windows only).
+  ///
+  /// [width] / [height] scale the image; give one to keep the aspect ratio.
+  /// [quality] (1-100) applies to JPEG. With [path] the image is written to
+  /// that file and [MpvCapture.bytes] is null. From the texture, it fails
+  /// until the file opened last has published its first frame.
+  Future<MpvCapture> captureFrame({
+    MpvCaptureFormat format = MpvCaptureFormat.png,
+    MpvCaptureSource source = MpvCaptureSource.texture,
+    int? width,
+    int? height,
+    int quality = 90,
+    String? path,
+  }) async {
+    final result = await _channel.invokeMapMethod<String, dynamic>(
+        'captureFrame', <String, dynamic>{
+      'textureId': textureId,
+      'format': format.name,
+      'source': source.name,
+      if (width != null) 'width': width,
+      if (height != null) 'height': height,
+      'quality': quality,
+      if (path != null) 'path': path,
+    });
+    return MpvCapture(
+      width: result!['width'] as int,
+      height: result['height'] as int,
+      format: MpvCaptureFormat.values.byName(result['format'] as String),
+      bytes: result['bytes'] as Uint8List?,
+      path: result['path'] as String?,
+      sourceTime: Duration(microseconds: result['sourceUs'] as int),
+      encodeTime: Duration(microseconds: result['encodeUs'] as int),
+      totalTime: Duration(microseconds: result['totalUs'] as int),
+    );
+  }
+
+  /// Plays [inputs] as a grid of tiles in this player's single texture, using
+  /// one mpv instance and one render per frame (Windows only).
+  ///
+  /// [columns] fixes the grid width; by default the smallest square grid is
+  /// used. Inputs are attached asynchronously: a `mosaic` event on [events]
+  /// reports `ok` and any `failedInputs` (which show black). Calling [open]
+  /// leaves mosaic mode.
+  Future<MpvMosaicLayout> openMosaic(List<String> inputs,
+      {int columns = 0}) async {
+    final result = await _channel.invokeMapMethod<Object?, Object?>(
+        'openMosaic', <String, dynamic>{
+      'textureId': textureId,
+      'inputs': inputs,
+      'columns': columns,
+    });
+    return MpvMosaicLayout._fromMap(result!);
+  }
+
+  /// Replaces the input shown in [tile] while the other tiles keep playing.
+  /// Completion is reported by a `mosaicSwap` event with `tile`, `url`, `ok`
+  /// and `error`.
+  Future<void> swapMosaicInput(int tile, String url) =>
+      _channel.invokeMethod('swapMosaicInput', <String, dynamic>{
+        'textureId': textureId,
+        'tile': tile,
+        'url': url,
+      });
+
+  /// Adds another texture showing this player's video at [width] x [height],
+  /// e.g. for a picture-in-picture or preview widget (Windows only).
+  ///
+  /// The output shares this player's decode and mpv render: each frame is
+  /// downscaled on the GPU from the main texture, at most [maxFps] times per
+  /// second (0 = every frame). Returns a texture id for a [Texture] widget.
+  ///
+  /// Outputs keep updating while the main view is hidden, in standby or
+  /// throttled, at a cost: they are blitted from the main render, so mpv
+  /// still draws the full-size frame for every output frame, and a hidden
+  /// player keeps decoding video as long as it has outputs. An output never
+  /// runs faster than the video.
+  Future<int> addOutput({
+    required int width,
+    required int height,
+    int maxFps = 0,
+  }) async {
+    final int id = await _channel.invokeMethod('addOutput', <String, dynamic>{
+      'textureId': textureId,
+      'width': width,
+      'height': height,
+      'maxFps': maxFps,
+    });
+    return id;
+  }
+
+  /// Removes an output created by [addOutput].
+  Future<void> removeOutput(int outputId) =>
+      _channel.invokeMethod('removeOutput', <String, dynamic>{
+        'textureId': textureId,
+        'outputId': outputId,
+      });
+
+  /// Starts a raw frame feed for analytics (Windows only); replaces any
+  /// running tap.
+  ///
+  /// At most [maxFps] frames per second (0 = every rendered frame) are copied
+  /// from the render thread, downscaled to [width] x [height] (one side keeps
+  /// the aspect ratio; omitted keeps the texture size), into [slots] slots.
+  Future<MpvFrameTap> startFrameTap({
+    int maxFps = 10,
+    int? width,
+    int? height,
+    int slots = 3,
+  }) async {
+    final int id = await _channel.invokeMethod('startFrameTap', <String, dynamic>{
+      'textureId': textureId,
+      'maxFps': maxFps,
+      if (width != null) 'width': width,
+      if (height != null) 'height': height,
+      'slots': slots,
+    });
+    return MpvFrameTap._(this, id);
+  }
+
+  Future<void> _stopFrameTap() => _channel.invokeMethod(
+      'stopFrameTap', <String, dynamic>{'textureId': textureId});
+
+  /// Reads one telemetry sample (Windows only).
+  Future<MpvTelemetry> getTelemetry() async {
+    final result = await _channel.invokeMapMethod<Object?, Object?>(
+        'getTelemetry', <String, dynamic>{'textureId': textureId});
+    return MpvTelemetry.fromMap(result ?? const <Object?, Object?>{});
+  }
+
+  /// Samples pushed every [setTelemetryInterval].
+  Stream<MpvTelemetry> get telemetry => events
+      .where((event) => event['type'] == 'telemetry')
+      .map(MpvTelemetry.fromMap);
+
+  /// Starts pushing a [telemetry] sample every [interval]; [Duration.zero]
+  /// stops it (Windows only).
+  Future<void> setTelemetryInterval(Duration interval) =>
+      _channel.invokeMethod('setTelemetryInterval', <String, dynamic>{
+        'textureId': textureId,
+        'intervalMs': interval.inMilliseconds,
+      });
+
+  /// Adjusts the demuxer cache; `null` arguments keep their current value.
+  ///
+  /// [cache] is mpv's `cache` option (`yes`, `no` or `auto`). Byte limits
+  /// apply to the next cache trim; on standby they take effect when the
+  /// player leaves it.
+  Future<void> setCacheOptions({
+    String? cache,
+    double? cacheSecs,
+    int? demuxerMaxBytes,
+    int? demuxerMaxBackBytes,
+    double? demuxerReadaheadSecs,
+  }) =>
+      _channel.invokeMethod('setCacheOptions', <String, dynamic>{
+        'textureId': textureId,
+        if (cache != null) 'cache': cache,
+        if (cacheSecs != null) 'cacheSecs': cacheSecs,
+        if (demuxerMaxBytes != null) 'demuxerMaxBytes': demuxerMaxBytes,
+        if (demuxerMaxBackBytes != null)
+          'demuxerMaxBackBytes': demuxerMaxBackBytes,
+        if (demuxerReadaheadSecs != null)
+          'demuxerReadaheadSecs': demuxerReadaheadSecs,
+      });
+
+  /// Reads the demuxer cache state; `null` while nothing is loaded.
+  Future<MpvCacheState?> getCacheState() async {
+    final result = await _channel.invokeMapMethod<Object?, Object?>(
+        'getCacheState', <String, dynamic>{'textureId': textureId});
+    return result == null ? null : MpvCacheState.fromMap(result);
+  }
+
+  /// States pushed every [setCacheStateInterval].
+  Stream<MpvCacheState> get cacheStates => events
+      .where((event) => event['type'] == 'cacheState')
+      .map(MpvCacheState.fromMap);
+
+  /// Starts pushing a [cacheStates] sample every [interval]; [Duration.zero]
+  /// stops it (Windows only).
+  Future<void> setCacheStateInterval(Duration interval) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('setCacheStateInterval', <String, dynamic>{
+      'textureId': textureId,
+      'intervalMs': interval.inMilliseconds,
+    });
+  }
+
+  /// URLs of remote files this player saved to the [MpvDiskCache]. Failed
+  /// saves only show up in [MpvDiskCacheStats.storeFailures].
+  Stream<String> get diskCacheStores => events
+      .where((event) =>
+          event['type'] == 'diskCacheStore' && event['ok'] == true)
+      .map((event) => event['url'] as String);
+
+  /// Level changes made by the adaptive quality governor.
+  Stream<MpvQualityLevel> get qualityLevel => events
+      .where((event) => event['type'] == 'quality')
+      .map((event) => MpvQualityLevel.values.byName(event['level'] as String));
+
+  /// Enables or disables the adaptive quality governor (Windows only; on by
+  /// default). When the render thread cannot keep up with the video frame
+  /// rate it disables interpolation, switches to bilinear scaling, halves the
+  /// render resolution and finally caps the frame rate, stepping back up once
+  /// there is headroom again. Disabling restores full quality.
+  Future<void> setAdaptiveQuality(bool enabled) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('setAdaptiveQuality', <String, dynamic>{
+      'textureId': textureId,
+      'enabled': enabled,
+    });
+  }
+
+  /// Scans through the media at [rate] times real time by keyframe seeks
+  /// (Windows only). A negative [rate] rewinds; the magnitude is clamped to
+  /// 2-64.
+  ///
+  /// Unlike [setSpeed] this does not decode every frame: the player is paused
+  /// and muted and jumps from keyframe to keyframe [visualFps] times per
+  /// second, so long recordings can be scanned at a small fraction of the
+  /// decode cost. Calling it again while active changes the rate in place.
+  /// [stopTrickPlay], [play] and [pause] end it and restore the previous
+  /// pause and mute state; it also stops at either end of the file. Start
+  /// and stop are reported as `trickPlay` [events] (`active`, `rate`,
+  /// `visualFps`, `reason`).
+  Future<void> startTrickPlay(double rate, {int visualFps = 8}) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('startTrickPlay', <String, dynamic>{
+      'textureId': textureId,
+      'rate': rate,
+      'visualFps': visualFps,
+    });
+  }
+
+  /// Ends [startTrickPlay] (Windows only).
+  Future<void> stopTrickPlay() async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod(
+        'stopTrickPlay', <String, dynamic>{'textureId': textureId});
+  }
+
+  /// Configures the history of recently rendered frames that
+  /// [frameBackStep] is served from (Windows only; off by default).
+  ///
+  /// Frames are kept while their total size stays under [maxBytes];
+  /// [downscale] (1, 2 or 4) stores them at a fraction of the render size so
+  /// more fit. Reconfiguring clears the history.
+  Future<void> setFrameCache({
+    bool enabled = true,
+    int maxBytes = 256 * 1024 * 1024,
+    int downscale = 1,
+  }) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('setFrameCache', <String, dynamic>{
+      'textureId': textureId,
+      'enabled': enabled,
+      'maxBytes': maxBytes,
+      'downscale': downscale,
+    });
+  }
+
+  /// Shows the next frame and pauses (Windows only). After [frameBackStep]
+  /// this walks the frame history back towards the live frame; otherwise mpv
+  /// decodes the next frame. Returns true when served from the history.
+  Future<bool> frameStep() async {
+    if (!_isWindows) return false;
+    final cached = await _channel.invokeMethod<bool>(
+        'frameStep', <String, dynamic>{'textureId': textureId});
+    return cached ?? false;
+  }
+
+  /// Shows the previous frame and pauses (Windows only). Served instantly
+  /// from the frame history when [setFrameCache] is enabled and the frame is
+  /// still cached; otherwise mpv seeks to the previous keyframe and decodes
+  /// forward. [play] resumes exactly from the frame shown. Returns true when
+  /// served from the history.
+  Future<bool> frameBackStep() async {
+    if (!_isWindows) return false;
+    final cached = await _channel.invokeMethod<bool>(
+        'frameBackStep', <String, dynamic>{'textureId': textureId});
+    return cached ?? false;
+  }
+
+  /// Adds [url] to the end of the playlist, starting it if nothing plays
+  /// (Windows only).
+  ///
+  /// The entry after the current one is opened and buffered while the
+  /// current one plays, and audio continues without a gap when the formats
+  /// match, so items follow each other without a black frame. [open]
+  /// replaces the playlist with a single item.
+  Future<void> playlistAppend(String url) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('playlistAppend',
+        <String, dynamic>{'textureId': textureId, 'url': url});
+  }
+
+  /// Inserts [url] so that it ends up at [index] (Windows only).
+  Future<void> playlistInsert(int index, String url) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('playlistInsert', <String, dynamic>{
+      'textureId': textureId,
+      'index': index,
+      'url': url,
+    });
+  }
+
+  /// Moves the entry at [from] so that it ends up at [to] (Windows only).
+  Future<void> playlistMove(int from, int to) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('playlistMove', <String, dynamic>{
+      'textureId': textureId,
+      'from': from,
+      'to': to,
+    });
+  }
+
+  /// Removes the entry at [index]; removing the current one plays the next
+  /// (Windows only).
+  Future<void> playlistRemove(int index) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('playlistRemove',
+        <String, dynamic>{'textureId': textureId, 'index': index});
+  }
+
+  /// Jumps to the entry at [index] (Windows only).
+  Future<void> playlistPlay(int index) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('playlistPlay',
+        <String, dynamic>{'textureId': textureId, 'index': index});
+  }
+
+  /// Skips to the next entry. Returns false at the end of the playlist.
+  Future<bool> playlistNext() async {
+    if (!_isWindows) return false;
+    final moved = await _channel.invokeMethod<bool>(
+        'playlistNext', <String, dynamic>{'textureId': textureId});
+    return moved ?? false;
+  }
+
+  /// Goes back to the previous entry. Returns false at the start.
+  Future<bool> playlistPrev() async {
+    if (!_isWindows) return false;
+    final moved = await _channel.invokeMethod<bool>(
+        'playlistPrev', <String, dynamic>{'textureId': textureId});
+    return moved ?? false;
+  }
+
+  /// The playlist, each time its entries or the current position change
+  /// (Windows only).
+  Stream<MpvPlaylist> get playlist => events
+      .where((event) => event['type'] == 'playlist')
+      .map(MpvPlaylist.fromEvent);
+
+  /// For every automatic advance to the next entry, the time from the last
+  /// new frame of the finished item to the first frame of the next one.
+  /// Includes one frame interval; `getStats()['playlistGap']` summarizes
+  /// them.
+  Stream<Duration> get playlistTransitions => events
+      .where((event) => event['type'] == 'playlistTransition')
+      .map((event) => Duration(microseconds: event['gapUs'] as int));
+
+  /// Sets the minimum level of mpv log messages (Windows only).
+  ///
+  /// Messages are always written to the plugin's log. When [stream] is true
+  /// they are also delivered on [logMessages], at most [maxPerSecond] per
+  /// second; excess lines are summarized as a single "suppressed" message.
+  Future<void> setLogLevel(MpvLogLevel level,
+          {bool stream = false, int maxPerSecond = 20}) =>
+      _channel.invokeMethod('setLogLevel', <String, dynamic>{
+        'textureId': textureId,
+        'level': level.name,
+        'stream': stream,
+        'maxPerSecond': maxPerSecond,
+      });
+
+  /// Tells the player how much of its output is on screen so off-screen or
+  /// minimized players stop rendering (Windows only; ignored elsewhere).
+  ///
+  /// Switching back to [MpvVisibility.visible] re-enables a suspended video
+  /// track and shows a fresh frame via a keyframe seek.
+  Future<void> setVisibility(MpvVisibility visibility) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('setVisibility', <String, dynamic>{
+      'textureId': textureId,
+      'visibility': visibility.name,
+    });
+  }
+
+  /// Puts the player on standby for channel zapping, or brings it back
+  /// (Windows only).
+  ///
+  /// On standby the player is paused and muted, draws nothing and keeps only
+  /// a small demuxer cache, but stays opened with its video decoder ready.
+  /// Leaving standby unpauses it; the time until its picture is on the
+  /// texture arrives on [zapTimes]. See [MpvZapManager].
+  Future<void> setStandby(bool standby) async {
+    if (!_isWindows) return;
+    await _channel.invokeMethod('setStandby', <String, dynamic>{
+      'textureId': textureId,
+      'standby': standby,
+    });
+  }
+
+  /// For every return from standby, the time until the texture showed this
+  /// player's picture.
+  Stream<Duration> get zapTimes => events
+      .where((event) => event['type'] == 'zap')
+      .map((event) => Duration(microseconds: event['zapUs'] as int));
+}
+
+/// Outcome of [MpvZapManager.zapTo].
+class MpvZap {
+  final int channel;
+
+  /// A standby player already had the channel open.
+  final bool warm;
+
+  /// From leaving standby until the channel's picture was on the texture;
+  /// for a cold zap this includes opening the channel. Null if no frame
+  /// arrived within the timeout.
+  final Duration? zapTime;
+
+  const MpvZap(this.channel, this.warm, this.zapTime);
+}
+
+/// Instant switching between a fixed set of channels (Windows only).
+///
+/// Keeps [standbyCount] extra players on standby (see
+/// [MpvNativeTextureController.setStandby]), pre-opened on the channels most
+/// likely to be picked next: the caller's [hints] when given, otherwise the
+/// neighbours of the current channel (next, previous, next but one, ...).
+/// Zapping to a pre-opened channel swaps which texture is shown and
+/// unpauses; there is no cold open. Show [activeTextureId] with a `Texture`
+/// widget.
+///
+/// A paused live stream falls behind; with [refreshAfter] standby players
+/// reopen their channel once they have waited that long.
+class MpvZapManager {
+  final List<String> channels;
+  final int standbyCount;
+  final Duration? refreshAfter;
+
+  /// Texture of the player showing the current channel.
+  final ValueNotifier<int> activeTextureId;
+
+  final List<MpvNativeTextureController> _players;
+  final Map<MpvNativeTextureController, int> _channelOf = {};
+  final Map<MpvNativeTextureController, DateTime> _openedAt = {};
+  MpvNativeTextureController _active;
+  List<int>? _hints;
+  Timer? _refreshTimer;
+  Future<void> _busy = Future<void>.value();
+
+  MpvZapManager._(this.channels, this.standbyCount, this.refreshAfter,
+      this._players, this._active)
+      : activeTextureId = ValueNotifier<int>(_active.textureId);
+
+  /// Creates `standbyCount + 1` players, starts [initial] and pre-opens the
+  /// predicted channels.
+  static Future<MpvZapManager> create(
+    List<String> channels, {
+    int initial = 0,
+    int standbyCount = 2,
+    int width = 1280,
+    int height = 720,
+    Duration? refreshAfter,
+  }) async {
+    assert(channels.isNotEmpty);
+    final count = standbyCount.clamp(0, channels.length - 1) + 1;
+    final players = <MpvNativeTextureController>[];
+    for (var i = 0; i < count; i++) {
+      players.add(await MpvNativeTextureController.create(
+          width: width, height: height));
+    }
+    final manager = MpvZapManager._(
+        channels, count - 1, refreshAfter, players, players.first);
+    await manager._openOn(players.first, initial);
+    await players.first.play();
+    for (final player in players.skip(1)) {
+      await player.setStandby(true);
+    }
+    await manager._rebalance();
+    if (refreshAfter != null) {
+      manager._refreshTimer = Timer.periodic(
+          refreshAfter, (_) => manager._serialized(manager._refreshStale));
+    }
+    return manager;
+  }
+
+  int get current => _channelOf[_active] ?? -1;
+  MpvNativeTextureController get active => _active;
+
+  /// Channels to keep ready instead of the neighbours, most likely first.
+  /// Null returns to adjacency.
+  Future<void> setHints(List<int>? hints) {
+    _hints = hints;
+    return _serialized(_rebalance);
+  }
+
+  /// Switches to [channel]. Calls are queued, so rapid zapping stays
+  /// consistent.
+  Future<MpvZap> zapTo(int channel) {
+    final completer = Completer<MpvZap>();
+    _serialized(() async {
+      completer.complete(await _zap(channel));
+    });
+    return completer.future;
+  }
+
+  Future<void> dispose() async {
+    _refreshTimer?.cancel();
+    await _busy;
+    for (final player in _players) {
+      await player.dispose();
+    }
+    activeTextureId.dispose();
+  }
+
+  Future<void> _serialized(Future<void> Function() task) {
+    final next = _busy.then((_) => task());
+    _busy = next.catchError((Object _) {});
+    return next;
+  }
+
+  Future<MpvZap> _zap(int channel) async {
+    if (channel == current) return MpvZap(channel, true, Duration.zero);
+    var target = _players.firstWhere(
+        (p) => p != _active && _channelOf[p] == channel,
+        orElse: () => _active);
+    final warm = target != _active;
+    if (!warm) {
+      // Cold: reuse the standby holding the least likely channel.
+      final predicted = _predicted();
+      final standbys = _players.where((p) => p != _active).toList()
+        ..sort((a, b) => _rank(predicted, _channelOf[b])
+            .compareTo(_rank(predicted, _channelOf[a])));
+      if (standbys.isEmpty) {
+        await _openOn(_active, channel);
+        return MpvZap(channel, false, null);
+      }
+      target = standbys.first;
+      await _openOn(target, channel);
+    }
+
+    final zapTime = target.zapTimes.first
+        .timeout(const Duration(seconds: 10))
+        .then<Duration?>((d) => d, onError: (Object _) => null);
+    await target.setStandby(false);
+    final previous = _active;
+    _active = target;
+    activeTextureId.value = target.textureId;
+    await previous.setStandby(true);
+    await _rebalance();
+    return MpvZap(channel, warm, await zapTime);
+  }
+
+  /// Channels worth keeping ready, most likely first.
+  List<int> _predicted() {
+    final hints = _hints;
+    if (hints != null) {
+      return hints.where((c) => c != current).take(standbyCount).toList();
+    }
+    final n = channels.length;
+    final result = <int>[];
+    for (var step = 1; result.length < standbyCount && step < n; step++) {
+      for (final c in [(current + step) % n, (current - step + n) % n]) {
+        if (c != current && !result.contains(c) && result.length < standbyCount) {
+          result.add(c);
+        }
+      }
+    }
+    return result;
+  }
+
+  static int _rank(List<int> predicted, int? channel) {
+    final i = channel == null ? -1 : predicted.indexOf(channel);
+    return i < 0 ? predicted.length : i;
+  }
+
+  Future<void> _rebalance() async {
+    final predicted = _predicted();
+    final standbys = _players.where((p) => p != _active).toList();
+    final missing =
+        predicted.where((c) => !standbys.any((p) => _channelOf[p] == c));
+    final free = standbys
+        .where((p) => !predicted.contains(_channelOf[p]))
+        .toList();
+    for (final channel in missing) {
+      if (free.isEmpty) break;
+      await _openOn(free.removeAt(0), channel);
+    }
+  }
+
+  Future<void> _refreshStale() async {
+    final limit = refreshAfter;
+    if (limit == null) return;
+    final now = DateTime.now();
+    for (final player in _players) {
+      final channel = _channelOf[player];
+      final openedAt = _openedAt[player];
+      if (player == _active || channel == null || openedAt == null) continue;
+      if (now.difference(openedAt) >= limit) await _openOn(player, channel);
+    }
+  }
+
+  Future<void> _openOn(MpvNativeTextureController player, int channel) async {
+    _channelOf[player] = channel;
+    _openedAt[player] = DateTime.now();
+    await player.open(channels[channel]);
+  }
 }
 
 /// A widget that displays the video texture from [MpvNativeTextureController].
@@ -82,6 +82,7 @@ typedef void (*mpv_render_update_fn)(void *cb_ctx);
     (mpv_handle *, const char *, mpv_format, void *);
 @property(nonatomic, assign) int (*mpv_command)
     (mpv_handle *, const char *const *);
+@property(nonatomic, assign) void (*mpv_free)(void *);
 
 // render.h functions
 @property(nonatomic, assign) int (*mpv_render_context_create)
@@ -88,6 +88,7 @@
                                void *))dlsym(_handle, "mpv_get_property");
   _mpv_command =
       (int (*)(mpv_handle *, const char *const *))dlsym(_handle, "mpv_command");
+  _mpv_free = (void (*)(void *))dlsym(_handle, "mpv_free");
   _mpv_render_context_create =
       (int (*)(mpv_render_context **, mpv_handle *, mpv_render_param *))dlsym(
           _handle, "mpv_render_context_create");
@@ -104,6 +105,7 @@
   BOOL ok = _mpv_client_api_version && _mpv_error_string && _mpv_create &&
             _mpv_initialize && _mpv_destroy && _mpv_set_option_string &&
             _mpv_set_property && _mpv_get_property && _mpv_command &&
+            _mpv_free &&
             _mpv_render_context_create && _mpv_render_context_free &&
             _mpv_render_context_set_update_callback &&
             _mpv_render_context_render;
@@ -131,6 +133,7 @@
   _mpv_set_property = NULL;
   _mpv_get_property = NULL;
   _mpv_command = NULL;
+  _mpv_free = NULL;
   _mpv_render_context_create = NULL;
   _mpv_render_context_free = NULL;
   _mpv_render_context_set_update_callback = NULL;
@@ -106,6 +106,22 @@
       [player toggleMute];
       result(nil);
 
+    } else if ([@"setCacheOptions" isEqualToString:call.method]) {
+      NSError *error;
+      NSDictionary *options = [call.arguments isKindOfClass:[NSDictionary class]]
+                                  ? call.arguments
+                                  : @{};
+      if ([player setCacheOptions:options error:&error]) {
+        result(nil);
+      } else {
+        result([FlutterError errorWithCode:@"bad_args"
+                                   message:error.localizedDescription
+                                   details:nil]);
+      }
+
+    } else if ([@"getCacheState" isEqualToString:call.method]) {
+      result([player cacheState]);
+
     } else {
       result(FlutterMethodNotImplemented);
     }
@@ -19,6 +19,14 @@
 - (void)setSpeed:(double)speed;
 - (void)toggleMute;
 
+// Demuxer cache control. Recognized keys: cache (NSString), cacheSecs,
+// demuxerMaxBytes, demuxerMaxBackBytes, demuxerReadaheadSecs (NSNumber; byte
+// sizes may also be NSString with mpv suffixes). Missing keys are left alone.
+- (BOOL)setCacheOptions:(NSDictionary *)options error:(NSError **)error;
+// demuxer-cache-state with the same keys as on Windows, or nil while nothing
+// is loaded.
+- (NSDictionary *)cacheState;
+
 @property(nonatomic, readonly) int64_t textureId;
 @property(nonatomic, readonly) BOOL isInitialized;
 @property(nonatomic, readonly) NSString *initializationError;
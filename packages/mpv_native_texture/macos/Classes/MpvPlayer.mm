@@ -142,8 +142,9 @@ static void on_mpv_render_update(void *ctx) {
     _api.mpv_set_option_string(_mpv, "msg-level", "all=warn");
     _api.mpv_set_option_string(_mpv, "vd-lavc-threads",
                                "4"); // Parallel decoding
-    _api.mpv_set_option_string(_mpv, "cache-secs",
-                               "10"); // Increase cache for smooth playback
+    _api.mpv_set_option_string(
+        _mpv, "cache-secs",
+        "10"); // Initial value; see setCacheOptions:error:
 
     // Initialize MPV
     int rc = _api.mpv_initialize(_mpv);
@@ -519,4 +520,89 @@ static void on_mpv_render_update(void *ctx) {
   _api.mpv_set_property(_mpv, "mute", MPV_FORMAT_FLAG, &mute);
 }
 
+#pragma mark - Cache
+
+- (BOOL)setCacheOptions:(NSDictionary *)options error:(NSError **)error {
+  if (!_mpv) {
+    if (error) {
+      *error = [NSError
+          errorWithDomain:@"MpvPlayer"
+                     code:-1
+                 userInfo:@{NSLocalizedDescriptionKey : @"Player not initialized"}];
+    }
+    return NO;
+  }
+
+  NSDictionary<NSString *, NSString *> *properties = @{
+    @"cache" : @"cache",
+    @"cacheSecs" : @"cache-secs",
+    @"demuxerMaxBytes" : @"demuxer-max-bytes",
+    @"demuxerMaxBackBytes" : @"demuxer-max-back-bytes",
+    @"demuxerReadaheadSecs" : @"demuxer-readahead-secs",
+  };
+  for (NSString *key in properties) {
+    id value = options[key];
+    if (!value || value == [NSNull null])
+      continue;
+    NSString *text = [value isKindOfClass:[NSNumber class]]
+                         ? [value stringValue]
+                         : [value description];
+    const char *cValue = text.UTF8String;
+    int rc = _api.mpv_set_property(_mpv, properties[key].UTF8String,
+                                   MPV_FORMAT_STRING, &cValue);
+    if (rc < 0) {
+      if (error) {
+        *error = [NSError
+            errorWithDomain:@"MpvPlayer"
+                       code:rc
+                   userInfo:@{
+                     NSLocalizedDescriptionKey : [NSString
+                         stringWithFormat:@"%@: %s", properties[key],
+                                          _api.mpv_error_string(rc)]
+                   }];
+      }
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (NSDictionary *)cacheState {
+  if (!_mpv)
+    return nil;
+  // Node-valued properties read as strings come back as JSON.
+  char *json = NULL;
+  if (_api.mpv_get_property(_mpv, "demuxer-cache-state", MPV_FORMAT_STRING,
+                            &json) < 0 ||
+      !json)
+    return nil;
+  NSData *data = [NSData dataWithBytes:json length:strlen(json)];
+  _api.mpv_free(json);
+  NSDictionary *state = [NSJSONSerialization JSONObjectWithData:data
+                                                        options:0
+                                                          error:NULL];
+  if (![state isKindOfClass:[NSDictionary class]])
+    return nil;
+
+  NSMutableArray *ranges = [NSMutableArray array];
+  for (NSDictionary *range in state[@"seekable-ranges"] ?: @[]) {
+    [ranges addObject:@{
+      @"start" : range[@"start"] ?: @0,
+      @"end" : range[@"end"] ?: @0
+    }];
+  }
+  return @{
+    @"seekableRanges" : ranges,
+    @"cacheEnd" : state[@"cache-end"] ?: @-1,
+    @"readerPts" : state[@"reader-pts"] ?: @-1,
+    @"cacheDuration" : state[@"cache-duration"] ?: @-1,
+    @"forwardBytes" : state[@"fw-bytes"] ?: @0,
+    @"totalBytes" : state[@"total-bytes"] ?: @0,
+    @"rawInputRate" : state[@"raw-input-rate"] ?: @0,
+    @"eof" : state[@"eof"] ?: @NO,
+    @"underrun" : state[@"underrun"] ?: @NO,
+    @"idle" : state[@"idle"] ?: @NO,
+  };
+}
+
 @end
@@ -0,0 +1,55 @@
+#pragma once
+
+// Control surface of the fake libmpv (libmpv-fake.so). Code under test keeps
+// loading "libmpv" as usual (MPV_LIBRARY=/path/to/libmpv-fake.so); a test or
+// benchmark resolves these from the same handle with dlsym to steer it and to
+// read back what was called. Everything here can also be set from the
+// environment before the first mpv_create(), as FAKE_MPV_<KEY> with the key
+// upper-cased and '-' as '_' (FAKE_MPV_LOAD_DELAY_MS=200).
+//
+// Settings, read when a handle is created:
+//   fps                 synthetic frame rate (60); "untimed=yes" ignores it
+//                       and produces the next frame as soon as one is rendered
+//   duration            seconds per file (10); 0 plays forever
+//   size                WxH of the synthetic video (1280x720)
+//   load-delay-ms       time loadfile spends opening, between the on_load and
+//                       on_preloaded hooks (0)
+//   render-delay-us     extra time each mpv_render_context_render takes (0)
+//   fail                comma-separated failure points, each "name" or
+//                       "name=<mpv error>": an exported mpv_* function, a
+//                       command name (seek), or "open" for files that end
+//                       with END_FILE/ERROR while loading. The error
+//                       defaults to MPV_ERROR_GENERIC (LOADING_FAILED for
+//                       "open")
+//   fail-after-frames   end the file with an error after N frames (-1: never)
+//   log                 also append every recorded call to this file
+//
+// av://lavfi:testsrc2=size=WxH:rate=R:duration=D URLs (what render_bench and
+// MpvPlayerController.benchmarkSource play) override size, fps and duration
+// for that file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mpv/client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Overrides a setting for handles created afterwards; NULL value removes the
+// override.
+MPV_EXPORT void fake_mpv_set(const char* key, const char* value);
+// Drops all overrides and clears the call log.
+MPV_EXPORT void fake_mpv_reset(void);
+// Calls made to an exported mpv_* function, or of a command ("seek"), since
+// the last reset.
+MPV_EXPORT int64_t fake_mpv_call_count(const char* name);
+// Copies the newline-separated call log ("mpv_command loadfile x.mkv") into
+// |buffer| (NUL-terminated, truncated to |size|). Returns the full length.
+// The log keeps the most recent 65536 calls.
+MPV_EXPORT size_t fake_mpv_calls(char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,314 @@
+// fake_mpv_test: checks the fake libmpv against what MpvPlayer and the tools
+// rely on. Links libmpv-fake directly; run through ctest. Runs every
+// scenario and exits non-zero if any check failed.
+//
+// Frames are produced untimed and rendered by a thread of the test, so the
+// sequence numbers and call counts checked here do not depend on timing.
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_mpv.h"
+#include "mpv/client.h"
+#include "mpv/render.h"
+
+namespace {
+
+int g_failures = 0;
+
+#define EXPECT(cond)                                                                       \
+  do {                                                                                     \
+    if (!(cond)) {                                                                         \
+      std::fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond);             \
+      ++g_failures;                                                                        \
+    }                                                                                      \
+  } while (0)
+
+#define EXPECT_EQ(a, b)                                                                    \
+  do {                                                                                     \
+    const long long expect_a = static_cast<long long>(a);                                  \
+    const long long expect_b = static_cast<long long>(b);                                  \
+    if (expect_a != expect_b) {                                                            \
+      std::fprintf(stderr, "%s:%d: %s == %s: %lld vs %lld\n", __FILE__, __LINE__, #a, #b,  \
+                   expect_a, expect_b);                                                    \
+      ++g_failures;                                                                        \
+    }                                                                                      \
+  } while (0)
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 16;
+
+// Renders on its own thread whenever the update callback fires, like the
+// plugin's render thread, and keeps the sequence number of every new frame.
+class Renderer {
+ public:
+  explicit Renderer(mpv_handle* mpv) {
+    const char* api_type = MPV_RENDER_API_TYPE_SW;
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(api_type)},
+        {MPV_RENDER_PARAM_INVALID, nullptr},
+    };
+    ok_ = mpv_render_context_create(&render_, mpv, params) >= 0;
+    if (!ok_) return;
+    pixels_.assign(static_cast<size_t>(kWidth) * kHeight * 4u, 0);
+    thread_ = std::thread([this] { Main(); });
+    mpv_render_context_set_update_callback(render_, &Renderer::OnUpdate, this);
+  }
+
+  ~Renderer() {
+    if (!ok_) return;
+    mpv_render_context_set_update_callback(render_, nullptr, nullptr);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+    mpv_render_context_free(render_);
+  }
+
+  bool ok() const { return ok_; }
+
+  // Waits for requested renders to finish, then returns the frame numbers.
+  std::vector<int64_t> Frames() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return !pending_ && !rendering_; });
+    return frames_;
+  }
+
+ private:
+  static void OnUpdate(void* ctx) {
+    auto* self = static_cast<Renderer*>(ctx);
+    {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      self->pending_ = true;
+    }
+    self->cv_.notify_one();
+  }
+
+  void Main() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      cv_.wait(lock, [this] { return pending_ || !running_; });
+      if (!running_) return;
+      pending_ = false;
+      rendering_ = true;
+      lock.unlock();
+
+      const uint64_t flags = mpv_render_context_update(render_);
+      int size[2] = {kWidth, kHeight};
+      char format[] = "rgb0";
+      size_t stride = static_cast<size_t>(kWidth) * 4u;
+      mpv_render_param params[] = {
+          {MPV_RENDER_PARAM_SW_SIZE, size},
+          {MPV_RENDER_PARAM_SW_FORMAT, format},
+          {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+          {MPV_RENDER_PARAM_SW_POINTER, pixels_.data()},
+          {MPV_RENDER_PARAM_INVALID, nullptr},
+      };
+      const bool rendered = mpv_render_context_render(render_, params) >= 0;
+      // The fake writes the frame number little-endian into the first bytes.
+      int64_t frame = 0;
+      for (size_t i = 0; i < sizeof(frame); ++i) frame |= static_cast<int64_t>(pixels_[i]) << (8 * i);
+
+      lock.lock();
+      if (rendered && (flags & MPV_RENDER_UPDATE_FRAME)) frames_.push_back(frame);
+      rendering_ = false;
+      idle_cv_.notify_all();
+    }
+  }
+
+  bool ok_ = false;
+  mpv_render_context* render_ = nullptr;
+  std::vector<uint8_t> pixels_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable idle_cv_;
+  bool running_ = true;
+  bool pending_ = false;
+  bool rendering_ = false;
+  std::vector<int64_t> frames_;
+};
+
+mpv_handle* CreatePlayer() {
+  mpv_handle* mpv = mpv_create();
+  if (!mpv) return nullptr;
+  mpv_set_option_string(mpv, "untimed", "yes");
+  mpv_set_option_string(mpv, "keep-open", "no");
+  if (mpv_initialize(mpv) < 0) {
+    mpv_terminate_destroy(mpv);
+    return nullptr;
+  }
+  return mpv;
+}
+
+// Runs the event loop until END_FILE, continuing hooks. Returns the event
+// ids in order (hooks as MPV_EVENT_HOOK) and the END_FILE payload.
+std::vector<mpv_event_id> RunToEnd(mpv_handle* mpv, mpv_event_end_file* end_out,
+                                   std::vector<std::string>* hooks_out = nullptr,
+                                   std::vector<double>* positions_out = nullptr) {
+  std::vector<mpv_event_id> events;
+  for (;;) {
+    const mpv_event* event = mpv_wait_event(mpv, 5.0);
+    if (event->event_id == MPV_EVENT_NONE) {
+      std::fprintf(stderr, "timed out waiting for END_FILE\n");
+      ++g_failures;
+      return events;
+    }
+    if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+      const auto* prop = static_cast<const mpv_event_property*>(event->data);
+      if (positions_out && prop->format == MPV_FORMAT_DOUBLE && std::strcmp(prop->name, "time-pos") == 0) {
+        positions_out->push_back(*static_cast<const double*>(prop->data));
+      }
+      continue;
+    }
+    events.push_back(event->event_id);
+    if (event->event_id == MPV_EVENT_HOOK) {
+      const auto* hook = static_cast<const mpv_event_hook*>(event->data);
+      if (hooks_out) hooks_out->push_back(hook->name);
+      mpv_hook_continue(mpv, hook->id);
+    } else if (event->event_id == MPV_EVENT_END_FILE) {
+      *end_out = *static_cast<const mpv_event_end_file*>(event->data);
+      return events;
+    }
+  }
+}
+
+int Index(const std::vector<mpv_event_id>& events, mpv_event_id id) {
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (events[i] == id) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+// One second at 25 fps: hooks in order, then every frame rendered exactly
+// once with consecutive sequence numbers.
+void TestPlaysEveryFrame() {
+  fake_mpv_reset();
+  fake_mpv_set("duration", "1");
+  fake_mpv_set("fps", "25");
+  mpv_handle* mpv = CreatePlayer();
+  EXPECT(mpv != nullptr);
+  if (!mpv) return;
+  mpv_hook_add(mpv, 1, "on_load", 0);
+  mpv_hook_add(mpv, 2, "on_preloaded", 0);
+  {
+    Renderer renderer(mpv);
+    EXPECT(renderer.ok());
+    const char* cmd[] = {"loadfile", "/media/one-second.mkv", nullptr};
+    EXPECT_EQ(mpv_command(mpv, cmd), 0);
+
+    mpv_event_end_file end{};
+    std::vector<std::string> hooks;
+    const std::vector<mpv_event_id> events = RunToEnd(mpv, &end, &hooks);
+    EXPECT_EQ(end.reason, MPV_END_FILE_REASON_EOF);
+    EXPECT(hooks == (std::vector<std::string>{"on_load", "on_preloaded"}));
+    EXPECT(Index(events, MPV_EVENT_START_FILE) >= 0);
+    EXPECT(Index(events, MPV_EVENT_START_FILE) < Index(events, MPV_EVENT_FILE_LOADED));
+    EXPECT(Index(events, MPV_EVENT_FILE_LOADED) < Index(events, MPV_EVENT_END_FILE));
+
+    const std::vector<int64_t> frames = renderer.Frames();
+    EXPECT_EQ(frames.size(), 25);
+    for (size_t i = 0; i < frames.size(); ++i) EXPECT_EQ(frames[i], static_cast<int64_t>(i) + 1);
+    EXPECT(fake_mpv_call_count("mpv_render_context_render") >= static_cast<int64_t>(frames.size()));
+  }
+  EXPECT_EQ(fake_mpv_call_count("loadfile"), 1);
+  EXPECT_EQ(fake_mpv_call_count("mpv_hook_continue"), 2);
+  EXPECT_EQ(fake_mpv_call_count("mpv_render_context_create"), 1);
+  EXPECT_EQ(fake_mpv_call_count("mpv_render_context_free"), 1);
+  mpv_terminate_destroy(mpv);
+}
+
+// loadfile's per-file start option (map form, as Open() sends it) and a
+// seek are reflected in time-pos, and counted.
+void TestStartAndSeek() {
+  fake_mpv_reset();
+  fake_mpv_set("duration", "1");
+  fake_mpv_set("fps", "10");
+  mpv_handle* mpv = CreatePlayer();
+  EXPECT(mpv != nullptr);
+  if (!mpv) return;
+  mpv_observe_property(mpv, 1, "time-pos", MPV_FORMAT_DOUBLE);
+  {
+    Renderer renderer(mpv);
+    char* option_keys[] = {const_cast<char*>("start")};
+    mpv_node option_values[1]{};
+    option_values[0].format = MPV_FORMAT_STRING;
+    option_values[0].u.string = const_cast<char*>("0.5");
+    mpv_node_list options{1, option_values, option_keys};
+    char* keys[] = {const_cast<char*>("name"), const_cast<char*>("url"), const_cast<char*>("flags"),
+                    const_cast<char*>("options")};
+    mpv_node values[4]{};
+    const char* strings[] = {"loadfile", "/media/start.mkv", "replace"};
+    for (int i = 0; i < 3; ++i) {
+      values[i].format = MPV_FORMAT_STRING;
+      values[i].u.string = const_cast<char*>(strings[i]);
+    }
+    values[3].format = MPV_FORMAT_NODE_MAP;
+    values[3].u.list = &options;
+    mpv_node_list args{4, values, keys};
+    mpv_node cmd{};
+    cmd.format = MPV_FORMAT_NODE_MAP;
+    cmd.u.list = &args;
+    EXPECT_EQ(mpv_command_node(mpv, &cmd, nullptr), 0);
+
+    mpv_event_end_file end{};
+    std::vector<double> positions;
+    RunToEnd(mpv, &end, nullptr, &positions);
+    EXPECT_EQ(end.reason, MPV_END_FILE_REASON_EOF);
+    EXPECT(!positions.empty());
+    if (!positions.empty()) EXPECT(positions.front() >= 0.49 && positions.front() <= 0.51);
+    // 0.5 s left at 10 fps: the frame at 0.5 and four more.
+    EXPECT_EQ(renderer.Frames().size(), 5);
+
+    const char* seek[] = {"seek", "0.2", "absolute", nullptr};
+    EXPECT(mpv_command(mpv, seek) < 0);  // nothing loaded any more
+  }
+  EXPECT_EQ(fake_mpv_call_count("loadfile"), 1);
+  EXPECT_EQ(fake_mpv_call_count("seek"), 1);
+  mpv_terminate_destroy(mpv);
+}
+
+// An injected open failure ends the file with LOADING_FAILED before
+// FILE_LOADED and renders nothing.
+void TestOpenFailure() {
+  fake_mpv_reset();
+  fake_mpv_set("fail", "open");
+  mpv_handle* mpv = CreatePlayer();
+  EXPECT(mpv != nullptr);
+  if (!mpv) return;
+  {
+    Renderer renderer(mpv);
+    const char* cmd[] = {"loadfile", "/media/broken.mkv", nullptr};
+    EXPECT_EQ(mpv_command(mpv, cmd), 0);
+    mpv_event_end_file end{};
+    const std::vector<mpv_event_id> events = RunToEnd(mpv, &end);
+    EXPECT_EQ(end.reason, MPV_END_FILE_REASON_ERROR);
+    EXPECT_EQ(end.error, MPV_ERROR_LOADING_FAILED);
+    EXPECT_EQ(Index(events, MPV_EVENT_FILE_LOADED), -1);
+    EXPECT(renderer.Frames().empty());
+  }
+  mpv_terminate_destroy(mpv);
+}
+
+}  // namespace
+
+int main() {
+  TestPlaysEveryFrame();
+  TestStartAndSeek();
+  TestOpenFailure();
+  fake_mpv_reset();
+  if (g_failures > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+    return 1;
+  }
+  std::printf("fake_mpv_test: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,263 @@
+#include "fake_nodes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace mpv_native_texture {
+
+namespace {
+
+char* DupString(const std::string& s) {
+  char* out = static_cast<char*>(std::malloc(s.size() + 1));
+  std::memcpy(out, s.c_str(), s.size() + 1);
+  return out;
+}
+
+mpv_node_list* NewList(size_t count, bool keys) {
+  auto* list = static_cast<mpv_node_list*>(std::calloc(1, sizeof(mpv_node_list)));
+  list->num = static_cast<int>(count);
+  list->values = static_cast<mpv_node*>(std::calloc(count ? count : 1, sizeof(mpv_node)));
+  if (keys) list->keys = static_cast<char**>(std::calloc(count ? count : 1, sizeof(char*)));
+  return list;
+}
+
+std::string FormatDouble(double v) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%.6f", v);
+  return buf;
+}
+
+// Strings that read as a number or flag, for options set as strings.
+bool ParseFlag(const char* s, int* out) {
+  if (std::strcmp(s, "yes") == 0) *out = 1;
+  else if (std::strcmp(s, "no") == 0) *out = 0;
+  else return false;
+  return true;
+}
+
+bool ParseDouble(const char* s, double* out) {
+  char* end = nullptr;
+  *out = std::strtod(s, &end);
+  return *s != '\0' && *end == '\0';
+}
+
+}  // namespace
+
+mpv_node NodeString(const std::string& value) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_STRING;
+  node.u.string = DupString(value);
+  return node;
+}
+
+mpv_node NodeInt(int64_t value) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_INT64;
+  node.u.int64 = value;
+  return node;
+}
+
+mpv_node NodeDouble(double value) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_DOUBLE;
+  node.u.double_ = value;
+  return node;
+}
+
+mpv_node NodeFlag(bool value) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_FLAG;
+  node.u.flag = value ? 1 : 0;
+  return node;
+}
+
+mpv_node NodeArray(std::vector<mpv_node> values) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_NODE_ARRAY;
+  node.u.list = NewList(values.size(), false);
+  for (size_t i = 0; i < values.size(); ++i) node.u.list->values[i] = values[i];
+  return node;
+}
+
+mpv_node NodeMap(std::vector<std::pair<std::string, mpv_node>> entries) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_NODE_MAP;
+  node.u.list = NewList(entries.size(), true);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    node.u.list->keys[i] = DupString(entries[i].first);
+    node.u.list->values[i] = entries[i].second;
+  }
+  return node;
+}
+
+mpv_node NodeBytes(const void* data, size_t size) {
+  mpv_node node{};
+  node.format = MPV_FORMAT_BYTE_ARRAY;
+  node.u.ba = static_cast<mpv_byte_array*>(std::calloc(1, sizeof(mpv_byte_array)));
+  node.u.ba->data = std::malloc(size ? size : 1);
+  node.u.ba->size = size;
+  if (size) std::memcpy(node.u.ba->data, data, size);
+  return node;
+}
+
+void FreeNode(mpv_node* node) {
+  switch (node->format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+      std::free(node->u.string);
+      break;
+    case MPV_FORMAT_NODE_ARRAY:
+    case MPV_FORMAT_NODE_MAP:
+      for (int i = 0; i < node->u.list->num; ++i) {
+        FreeNode(&node->u.list->values[i]);
+        if (node->u.list->keys) std::free(node->u.list->keys[i]);
+      }
+      std::free(node->u.list->values);
+      std::free(node->u.list->keys);
+      std::free(node->u.list);
+      break;
+    case MPV_FORMAT_BYTE_ARRAY:
+      std::free(node->u.ba->data);
+      std::free(node->u.ba);
+      break;
+    default:
+      break;
+  }
+  *node = mpv_node{};
+}
+
+mpv_node CopyNode(const mpv_node& node) {
+  switch (node.format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING: {
+      mpv_node copy = NodeString(node.u.string);
+      copy.format = node.format;
+      return copy;
+    }
+    case MPV_FORMAT_NODE_ARRAY:
+    case MPV_FORMAT_NODE_MAP: {
+      const bool map = node.format == MPV_FORMAT_NODE_MAP;
+      mpv_node copy{};
+      copy.format = node.format;
+      copy.u.list = NewList(static_cast<size_t>(node.u.list->num), map);
+      for (int i = 0; i < node.u.list->num; ++i) {
+        copy.u.list->values[i] = CopyNode(node.u.list->values[i]);
+        if (map) copy.u.list->keys[i] = DupString(node.u.list->keys[i]);
+      }
+      return copy;
+    }
+    case MPV_FORMAT_BYTE_ARRAY:
+      return NodeBytes(node.u.ba->data, node.u.ba->size);
+    default:
+      return node;
+  }
+}
+
+std::string NodeToString(const mpv_node& node) {
+  switch (node.format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+      return node.u.string ? node.u.string : "";
+    case MPV_FORMAT_FLAG:
+      return node.u.flag ? "yes" : "no";
+    case MPV_FORMAT_INT64:
+      return std::to_string(node.u.int64);
+    case MPV_FORMAT_DOUBLE:
+      return FormatDouble(node.u.double_);
+    case MPV_FORMAT_NODE_ARRAY:
+    case MPV_FORMAT_NODE_MAP: {
+      std::string out;
+      for (int i = 0; i < node.u.list->num; ++i) {
+        if (i) out += ",";
+        if (node.u.list->keys) out += std::string(node.u.list->keys[i]) + "=";
+        out += NodeToString(node.u.list->values[i]);
+      }
+      return out;
+    }
+    default:
+      return "";
+  }
+}
+
+const mpv_node* NodeMapGet(const mpv_node& node, const char* key) {
+  if (node.format != MPV_FORMAT_NODE_MAP) return nullptr;
+  for (int i = 0; i < node.u.list->num; ++i) {
+    if (std::strcmp(node.u.list->keys[i], key) == 0) return &node.u.list->values[i];
+  }
+  return nullptr;
+}
+
+std::map<std::string, std::string> NodeToStringMap(const mpv_node& node) {
+  std::map<std::string, std::string> out;
+  if (node.format != MPV_FORMAT_NODE_MAP) return out;
+  for (int i = 0; i < node.u.list->num; ++i) out[node.u.list->keys[i]] = NodeToString(node.u.list->values[i]);
+  return out;
+}
+
+int WriteNode(const mpv_node& value, mpv_format format, void* data) {
+  const bool is_string = value.format == MPV_FORMAT_STRING || value.format == MPV_FORMAT_OSD_STRING;
+  switch (format) {
+    case MPV_FORMAT_NODE:
+      *static_cast<mpv_node*>(data) = CopyNode(value);
+      return 0;
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+      *static_cast<char**>(data) = DupString(NodeToString(value));
+      return 0;
+    case MPV_FORMAT_FLAG: {
+      int flag = 0;
+      if (value.format == MPV_FORMAT_FLAG) {
+        flag = value.u.flag;
+      } else if (!is_string || !ParseFlag(value.u.string, &flag)) {
+        return MPV_ERROR_PROPERTY_FORMAT;
+      }
+      *static_cast<int*>(data) = flag;
+      return 0;
+    }
+    case MPV_FORMAT_INT64:
+    case MPV_FORMAT_DOUBLE: {
+      double d = 0;
+      if (value.format == MPV_FORMAT_INT64) {
+        d = static_cast<double>(value.u.int64);
+      } else if (value.format == MPV_FORMAT_DOUBLE) {
+        d = value.u.double_;
+      } else if (!is_string || !ParseDouble(value.u.string, &d)) {
+        return MPV_ERROR_PROPERTY_FORMAT;
+      }
+      if (format == MPV_FORMAT_DOUBLE) {
+        *static_cast<double*>(data) = d;
+      } else {
+        *static_cast<int64_t*>(data) = value.format == MPV_FORMAT_INT64 ? value.u.int64 : static_cast<int64_t>(d);
+      }
+      return 0;
+    }
+    default:
+      return MPV_ERROR_PROPERTY_FORMAT;
+  }
+}
+
+int ReadNode(mpv_format format, const void* data, mpv_node* out) {
+  switch (format) {
+    case MPV_FORMAT_STRING:
+    case MPV_FORMAT_OSD_STRING:
+      *out = NodeString(*static_cast<const char* const*>(data));
+      return 0;
+    case MPV_FORMAT_FLAG:
+      *out = NodeFlag(*static_cast<const int*>(data) != 0);
+      return 0;
+    case MPV_FORMAT_INT64:
+      *out = NodeInt(*static_cast<const int64_t*>(data));
+      return 0;
+    case MPV_FORMAT_DOUBLE:
+      *out = NodeDouble(*static_cast<const double*>(data));
+      return 0;
+    case MPV_FORMAT_NODE:
+      *out = CopyNode(*static_cast<const mpv_node*>(data));
+      return 0;
+    default:
+      return MPV_ERROR_PROPERTY_FORMAT;
+  }
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mpv/client.h"
+
+namespace mpv_native_texture {
+
+// mpv_node building and conversion. Everything is allocated so that
+// FreeNode() (mpv_free_node_contents) releases it, and strings handed out
+// as MPV_FORMAT_STRING with malloc so mpv_free() can.
+mpv_node NodeString(const std::string& value);
+mpv_node NodeInt(int64_t value);
+mpv_node NodeDouble(double value);
+mpv_node NodeFlag(bool value);
+mpv_node NodeArray(std::vector<mpv_node> values);
+mpv_node NodeMap(std::vector<std::pair<std::string, mpv_node>> entries);
+mpv_node NodeBytes(const void* data, size_t size);
+
+void FreeNode(mpv_node* node);
+mpv_node CopyNode(const mpv_node& node);
+
+// As mpv prints it: "yes"/"no" for flags, six decimals for doubles,
+// "k=v,..." for maps.
+std::string NodeToString(const mpv_node& node);
+// Map entry |key|, or null.
+const mpv_node* NodeMapGet(const mpv_node& node, const char* key);
+// A string map ("options" of loadfile) as std::map; other nodes give {}.
+std::map<std::string, std::string> NodeToStringMap(const mpv_node& node);
+
+// Property reads: converts |value| to |format| into |data| as mpv does
+// (numbers and flags parsed from strings where unambiguous). Returns 0 or
+// MPV_ERROR_PROPERTY_FORMAT.
+int WriteNode(const mpv_node& value, mpv_format format, void* data);
+// Property writes: the caller's |data| of |format| as a node.
+int ReadNode(mpv_format format, const void* data, mpv_node* out);
+
+}  // namespace mpv_native_texture
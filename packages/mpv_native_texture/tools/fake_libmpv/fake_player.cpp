@@ -0,0 +1,711 @@
+#include "fake_player.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "fake_nodes.h"
+
+namespace mpv_native_texture {
+
+using Clock = std::chrono::steady_clock;
+
+struct FakePlayer::Event {
+  mpv_event event{};
+  std::string name;
+  mpv_node value{};  // property value or command result, owned
+  mpv_event_start_file start_file{};
+  mpv_event_end_file end_file{};
+  mpv_event_hook hook{};
+  mpv_event_property property{};
+  mpv_event_command command{};
+
+  explicit Event(mpv_event_id id) { event.event_id = id; }
+  ~Event() { FreeNode(&value); }
+};
+
+namespace {
+
+// Read-only properties the fake computes.
+const char* const kReadOnly[] = {
+    "core-idle", "idle-active", "eof-reached", "paused-for-cache", "duration", "width", "height", "dwidth",
+    "dheight", "video-params", "container-fps", "estimated-vf-fps", "frame-drop-count",
+    "decoder-frame-drop-count", "vo-delayed-frame-count", "track-list", "track-list/count", "playlist",
+    "playlist-count", "path", "filename", "media-title", "stream-open-filename", "file-format", "start-time",
+    "avsync", "demuxer-cache-state",
+};
+
+bool IsReadOnly(const std::string& name) {
+  return std::find(std::begin(kReadOnly), std::end(kReadOnly), name) != std::end(kReadOnly);
+}
+
+bool ParseNumber(const std::string& s, double* out) {
+  char* end = nullptr;
+  *out = std::strtod(s.c_str(), &end);
+  return !s.empty() && *end == '\0';
+}
+
+bool ParseYes(const std::string& s) { return s == "yes" || s == "1" || s == "true"; }
+
+}  // namespace
+
+void FillSyntheticFrame(uint8_t* dst, int width, int height, size_t stride, int bytes_per_pixel, int64_t frame) {
+  const size_t row_bytes = static_cast<size_t>(width) * static_cast<size_t>(bytes_per_pixel);
+  for (int y = 0; y < height; ++y) {
+    const int level = frame < 0 ? 0 : static_cast<int>((frame * 4 + y * 256 / std::max(1, height)) & 0xff);
+    std::memset(dst + static_cast<size_t>(y) * stride, level, row_bytes);
+  }
+  if (frame >= 0 && row_bytes >= sizeof(frame)) {
+    for (size_t i = 0; i < sizeof(frame); ++i) dst[i] = static_cast<uint8_t>(static_cast<uint64_t>(frame) >> (8 * i));
+  }
+}
+
+FakePlayer::FakePlayer(const FakeSettings& settings) : settings_(settings), file_(settings) {}
+
+FakePlayer::~FakePlayer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    terminating_ = true;
+  }
+  state_cv_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+int FakePlayer::Initialize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (initialized_) return MPV_ERROR_INVALID_PARAMETER;
+  initialized_ = true;
+  thread_ = std::thread([this] { Main(); });
+  return 0;
+}
+
+bool FakePlayer::initialized() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return initialized_;
+}
+
+// --- Player thread
+
+void FakePlayer::Main() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Clock::time_point next_frame = Clock::now();
+  while (!terminating_) {
+    if (load_pending_) {
+      Load(lock);
+      next_frame = Clock::now();
+      continue;
+    }
+    if (phase_ != Phase::kPlaying) {
+      state_cv_.wait(lock);
+      continue;
+    }
+    if (stop_pending_) {
+      stop_pending_ = false;
+      EndFile(MPV_END_FILE_REASON_STOP, 0);
+      continue;
+    }
+    const double frame_s = 1.0 / file_.fps;
+    if (seek_pending_) {
+      seek_pending_ = false;
+      position_ = seek_target_;
+      eof_reached_ = false;
+      PushSimple(MPV_EVENT_SEEK);
+      ProduceFrame(lock);
+      PushSimple(MPV_EVENT_PLAYBACK_RESTART);
+      next_frame = Clock::now();
+      continue;
+    }
+    if (step_pending_ != 0) {
+      position_ = std::max(0.0, position_ + step_pending_ * frame_s);
+      step_pending_ = 0;
+      ProduceFrame(lock);
+      continue;
+    }
+    if (paused_ || eof_reached_) {
+      state_cv_.wait(lock);
+      next_frame = Clock::now();
+      continue;
+    }
+
+    // untimed: the next frame as soon as the renderer took the last one.
+    const auto untimed = options_.find("untimed");
+    if (untimed != options_.end() && ParseYes(untimed->second) && update_fn_) {
+      if (frame_pending_) {
+        state_cv_.wait(lock);
+        continue;
+      }
+    } else {
+      const auto speed = options_.find("speed");
+      double rate = 1.0;
+      if (speed != options_.end() && (!ParseNumber(speed->second, &rate) || rate <= 0)) rate = 1.0;
+      const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frame_s / rate));
+      const auto now = Clock::now();
+      if (now < next_frame + interval) {
+        state_cv_.wait_until(lock, next_frame + interval);
+        continue;
+      }
+      // Fell more than a frame behind (a slow callback): don't burst.
+      next_frame = now - next_frame > interval * 2 ? now : next_frame + interval;
+    }
+
+    position_ += frame_s;
+    if (file_.duration > 0 && position_ >= file_.duration - frame_s / 2) {
+      position_ = file_.duration;
+      if (KeepOpen()) {
+        eof_reached_ = true;
+        Notify("eof-reached");
+      } else {
+        EndFile(MPV_END_FILE_REASON_EOF, 0);
+      }
+      continue;
+    }
+    ProduceFrame(lock);
+    if (file_.fail_after_frames >= 0 && frames_produced_ >= file_.fail_after_frames) {
+      EndFile(MPV_END_FILE_REASON_ERROR, MPV_ERROR_GENERIC);
+    }
+  }
+}
+
+void FakePlayer::Load(std::unique_lock<std::mutex>& lock) {
+  load_pending_ = false;
+  stop_pending_ = false;
+  if (phase_ != Phase::kIdle) EndFile(MPV_END_FILE_REASON_STOP, 0);
+
+  url_ = pending_url_;
+  const std::map<std::string, std::string> file_options = pending_options_;
+  file_ = settings_;
+  file_.ApplyLavfiUrl(url_);
+  entry_id_ += 1;
+  phase_ = Phase::kLoading;
+  eof_reached_ = false;
+  position_ = 0;
+  frame_pending_ = false;
+  frames_produced_ = 0;
+  frames_dropped_ = 0;
+  seek_pending_ = false;
+  step_pending_ = 0;
+
+  auto start = std::make_unique<Event>(MPV_EVENT_START_FILE);
+  start->start_file.playlist_entry_id = entry_id_;
+  start->event.data = &start->start_file;
+  Push(std::move(start));
+  Notify("playlist");
+  Notify("playlist-pos");
+  Notify("idle-active");
+
+  if (!RunHooks("on_load", lock)) return;
+  if (file_.load_delay_ms > 0) {
+    state_cv_.wait_for(lock, std::chrono::milliseconds(file_.load_delay_ms),
+                       [this] { return terminating_ || load_pending_ || stop_pending_; });
+    if (Interrupted()) return;
+  }
+  if (const int error = file_.FailureFor("open")) {
+    EndFile(MPV_END_FILE_REASON_ERROR, error);
+    return;
+  }
+  if (!RunHooks("on_preloaded", lock)) return;
+
+  // Per-file options win over the global ones, as in mpv.
+  const auto option = [&](const char* name) -> const std::string* {
+    auto it = file_options.find(name);
+    if (it != file_options.end()) return &it->second;
+    auto global = options_.find(name);
+    return global != options_.end() ? &global->second : nullptr;
+  };
+  double start_s = 0;
+  if (const std::string* s = option("start")) ParseNumber(*s, &start_s);
+  if (file_.duration > 0) start_s = std::min(start_s, file_.duration);
+  position_ = std::max(0.0, start_s);
+  // pause is a property and outlives files; a per-file pause only sets it.
+  const auto pause = file_options.find("pause");
+  if (pause != file_options.end()) paused_ = ParseYes(pause->second);
+
+  phase_ = Phase::kPlaying;
+  PushSimple(MPV_EVENT_FILE_LOADED);
+  PushSimple(MPV_EVENT_VIDEO_RECONFIG);
+  Notify("duration");
+  Notify("pause");
+  Notify("track-list");
+  Notify("vid");
+  ProduceFrame(lock);
+  PushSimple(MPV_EVENT_PLAYBACK_RESTART);
+}
+
+bool FakePlayer::RunHooks(const char* name, std::unique_lock<std::mutex>& lock) {
+  std::vector<Hook> hooks;
+  for (const Hook& hook : hooks_) {
+    if (hook.name == name) hooks.push_back(hook);
+  }
+  std::stable_sort(hooks.begin(), hooks.end(), [](const Hook& a, const Hook& b) { return a.priority < b.priority; });
+  for (const Hook& hook : hooks) {
+    const uint64_t id = next_hook_id_++;
+    auto event = std::make_unique<Event>(MPV_EVENT_HOOK);
+    event->event.reply_userdata = hook.reply_userdata;
+    event->name = hook.name;
+    event->hook.name = event->name.c_str();
+    event->hook.id = id;
+    event->event.data = &event->hook;
+    Push(std::move(event));
+    // Like mpv, the file waits for the client however long it takes.
+    state_cv_.wait(lock, [&] { return terminating_ || hooks_continued_.count(id) != 0; });
+    hooks_continued_.erase(id);
+    if (Interrupted()) return false;
+  }
+  return !Interrupted();
+}
+
+bool FakePlayer::Interrupted() {
+  if (terminating_ || load_pending_) return true;
+  if (stop_pending_) {
+    stop_pending_ = false;
+    EndFile(MPV_END_FILE_REASON_STOP, 0);
+    return true;
+  }
+  return false;
+}
+
+void FakePlayer::EndFile(mpv_end_file_reason reason, int error) {
+  auto event = std::make_unique<Event>(MPV_EVENT_END_FILE);
+  event->end_file.reason = reason;
+  event->end_file.error = error;
+  event->end_file.playlist_entry_id = entry_id_;
+  event->event.data = &event->end_file;
+  Push(std::move(event));
+  phase_ = Phase::kIdle;
+  frame_pending_ = false;
+  eof_reached_ = false;
+  url_.clear();
+  Notify("playlist");
+  Notify("playlist-pos");
+  Notify("duration");
+  if (!load_pending_) {
+    PushSimple(MPV_EVENT_IDLE);
+    Notify("idle-active");
+  }
+}
+
+void FakePlayer::ProduceFrame(std::unique_lock<std::mutex>& lock) {
+  if (frame_pending_) ++frames_dropped_;
+  frame_pending_ = true;
+  ++frames_produced_;
+  Notify("time-pos");
+  if (!update_fn_) return;
+  const mpv_render_update_fn fn = update_fn_;
+  void* const ctx = update_ctx_;
+  in_update_ = true;
+  lock.unlock();
+  fn(ctx);
+  lock.lock();
+  in_update_ = false;
+  state_cv_.notify_all();
+}
+
+bool FakePlayer::KeepOpen() {
+  const auto it = options_.find("keep-open");
+  return it != options_.end() && it->second != "no";
+}
+
+// --- Client API
+
+int FakePlayer::SetProperty(const std::string& name, const mpv_node& value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return WriteProperty(name, value);
+}
+
+int FakePlayer::GetProperty(const std::string& name, mpv_format format, void* data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  mpv_node value{};
+  int rc = ReadProperty(name, &value);
+  if (rc >= 0) rc = WriteNode(value, format, data);
+  FreeNode(&value);
+  return rc;
+}
+
+int FakePlayer::RunCommand(const Command& command, mpv_node* result) {
+  if (result) *result = mpv_node{};
+  if (command.args.empty()) return MPV_ERROR_INVALID_PARAMETER;
+  const std::string& name = command.args[0];
+  const auto arg = [&](size_t i) { return i < command.args.size() ? command.args[i] : std::string(); };
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!initialized_) return MPV_ERROR_UNINITIALIZED;
+  if (const int error = settings_.FailureFor(name)) return error;
+
+  if (name == "loadfile") {
+    const std::string flags = arg(2).empty() ? "replace" : arg(2);
+    if (arg(1).empty()) return MPV_ERROR_INVALID_PARAMETER;
+    if (flags != "replace" && !(flags == "append-play" && phase_ == Phase::kIdle && !load_pending_)) return 0;
+    pending_url_ = arg(1);
+    pending_options_ = command.options;
+    load_pending_ = true;
+    state_cv_.notify_all();
+    return 0;
+  }
+  if (name == "stop") {
+    load_pending_ = false;
+    if (phase_ != Phase::kIdle) stop_pending_ = true;
+    state_cv_.notify_all();
+    return 0;
+  }
+  if (name == "seek") {
+    double target = 0;
+    if (!ParseNumber(arg(1), &target)) return MPV_ERROR_INVALID_PARAMETER;
+    const std::string flags = arg(2);
+    const double duration = file_.duration;
+    if (flags.find("absolute-percent") != std::string::npos) {
+      target = duration * target / 100.0;
+    } else if (flags.find("relative-percent") != std::string::npos) {
+      target = position_ + duration * target / 100.0;
+    } else if (flags.find("absolute") == std::string::npos) {
+      target += position_;
+    }
+    return Seek(target);
+  }
+  if (name == "set") return WriteProperty(arg(1), NodeString(arg(2)));
+  if (name == "cycle") {
+    mpv_node value{};
+    if (ReadProperty(arg(1), &value) < 0) return MPV_ERROR_PROPERTY_UNAVAILABLE;
+    int flag = 0;
+    const int rc = WriteNode(value, MPV_FORMAT_FLAG, &flag);
+    FreeNode(&value);
+    if (rc < 0) return MPV_ERROR_COMMAND;
+    mpv_node toggled = NodeFlag(!flag);
+    return WriteProperty(arg(1), toggled);
+  }
+  if (name == "add") {
+    mpv_node value{};
+    double current = 0;
+    double delta = 1;
+    if (!arg(2).empty() && !ParseNumber(arg(2), &delta)) return MPV_ERROR_INVALID_PARAMETER;
+    if (ReadProperty(arg(1), &value) < 0) return MPV_ERROR_PROPERTY_UNAVAILABLE;
+    const int rc = WriteNode(value, MPV_FORMAT_DOUBLE, &current);
+    FreeNode(&value);
+    if (rc < 0) return MPV_ERROR_COMMAND;
+    mpv_node sum = NodeDouble(current + delta);
+    return WriteProperty(arg(1), sum);
+  }
+  if (name == "frame-step" || name == "frame-back-step") {
+    if (phase_ != Phase::kPlaying) return MPV_ERROR_COMMAND;
+    paused_ = true;
+    step_pending_ = name == "frame-step" ? 1 : -1;
+    Notify("pause");
+    state_cv_.notify_all();
+    return 0;
+  }
+  if (name == "screenshot-raw") {
+    if (phase_ != Phase::kPlaying) return MPV_ERROR_COMMAND;
+    if (result) {
+      const size_t stride = static_cast<size_t>(file_.width) * 4u;
+      std::vector<uint8_t> pixels(stride * static_cast<size_t>(file_.height));
+      FillSyntheticFrame(pixels.data(), file_.width, file_.height, stride, 4, frames_produced_);
+      *result = NodeMap({
+          {"w", NodeInt(file_.width)},
+          {"h", NodeInt(file_.height)},
+          {"stride", NodeInt(static_cast<int64_t>(stride))},
+          {"format", NodeString("bgr0")},
+          {"data", NodeBytes(pixels.data(), pixels.size())},
+      });
+    }
+    return 0;
+  }
+  if (name == "quit") {
+    if (phase_ != Phase::kIdle) EndFile(MPV_END_FILE_REASON_QUIT, 0);
+    PushSimple(MPV_EVENT_SHUTDOWN);
+    return 0;
+  }
+  // Anything else (script messages, cache dumps, ...) is only recorded.
+  return 0;
+}
+
+int FakePlayer::RunCommandAsync(uint64_t reply_userdata, const Command& command) {
+  auto reply = std::make_unique<Event>(MPV_EVENT_COMMAND_REPLY);
+  const int rc = RunCommand(command, &reply->value);
+  std::lock_guard<std::mutex> lock(mutex_);
+  reply->event.error = rc < 0 ? rc : 0;
+  reply->event.reply_userdata = reply_userdata;
+  reply->command.result = reply->value;
+  reply->event.data = &reply->command;
+  Push(std::move(reply));
+  return 0;
+}
+
+int FakePlayer::Observe(uint64_t reply_userdata, const std::string& name, mpv_format format) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  observers_.push_back({reply_userdata, name, format});
+  // mpv reports the current value right away.
+  PushChange(observers_.back());
+  return 0;
+}
+
+int FakePlayer::AddHook(uint64_t reply_userdata, const std::string& name, int priority) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  hooks_.push_back({reply_userdata, name, priority});
+  return 0;
+}
+
+int FakePlayer::ContinueHook(uint64_t id) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == 0 || id >= next_hook_id_) return MPV_ERROR_INVALID_PARAMETER;
+    hooks_continued_.insert(id);
+  }
+  state_cv_.notify_all();
+  return 0;
+}
+
+mpv_event* FakePlayer::WaitEvent(double timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto ready = [this] { return !events_.empty() || wakeup_; };
+  if (timeout < 0) {
+    events_cv_.wait(lock, ready);
+  } else if (timeout > 0) {
+    events_cv_.wait_for(lock, std::chrono::duration<double>(timeout), ready);
+  }
+  wakeup_ = false;
+  current_.reset();
+  if (events_.empty()) {
+    none_ = mpv_event{};
+    return &none_;
+  }
+  current_ = std::move(events_.front());
+  events_.pop_front();
+  return &current_->event;
+}
+
+void FakePlayer::Wakeup() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wakeup_ = true;
+  }
+  events_cv_.notify_all();
+}
+
+// --- Render context
+
+void FakePlayer::SetUpdateCallback(mpv_render_update_fn callback, void* ctx) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  state_cv_.wait(lock, [this] { return !in_update_; });
+  update_fn_ = callback;
+  update_ctx_ = ctx;
+  state_cv_.notify_all();
+}
+
+uint64_t FakePlayer::RenderUpdate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return frame_pending_ ? MPV_RENDER_UPDATE_FRAME : 0;
+}
+
+int64_t FakePlayer::TakeFrame(int* width, int* height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *width = file_.width;
+  *height = file_.height;
+  if (frame_pending_) {
+    frame_pending_ = false;
+    state_cv_.notify_all();
+  }
+  return phase_ == Phase::kPlaying ? frames_produced_ : -1;
+}
+
+// --- Properties (under mutex_)
+
+int FakePlayer::ReadProperty(const std::string& name, mpv_node* out) {
+  const bool loaded = phase_ == Phase::kPlaying;
+  const auto option = options_.find(name);
+  const auto stored = [&](mpv_node fallback) {
+    if (option == options_.end()) return fallback;
+    FreeNode(&fallback);
+    return NodeString(option->second);
+  };
+  const auto needs_file = [&](mpv_node value) {
+    if (loaded) {
+      *out = value;
+      return 0;
+    }
+    FreeNode(&value);
+    return static_cast<int>(MPV_ERROR_PROPERTY_UNAVAILABLE);
+  };
+
+  if (name == "pause") {
+    *out = NodeFlag(paused_);
+  } else if (name == "core-idle") {
+    *out = NodeFlag(!loaded || paused_ || eof_reached_);
+  } else if (name == "idle-active") {
+    *out = NodeFlag(phase_ == Phase::kIdle && !load_pending_);
+  } else if (name == "eof-reached") {
+    *out = NodeFlag(eof_reached_);
+  } else if (name == "paused-for-cache") {
+    *out = NodeFlag(false);
+  } else if (name == "time-pos" || name == "playback-time") {
+    return needs_file(NodeDouble(position_));
+  } else if (name == "duration") {
+    if (file_.duration <= 0) return MPV_ERROR_PROPERTY_UNAVAILABLE;
+    return needs_file(NodeDouble(file_.duration));
+  } else if (name == "percent-pos") {
+    if (file_.duration <= 0) return MPV_ERROR_PROPERTY_UNAVAILABLE;
+    return needs_file(NodeDouble(position_ * 100.0 / file_.duration));
+  } else if (name == "width" || name == "height" || name == "dwidth" || name == "dheight") {
+    return needs_file(NodeInt(name.find("width") != std::string::npos ? file_.width : file_.height));
+  } else if (name == "video-params") {
+    return needs_file(NodeMap({
+        {"pixelformat", NodeString("yuv420p")},
+        {"w", NodeInt(file_.width)},
+        {"h", NodeInt(file_.height)},
+        {"dw", NodeInt(file_.width)},
+        {"dh", NodeInt(file_.height)},
+        {"aspect", NodeDouble(static_cast<double>(file_.width) / file_.height)},
+    }));
+  } else if (name == "container-fps" || name == "estimated-vf-fps") {
+    return needs_file(NodeDouble(file_.fps));
+  } else if (name == "frame-drop-count") {
+    return needs_file(NodeInt(frames_dropped_));
+  } else if (name == "decoder-frame-drop-count" || name == "vo-delayed-frame-count") {
+    return needs_file(NodeInt(0));
+  } else if (name == "vid") {
+    *out = stored(loaded ? NodeInt(1) : NodeString("auto"));
+  } else if (name == "track-list") {
+    std::vector<mpv_node> tracks;
+    if (loaded) {
+      tracks.push_back(NodeMap({
+          {"id", NodeInt(1)},
+          {"type", NodeString("video")},
+          {"selected", NodeFlag(true)},
+          {"codec", NodeString("rawvideo")},
+          {"demux-w", NodeInt(file_.width)},
+          {"demux-h", NodeInt(file_.height)},
+          {"demux-fps", NodeDouble(file_.fps)},
+      }));
+    }
+    *out = NodeArray(std::move(tracks));
+  } else if (name == "track-list/count") {
+    *out = NodeInt(loaded ? 1 : 0);
+  } else if (name == "playlist") {
+    std::vector<mpv_node> entries;
+    if (!url_.empty()) {
+      entries.push_back(NodeMap({
+          {"filename", NodeString(url_)},
+          {"current", NodeFlag(true)},
+          {"playing", NodeFlag(true)},
+          {"id", NodeInt(entry_id_)},
+      }));
+    }
+    *out = NodeArray(std::move(entries));
+  } else if (name == "playlist-count") {
+    *out = NodeInt(url_.empty() ? 0 : 1);
+  } else if (name == "playlist-pos") {
+    *out = NodeInt(url_.empty() ? -1 : 0);
+  } else if (name == "path" || name == "stream-open-filename" || name == "filename" || name == "media-title") {
+    if (url_.empty()) return MPV_ERROR_PROPERTY_UNAVAILABLE;
+    const size_t slash = url_.find_last_of("/\\");
+    const bool short_name = name == "filename" || name == "media-title";
+    *out = NodeString(short_name && slash != std::string::npos ? url_.substr(slash + 1) : url_);
+  } else if (name == "file-format") {
+    return needs_file(NodeString("fake"));
+  } else if (name == "start-time" || name == "avsync") {
+    return needs_file(NodeDouble(0.0));
+  } else if (name == "demuxer-cache-state") {
+    return needs_file(NodeMap({
+        {"cache-end", NodeDouble(file_.duration)},
+        {"cache-duration", NodeDouble(std::max(0.0, file_.duration - position_))},
+        {"eof", NodeFlag(true)},
+        {"underrun", NodeFlag(false)},
+        {"idle", NodeFlag(true)},
+        {"total-bytes", NodeInt(0)},
+        {"fw-bytes", NodeInt(0)},
+    }));
+  } else if (name == "speed") {
+    *out = stored(NodeDouble(1.0));
+  } else if (name == "mute") {
+    *out = stored(NodeFlag(false));
+  } else if (name == "volume") {
+    *out = stored(NodeDouble(100.0));
+  } else if (option != options_.end()) {
+    *out = NodeString(option->second);
+  } else {
+    return MPV_ERROR_PROPERTY_UNAVAILABLE;
+  }
+  return 0;
+}
+
+int FakePlayer::WriteProperty(const std::string& name, const mpv_node& value) {
+  if (name.empty()) return MPV_ERROR_INVALID_PARAMETER;
+  if (IsReadOnly(name)) return MPV_ERROR_PROPERTY_ERROR;
+  if (name == "pause") {
+    int flag = 0;
+    if (WriteNode(value, MPV_FORMAT_FLAG, &flag) < 0) return MPV_ERROR_PROPERTY_FORMAT;
+    if (paused_ != (flag != 0)) {
+      paused_ = flag != 0;
+      Notify("pause");
+      state_cv_.notify_all();
+    }
+    return 0;
+  }
+  if (name == "time-pos" || name == "playback-time" || name == "percent-pos") {
+    double target = 0;
+    if (WriteNode(value, MPV_FORMAT_DOUBLE, &target) < 0) return MPV_ERROR_PROPERTY_FORMAT;
+    if (phase_ != Phase::kPlaying) return MPV_ERROR_PROPERTY_UNAVAILABLE;
+    if (name == "percent-pos") target = file_.duration * target / 100.0;
+    return Seek(target);
+  }
+  options_[name] = NodeToString(value);
+  Notify(name);
+  state_cv_.notify_all();
+  return 0;
+}
+
+int FakePlayer::Seek(double target) {
+  if (phase_ != Phase::kPlaying) return MPV_ERROR_COMMAND;
+  if (file_.duration > 0) target = std::min(target, file_.duration);
+  seek_target_ = std::max(0.0, target);
+  seek_pending_ = true;
+  state_cv_.notify_all();
+  return 0;
+}
+
+void FakePlayer::Push(std::unique_ptr<Event> event) {
+  events_.push_back(std::move(event));
+  events_cv_.notify_all();
+}
+
+void FakePlayer::PushSimple(mpv_event_id id) { Push(std::make_unique<Event>(id)); }
+
+void FakePlayer::Notify(const std::string& name) {
+  for (const Observer& observer : observers_) {
+    if (observer.name == name) PushChange(observer);
+  }
+}
+
+void FakePlayer::PushChange(const Observer& observer) {
+  const std::string& name = observer.name;
+  auto event = std::make_unique<Event>(MPV_EVENT_PROPERTY_CHANGE);
+  event->event.reply_userdata = observer.reply_userdata;
+  event->name = name;
+  event->property.name = event->name.c_str();
+  mpv_node value{};
+  if (observer.format != MPV_FORMAT_NONE && ReadProperty(name, &value) >= 0) {
+    // Converted into event->value in the observer's format; data points there.
+    void* slot = nullptr;
+    switch (observer.format) {
+      case MPV_FORMAT_NODE: slot = &event->value; break;
+      case MPV_FORMAT_STRING:
+      case MPV_FORMAT_OSD_STRING: slot = &event->value.u.string; break;
+      case MPV_FORMAT_FLAG: slot = &event->value.u.flag; break;
+      case MPV_FORMAT_INT64: slot = &event->value.u.int64; break;
+      case MPV_FORMAT_DOUBLE: slot = &event->value.u.double_; break;
+      default: break;
+    }
+    if (slot && WriteNode(value, observer.format, slot) >= 0) {
+      if (observer.format == MPV_FORMAT_OSD_STRING) {
+        event->value.format = MPV_FORMAT_STRING;
+      } else if (observer.format != MPV_FORMAT_NODE) {
+        event->value.format = observer.format;
+      }
+      event->property.format = observer.format;
+      event->property.data = slot;
+    }
+  }
+  FreeNode(&value);
+  event->event.data = &event->property;
+  Push(std::move(event));
+}
+
+}  // namespace mpv_native_texture
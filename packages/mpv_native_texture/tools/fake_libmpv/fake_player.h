@@ -0,0 +1,146 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_settings.h"
+#include "mpv/client.h"
+#include "mpv/render.h"
+
+namespace mpv_native_texture {
+
+// Deterministic synthetic picture: every row one grey level that scrolls
+// with |frame|, and the frame number (little-endian int64) in the first
+// eight bytes of the top row so consumers can tell frames apart. |frame| < 0
+// is black (nothing loaded).
+void FillSyntheticFrame(uint8_t* dst, int width, int height, size_t stride, int bytes_per_pixel, int64_t frame);
+
+// What an mpv_handle is in the fake: a playback thread that walks a file
+// through START_FILE, the on_load hook, opening, on_preloaded and
+// FILE_LOADED, then "decodes" frames at the configured rate and announces
+// each through the render update callback, ending with END_FILE. Properties,
+// commands, hooks and observers behave like mpv's for what MpvPlayer uses.
+class FakePlayer {
+ public:
+  struct Command {
+    std::vector<std::string> args;              // name first
+    std::map<std::string, std::string> options;  // loadfile per-file options
+  };
+
+  explicit FakePlayer(const FakeSettings& settings);
+  ~FakePlayer();
+
+  FakePlayer(const FakePlayer&) = delete;
+  FakePlayer& operator=(const FakePlayer&) = delete;
+
+  const FakeSettings& settings() const { return settings_; }
+
+  int Initialize();
+  int SetProperty(const std::string& name, const mpv_node& value);
+  int GetProperty(const std::string& name, mpv_format format, void* data);
+  // |result| may be null.
+  int RunCommand(const Command& command, mpv_node* result);
+  int RunCommandAsync(uint64_t reply_userdata, const Command& command);
+  int Observe(uint64_t reply_userdata, const std::string& name, mpv_format format);
+  int AddHook(uint64_t reply_userdata, const std::string& name, int priority);
+  int ContinueHook(uint64_t id);
+  mpv_event* WaitEvent(double timeout);
+  void Wakeup();
+
+  // Render context side.
+  bool initialized();
+  // Blocks until a callback already running has returned, like mpv.
+  void SetUpdateCallback(mpv_render_update_fn callback, void* ctx);
+  uint64_t RenderUpdate();
+  // Marks the announced frame as rendered. Returns the frame to draw (see
+  // FillSyntheticFrame) and the video size.
+  int64_t TakeFrame(int* width, int* height);
+
+ private:
+  enum class Phase { kIdle, kLoading, kPlaying };
+  struct Event;
+  struct Hook {
+    uint64_t reply_userdata;
+    std::string name;
+    int priority;
+  };
+  struct Observer {
+    uint64_t reply_userdata;
+    std::string name;
+    mpv_format format;
+  };
+
+  void Main();
+  void Load(std::unique_lock<std::mutex>& lock);
+  // False when the load was superseded, stopped or the handle is going away.
+  bool RunHooks(const char* name, std::unique_lock<std::mutex>& lock);
+  bool Interrupted();
+  void EndFile(mpv_end_file_reason reason, int error);
+  void ProduceFrame(std::unique_lock<std::mutex>& lock);
+  bool KeepOpen();
+
+  // Under mutex_.
+  int ReadProperty(const std::string& name, mpv_node* out);
+  int WriteProperty(const std::string& name, const mpv_node& value);
+  int Seek(double target);
+  void Push(std::unique_ptr<Event> event);
+  void PushSimple(mpv_event_id id);
+  void Notify(const std::string& name);
+  void PushChange(const Observer& observer);
+
+  const FakeSettings settings_;
+
+  std::mutex mutex_;
+  std::condition_variable state_cv_;   // player thread
+  std::condition_variable events_cv_;  // mpv_wait_event
+  bool initialized_ = false;
+  bool terminating_ = false;
+  bool wakeup_ = false;
+
+  std::deque<std::unique_ptr<Event>> events_;
+  std::unique_ptr<Event> current_;  // backs the event last returned
+  mpv_event none_{};
+  std::vector<Observer> observers_;
+  std::vector<Hook> hooks_;
+  uint64_t next_hook_id_ = 1;
+  std::set<uint64_t> hooks_continued_;
+  std::map<std::string, std::string> options_;  // options and plain properties
+
+  // Requests for the player thread.
+  bool load_pending_ = false;
+  std::string pending_url_;
+  std::map<std::string, std::string> pending_options_;
+  bool stop_pending_ = false;
+  bool seek_pending_ = false;
+  double seek_target_ = 0;
+  int step_pending_ = 0;  // +1 frame-step, -1 frame-back-step
+
+  // The current file.
+  Phase phase_ = Phase::kIdle;
+  FakeSettings file_;  // settings_ with the URL's overrides
+  std::string url_;
+  int64_t entry_id_ = 0;
+  bool paused_ = false;
+  bool eof_reached_ = false;
+  double position_ = 0;
+  bool frame_pending_ = false;  // announced, not rendered yet
+  int64_t frames_produced_ = 0;
+  int64_t frames_dropped_ = 0;
+
+  mpv_render_update_fn update_fn_ = nullptr;
+  void* update_ctx_ = nullptr;
+  bool in_update_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,79 @@
+#include "fake_render_context.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace mpv_native_texture {
+
+namespace {
+
+constexpr unsigned kGlFramebuffer = 0x8D40;
+constexpr unsigned kGlColorBufferBit = 0x4000;
+
+const void* FindParam(const mpv_render_param* params, mpv_render_param_type type) {
+  for (; params && params->type != MPV_RENDER_PARAM_INVALID; ++params) {
+    if (params->type == type) return params->data;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+FakeRenderContext::FakeRenderContext(FakePlayer* player, bool software, const mpv_opengl_init_params* gl)
+    : player_(player), software_(software) {
+  if (software_ || !gl || !gl->get_proc_address) return;
+  void* ctx = gl->get_proc_address_ctx;
+  bind_framebuffer_ = reinterpret_cast<BindFramebufferFn>(gl->get_proc_address(ctx, "glBindFramebuffer"));
+  viewport_ = reinterpret_cast<ViewportFn>(gl->get_proc_address(ctx, "glViewport"));
+  clear_color_ = reinterpret_cast<ClearColorFn>(gl->get_proc_address(ctx, "glClearColor"));
+  clear_ = reinterpret_cast<ClearFn>(gl->get_proc_address(ctx, "glClear"));
+}
+
+FakeRenderContext::~FakeRenderContext() { player_->SetUpdateCallback(nullptr, nullptr); }
+
+int FakeRenderContext::Render(const mpv_render_param* params) {
+  if (const int error = player_->settings().FailureFor("mpv_render_context_render")) return error;
+  int width = 0;
+  int height = 0;
+  const int64_t frame = player_->TakeFrame(&width, &height);
+  const int delay_us = player_->settings().render_delay_us;
+  if (delay_us > 0) std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+  return software_ ? RenderSoftware(params, frame) : RenderGl(params, frame);
+}
+
+int FakeRenderContext::RenderSoftware(const mpv_render_param* params, int64_t frame) {
+  const auto* size = static_cast<const int*>(FindParam(params, MPV_RENDER_PARAM_SW_SIZE));
+  const auto* format = static_cast<const char*>(FindParam(params, MPV_RENDER_PARAM_SW_FORMAT));
+  const auto* stride = static_cast<const size_t*>(FindParam(params, MPV_RENDER_PARAM_SW_STRIDE));
+  auto* pixels = static_cast<uint8_t*>(const_cast<void*>(FindParam(params, MPV_RENDER_PARAM_SW_POINTER)));
+  if (!size || !format || !stride || !pixels || size[0] <= 0 || size[1] <= 0) return MPV_ERROR_INVALID_PARAMETER;
+
+  int bytes_per_pixel = 4;
+  if (std::strcmp(format, "rgb24") == 0 || std::strcmp(format, "bgr24") == 0) {
+    bytes_per_pixel = 3;
+  } else if (std::strcmp(format, "rgb0") != 0 && std::strcmp(format, "bgr0") != 0 &&
+             std::strcmp(format, "0rgb") != 0 && std::strcmp(format, "0bgr") != 0 &&
+             std::strcmp(format, "rgba") != 0 && std::strcmp(format, "bgra") != 0) {
+    return MPV_ERROR_UNSUPPORTED;
+  }
+  if (*stride < static_cast<size_t>(size[0]) * static_cast<size_t>(bytes_per_pixel) || *stride % 4 != 0) {
+    return MPV_ERROR_INVALID_PARAMETER;
+  }
+  FillSyntheticFrame(pixels, size[0], size[1], *stride, bytes_per_pixel, frame);
+  return 0;
+}
+
+int FakeRenderContext::RenderGl(const mpv_render_param* params, int64_t frame) {
+  const auto* fbo = static_cast<const mpv_opengl_fbo*>(FindParam(params, MPV_RENDER_PARAM_OPENGL_FBO));
+  if (!fbo || fbo->w <= 0 || fbo->h <= 0) return MPV_ERROR_INVALID_PARAMETER;
+  if (!bind_framebuffer_ || !viewport_ || !clear_color_ || !clear_) return 0;
+  const float level = frame < 0 ? 0.0f : static_cast<float>((frame * 4) & 0xff) / 255.0f;
+  bind_framebuffer_(kGlFramebuffer, static_cast<unsigned>(fbo->fbo));
+  viewport_(0, 0, fbo->w, fbo->h);
+  clear_color_(level, level, level, 1.0f);
+  clear_(kGlColorBufferBit);
+  return 0;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fake_player.h"
+#include "mpv/render.h"
+#include "mpv/render_gl.h"
+
+// The calling convention of GL entry points (APIENTRY).
+#if defined(_WIN32) && !defined(_WIN64)
+#define FAKE_MPV_GLAPI __stdcall
+#else
+#define FAKE_MPV_GLAPI
+#endif
+
+namespace mpv_native_texture {
+
+// What an mpv_render_context is in the fake. Frames are the player's
+// synthetic ones; "sw" writes them into the caller's buffer, "opengl"
+// clears the target FBO to the frame's grey level through the GL functions
+// the caller's get_proc_address returns (and draws nothing when it returns
+// none). render-delay-us is added to every render.
+class FakeRenderContext {
+ public:
+  FakeRenderContext(FakePlayer* player, bool software, const mpv_opengl_init_params* gl);
+  ~FakeRenderContext();
+
+  FakeRenderContext(const FakeRenderContext&) = delete;
+  FakeRenderContext& operator=(const FakeRenderContext&) = delete;
+
+  void SetUpdateCallback(mpv_render_update_fn callback, void* ctx) { player_->SetUpdateCallback(callback, ctx); }
+  uint64_t Update() { return player_->RenderUpdate(); }
+  int Render(const mpv_render_param* params);
+
+ private:
+  // GL entry points, resolved through the caller's get_proc_address.
+  using BindFramebufferFn = void(FAKE_MPV_GLAPI*)(unsigned target, unsigned framebuffer);
+  using ViewportFn = void(FAKE_MPV_GLAPI*)(int x, int y, int width, int height);
+  using ClearColorFn = void(FAKE_MPV_GLAPI*)(float r, float g, float b, float a);
+  using ClearFn = void(FAKE_MPV_GLAPI*)(unsigned mask);
+
+  int RenderSoftware(const mpv_render_param* params, int64_t frame);
+  int RenderGl(const mpv_render_param* params, int64_t frame);
+
+  FakePlayer* const player_;
+  const bool software_;
+  BindFramebufferFn bind_framebuffer_ = nullptr;
+  ViewportFn viewport_ = nullptr;
+  ClearColorFn clear_color_ = nullptr;
+  ClearFn clear_ = nullptr;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,210 @@
+#include "fake_settings.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "mpv/client.h"
+
+namespace mpv_native_texture {
+
+namespace {
+
+constexpr size_t kMaxLogLines = 65536;
+
+const char* const kKeys[] = {"fps",  "duration",          "size", "load-delay-ms", "render-delay-us",
+                             "fail", "fail-after-frames", "log"};
+
+std::mutex g_settings_mutex;
+std::map<std::string, std::string> g_overrides;
+
+std::mutex g_log_mutex;
+std::deque<std::string> g_log_lines;
+std::unordered_map<std::string, int64_t> g_log_counts;
+FILE* g_log_file = nullptr;
+std::string g_log_path;
+
+std::string EnvName(const std::string& key) {
+  std::string name = "FAKE_MPV_";
+  for (char c : key) name += c == '-' ? '_' : static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  return name;
+}
+
+bool ParseDouble(const std::string& s, double* out) {
+  char* end = nullptr;
+  const double v = std::strtod(s.c_str(), &end);
+  if (s.empty() || *end != '\0') return false;
+  *out = v;
+  return true;
+}
+
+bool ParseInt(const std::string& s, int64_t* out) {
+  char* end = nullptr;
+  const long long v = std::strtoll(s.c_str(), &end, 10);
+  if (s.empty() || *end != '\0') return false;
+  *out = v;
+  return true;
+}
+
+}  // namespace
+
+FakeSettings FakeSettings::Current() {
+  FakeSettings settings;
+  std::lock_guard<std::mutex> lock(g_settings_mutex);
+  for (const char* key : kKeys) {
+    const auto it = g_overrides.find(key);
+    const char* env = std::getenv(EnvName(key).c_str());
+    if (it != g_overrides.end()) {
+      settings.Apply(key, it->second);
+    } else if (env) {
+      settings.Apply(key, env);
+    }
+  }
+  return settings;
+}
+
+void FakeSettings::SetOverride(const char* key, const char* value) {
+  std::lock_guard<std::mutex> lock(g_settings_mutex);
+  if (value) {
+    g_overrides[key] = value;
+  } else {
+    g_overrides.erase(key);
+  }
+}
+
+void FakeSettings::ClearOverrides() {
+  std::lock_guard<std::mutex> lock(g_settings_mutex);
+  g_overrides.clear();
+}
+
+bool FakeSettings::Apply(const std::string& key, const std::string& value) {
+  int64_t i = 0;
+  double d = 0;
+  if (key == "fps") {
+    if (!ParseDouble(value, &d) || d <= 0) return false;
+    fps = d;
+  } else if (key == "duration") {
+    if (!ParseDouble(value, &d) || d < 0) return false;
+    duration = d;
+  } else if (key == "size") {
+    int w = 0, h = 0;
+    if (std::sscanf(value.c_str(), "%dx%d", &w, &h) != 2 || w < 1 || h < 1) return false;
+    width = w;
+    height = h;
+  } else if (key == "load-delay-ms") {
+    if (!ParseInt(value, &i) || i < 0) return false;
+    load_delay_ms = static_cast<int>(i);
+  } else if (key == "render-delay-us") {
+    if (!ParseInt(value, &i) || i < 0) return false;
+    render_delay_us = static_cast<int>(i);
+  } else if (key == "fail-after-frames") {
+    if (!ParseInt(value, &i)) return false;
+    fail_after_frames = i;
+  } else if (key == "fail") {
+    fail.clear();
+    size_t start = 0;
+    while (start <= value.size()) {
+      size_t end = value.find(',', start);
+      if (end == std::string::npos) end = value.size();
+      const std::string item = value.substr(start, end - start);
+      start = end + 1;
+      if (item.empty()) continue;
+      const size_t eq = item.find('=');
+      const std::string point = item.substr(0, eq);
+      int64_t code = point == "open" ? MPV_ERROR_LOADING_FAILED : MPV_ERROR_GENERIC;
+      if (eq != std::string::npos && (!ParseInt(item.substr(eq + 1), &code) || code >= 0)) return false;
+      fail[point] = static_cast<int>(code);
+    }
+  } else if (key == "log") {
+    log_path = value;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void FakeSettings::ApplyLavfiUrl(const std::string& url) {
+  static const char kPrefix[] = "av://lavfi:";
+  if (url.compare(0, sizeof(kPrefix) - 1, kPrefix) != 0) return;
+  // testsrc2=size=1280x720:rate=60:duration=10
+  const size_t eq = url.find('=');
+  if (eq == std::string::npos) return;
+  size_t start = eq + 1;
+  while (start < url.size()) {
+    size_t end = url.find(':', start);
+    if (end == std::string::npos) end = url.size();
+    const std::string item = url.substr(start, end - start);
+    start = end + 1;
+    const size_t sep = item.find('=');
+    if (sep == std::string::npos) continue;
+    const std::string name = item.substr(0, sep);
+    const std::string value = item.substr(sep + 1);
+    if (name == "size" || name == "s") Apply("size", value);
+    if (name == "rate" || name == "r") Apply("fps", value);
+    if (name == "duration" || name == "d") Apply("duration", value);
+  }
+}
+
+int FakeSettings::FailureFor(const std::string& point) const {
+  const auto it = fail.find(point);
+  return it == fail.end() ? 0 : it->second;
+}
+
+CallLog& CallLog::Instance() {
+  static CallLog log;
+  return log;
+}
+
+CallLog::~CallLog() {
+  if (g_log_file) std::fclose(g_log_file);
+}
+
+void CallLog::Record(const std::string& name, const std::string& detail) {
+  std::string line = detail.empty() ? name : name + " " + detail;
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  ++g_log_counts[name];
+  if (g_log_file) {
+    std::fprintf(g_log_file, "%s\n", line.c_str());
+    std::fflush(g_log_file);
+  }
+  g_log_lines.push_back(std::move(line));
+  if (g_log_lines.size() > kMaxLogLines) g_log_lines.pop_front();
+}
+
+void CallLog::Tally(const std::string& name) {
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  ++g_log_counts[name];
+}
+
+int64_t CallLog::Count(const std::string& name) {
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  const auto it = g_log_counts.find(name);
+  return it == g_log_counts.end() ? 0 : it->second;
+}
+
+std::string CallLog::Text() {
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  std::string text;
+  for (const std::string& line : g_log_lines) text += line + "\n";
+  return text;
+}
+
+void CallLog::Clear() {
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  g_log_lines.clear();
+  g_log_counts.clear();
+}
+
+void CallLog::SetFile(const std::string& path) {
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  if (path == g_log_path) return;
+  if (g_log_file) std::fclose(g_log_file);
+  g_log_file = path.empty() ? nullptr : std::fopen(path.c_str(), "a");
+  g_log_path = path;
+}
+
+}  // namespace mpv_native_texture
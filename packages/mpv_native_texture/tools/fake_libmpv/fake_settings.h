@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace mpv_native_texture {
+
+// What a fake mpv_handle plays and where it fails; see fake_mpv.h for the
+// keys. A copy is taken per handle, so changing settings never races a
+// running player.
+struct FakeSettings {
+  double fps = 60.0;
+  double duration = 10.0;
+  int width = 1280;
+  int height = 720;
+  int load_delay_ms = 0;
+  int render_delay_us = 0;
+  int64_t fail_after_frames = -1;
+  std::map<std::string, int> fail;  // failure point -> mpv error code
+  std::string log_path;
+
+  // The environment overlaid with fake_mpv_set() overrides.
+  static FakeSettings Current();
+  static void SetOverride(const char* key, const char* value);
+  static void ClearOverrides();
+
+  // Applies one key; false for an unknown key or a bad value.
+  bool Apply(const std::string& key, const std::string& value);
+  // Overrides size/fps/duration from an av://lavfi:testsrc2=... URL.
+  void ApplyLavfiUrl(const std::string& url);
+
+  // The error to return at |point|, or 0 when it should succeed.
+  int FailureFor(const std::string& point) const;
+};
+
+// Every call into the fake, in order, for tests to assert on.
+class CallLog {
+ public:
+  static CallLog& Instance();
+
+  void Record(const std::string& name, const std::string& detail = std::string());
+  // Counts |name| without a log line (commands, logged as mpv_command).
+  void Tally(const std::string& name);
+  int64_t Count(const std::string& name);
+  std::string Text();
+  void Clear();
+  // Appends subsequent records to |path| as well ("" stops).
+  void SetFile(const std::string& path);
+
+ private:
+  CallLog() = default;
+  ~CallLog();
+};
+
+}  // namespace mpv_native_texture
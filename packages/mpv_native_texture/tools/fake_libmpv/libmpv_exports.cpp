@@ -0,0 +1,367 @@
+// The libmpv C API over FakePlayer / FakeRenderContext: the subset
+// MpvApi (windows/mpv_dll.h) and the tools' LibMpv resolve, plus the
+// fake_mpv_* controls from fake_mpv.h. Every entry point is recorded in the
+// CallLog and can be made to fail through the "fail" setting.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "fake_mpv.h"
+#include "fake_nodes.h"
+#include "fake_player.h"
+#include "fake_render_context.h"
+#include "fake_settings.h"
+#include "mpv/client.h"
+#include "mpv/render.h"
+#include "mpv/render_gl.h"
+
+using mpv_native_texture::CallLog;
+using mpv_native_texture::FakePlayer;
+using mpv_native_texture::FakeRenderContext;
+using mpv_native_texture::FakeSettings;
+
+struct mpv_handle : FakePlayer {
+  using FakePlayer::FakePlayer;
+};
+
+struct mpv_render_context : FakeRenderContext {
+  using FakeRenderContext::FakeRenderContext;
+};
+
+namespace {
+
+void Record(const char* name, const std::string& detail = std::string()) {
+  CallLog::Instance().Record(name, detail);
+}
+
+int FailureFor(mpv_handle* ctx, const char* name) { return ctx ? ctx->settings().FailureFor(name) : 0; }
+
+std::map<std::string, std::string> ParseOptionList(const std::string& list) {
+  std::map<std::string, std::string> options;
+  size_t start = 0;
+  while (start < list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    const std::string item = list.substr(start, end - start);
+    const size_t eq = item.find('=');
+    if (eq != std::string::npos) options[item.substr(0, eq)] = item.substr(eq + 1);
+    start = end + 1;
+  }
+  return options;
+}
+
+// loadfile <url> [<flags> [<index> [<options>]]]; before mpv 0.38 the
+// options came third.
+void ExtractLoadfileOptions(FakePlayer::Command* command) {
+  if (command->args.empty() || command->args[0] != "loadfile" || !command->options.empty()) return;
+  if (command->args.size() > 4) {
+    command->options = ParseOptionList(command->args[4]);
+  } else if (command->args.size() == 4 && command->args[3].find('=') != std::string::npos) {
+    command->options = ParseOptionList(command->args[3]);
+  }
+}
+
+FakePlayer::Command FromArgv(const char** args) {
+  FakePlayer::Command command;
+  for (; args && *args; ++args) command.args.push_back(*args);
+  ExtractLoadfileOptions(&command);
+  return command;
+}
+
+// Named arguments in the positions mpv documents for the commands the
+// player sends as maps; others keep their map order.
+FakePlayer::Command FromNode(const mpv_node& node) {
+  using mpv_native_texture::NodeMapGet;
+  using mpv_native_texture::NodeToString;
+  using mpv_native_texture::NodeToStringMap;
+  FakePlayer::Command command;
+  if (node.format == MPV_FORMAT_NODE_ARRAY) {
+    for (int i = 0; i < node.u.list->num; ++i) {
+      const mpv_node& arg = node.u.list->values[i];
+      if (arg.format == MPV_FORMAT_NODE_MAP) {
+        command.options = NodeToStringMap(arg);
+      } else {
+        command.args.push_back(NodeToString(arg));
+      }
+    }
+    ExtractLoadfileOptions(&command);
+    return command;
+  }
+  if (node.format != MPV_FORMAT_NODE_MAP) return command;
+  const mpv_node* name = NodeMapGet(node, "name");
+  if (!name) return command;
+  command.args.push_back(NodeToString(*name));
+  static const std::map<std::string, std::vector<const char*>> kSignatures = {
+      {"loadfile", {"url", "flags", "index"}},
+      {"seek", {"target", "flags"}},
+      {"set", {"name", "value"}},
+      {"cycle", {"name", "value"}},
+      {"add", {"name", "value"}},
+  };
+  const auto signature = kSignatures.find(command.args[0]);
+  if (signature != kSignatures.end()) {
+    for (const char* key : signature->second) {
+      const mpv_node* value = NodeMapGet(node, key);
+      command.args.push_back(value ? NodeToString(*value) : std::string());
+    }
+    while (command.args.size() > 1 && command.args.back().empty()) command.args.pop_back();
+    if (const mpv_node* options = NodeMapGet(node, "options")) command.options = NodeToStringMap(*options);
+  } else {
+    for (int i = 0; i < node.u.list->num; ++i) {
+      if (std::strcmp(node.u.list->keys[i], "name") != 0) command.args.push_back(NodeToString(node.u.list->values[i]));
+    }
+  }
+  return command;
+}
+
+std::string Describe(const FakePlayer::Command& command) {
+  std::string out;
+  for (const std::string& arg : command.args) out += (out.empty() ? "" : " ") + arg;
+  for (const auto& [key, value] : command.options) out += " " + key + "=" + value;
+  return out;
+}
+
+int RunCommand(mpv_handle* ctx, const FakePlayer::Command& command, mpv_node* result) {
+  Record("mpv_command", Describe(command));
+  if (!command.args.empty()) CallLog::Instance().Tally(command.args[0]);
+  return ctx->RunCommand(command, result);
+}
+
+}  // namespace
+
+extern "C" {
+
+// --- client.h
+
+unsigned long mpv_client_api_version(void) {
+  Record("mpv_client_api_version");
+  return MPV_CLIENT_API_VERSION;
+}
+
+const char* mpv_error_string(int error) {
+  static const char* const kErrors[] = {
+      "success",
+      "event queue full",
+      "memory allocation failed",
+      "core not initialized",
+      "invalid parameter",
+      "option not found",
+      "unsupported format for accessing option",
+      "error setting option",
+      "property not found",
+      "unsupported format for accessing property",
+      "property unavailable",
+      "error accessing property",
+      "error running command",
+      "loading failed",
+      "audio output initialization failed",
+      "video output initialization failed",
+      "no audio or video data played",
+      "unrecognized file format",
+      "not supported",
+      "operation not implemented",
+      "something happened",
+  };
+  const int index = -error;
+  if (index < 0 || index >= static_cast<int>(sizeof(kErrors) / sizeof(kErrors[0]))) return "unknown error";
+  return kErrors[index];
+}
+
+void mpv_free(void* data) { std::free(data); }
+
+mpv_handle* mpv_create(void) {
+  Record("mpv_create");
+  const FakeSettings settings = FakeSettings::Current();
+  CallLog::Instance().SetFile(settings.log_path);
+  if (settings.FailureFor("mpv_create")) return nullptr;
+  return new mpv_handle(settings);
+}
+
+int mpv_initialize(mpv_handle* ctx) {
+  Record("mpv_initialize");
+  if (const int error = FailureFor(ctx, "mpv_initialize")) return error;
+  return ctx->Initialize();
+}
+
+void mpv_destroy(mpv_handle* ctx) {
+  Record("mpv_destroy");
+  delete ctx;
+}
+
+void mpv_terminate_destroy(mpv_handle* ctx) {
+  Record("mpv_terminate_destroy");
+  delete ctx;
+}
+
+int mpv_set_option_string(mpv_handle* ctx, const char* name, const char* data) {
+  Record("mpv_set_option_string", std::string(name) + "=" + data);
+  if (const int error = FailureFor(ctx, "mpv_set_option_string")) return error;
+  mpv_node value = mpv_native_texture::NodeString(data);
+  const int rc = ctx->SetProperty(name, value);
+  mpv_native_texture::FreeNode(&value);
+  return rc;
+}
+
+int mpv_set_property(mpv_handle* ctx, const char* name, mpv_format format, void* data) {
+  mpv_node value{};
+  const int read = mpv_native_texture::ReadNode(format, data, &value);
+  Record("mpv_set_property", std::string(name) + "=" + mpv_native_texture::NodeToString(value));
+  int rc = FailureFor(ctx, "mpv_set_property");
+  if (rc == 0) rc = read < 0 ? read : ctx->SetProperty(name, value);
+  mpv_native_texture::FreeNode(&value);
+  return rc;
+}
+
+int mpv_get_property(mpv_handle* ctx, const char* name, mpv_format format, void* data) {
+  Record("mpv_get_property", name);
+  if (const int error = FailureFor(ctx, "mpv_get_property")) return error;
+  return ctx->GetProperty(name, format, data);
+}
+
+int mpv_command(mpv_handle* ctx, const char** args) {
+  if (const int error = FailureFor(ctx, "mpv_command")) return error;
+  return RunCommand(ctx, FromArgv(args), nullptr);
+}
+
+int mpv_command_node(mpv_handle* ctx, mpv_node* args, mpv_node* result) {
+  if (const int error = FailureFor(ctx, "mpv_command_node")) return error;
+  return RunCommand(ctx, FromNode(*args), result);
+}
+
+int mpv_command_async(mpv_handle* ctx, uint64_t reply_userdata, const char** args) {
+  const FakePlayer::Command command = FromArgv(args);
+  Record("mpv_command_async", Describe(command));
+  if (const int error = FailureFor(ctx, "mpv_command_async")) return error;
+  if (!command.args.empty()) CallLog::Instance().Tally(command.args[0]);
+  return ctx->RunCommandAsync(reply_userdata, command);
+}
+
+const char* mpv_event_name(mpv_event_id event) {
+  switch (event) {
+    case MPV_EVENT_NONE: return "none";
+    case MPV_EVENT_SHUTDOWN: return "shutdown";
+    case MPV_EVENT_LOG_MESSAGE: return "log-message";
+    case MPV_EVENT_GET_PROPERTY_REPLY: return "get-property-reply";
+    case MPV_EVENT_SET_PROPERTY_REPLY: return "set-property-reply";
+    case MPV_EVENT_COMMAND_REPLY: return "command-reply";
+    case MPV_EVENT_START_FILE: return "start-file";
+    case MPV_EVENT_END_FILE: return "end-file";
+    case MPV_EVENT_FILE_LOADED: return "file-loaded";
+    case MPV_EVENT_IDLE: return "idle";
+    case MPV_EVENT_TICK: return "tick";
+    case MPV_EVENT_CLIENT_MESSAGE: return "client-message";
+    case MPV_EVENT_VIDEO_RECONFIG: return "video-reconfig";
+    case MPV_EVENT_AUDIO_RECONFIG: return "audio-reconfig";
+    case MPV_EVENT_SEEK: return "seek";
+    case MPV_EVENT_PLAYBACK_RESTART: return "playback-restart";
+    case MPV_EVENT_PROPERTY_CHANGE: return "property-change";
+    case MPV_EVENT_QUEUE_OVERFLOW: return "event-queue-overflow";
+    case MPV_EVENT_HOOK: return "hook";
+    default: return nullptr;
+  }
+}
+
+mpv_event* mpv_wait_event(mpv_handle* ctx, double timeout) {
+  mpv_event* event = ctx->WaitEvent(timeout);
+  if (event->event_id != MPV_EVENT_NONE) Record("mpv_wait_event", mpv_event_name(event->event_id));
+  return event;
+}
+
+void mpv_wakeup(mpv_handle* ctx) {
+  Record("mpv_wakeup");
+  ctx->Wakeup();
+}
+
+int mpv_request_log_messages(mpv_handle* ctx, const char* min_level) {
+  Record("mpv_request_log_messages", min_level);
+  return FailureFor(ctx, "mpv_request_log_messages");
+}
+
+void mpv_free_node_contents(mpv_node* node) { mpv_native_texture::FreeNode(node); }
+
+int mpv_observe_property(mpv_handle* ctx, uint64_t reply_userdata, const char* name, mpv_format format) {
+  Record("mpv_observe_property", name);
+  if (const int error = FailureFor(ctx, "mpv_observe_property")) return error;
+  return ctx->Observe(reply_userdata, name, format);
+}
+
+int mpv_hook_add(mpv_handle* ctx, uint64_t reply_userdata, const char* name, int priority) {
+  Record("mpv_hook_add", name);
+  if (const int error = FailureFor(ctx, "mpv_hook_add")) return error;
+  return ctx->AddHook(reply_userdata, name, priority);
+}
+
+int mpv_hook_continue(mpv_handle* ctx, uint64_t id) {
+  Record("mpv_hook_continue", std::to_string(id));
+  if (const int error = FailureFor(ctx, "mpv_hook_continue")) return error;
+  return ctx->ContinueHook(id);
+}
+
+// --- render.h
+
+int mpv_render_context_create(mpv_render_context** res, mpv_handle* mpv, mpv_render_param* params) {
+  Record("mpv_render_context_create");
+  *res = nullptr;
+  if (const int error = FailureFor(mpv, "mpv_render_context_create")) return error;
+  if (!mpv->initialized()) return MPV_ERROR_UNINITIALIZED;
+  const char* api = nullptr;
+  const mpv_opengl_init_params* gl = nullptr;
+  for (; params && params->type != MPV_RENDER_PARAM_INVALID; ++params) {
+    if (params->type == MPV_RENDER_PARAM_API_TYPE) api = static_cast<const char*>(params->data);
+    if (params->type == MPV_RENDER_PARAM_OPENGL_INIT_PARAMS) gl = static_cast<const mpv_opengl_init_params*>(params->data);
+  }
+  if (!api) return MPV_ERROR_INVALID_PARAMETER;
+  const bool software = std::strcmp(api, MPV_RENDER_API_TYPE_SW) == 0;
+  if (!software && std::strcmp(api, MPV_RENDER_API_TYPE_OPENGL) != 0) return MPV_ERROR_NOT_IMPLEMENTED;
+  if (!software && (!gl || !gl->get_proc_address)) return MPV_ERROR_INVALID_PARAMETER;
+  *res = new mpv_render_context(mpv, software, gl);
+  return 0;
+}
+
+void mpv_render_context_free(mpv_render_context* ctx) {
+  Record("mpv_render_context_free");
+  delete ctx;
+}
+
+void mpv_render_context_set_update_callback(mpv_render_context* ctx, mpv_render_update_fn callback,
+                                            void* callback_ctx) {
+  Record("mpv_render_context_set_update_callback");
+  ctx->SetUpdateCallback(callback, callback_ctx);
+}
+
+uint64_t mpv_render_context_update(mpv_render_context* ctx) {
+  Record("mpv_render_context_update");
+  return ctx->Update();
+}
+
+int mpv_render_context_render(mpv_render_context* ctx, mpv_render_param* params) {
+  Record("mpv_render_context_render");
+  return ctx->Render(params);
+}
+
+// --- fake_mpv.h
+
+void fake_mpv_set(const char* key, const char* value) { FakeSettings::SetOverride(key, value); }
+
+void fake_mpv_reset(void) {
+  FakeSettings::ClearOverrides();
+  CallLog::Instance().Clear();
+}
+
+int64_t fake_mpv_call_count(const char* name) { return CallLog::Instance().Count(name); }
+
+size_t fake_mpv_calls(char* buffer, size_t size) {
+  const std::string text = CallLog::Instance().Text();
+  if (buffer && size > 0) {
+    const size_t n = std::min(size - 1, text.size());
+    std::memcpy(buffer, text.data(), n);
+    buffer[n] = '\0';
+  }
+  return text.size();
+}
+
+}  // extern "C"
@@ -0,0 +1,178 @@
+// mpv_render_bench: untimed decode + render + publish throughput.
+//
+// Plays mpv's testsrc2 pattern at each requested size as fast as the
+// pipeline allows (see untimed_pipeline.h) and reports frames/s, the
+// per-stage histograms getStats reports, CPU and memory as JSON. The source
+// is generated by lavfi, so results compare across machines and changes
+// with nothing but libmpv installed. With MPV_LIBRARY pointing at
+// tools/fake_libmpv's libmpv-fake.so, decoding drops out and the numbers
+// are the pipeline's alone.
+//
+//   mpv_render_bench [--size 1280x720 --size 3840x2160] [--seconds 10] [--runs 3]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json_util.h"
+#include "libmpv_loader.h"
+#include "pipeline_stats.h"
+#include "untimed_pipeline.h"
+
+using namespace mpv_native_texture;
+
+namespace {
+
+struct Size {
+  int width;
+  int height;
+};
+
+struct Args {
+  std::vector<Size> sizes;
+  double seconds = 10.0;
+  int fps = 60;
+  int runs = 3;
+  int consumer_hz = 60;
+  std::string hwdec = "no";
+  std::string json_path;
+};
+
+void Usage() {
+  std::fprintf(stderr,
+               "usage: mpv_render_bench [options]\n"
+               "  --size WxH            render size, repeatable (1280x720, 1920x1080, 3840x2160)\n"
+               "  --seconds S           source length (10)\n"
+               "  --fps N               source frame rate (60)\n"
+               "  --runs N              runs per size (3)\n"
+               "  --consumer-hz N       frame pickups per second, 0 = unthrottled (60)\n"
+               "  --hwdec MODE          mpv hwdec (no)\n"
+               "  --json FILE           write the report there instead of stdout\n");
+}
+
+bool ParseArgs(int argc, char** argv, Args* args) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") return false;
+    if (i + 1 >= argc) {
+      std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+      return false;
+    }
+    const char* v = argv[++i];
+    if (arg == "--size") {
+      Size size{};
+      if (std::sscanf(v, "%dx%d", &size.width, &size.height) != 2 || size.width < 16 || size.height < 16) {
+        std::fprintf(stderr, "bad size %s\n", v);
+        return false;
+      }
+      args->sizes.push_back(size);
+    } else if (arg == "--seconds") {
+      args->seconds = std::max(1.0, std::atof(v));
+    } else if (arg == "--fps") {
+      args->fps = std::max(1, std::atoi(v));
+    } else if (arg == "--runs") {
+      args->runs = std::max(1, std::atoi(v));
+    } else if (arg == "--consumer-hz") {
+      args->consumer_hz = std::max(0, std::atoi(v));
+    } else if (arg == "--hwdec") {
+      args->hwdec = v;
+    } else if (arg == "--json") {
+      args->json_path = v;
+    } else {
+      std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+      return false;
+    }
+  }
+  if (args->sizes.empty()) args->sizes = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+  return true;
+}
+
+void WriteSummary(std::ostream& out, const LatencyHistogram::Summary& s) {
+  out << "{\"count\":" << s.count << ",\"meanUs\":" << s.mean_us << ",\"p50Us\":" << s.p50_us
+      << ",\"p95Us\":" << s.p95_us << ",\"p99Us\":" << s.p99_us << ",\"maxUs\":" << s.max_us << "}";
+}
+
+void WriteRun(std::ostream& out, const BenchmarkReport& r) {
+  out << "{\"ok\":" << (r.ok ? "true" : "false") << ",\"error\":";
+  WriteJsonString(out, r.error.c_str());
+  out << ",\"elapsedUs\":" << r.elapsed_us << ",\"renderFps\":" << r.render_fps
+      << ",\"publishFps\":" << r.publish_fps << ",\"cpuPercent\":" << r.cpu_percent
+      << ",\"peakRssBytes\":" << r.peak_rss_bytes << ",\"rssBytes\":" << r.rss_bytes
+      << ",\"framesRendered\":" << r.stats.frames_rendered << ",\"framesPublished\":" << r.stats.frames_published
+      << ",\"framesConsumed\":" << r.stats.frames_consumed << ",\"framesDropped\":" << r.stats.frames_dropped
+      << ",\"stages\":{";
+  for (int i = 0; i < PipelineStats::kStageCount; ++i) {
+    if (i) out << ",";
+    WriteJsonString(out, PipelineStats::StageName(static_cast<PipelineStats::Stage>(i)));
+    out << ":";
+    WriteSummary(out, r.stats.stages[i]);
+  }
+  out << "}}";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Args args;
+  if (!ParseArgs(argc, argv, &args)) {
+    Usage();
+    return 2;
+  }
+
+  LibMpv lib;
+  std::string err;
+  if (!lib.Load(&err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 1;
+  }
+
+  std::ostringstream out;
+  out << "{\"seconds\":" << args.seconds << ",\"fps\":" << args.fps << ",\"consumerHz\":" << args.consumer_hz
+      << ",\"hwdec\":";
+  WriteJsonString(out, args.hwdec.c_str());
+  out << ",\"results\":[";
+  bool all_ok = true;
+  for (size_t s = 0; s < args.sizes.size(); ++s) {
+    const Size size = args.sizes[s];
+    BenchmarkPlan plan;
+    plan.width = size.width;
+    plan.height = size.height;
+    plan.consumer_hz = args.consumer_hz;
+    plan.hwdec = args.hwdec;
+    char url[160];
+    std::snprintf(url, sizeof(url), "av://lavfi:testsrc2=size=%dx%d:rate=%d:duration=%g", size.width, size.height,
+                  args.fps, args.seconds);
+    plan.url = url;
+
+    if (s) out << ",";
+    out << "{\"width\":" << size.width << ",\"height\":" << size.height << ",\"runs\":[";
+    for (int run = 0; run < args.runs; ++run) {
+      const BenchmarkReport report = RunBenchmark(lib, plan);
+      std::fprintf(stderr, "[%dx%d] run %d: %s %.1f fps rendered, %.1f published, cpu %.0f%%\n", size.width,
+                   size.height, run + 1, report.ok ? "ok," : report.error.c_str(), report.render_fps,
+                   report.publish_fps, report.cpu_percent);
+      all_ok = all_ok && report.ok;
+      if (run) out << ",";
+      WriteRun(out, report);
+    }
+    out << "]}";
+  }
+  out << "]}\n";
+
+  if (args.json_path.empty()) {
+    std::cout << out.str();
+  } else {
+    std::ofstream file(args.json_path);
+    file << out.str();
+    if (!file) {
+      std::fprintf(stderr, "Cannot write %s\n", args.json_path.c_str());
+      return 1;
+    }
+  }
+  return all_ok ? 0 : 1;
+}
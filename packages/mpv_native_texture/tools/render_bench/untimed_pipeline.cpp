@@ -0,0 +1,322 @@
+#include "untimed_pipeline.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <clocale>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpv_native_texture {
+
+namespace {
+
+int64_t ProcessCpuMicros() {
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  const auto micros = [](const timeval& tv) { return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec; };
+  return micros(usage.ru_utime) + micros(usage.ru_stime);
+}
+
+// VmHWM and VmRSS from /proc/self/status, in bytes.
+void ProcessMemory(int64_t* peak_rss, int64_t* rss) {
+  *peak_rss = 0;
+  *rss = 0;
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    long long kb = 0;
+    if (std::sscanf(line.c_str(), "VmHWM: %lld kB", &kb) == 1) *peak_rss = kb * 1024;
+    if (std::sscanf(line.c_str(), "VmRSS: %lld kB", &kb) == 1) *rss = kb * 1024;
+  }
+}
+
+// MpvPlayer's frame path without GL and Flutter: render thread, double
+// buffer, publish lock and a consumer in place of the raster thread.
+class Pipeline {
+ public:
+  Pipeline(const LibMpv& lib, mpv_render_context* render, int width, int height, int consumer_hz)
+      : lib_(lib), render_(render), width_(width), height_(height), consumer_hz_(consumer_hz) {
+    const size_t bytes = static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4u;
+    front_.assign(bytes, 0);
+    back_.assign(bytes, 0);
+    staging_.assign(bytes, 0);
+    lib_.mpv_render_context_set_update_callback(render_, &Pipeline::OnUpdate, this);
+    render_thread_ = std::thread([this] { RenderMain(); });
+    consumer_thread_ = std::thread([this] { ConsumerMain(); });
+  }
+
+  ~Pipeline() {
+    lib_.mpv_render_context_set_update_callback(render_, nullptr, nullptr);
+    {
+      std::lock_guard<std::mutex> lock(render_mutex_);
+      running_.store(false);
+    }
+    render_cv_.notify_one();
+    render_thread_.join();
+    consumer_thread_.join();
+  }
+
+  PipelineStats& stats() { return stats_; }
+
+  // Waits until a requested render has finished: END_FILE can be dequeued
+  // while the last frame is still being rendered.
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lock(render_mutex_);
+    idle_cv_.wait(lock, [this] { return (!needs_render_ && !rendering_) || !running_.load(); });
+  }
+  int64_t first_frame_ticks() const { return first_frame_ticks_.load(); }
+  int64_t last_frame_ticks() const { return last_frame_ticks_.load(); }
+
+ private:
+  static void OnUpdate(void* ctx) {
+    auto* self = static_cast<Pipeline*>(ctx);
+    int64_t none = 0;
+    self->requested_ticks_.compare_exchange_strong(none, SteadyClock::now().time_since_epoch().count());
+    {
+      std::lock_guard<std::mutex> lock(self->render_mutex_);
+      self->needs_render_ = true;
+    }
+    self->render_cv_.notify_one();
+  }
+
+  void RenderMain() {
+    while (running_.load()) {
+      {
+        std::unique_lock<std::mutex> lock(render_mutex_);
+        render_cv_.wait(lock, [this] { return needs_render_ || !running_.load(); });
+        if (!running_.load()) return;
+        needs_render_ = false;
+        rendering_ = true;
+      }
+      auto stage_start = SteadyClock::now();
+      const int64_t requested = requested_ticks_.exchange(0);
+      if (requested != 0) {
+        stats_.Record(PipelineStats::kWakeup,
+                      MicrosBetween(SteadyClock::time_point(SteadyClock::duration(requested)), stage_start));
+      }
+
+      const uint64_t flags = lib_.mpv_render_context_update(render_);
+      int size[2] = {width_, height_};
+      char format[] = "rgb0";
+      size_t stride = static_cast<size_t>(width_) * 4u;
+      mpv_render_param params[] = {
+          {MPV_RENDER_PARAM_SW_SIZE, size},
+          {MPV_RENDER_PARAM_SW_FORMAT, format},
+          {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+          {MPV_RENDER_PARAM_SW_POINTER, back_.data()},
+          {MPV_RENDER_PARAM_INVALID, nullptr},
+      };
+      stage_start = SteadyClock::now();
+      const int rc = lib_.mpv_render_context_render(render_, params);
+      if (rc < 0) {
+        FinishRender();
+        continue;
+      }
+      const auto rendered_at = SteadyClock::now();
+      stats_.Record(PipelineStats::kRender, MicrosBetween(stage_start, rendered_at));
+      stats_.CountRendered();
+      if (flags & MPV_RENDER_UPDATE_FRAME) {
+        int64_t none = 0;
+        first_frame_ticks_.compare_exchange_strong(none, rendered_at.time_since_epoch().count());
+        last_frame_ticks_.store(rendered_at.time_since_epoch().count());
+      }
+
+      stage_start = SteadyClock::now();
+      {
+        std::lock_guard<std::mutex> lock(pixel_mutex_);
+        front_.swap(back_);
+        stats_.CountPublished(frame_unconsumed_);
+        frame_unconsumed_ = true;
+        published_at_ = SteadyClock::now();
+        stats_.Record(PipelineStats::kPublish, MicrosBetween(stage_start, published_at_));
+      }
+      FinishRender();
+    }
+  }
+
+  void FinishRender() {
+    {
+      std::lock_guard<std::mutex> lock(render_mutex_);
+      rendering_ = false;
+    }
+    idle_cv_.notify_all();
+  }
+
+  // Copies under the lock: the engine uploads the buffer right after
+  // CopyPixelBuffer returns, and the tool must not race the next swap.
+  void ConsumerMain() {
+    const auto interval = consumer_hz_ > 0 ? std::chrono::microseconds(1000000 / consumer_hz_)
+                                           : std::chrono::microseconds(0);
+    auto next = SteadyClock::now();
+    while (running_.load()) {
+      if (consumer_hz_ > 0) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+      }
+      std::lock_guard<std::mutex> lock(pixel_mutex_);
+      if (!frame_unconsumed_) continue;
+      frame_unconsumed_ = false;
+      stats_.Record(PipelineStats::kConsume, MicrosBetween(published_at_, SteadyClock::now()));
+      stats_.CountConsumed();
+      std::memcpy(staging_.data(), front_.data(), front_.size());
+    }
+  }
+
+  const LibMpv& lib_;
+  mpv_render_context* const render_;
+  const int width_;
+  const int height_;
+  const int consumer_hz_;
+
+  PipelineStats stats_;
+  std::atomic<bool> running_{true};
+  std::atomic<int64_t> requested_ticks_{0};
+  std::atomic<int64_t> first_frame_ticks_{0};
+  std::atomic<int64_t> last_frame_ticks_{0};
+  std::mutex render_mutex_;
+  std::condition_variable render_cv_;
+  std::condition_variable idle_cv_;
+  bool needs_render_ = false;
+  bool rendering_ = false;
+
+  std::mutex pixel_mutex_;
+  std::vector<uint8_t> front_;
+  std::vector<uint8_t> back_;
+  std::vector<uint8_t> staging_;  // the engine's copy
+  bool frame_unconsumed_ = false;
+  SteadyClock::time_point published_at_{};
+
+  std::thread render_thread_;
+  std::thread consumer_thread_;
+};
+
+}  // namespace
+
+BenchmarkReport RunBenchmark(const LibMpv& lib, const BenchmarkPlan& plan) {
+  BenchmarkReport report;
+  std::setlocale(LC_NUMERIC, "C");
+  mpv_handle* mpv = lib.mpv_create();
+  if (!mpv) {
+    report.error = "mpv_create() failed";
+    return report;
+  }
+
+  // OpenOptions::benchmark, plus what the GPU-less render path needs.
+  const std::pair<const char*, const char*> options[] = {
+      {"vo", "libmpv"},
+      {"hwdec", plan.hwdec.c_str()},
+      {"untimed", "yes"},
+      {"video-sync", "desync"},
+      {"ao", "null"},
+      {"keep-open", "no"},
+      {"config", "no"},
+      {"load-scripts", "no"},
+      {"terminal", "no"},
+      {"osd-level", "0"},
+      {"ytdl", "no"},
+  };
+  for (const auto& [name, value] : options) lib.mpv_set_option_string(mpv, name, value);
+
+  mpv_render_context* render = nullptr;
+  int rc = lib.mpv_initialize(mpv);
+  if (rc >= 0) {
+    const char* api_type = MPV_RENDER_API_TYPE_SW;
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(api_type)},
+        {MPV_RENDER_PARAM_INVALID, nullptr},
+    };
+    rc = lib.mpv_render_context_create(&render, mpv, params);
+    if (rc < 0) report.error = lib.Error("mpv_render_context_create(sw)", rc);
+  } else {
+    report.error = lib.Error("mpv_initialize", rc);
+  }
+  if (rc < 0) {
+    lib.mpv_terminate_destroy(mpv);
+    return report;
+  }
+
+  {
+    Pipeline pipeline(lib, render, std::max(16, plan.width), std::max(16, plan.height), plan.consumer_hz);
+    // Baseline before loadfile: the first frame can be rendered before this
+    // thread gets to FILE_LOADED.
+    pipeline.stats().TakeSnapshot(true);
+    const PipelineStats::Counters at_start = pipeline.stats().counters();
+    const int64_t cpu_start_us = ProcessCpuMicros();
+    const auto issued = SteadyClock::now();
+    const char* cmd[] = {"loadfile", plan.url.c_str(), nullptr};
+    rc = lib.mpv_command(mpv, cmd);
+    if (rc < 0) report.error = lib.Error("loadfile", rc);
+
+    bool loaded = false;
+    const auto deadline =
+        SteadyClock::now() + std::chrono::duration_cast<SteadyClock::duration>(
+                                 std::chrono::duration<double>(plan.timeout_seconds));
+    bool ended = rc < 0;
+    while (!ended) {
+      if (SteadyClock::now() >= deadline) {
+        report.error = "timed out";
+        break;
+      }
+      const mpv_event* event = lib.mpv_wait_event(mpv, 0.1);
+      switch (event->event_id) {
+        case MPV_EVENT_FILE_LOADED:
+          loaded = true;
+          break;
+        case MPV_EVENT_END_FILE: {
+          const auto* end = static_cast<const mpv_event_end_file*>(event->data);
+          if (end->reason == MPV_END_FILE_REASON_EOF) {
+            report.ok = loaded;
+            if (!report.ok) report.error = "ended before loading";
+          } else {
+            report.error = end->reason == MPV_END_FILE_REASON_ERROR ? lib.Error("playback", end->error)
+                                                                     : "playback stopped";
+          }
+          ended = true;
+          break;
+        }
+        case MPV_EVENT_SHUTDOWN:
+          report.error = "mpv shut down";
+          ended = true;
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (report.ok) {
+      pipeline.WaitIdle();
+      // From the first new frame to the last; CPU is charged from loadfile.
+      const int64_t first = pipeline.first_frame_ticks();
+      const int64_t last = pipeline.last_frame_ticks();
+      const auto started = first != 0 ? SteadyClock::time_point(SteadyClock::duration(first)) : issued;
+      const auto until = last != 0 ? SteadyClock::time_point(SteadyClock::duration(last)) : SteadyClock::now();
+      report.elapsed_us = std::max<int64_t>(1, MicrosBetween(started, until));
+      report.cpu_percent = static_cast<double>(ProcessCpuMicros() - cpu_start_us) * 100.0 /
+                           static_cast<double>(std::max<int64_t>(1, MicrosBetween(issued, until)));
+      report.stats = pipeline.stats().TakeSnapshot(false);
+      const double seconds = static_cast<double>(report.elapsed_us) / 1e6;
+      // Counters never reset; report the run's share.
+      report.stats.frames_rendered -= at_start.frames_rendered;
+      report.stats.frames_skipped -= at_start.frames_skipped;
+      report.stats.frames_published -= at_start.frames_published;
+      report.stats.frames_consumed -= at_start.frames_consumed;
+      report.stats.frames_dropped -= at_start.frames_dropped;
+      report.render_fps = static_cast<double>(report.stats.frames_rendered) / seconds;
+      report.publish_fps = static_cast<double>(report.stats.frames_published) / seconds;
+    }
+    ProcessMemory(&report.peak_rss_bytes, &report.rss_bytes);
+  }
+
+  lib.mpv_render_context_free(render);
+  lib.mpv_terminate_destroy(mpv);
+  return report;
+}
+
+}  // namespace mpv_native_texture
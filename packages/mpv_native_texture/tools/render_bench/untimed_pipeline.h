@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "libmpv_loader.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+struct BenchmarkPlan {
+  std::string url;
+  // Render target; normally the source size.
+  int width = 1280;
+  int height = 720;
+  // How often the stand-in for the Flutter raster thread picks up the
+  // published frame (CopyPixelBuffer); 0 polls as fast as it can.
+  int consumer_hz = 60;
+  std::string hwdec = "no";
+  double timeout_seconds = 300.0;
+};
+
+struct BenchmarkReport {
+  bool ok = false;
+  std::string error;
+  int64_t elapsed_us = 0;  // first new frame -> last new frame
+  double render_fps = 0.0;
+  double publish_fps = 0.0;
+  double cpu_percent = 0.0;  // process CPU from loadfile on; 100 = one core
+  int64_t peak_rss_bytes = 0;
+  int64_t rss_bytes = 0;
+  PipelineStats::Snapshot stats;  // same stages and counters as getStats
+};
+
+// Plays |plan.url| once with the plugin's benchmark options (untimed,
+// video-sync=desync, ao=null) through the render and publish path of
+// MpvPlayer::RenderThreadMain: an update callback wakes a render thread that
+// renders into the back buffer and swaps it to the front under a mutex, and
+// a consumer thread takes frames off the front like CopyPixelBuffer. The
+// software renderer stands in for GL render + glReadPixels, so kRender
+// covers both and kMakeCurrent / kReadback stay empty.
+BenchmarkReport RunBenchmark(const LibMpv& lib, const BenchmarkPlan& plan);
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,297 @@
+// mpv_stream_harness: reproducible network playback measurements.
+//
+// Generates test media with libmpv, serves it from a local HTTP server that
+// can throttle, delay, stall and cut connections, and plays it back
+// headlessly through the same libmpv setup MpvPlayer uses, once per fault
+// scenario. Reports time to first frame, rebuffering and seek latency as
+// JSON. Runs on a GPU-less Linux machine; only libmpv is needed at runtime.
+//
+//   mpv_stream_harness [--scenario baseline --scenario stalls ...] [--runs 3]
+//   mpv_stream_harness --serve --rate 500000 --stall-every 4000000 --stall-ms 3000
+//
+// --serve keeps the server up with the given faults (until Ctrl+C), e.g. to
+// point the Flutter example app at it.
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_util.h"
+#include "libmpv_loader.h"
+#include "media_generator.h"
+#include "pipeline_stats.h"
+#include "playback_probe.h"
+#include "throttled_http_server.h"
+
+using namespace mpv_native_texture;
+
+namespace {
+
+struct Scenario {
+  std::string name;
+  ThrottledHttpServer::Faults faults;
+};
+
+struct Args {
+  std::string media_dir = "harness_media";
+  bool regenerate = false;
+  MediaSpec spec;
+  int port = 0;
+  bool serve = false;
+  ThrottledHttpServer::Faults serve_faults;
+  std::vector<std::string> scenarios;
+  int runs = 3;
+  double play_seconds = 10.0;
+  std::string json_path;
+};
+
+volatile std::sig_atomic_t g_interrupted = 0;
+
+void Usage() {
+  std::fprintf(stderr,
+               "usage: mpv_stream_harness [options]\n"
+               "  --media-dir DIR       generated media, reused between runs (harness_media)\n"
+               "  --regenerate          re-encode the media\n"
+               "  --seconds N           media length (60)\n"
+               "  --bitrate BPS         video bitrate (3000000)\n"
+               "  --codec NAME          video encoder (libx264)\n"
+               "  --no-hls              progressive file only\n"
+               "  --scenario NAME       baseline, throttled, slow-link, latency, stalls, cuts;\n"
+               "                        repeatable, all by default\n"
+               "  --runs N              runs per scenario and source (3)\n"
+               "  --play-seconds S      playback before the seeks (10)\n"
+               "  --json FILE           write the report there instead of stdout\n"
+               "  --port N              server port (any free one)\n"
+               "  --serve               only serve, with these faults:\n"
+               "    --rate BPS --latency MS --stall-every BYTES --stall-ms MS --cut-after BYTES\n");
+}
+
+bool ParseArgs(int argc, char** argv, Args* args) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+    const char* v = nullptr;
+    if (arg == "--regenerate") {
+      args->regenerate = true;
+    } else if (arg == "--no-hls") {
+      args->spec.hls = false;
+    } else if (arg == "--serve") {
+      args->serve = true;
+    } else if (arg == "--help" || arg == "-h") {
+      return false;
+    } else if (!(v = value())) {
+      std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+      return false;
+    } else if (arg == "--media-dir") {
+      args->media_dir = v;
+    } else if (arg == "--seconds") {
+      args->spec.seconds = std::max(4, std::atoi(v));
+    } else if (arg == "--bitrate") {
+      args->spec.video_bitrate = std::max<int64_t>(100000, std::atoll(v));
+    } else if (arg == "--codec") {
+      args->spec.video_codec = v;
+    } else if (arg == "--scenario") {
+      args->scenarios.push_back(v);
+    } else if (arg == "--runs") {
+      args->runs = std::max(1, std::atoi(v));
+    } else if (arg == "--play-seconds") {
+      args->play_seconds = std::max(0.0, std::atof(v));
+    } else if (arg == "--json") {
+      args->json_path = v;
+    } else if (arg == "--port") {
+      args->port = std::atoi(v);
+    } else if (arg == "--rate") {
+      args->serve_faults.bytes_per_second = std::atoll(v);
+    } else if (arg == "--latency") {
+      args->serve_faults.latency_ms = std::atoi(v);
+    } else if (arg == "--stall-every") {
+      args->serve_faults.stall_every_bytes = std::atoll(v);
+    } else if (arg == "--stall-ms") {
+      args->serve_faults.stall_ms = std::atoi(v);
+    } else if (arg == "--cut-after") {
+      args->serve_faults.cut_after_bytes = std::atoll(v);
+    } else {
+      std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fault sets scaled to the media's bitrate, so they mean the same thing for
+// any --bitrate: "throttled" still keeps up, "slow-link" cannot.
+std::vector<Scenario> BuiltinScenarios(const MediaSpec& spec) {
+  const int64_t stream_bytes_per_second = (spec.video_bitrate + 128000) / 8;
+  std::vector<Scenario> all(6);
+  all[0].name = "baseline";
+  all[1].name = "throttled";
+  all[1].faults.bytes_per_second = stream_bytes_per_second * 3 / 2;
+  all[2].name = "slow-link";
+  all[2].faults.bytes_per_second = stream_bytes_per_second * 4 / 5;
+  all[3].name = "latency";
+  all[3].faults.latency_ms = 300;
+  all[4].name = "stalls";
+  all[4].faults.stall_every_bytes = stream_bytes_per_second * 8;
+  all[4].faults.stall_ms = 2500;
+  all[4].faults.bytes_per_second = stream_bytes_per_second * 2;
+  all[5].name = "cuts";
+  all[5].faults.cut_after_bytes = stream_bytes_per_second * 5;
+  return all;
+}
+
+void WriteSummary(std::ostream& out, const LatencyHistogram::Summary& s) {
+  out << "{\"count\":" << s.count << ",\"meanMs\":" << s.mean_us / 1000.0 << ",\"p50Ms\":" << s.p50_us / 1000.0
+      << ",\"p95Ms\":" << s.p95_us / 1000.0 << ",\"maxMs\":" << s.max_us / 1000.0 << "}";
+}
+
+// Runs |runs| playbacks of |url| and appends one JSON object to |out|.
+void RunScenario(const LibMpv& lib, ThrottledHttpServer* server, const Scenario& scenario, const char* source,
+                 const std::string& url, const Args& args, std::ostream& out) {
+  server->SetFaults(scenario.faults);
+  const ThrottledHttpServer::Stats before = server->TakeStats();
+
+  PlaybackPlan plan;
+  plan.play_seconds = args.play_seconds;
+  const double s = args.spec.seconds;
+  plan.seeks = {s * 0.5, s * 0.25, s * 0.8};
+
+  LatencyHistogram loaded;
+  LatencyHistogram first_frame;
+  LatencyHistogram seeks;
+  int ok = 0;
+  int rebuffers = 0;
+  int64_t rebuffer_us = 0;
+  int seek_timeouts = 0;
+  std::vector<std::string> errors;
+  for (int run = 0; run < args.runs && !g_interrupted; ++run) {
+    const PlaybackReport report = RunPlayback(lib, url, plan);
+    std::fprintf(stderr, "[%s/%s] run %d: %s first frame %.1f ms, %d rebuffers, %zu seeks\n", scenario.name.c_str(),
+                 source, run + 1, report.ok ? "ok," : report.error.c_str(), report.first_frame_us / 1000.0,
+                 report.rebuffers, report.seek_us.size());
+    if (report.ok) ++ok;
+    if (!report.error.empty()) errors.push_back(report.error);
+    if (report.file_loaded_us >= 0) loaded.Record(report.file_loaded_us);
+    if (report.first_frame_us >= 0) first_frame.Record(report.first_frame_us);
+    rebuffers += report.rebuffers;
+    rebuffer_us += report.rebuffer_us;
+    for (const int64_t us : report.seek_us) {
+      if (us < 0) {
+        ++seek_timeouts;
+      } else {
+        seeks.Record(us);
+      }
+    }
+  }
+  const ThrottledHttpServer::Stats after = server->TakeStats();
+
+  out << "{\"scenario\":";
+  WriteJsonString(out, scenario.name.c_str());
+  out << ",\"source\":";
+  WriteJsonString(out, source);
+  out << ",\"faults\":{\"bytesPerSecond\":" << scenario.faults.bytes_per_second
+      << ",\"latencyMs\":" << scenario.faults.latency_ms << ",\"stallEveryBytes\":" << scenario.faults.stall_every_bytes
+      << ",\"stallMs\":" << scenario.faults.stall_ms << ",\"cutAfterBytes\":" << scenario.faults.cut_after_bytes
+      << "},\"runs\":" << args.runs << ",\"ok\":" << ok << ",\"fileLoaded\":";
+  WriteSummary(out, loaded.Summarize());
+  out << ",\"timeToFirstFrame\":";
+  WriteSummary(out, first_frame.Summarize());
+  out << ",\"rebuffers\":" << rebuffers << ",\"rebufferMs\":" << rebuffer_us / 1000.0 << ",\"seek\":";
+  WriteSummary(out, seeks.Summarize());
+  out << ",\"seekTimeouts\":" << seek_timeouts << ",\"server\":{\"requests\":" << after.requests - before.requests
+      << ",\"bytesSent\":" << after.bytes_sent - before.bytes_sent << ",\"stalls\":" << after.stalls - before.stalls
+      << ",\"cuts\":" << after.cuts - before.cuts << "},\"errors\":[";
+  for (size_t i = 0; i < errors.size(); ++i) {
+    if (i) out << ",";
+    WriteJsonString(out, errors[i].c_str());
+  }
+  out << "]}";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Args args;
+  if (!ParseArgs(argc, argv, &args)) {
+    Usage();
+    return 2;
+  }
+  std::signal(SIGINT, [](int) { g_interrupted = 1; });
+
+  LibMpv lib;
+  std::string err;
+  if (!lib.Load(&err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 1;
+  }
+
+  std::fprintf(stderr, "Preparing test media in %s\n", args.media_dir.c_str());
+  GeneratedMedia media;
+  if (!GenerateTestMedia(lib, args.media_dir, args.spec, args.regenerate, &media, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 1;
+  }
+
+  ThrottledHttpServer server(args.media_dir);
+  if (!server.Start(args.port, &err)) {
+    std::fprintf(stderr, "%s\n", err.c_str());
+    return 1;
+  }
+
+  if (args.serve) {
+    server.SetFaults(args.serve_faults);
+    std::fprintf(stderr, "Serving %s\n", server.Url(media.progressive).c_str());
+    if (!media.hls.empty()) std::fprintf(stderr, "Serving %s\n", server.Url(media.hls).c_str());
+    while (!g_interrupted) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    server.Stop();
+    return 0;
+  }
+
+  std::vector<Scenario> scenarios;
+  for (const Scenario& s : BuiltinScenarios(args.spec)) {
+    if (args.scenarios.empty() || std::count(args.scenarios.begin(), args.scenarios.end(), s.name)) {
+      scenarios.push_back(s);
+    }
+  }
+  if (scenarios.empty()) {
+    std::fprintf(stderr, "No such scenario\n");
+    Usage();
+    return 2;
+  }
+
+  std::ostringstream out;
+  out << "{\"media\":{\"seconds\":" << args.spec.seconds << ",\"bitrate\":" << args.spec.video_bitrate
+      << ",\"codec\":";
+  WriteJsonString(out, args.spec.video_codec.c_str());
+  out << "},\"results\":[";
+  bool first = true;
+  for (const Scenario& scenario : scenarios) {
+    const std::pair<const char*, std::string> sources[] = {{"progressive", media.progressive}, {"hls", media.hls}};
+    for (const auto& [source, path] : sources) {
+      if (path.empty() || g_interrupted) continue;
+      if (!first) out << ",";
+      first = false;
+      RunScenario(lib, &server, scenario, source, server.Url(path), args, out);
+    }
+  }
+  out << "]}\n";
+  server.Stop();
+
+  if (args.json_path.empty()) {
+    std::cout << out.str();
+  } else {
+    std::ofstream file(args.json_path);
+    file << out.str();
+    if (!file) {
+      std::fprintf(stderr, "Cannot write %s\n", args.json_path.c_str());
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "libmpv_loader.h"
+
+#include <dlfcn.h>
+
+#include <cstdlib>
+
+namespace mpv_native_texture {
+
+template <typename T>
+static bool Resolve(void* handle, const char* name, T* out) {
+  *out = reinterpret_cast<T>(dlsym(handle, name));
+  return *out != nullptr;
+}
+
+bool LibMpv::Load(std::string* err_out) {
+  if (handle) return true;
+
+  std::string tried;
+  const char* env = std::getenv("MPV_LIBRARY");
+  const char* const candidates[] = {env, "libmpv.so.2", "libmpv.so.1", "libmpv.so"};
+  for (const char* name : candidates) {
+    if (!name || !*name) continue;
+    handle = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+    if (handle) break;
+    tried += std::string(tried.empty() ? "" : ", ") + name;
+  }
+  if (!handle) {
+    if (err_out) *err_out = "Cannot load libmpv (tried " + tried + "); set MPV_LIBRARY";
+    return false;
+  }
+
+  const bool ok = Resolve(handle, "mpv_error_string", &mpv_error_string) &&
+                  Resolve(handle, "mpv_event_name", &mpv_event_name) &&
+                  Resolve(handle, "mpv_create", &mpv_create) &&
+                  Resolve(handle, "mpv_initialize", &mpv_initialize) &&
+                  Resolve(handle, "mpv_terminate_destroy", &mpv_terminate_destroy) &&
+                  Resolve(handle, "mpv_set_option_string", &mpv_set_option_string) &&
+                  Resolve(handle, "mpv_get_property", &mpv_get_property) &&
+                  Resolve(handle, "mpv_command", &mpv_command) &&
+                  Resolve(handle, "mpv_observe_property", &mpv_observe_property) &&
+                  Resolve(handle, "mpv_wait_event", &mpv_wait_event) &&
+                  Resolve(handle, "mpv_wakeup", &mpv_wakeup) &&
+                  Resolve(handle, "mpv_render_context_create", &mpv_render_context_create) &&
+                  Resolve(handle, "mpv_render_context_set_update_callback",
+                          &mpv_render_context_set_update_callback) &&
+                  Resolve(handle, "mpv_render_context_update", &mpv_render_context_update) &&
+                  Resolve(handle, "mpv_render_context_render", &mpv_render_context_render) &&
+                  Resolve(handle, "mpv_render_context_free", &mpv_render_context_free);
+  if (!ok) {
+    if (err_out) *err_out = std::string("libmpv is missing a symbol: ") + dlerror();
+    Unload();
+    return false;
+  }
+  return true;
+}
+
+void LibMpv::Unload() {
+  void* const loaded = handle;
+  *this = LibMpv{};
+  if (loaded) dlclose(loaded);
+}
+
+std::string LibMpv::Error(const char* what, int code) const {
+  const char* text = mpv_error_string ? mpv_error_string(code) : "unknown";
+  return std::string(what) + ": libmpv error " + std::to_string(code) + ": " + text;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "mpv/client.h"
+#include "mpv/render.h"
+
+namespace mpv_native_texture {
+
+// The slice of libmpv the harness uses, resolved with dlopen so the tool
+// builds without a libmpv development package. $MPV_LIBRARY overrides the
+// search (libmpv.so.2, then libmpv.so.1, then libmpv.so).
+struct LibMpv {
+  void* handle = nullptr;
+
+  const char* (*mpv_error_string)(int) = nullptr;
+  const char* (*mpv_event_name)(mpv_event_id) = nullptr;
+  mpv_handle* (*mpv_create)(void) = nullptr;
+  int (*mpv_initialize)(mpv_handle*) = nullptr;
+  void (*mpv_terminate_destroy)(mpv_handle*) = nullptr;
+  int (*mpv_set_option_string)(mpv_handle*, const char*, const char*) = nullptr;
+  int (*mpv_get_property)(mpv_handle*, const char*, mpv_format, void*) = nullptr;
+  int (*mpv_command)(mpv_handle*, const char**) = nullptr;
+  int (*mpv_observe_property)(mpv_handle*, uint64_t, const char*, mpv_format) = nullptr;
+  mpv_event* (*mpv_wait_event)(mpv_handle*, double) = nullptr;
+  void (*mpv_wakeup)(mpv_handle*) = nullptr;
+  int (*mpv_render_context_create)(mpv_render_context**, mpv_handle*, mpv_render_param*) = nullptr;
+  void (*mpv_render_context_set_update_callback)(mpv_render_context*, mpv_render_update_fn, void*) = nullptr;
+  uint64_t (*mpv_render_context_update)(mpv_render_context*) = nullptr;
+  int (*mpv_render_context_render)(mpv_render_context*, mpv_render_param*) = nullptr;
+  void (*mpv_render_context_free)(mpv_render_context*) = nullptr;
+
+  bool Load(std::string* err_out);
+  void Unload();
+  // "<what>: libmpv error <code>: <text>"
+  std::string Error(const char* what, int code) const;
+};
+
+}  // namespace mpv_native_texture
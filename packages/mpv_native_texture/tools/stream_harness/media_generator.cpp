@@ -0,0 +1,92 @@
+#include "media_generator.h"
+
+#include <clocale>
+#include <filesystem>
+
+namespace mpv_native_texture {
+
+namespace fs = std::filesystem;
+
+// Runs one libmpv encode of the lavfi test source into |output|.
+static bool Encode(const LibMpv& lib, const MediaSpec& spec, const std::string& output, const char* format,
+                   const std::string& format_options, std::string* err_out) {
+  std::setlocale(LC_NUMERIC, "C");
+  mpv_handle* mpv = lib.mpv_create();
+  if (!mpv) {
+    if (err_out) *err_out = "mpv_create() failed";
+    return false;
+  }
+  const std::string d = std::to_string(spec.seconds);
+  // Two outputs of one lavfi graph: out0 is video, out1 audio.
+  const std::string source = "av://lavfi:testsrc2=s=" + std::to_string(spec.width) + "x" +
+                             std::to_string(spec.height) + ":r=" + std::to_string(spec.fps) + ":d=" + d +
+                             "[out0];sine=f=440:sample_rate=48000:d=" + d + "[out1]";
+  const std::string gop = std::to_string(spec.fps * spec.keyframe_secs);
+  const std::string video_options =
+      "b=" + std::to_string(spec.video_bitrate) + ",g=" + gop + ",keyint_min=" + gop + ",bf=0";
+
+  lib.mpv_set_option_string(mpv, "config", "no");
+  lib.mpv_set_option_string(mpv, "terminal", "no");
+  lib.mpv_set_option_string(mpv, "o", output.c_str());
+  lib.mpv_set_option_string(mpv, "of", format);
+  if (!format_options.empty()) lib.mpv_set_option_string(mpv, "ofopts", format_options.c_str());
+  lib.mpv_set_option_string(mpv, "ovc", spec.video_codec.c_str());
+  lib.mpv_set_option_string(mpv, "ovcopts", video_options.c_str());
+  lib.mpv_set_option_string(mpv, "oac", "aac");
+  lib.mpv_set_option_string(mpv, "oacopts", "b=128000");
+
+  int rc = lib.mpv_initialize(mpv);
+  if (rc >= 0) {
+    const char* cmd[] = {"loadfile", source.c_str(), nullptr};
+    rc = lib.mpv_command(mpv, cmd);
+  }
+  bool ok = rc >= 0;
+  if (!ok && err_out) *err_out = lib.Error(("encode " + output).c_str(), rc);
+  while (ok) {
+    mpv_event* event = lib.mpv_wait_event(mpv, -1);
+    if (event->event_id == MPV_EVENT_SHUTDOWN) break;
+    if (event->event_id != MPV_EVENT_END_FILE) continue;
+    const auto* end = static_cast<const mpv_event_end_file*>(event->data);
+    if (end->reason == MPV_END_FILE_REASON_ERROR) {
+      ok = false;
+      if (err_out) *err_out = lib.Error(("encode " + output).c_str(), end->error);
+    }
+    break;
+  }
+  // Finishes the muxer (trailer, last HLS segment and playlist).
+  lib.mpv_terminate_destroy(mpv);
+  return ok;
+}
+
+bool GenerateTestMedia(const LibMpv& lib, const std::string& dir, const MediaSpec& spec, bool force,
+                       GeneratedMedia* out, std::string* err_out) {
+  std::error_code ec;
+  const fs::path root = fs::absolute(dir, ec);
+  fs::create_directories(root / "hls", ec);
+  if (ec) {
+    if (err_out) *err_out = "Cannot create " + (root / "hls").string() + ": " + ec.message();
+    return false;
+  }
+
+  const fs::path progressive = root / "media.mkv";
+  if (force || !fs::exists(progressive, ec)) {
+    if (!Encode(lib, spec, progressive.string(), "matroska", "", err_out)) return false;
+  }
+  out->progressive = "/media.mkv";
+
+  out->hls.clear();
+  if (spec.hls) {
+    const fs::path playlist = root / "hls" / "index.m3u8";
+    if (force || !fs::exists(playlist, ec)) {
+      for (const auto& entry : fs::directory_iterator(root / "hls", ec)) fs::remove(entry.path(), ec);
+      const std::string options = "hls_time=" + std::to_string(spec.keyframe_secs) +
+                                  ",hls_list_size=0,hls_playlist_type=vod,hls_segment_filename=" +
+                                  (root / "hls" / "seg%05d.ts").string();
+      if (!Encode(lib, spec, playlist.string(), "hls", options, err_out)) return false;
+    }
+    out->hls = "/hls/index.m3u8";
+  }
+  return true;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+#include "libmpv_loader.h"
+
+namespace mpv_native_texture {
+
+// Test media encoded by libmpv itself (encoding mode, --o) from lavfi
+// sources: testsrc2 video with a sine tone, so no sample files or ffmpeg
+// binary are needed. Keyframes every |keyframe_secs| keep seeks and HLS
+// segment boundaries predictable.
+struct MediaSpec {
+  int seconds = 60;
+  int width = 1280;
+  int height = 720;
+  int fps = 25;
+  int64_t video_bitrate = 3000000;
+  std::string video_codec = "libx264";
+  int keyframe_secs = 2;
+  bool hls = true;  // also write an HLS rendition (one segment per keyframe)
+};
+
+// Paths relative to the output directory, ready to append to a server URL.
+struct GeneratedMedia {
+  std::string progressive;  // "/media.mkv"
+  std::string hls;          // "/hls/index.m3u8", empty without HLS
+};
+
+// Writes the media into |dir| unless it is already there; |force| re-encodes.
+bool GenerateTestMedia(const LibMpv& lib, const std::string& dir, const MediaSpec& spec, bool force,
+                       GeneratedMedia* out, std::string* err_out);
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,265 @@
+#include "playback_probe.h"
+
+#include <algorithm>
+#include <atomic>
+#include <clocale>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+static constexpr uint64_t kPausedForCacheObserver = 1;
+
+namespace {
+
+// Render side: renders every frame mpv announces and stamps it.
+class FrameClock {
+ public:
+  FrameClock(const LibMpv& lib, mpv_render_context* render, int width, int height)
+      : lib_(lib), render_(render), width_(width), height_(height) {
+    pixels_.resize(static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4u);
+    lib_.mpv_render_context_set_update_callback(render_, &FrameClock::OnUpdate, this);
+    thread_ = std::thread([this] { Main(); });
+  }
+
+  ~FrameClock() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+    lib_.mpv_render_context_set_update_callback(render_, nullptr, nullptr);
+  }
+
+  uint64_t frames() const { return frames_.load(); }
+  SteadyClock::time_point last_frame() const {
+    return SteadyClock::time_point(SteadyClock::duration(last_frame_ticks_.load()));
+  }
+
+ private:
+  static void OnUpdate(void* ctx) {
+    auto* self = static_cast<FrameClock*>(ctx);
+    {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      self->update_pending_ = true;
+    }
+    self->cv_.notify_one();
+  }
+
+  void Main() {
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stopping_ || update_pending_; });
+        if (stopping_) return;
+        update_pending_ = false;
+      }
+      if (!(lib_.mpv_render_context_update(render_) & MPV_RENDER_UPDATE_FRAME)) continue;
+      int size[2] = {width_, height_};
+      char format[] = "rgb0";
+      size_t stride = static_cast<size_t>(width_) * 4u;
+      mpv_render_param params[] = {
+          {MPV_RENDER_PARAM_SW_SIZE, size},
+          {MPV_RENDER_PARAM_SW_FORMAT, format},
+          {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+          {MPV_RENDER_PARAM_SW_POINTER, pixels_.data()},
+          {MPV_RENDER_PARAM_INVALID, nullptr},
+      };
+      if (lib_.mpv_render_context_render(render_, params) < 0) continue;
+      // Stamp before counting, so a reader that sees the new count also sees
+      // this frame's time.
+      last_frame_ticks_.store(SteadyClock::now().time_since_epoch().count());
+      frames_.fetch_add(1);
+    }
+  }
+
+  const LibMpv& lib_;
+  mpv_render_context* const render_;
+  const int width_;
+  const int height_;
+  std::vector<uint8_t> pixels_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool update_pending_ = false;
+  bool stopping_ = false;
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<int64_t> last_frame_ticks_{0};
+  std::thread thread_;
+};
+
+}  // namespace
+
+PlaybackReport RunPlayback(const LibMpv& lib, const std::string& url, const PlaybackPlan& plan) {
+  PlaybackReport report;
+  std::setlocale(LC_NUMERIC, "C");
+  mpv_handle* mpv = lib.mpv_create();
+  if (!mpv) {
+    report.error = "mpv_create() failed";
+    return report;
+  }
+
+  // MpvPlayer's playback options, minus what needs a GPU or a sound card.
+  lib.mpv_set_option_string(mpv, "vo", "libmpv");
+  lib.mpv_set_option_string(mpv, "ao", "null");
+  lib.mpv_set_option_string(mpv, "hwdec", "no");
+  lib.mpv_set_option_string(mpv, "config", "no");
+  lib.mpv_set_option_string(mpv, "load-scripts", "no");
+  lib.mpv_set_option_string(mpv, "ytdl", "no");
+  lib.mpv_set_option_string(mpv, "terminal", "no");
+  lib.mpv_set_option_string(mpv, "osd-level", "0");
+  lib.mpv_set_option_string(mpv, "keep-open", "yes");
+  lib.mpv_set_option_string(mpv, "cache", "yes");
+
+  mpv_render_context* render = nullptr;
+  int rc = lib.mpv_initialize(mpv);
+  if (rc >= 0) {
+    const char* api_type = MPV_RENDER_API_TYPE_SW;
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(api_type)},
+        {MPV_RENDER_PARAM_INVALID, nullptr},
+    };
+    rc = lib.mpv_render_context_create(&render, mpv, params);
+    if (rc < 0) report.error = lib.Error("mpv_render_context_create(sw)", rc);
+  } else {
+    report.error = lib.Error("mpv_initialize", rc);
+  }
+  if (rc < 0) {
+    lib.mpv_terminate_destroy(mpv);
+    return report;
+  }
+
+  {
+    FrameClock clock(lib, render, std::max(16, plan.width), std::max(16, plan.height));
+    lib.mpv_observe_property(mpv, kPausedForCacheObserver, "paused-for-cache", MPV_FORMAT_FLAG);
+
+    // Phases, driven from this thread. The frame clock stamps frames
+    // exactly; events are polled often enough not to miss a phase change.
+    enum class Phase { kOpening, kPlaying, kSeeking, kSettling, kDone };
+    Phase phase = Phase::kOpening;
+    size_t next_seek = 0;
+    uint64_t frames_at_seek = 0;
+    bool seek_restarted = false;
+    bool buffering = false;
+    auto phase_started = SteadyClock::now();
+    SteadyClock::time_point buffering_since{};
+
+    const auto opened = SteadyClock::now();
+    const char* load[] = {"loadfile", url.c_str(), nullptr};
+    rc = lib.mpv_command(mpv, load);
+    if (rc < 0) {
+      report.error = lib.Error("loadfile", rc);
+      phase = Phase::kDone;
+    }
+
+    const auto start_seek = [&] {
+      char target[32] = {0};
+      std::snprintf(target, sizeof(target), "%0.3f", plan.seeks[next_seek]);
+      const char* cmd[] = {"seek", target, "absolute", nullptr};
+      seek_restarted = false;
+      phase_started = SteadyClock::now();
+      phase = Phase::kSeeking;
+      if (lib.mpv_command(mpv, cmd) < 0) {
+        report.seek_us.push_back(-1);
+        ++next_seek;
+        phase = Phase::kSettling;
+      }
+    };
+    const auto next_step = [&] {
+      phase_started = SteadyClock::now();
+      if (next_seek < plan.seeks.size()) {
+        start_seek();
+      } else {
+        report.ok = true;
+        phase = Phase::kDone;
+      }
+    };
+
+    while (phase != Phase::kDone) {
+      mpv_event* event = lib.mpv_wait_event(mpv, 0.005);
+      const auto now = SteadyClock::now();
+      if (event && event->event_id == MPV_EVENT_SHUTDOWN) {
+        report.error = "mpv shut down";
+        break;
+      }
+      if (event && event->event_id == MPV_EVENT_END_FILE) {
+        const auto* end = static_cast<const mpv_event_end_file*>(event->data);
+        if (end && end->reason == MPV_END_FILE_REASON_ERROR) {
+          report.error = lib.Error("Playback failed", end->error);
+          break;
+        }
+      }
+      if (event && event->event_id == MPV_EVENT_FILE_LOADED && report.file_loaded_us < 0) {
+        report.file_loaded_us = MicrosBetween(opened, now);
+      }
+      if (event && event->event_id == MPV_EVENT_PLAYBACK_RESTART && phase == Phase::kSeeking) {
+        // Frames still in flight from before the seek do not count.
+        seek_restarted = true;
+        frames_at_seek = clock.frames();
+      }
+      if (event && event->event_id == MPV_EVENT_PROPERTY_CHANGE && event->reply_userdata == kPausedForCacheObserver) {
+        const auto* prop = static_cast<const mpv_event_property*>(event->data);
+        const bool paused = prop->format == MPV_FORMAT_FLAG && *static_cast<const int*>(prop->data) != 0;
+        // Buffering after a seek is part of the seek latency.
+        const bool counts = phase == Phase::kPlaying || phase == Phase::kSettling;
+        if (paused && !buffering && counts) {
+          ++report.rebuffers;
+          buffering = true;
+          buffering_since = now;
+        } else if (!paused && buffering) {
+          report.rebuffer_us += MicrosBetween(buffering_since, now);
+          buffering = false;
+        }
+      }
+
+      const auto elapsed = now - phase_started;
+      switch (phase) {
+        case Phase::kOpening:
+          if (clock.frames() > 0) {
+            report.first_frame_us = MicrosBetween(opened, clock.last_frame());
+            phase = Phase::kPlaying;
+            phase_started = now;
+          } else if (elapsed > plan.timeout) {
+            report.error = "Timed out waiting for the first frame";
+            phase = Phase::kDone;
+          }
+          break;
+        case Phase::kPlaying:
+          if (elapsed >= std::chrono::duration<double>(plan.play_seconds)) next_step();
+          break;
+        case Phase::kSeeking:
+          // The first frame rendered after the seek's playback restart.
+          if (seek_restarted && clock.frames() > frames_at_seek) {
+            report.seek_us.push_back(MicrosBetween(phase_started, clock.last_frame()));
+            ++next_seek;
+            phase = Phase::kSettling;
+            phase_started = now;
+          } else if (elapsed > plan.timeout) {
+            report.seek_us.push_back(-1);
+            ++next_seek;
+            phase = Phase::kSettling;
+            phase_started = now;
+          }
+          break;
+        case Phase::kSettling:
+          if (elapsed >= std::chrono::duration<double>(plan.settle_seconds)) next_step();
+          break;
+        case Phase::kDone:
+          break;
+      }
+    }
+    if (buffering) report.rebuffer_us += MicrosBetween(buffering_since, SteadyClock::now());
+    report.frames = clock.frames();
+  }
+
+  lib.mpv_render_context_free(render);
+  lib.mpv_terminate_destroy(mpv);
+  return report;
+}
+
+}  // namespace mpv_native_texture
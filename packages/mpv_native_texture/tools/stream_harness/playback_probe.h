@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "libmpv_loader.h"
+
+namespace mpv_native_texture {
+
+// What one playback run does: open, play for |play_seconds| after the first
+// frame, then seek to each of |seeks| (absolute seconds) in turn, playing
+// |settle_seconds| after each landing.
+struct PlaybackPlan {
+  double play_seconds = 10.0;
+  std::vector<double> seeks;
+  double settle_seconds = 1.0;
+  std::chrono::milliseconds timeout{30000};  // per phase
+  // Software render target; small, as only frame timing matters.
+  int width = 320;
+  int height = 180;
+};
+
+// Microseconds on the steady clock; -1 when the phase never completed.
+struct PlaybackReport {
+  bool ok = false;
+  std::string error;
+  int64_t file_loaded_us = -1;  // loadfile -> FILE_LOADED
+  int64_t first_frame_us = -1;  // loadfile -> first frame rendered
+  int rebuffers = 0;            // paused-for-cache outside of seeks
+  int64_t rebuffer_us = 0;      // total time spent in them
+  std::vector<int64_t> seek_us;  // seek issued -> first frame after it
+  uint64_t frames = 0;
+};
+
+// Plays |url| the way MpvPlayer does (vo=libmpv and a render context driven
+// from its own thread), with the software renderer and no audio output, so
+// it runs on a machine without a GPU or sound card.
+PlaybackReport RunPlayback(const LibMpv& lib, const std::string& url, const PlaybackPlan& plan);
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,317 @@
+#include "throttled_http_server.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+static constexpr size_t kMaxRequestBytes = 16 * 1024;
+static constexpr int64_t kChunkBytes = 16 * 1024;
+
+static std::string Lower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return s;
+}
+
+static const char* ContentType(const std::string& path) {
+  const size_t dot = path.rfind('.');
+  const std::string ext = dot == std::string::npos ? "" : Lower(path.substr(dot + 1));
+  if (ext == "m3u8") return "application/vnd.apple.mpegurl";
+  if (ext == "ts") return "video/mp2t";
+  if (ext == "mkv") return "video/x-matroska";
+  if (ext == "mp4" || ext == "m4s") return "video/mp4";
+  return "application/octet-stream";
+}
+
+// Decodes %XX escapes and refuses anything that could leave the root.
+static bool SafePath(const std::string& target, std::string* out) {
+  std::string path;
+  for (size_t i = 0; i < target.size(); ++i) {
+    if (target[i] == '%' && i + 2 < target.size() && std::isxdigit(static_cast<unsigned char>(target[i + 1])) &&
+        std::isxdigit(static_cast<unsigned char>(target[i + 2]))) {
+      path += static_cast<char>(std::stoi(target.substr(i + 1, 2), nullptr, 16));
+      i += 2;
+    } else {
+      path += target[i];
+    }
+  }
+  if (path.empty() || path[0] != '/' || path.find('\0') != std::string::npos) return false;
+  if (path.find("/../") != std::string::npos || (path.size() >= 3 && path.compare(path.size() - 3, 3, "/..") == 0)) {
+    return false;
+  }
+  *out = path;
+  return true;
+}
+
+// "bytes=a-b", "bytes=a-" or "bytes=-n" against a file of |size| bytes.
+static bool ParseRange(const std::string& value, int64_t size, int64_t* begin, int64_t* end) {
+  const std::string v = Lower(value);
+  if (v.compare(0, 6, "bytes=") != 0 || v.find(',') != std::string::npos) return false;
+  const size_t dash = v.find('-', 6);
+  if (dash == std::string::npos) return false;
+  const std::string first = v.substr(6, dash - 6);
+  const std::string last = v.substr(dash + 1);
+  try {
+    if (first.empty()) {
+      if (last.empty()) return false;
+      *begin = std::max<int64_t>(0, size - std::stoll(last));
+      *end = size - 1;
+    } else {
+      *begin = std::stoll(first);
+      *end = last.empty() ? size - 1 : std::min<int64_t>(std::stoll(last), size - 1);
+    }
+  } catch (...) {
+    return false;
+  }
+  return *begin <= *end && *begin < size;
+}
+
+static bool SendAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+ThrottledHttpServer::ThrottledHttpServer(std::string root) : root_(std::move(root)) {}
+
+ThrottledHttpServer::~ThrottledHttpServer() { Stop(); }
+
+bool ThrottledHttpServer::Start(int port, std::string* err_out) {
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    if (err_out) *err_out = std::string("socket: ") + std::strerror(errno);
+    return false;
+  }
+  const int one = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  socklen_t len = sizeof(addr);
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, 64) < 0 ||
+      getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+    if (err_out) *err_out = std::string("bind/listen: ") + std::strerror(errno);
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+  port_ = ntohs(addr.sin_port);
+  stopping_.store(false);
+  accept_thread_ = std::thread([this] { AcceptMain(); });
+  return true;
+}
+
+void ThrottledHttpServer::Stop() {
+  if (listen_fd_ < 0) return;
+  stopping_.store(true);
+  shutdown(listen_fd_, SHUT_RDWR);
+  if (accept_thread_.joinable()) accept_thread_.join();
+  close(listen_fd_);
+  listen_fd_ = -1;
+
+  std::vector<std::thread> connections;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const int fd : open_fds_) shutdown(fd, SHUT_RDWR);
+    connections.swap(connections_);
+  }
+  for (auto& t : connections) t.join();
+}
+
+std::string ThrottledHttpServer::Url(const std::string& path) const {
+  return "http://127.0.0.1:" + std::to_string(port_) + (path.empty() || path[0] != '/' ? "/" : "") + path;
+}
+
+void ThrottledHttpServer::SetFaults(const Faults& faults) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  faults_ = faults;
+}
+
+ThrottledHttpServer::Faults ThrottledHttpServer::faults() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return faults_;
+}
+
+ThrottledHttpServer::Stats ThrottledHttpServer::TakeStats() const {
+  Stats stats;
+  stats.requests = requests_.load();
+  stats.bytes_sent = bytes_sent_.load();
+  stats.stalls = stalls_.load();
+  stats.cuts = cuts_.load();
+  return stats;
+}
+
+void ThrottledHttpServer::AcceptMain() {
+  while (!stopping_.load()) {
+    const int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      break;
+    }
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_.load()) {
+      close(fd);
+      break;
+    }
+    open_fds_.push_back(fd);
+    connections_.emplace_back([this, fd] { Serve(fd); });
+  }
+}
+
+void ThrottledHttpServer::Serve(int fd) {
+  std::string request;
+  char buf[4096];
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+    const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) break;
+    request.append(buf, static_cast<size_t>(n));
+  }
+
+  const auto respond = [&](const std::string& status, const std::string& headers) {
+    const std::string head = "HTTP/1.1 " + status + "\r\n" + headers + "Connection: close\r\n\r\n";
+    return SendAll(fd, head.data(), head.size());
+  };
+  const auto finish = [&] {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_fds_.erase(std::remove(open_fds_.begin(), open_fds_.end(), fd), open_fds_.end());
+    close(fd);
+  };
+
+  const size_t line_end = request.find("\r\n");
+  if (line_end == std::string::npos) {
+    finish();
+    return;
+  }
+  ++requests_;
+  const std::string line = request.substr(0, line_end);
+  const size_t sp1 = line.find(' ');
+  const size_t sp2 = line.find(' ', sp1 + 1);
+  const std::string method = line.substr(0, sp1);
+  std::string target = sp1 == std::string::npos ? "" : line.substr(sp1 + 1, sp2 - sp1 - 1);
+  target = target.substr(0, target.find('?'));
+  std::string range;
+  for (size_t pos = line_end + 2; pos < request.size();) {
+    const size_t end = request.find("\r\n", pos);
+    if (end == std::string::npos || end == pos) break;
+    const std::string header = request.substr(pos, end - pos);
+    const size_t colon = header.find(':');
+    const size_t value = colon == std::string::npos ? colon : header.find_first_not_of(' ', colon + 1);
+    if (value != std::string::npos && Lower(header.substr(0, colon)) == "range") range = header.substr(value);
+    pos = end + 2;
+  }
+
+  std::string path;
+  struct stat st {};
+  const int file = (method == "GET" || method == "HEAD") && SafePath(target, &path)
+                       ? open((root_ + path).c_str(), O_RDONLY)
+                       : -1;
+  if (file < 0 || fstat(file, &st) < 0 || !S_ISREG(st.st_mode)) {
+    if (file >= 0) close(file);
+    respond(method == "GET" || method == "HEAD" ? "404 Not Found" : "405 Method Not Allowed",
+            "Content-Length: 0\r\n");
+    finish();
+    return;
+  }
+
+  const int64_t size = static_cast<int64_t>(st.st_size);
+  int64_t begin = 0;
+  int64_t end = size - 1;
+  const bool partial = !range.empty();
+  if (partial && !ParseRange(range, size, &begin, &end)) {
+    respond("416 Range Not Satisfiable", "Content-Range: bytes */" + std::to_string(size) + "\r\nContent-Length: 0\r\n");
+    close(file);
+    finish();
+    return;
+  }
+
+  const Faults faults = this->faults();
+  if (faults.latency_ms > 0) {
+    const auto until = SteadyClock::now() + std::chrono::milliseconds(faults.latency_ms);
+    while (!stopping_.load() && SteadyClock::now() < until) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  std::string headers = std::string("Content-Type: ") + ContentType(path) + "\r\nAccept-Ranges: bytes\r\n" +
+                        "Content-Length: " + std::to_string(size > 0 ? end - begin + 1 : 0) + "\r\n";
+  if (partial) {
+    headers += "Content-Range: bytes " + std::to_string(begin) + "-" + std::to_string(end) + "/" +
+               std::to_string(size) + "\r\n";
+  }
+  if (respond(partial ? "206 Partial Content" : "200 OK", headers) && method == "GET" && size > 0) {
+    SendBody(fd, file, begin, end - begin + 1);
+  }
+  close(file);
+  finish();
+}
+
+bool ThrottledHttpServer::SendBody(int fd, int file, int64_t offset, int64_t size) {
+  std::vector<char> chunk(static_cast<size_t>(kChunkBytes));
+  int64_t sent = 0;
+  int64_t stalls_done = 0;
+  // Pacing restarts after every stall, so a stall is not made up for with
+  // a burst.
+  auto pace_from = SteadyClock::now();
+  int64_t pace_sent = 0;
+
+  const auto sleep_until = [this](SteadyClock::time_point until) {
+    while (!stopping_.load() && SteadyClock::now() < until) {
+      std::this_thread::sleep_for(std::min<SteadyClock::duration>(until - SteadyClock::now(),
+                                                                   std::chrono::milliseconds(20)));
+    }
+  };
+
+  while (sent < size && !stopping_.load()) {
+    const Faults f = faults();
+    int64_t want = std::min(kChunkBytes, size - sent);
+    if (f.cut_after_bytes > 0) {
+      if (sent >= f.cut_after_bytes) {
+        ++cuts_;
+        shutdown(fd, SHUT_RDWR);
+        return false;
+      }
+      want = std::min(want, f.cut_after_bytes - sent);
+    }
+    if (f.stall_every_bytes > 0) {
+      if (sent / f.stall_every_bytes > stalls_done) {
+        ++stalls_done;
+        ++stalls_;
+        sleep_until(SteadyClock::now() + std::chrono::milliseconds(f.stall_ms));
+        pace_from = SteadyClock::now();
+        pace_sent = sent;
+      }
+      want = std::min(want, (stalls_done + 1) * f.stall_every_bytes - sent);
+    }
+
+    const ssize_t n = pread(file, chunk.data(), static_cast<size_t>(want), offset + sent);
+    if (n <= 0 || !SendAll(fd, chunk.data(), static_cast<size_t>(n))) return false;
+    sent += n;
+    bytes_sent_ += static_cast<uint64_t>(n);
+
+    if (f.bytes_per_second > 0) {
+      sleep_until(pace_from + std::chrono::microseconds((sent - pace_sent) * 1000000 / f.bytes_per_second));
+    }
+  }
+  return sent == size;
+}
+
+}  // namespace mpv_native_texture
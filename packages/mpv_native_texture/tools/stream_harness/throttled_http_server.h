@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mpv_native_texture {
+
+// Minimal HTTP/1.1 file server on 127.0.0.1 that misbehaves on purpose.
+//
+// Serves GET and HEAD for files under |root| with single byte ranges (mpv
+// seeks with them), one request per connection. Faults apply to every
+// response body and can be changed while clients are connected:
+//
+//  - bytes_per_second paces each connection (0: unthrottled).
+//  - latency_ms delays the response headers, like a slow first byte.
+//  - Every stall_every_bytes sent on a connection, it stops for stall_ms.
+//  - After cut_after_bytes the connection is closed mid-body.
+//
+// One thread per connection; players open a handful at a time.
+class ThrottledHttpServer {
+ public:
+  struct Faults {
+    int64_t bytes_per_second = 0;
+    int latency_ms = 0;
+    int64_t stall_every_bytes = 0;
+    int stall_ms = 0;
+    int64_t cut_after_bytes = 0;
+  };
+
+  struct Stats {
+    uint64_t requests = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t stalls = 0;
+    uint64_t cuts = 0;
+  };
+
+  explicit ThrottledHttpServer(std::string root);
+  ~ThrottledHttpServer();
+
+  ThrottledHttpServer(const ThrottledHttpServer&) = delete;
+  ThrottledHttpServer& operator=(const ThrottledHttpServer&) = delete;
+
+  // |port| 0 picks a free one; see port().
+  bool Start(int port, std::string* err_out);
+  void Stop();
+  int port() const { return port_; }
+  // http://127.0.0.1:<port>/<path>
+  std::string Url(const std::string& path) const;
+
+  void SetFaults(const Faults& faults);
+  Faults faults() const;
+  Stats TakeStats() const;
+
+ private:
+  void AcceptMain();
+  void Serve(int fd);
+  // Sends |size| bytes of |file| from |offset| under the current faults.
+  // False when the client went away or the connection was cut.
+  bool SendBody(int fd, int file, int64_t offset, int64_t size);
+
+  const std::string root_;
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::atomic<bool> stopping_{false};
+  std::thread accept_thread_;
+
+  mutable std::mutex mutex_;
+  Faults faults_;
+  std::vector<std::thread> connections_;
+  std::vector<int> open_fds_;
+
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<uint64_t> bytes_sent_{0};
+  std::atomic<uint64_t> stalls_{0};
+  std::atomic<uint64_t> cuts_{0};
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,15 @@
+#pragma once
+
+// The one type frame_transport.h takes from the Flutter embedder header,
+// laid out as in flutter_texture_registrar.h.
+
+#include <cstddef>
+#include <cstdint>
+
+typedef struct {
+  const uint8_t* buffer;
+  size_t width;
+  size_t height;
+  void (*release_callback)(void* release_context);
+  void* release_context;
+} FlutterDesktopPixelBuffer;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <flutter_texture_registrar.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpv_native_texture {
+
+// Stand-in for flutter::TextureRegistrar with a raster thread of its own.
+// MarkTextureFrameAvailable() wakes the thread, which calls the texture's
+// copy callback (PixelBufferTexture's CopyPixelBuffer) and then copies the
+// returned buffer the way the engine's upload does. Marks that arrive while
+// a copy is pending coalesce, as they do in the engine.
+class FakeTextureRegistrar {
+ public:
+  using CopyCallback = std::function<const FlutterDesktopPixelBuffer*(size_t width, size_t height)>;
+
+  FakeTextureRegistrar() : thread_([this] { RasterMain(); }) {}
+
+  ~FakeTextureRegistrar() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  FakeTextureRegistrar(const FakeTextureRegistrar&) = delete;
+  FakeTextureRegistrar& operator=(const FakeTextureRegistrar&) = delete;
+
+  // One texture at a time is all the benchmarks need.
+  int64_t RegisterTexture(CopyCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+    return 1;
+  }
+
+  void UnregisterTexture(int64_t) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = nullptr;
+    pending_ = false;
+  }
+
+  bool MarkTextureFrameAvailable(int64_t) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!callback_) return false;
+      pending_ = true;
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  // Frames the raster thread has copied out.
+  uint64_t frames_uploaded() const { return uploaded_.load(std::memory_order_relaxed); }
+
+ private:
+  void RasterMain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return pending_ || !running_; });
+      if (!running_) return;
+      pending_ = false;
+      CopyCallback callback = callback_;
+      lock.unlock();
+      const FlutterDesktopPixelBuffer* buffer = callback ? callback(0, 0) : nullptr;
+      if (buffer && buffer->buffer) {
+        const size_t bytes = buffer->width * buffer->height * 4u;
+        if (upload_.size() < bytes) upload_.resize(bytes);
+        std::memcpy(upload_.data(), buffer->buffer, bytes);
+        uploaded_.fetch_add(1, std::memory_order_relaxed);
+      }
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool running_ = true;
+  bool pending_ = false;
+  CopyCallback callback_;
+  std::vector<uint8_t> upload_;  // raster thread
+  std::atomic<uint64_t> uploaded_{0};
+  std::thread thread_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,139 @@
+// Microbenchmarks for the frame hand-off between MpvPlayer's render thread
+// and Flutter's raster thread (FrameTransport) and the per-frame pixel work
+// around it, at the resolutions the player commonly renders.
+//
+//   frame_transport_benchmark --benchmark_filter=Publish
+//
+// bytes_per_second is frame bytes moved; compare runs with
+// --benchmark_out=FILE --benchmark_out_format=json and compare.py.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "fake_texture_registrar.h"
+#include "frame_transport.h"
+#include "pipeline_stats.h"
+#include "rgba_util.h"
+
+namespace mpv_native_texture {
+namespace {
+
+// 720p, 1080p, 1440p, 4K.
+void Resolutions(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"w", "h"});
+  b->Args({1280, 720});
+  b->Args({1920, 1080});
+  b->Args({2560, 1440});
+  b->Args({3840, 2160});
+}
+
+size_t FrameBytes(const benchmark::State& state) {
+  return static_cast<size_t>(state.range(0)) * static_cast<size_t>(state.range(1)) * 4u;
+}
+
+// The swap alone: lock, pointer exchange, stats.
+void BM_Publish(benchmark::State& state) {
+  PipelineStats stats;
+  FrameTransport transport(&stats, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(transport.Publish());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Publish)->Apply(Resolutions);
+
+// Publish + MarkTextureFrameAvailable with a raster thread taking frames
+// through CopyPixelBuffer and copying them out, as the engine does.
+void BM_PublishWithRasterThread(benchmark::State& state) {
+  PipelineStats stats;
+  FrameTransport transport(&stats, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  FakeTextureRegistrar registrar;
+  const int64_t id = registrar.RegisterTexture([&transport](size_t, size_t) {
+    SteadyClock::time_point consumed_at;
+    return transport.Acquire(&consumed_at);
+  });
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(transport.Publish());
+    registrar.MarkTextureFrameAvailable(id);
+  }
+  registrar.UnregisterTexture(id);
+  const PipelineStats::Counters counters = stats.counters();
+  state.counters["consumed"] = static_cast<double>(counters.frames_consumed);
+  state.counters["dropped"] = static_cast<double>(counters.frames_dropped);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PublishWithRasterThread)->Apply(Resolutions)->UseRealTime();
+
+// CopyPixelBuffer's side while the render thread publishes back to back:
+// the lock hold time the raster thread sees under contention.
+void BM_AcquireContended(benchmark::State& state) {
+  PipelineStats stats;
+  FrameTransport transport(&stats, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  std::atomic<bool> running{true};
+  std::thread render([&] {
+    while (running.load(std::memory_order_relaxed)) transport.Publish();
+  });
+  for (auto _ : state) {
+    SteadyClock::time_point consumed_at;
+    benchmark::DoNotOptimize(transport.Acquire(&consumed_at));
+  }
+  running.store(false);
+  render.join();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AcquireContended)->Apply(Resolutions)->UseRealTime();
+
+// Both buffers reallocated and cleared, as on every video size change.
+void BM_Resize(benchmark::State& state) {
+  PipelineStats stats;
+  FrameTransport transport(&stats, 16, 16);
+  const int w = static_cast<int>(state.range(0));
+  const int h = static_cast<int>(state.range(1));
+  bool full = false;
+  for (auto _ : state) {
+    full = !full;
+    transport.Resize(full ? w : w / 2, full ? h : h / 2);
+    benchmark::DoNotOptimize(transport.back());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Resize)->Apply(Resolutions);
+
+// A finished readback landing in the back buffer (glReadPixels' CPU side)
+// followed by the publish: the per-frame cost after the GPU is done.
+void BM_ReadbackToPublish(benchmark::State& state) {
+  PipelineStats stats;
+  FrameTransport transport(&stats, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  const size_t bytes = FrameBytes(state);
+  std::vector<uint8_t> readback(bytes, 0x80);
+  for (auto _ : state) {
+    std::memcpy(transport.back(), readback.data(), bytes);
+    benchmark::DoNotOptimize(transport.Publish());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ReadbackToPublish)->Apply(Resolutions);
+
+// BGR0 -> RGBA, the screenshot and SW-render conversion.
+void BM_SwizzleBgraToRgba(benchmark::State& state) {
+  const int w = static_cast<int>(state.range(0));
+  const int h = static_cast<int>(state.range(1));
+  const size_t bytes = FrameBytes(state);
+  std::vector<uint8_t> src(bytes, 0x40);
+  std::vector<uint8_t> dst(bytes);
+  for (auto _ : state) {
+    PackedToRgba(src.data(), static_cast<size_t>(w) * 4u, w, h, true, dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_SwizzleBgraToRgba)->Apply(Resolutions);
+
+}  // namespace
+}  // namespace mpv_native_texture
+
+BENCHMARK_MAIN();
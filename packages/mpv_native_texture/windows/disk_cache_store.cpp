@@ -0,0 +1,202 @@
+#include "disk_cache_store.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <system_error>
+#include <vector>
+
+#include "logger.h"
+
+namespace mpv_native_texture {
+
+namespace fs = std::filesystem;
+
+// dump-cache picks the container from the extension; Matroska takes any
+// codec mpv can demux.
+static constexpr const char* kEntryExtension = ".mkv";
+static constexpr const char* kPartExtension = ".part.mkv";
+
+static uint64_t HashUrl(const std::string& url) {
+  uint64_t h = 14695981039346656037ull;
+  for (const unsigned char c : url) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static std::string KeyName(uint64_t key) {
+  char buf[17] = {0};
+  std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(key));
+  return buf;
+}
+
+static bool ParseKeyName(const std::string& name, uint64_t* key) {
+  if (name.size() != 16 || name.find_first_not_of("0123456789abcdef") != std::string::npos) return false;
+  *key = std::stoull(name, nullptr, 16);
+  return true;
+}
+
+static DiskCacheStore::Options Resolved(DiskCacheStore::Options options) {
+  if (options.directory.empty()) {
+    std::error_code ec;
+    options.directory = (fs::temp_directory_path(ec) / "mpv_native_texture_media").u8string();
+  }
+  options.max_file_bytes = std::min(options.max_file_bytes, options.max_bytes);
+  return options;
+}
+
+DiskCacheStore::DiskCacheStore(const Options& options)
+    : options_(Resolved(options)), dir_(fs::u8path(options_.directory)) {
+  std::error_code ec;
+  fs::create_directories(dir_ / "session", ec);
+
+  const std::string entry_ext = kEntryExtension;
+  for (fs::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec)) {
+    if (!it->is_regular_file(ec)) continue;
+    const std::string name = it->path().filename().u8string();
+    uint64_t key = 0;
+    if (name.size() > entry_ext.size() && name.compare(name.size() - entry_ext.size(), entry_ext.size(), entry_ext) == 0 &&
+        ParseKeyName(name.substr(0, name.size() - entry_ext.size()), &key)) {
+      Entry entry;
+      entry.path = it->path();
+      entry.bytes = it->file_size(ec);
+      entry.last_used = it->last_write_time(ec);
+      total_bytes_ += entry.bytes;
+      entries_[key] = std::move(entry);
+    } else if (name.find(".part.") != std::string::npos) {
+      std::error_code rm_ec;
+      fs::remove(it->path(), rm_ec);
+    }
+  }
+  // Left over by a crashed session; mpv recreates what it needs.
+  for (fs::directory_iterator it(dir_ / "session", ec), end; !ec && it != end; it.increment(ec)) {
+    std::error_code rm_ec;
+    fs::remove(it->path(), rm_ec);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  EvictLocked();
+}
+
+std::string DiskCacheStore::session_dir() const { return (dir_ / "session").u8string(); }
+
+bool DiskCacheStore::IsRemote(const std::string& url) {
+  static const char* const kSchemes[] = {"http://", "https://", "ftp://", "ftps://", "sftp://", "smb://", "dav://",
+                                         "davs://"};
+  for (const char* scheme : kSchemes) {
+    const size_t n = std::char_traits<char>::length(scheme);
+    if (url.size() > n && std::equal(scheme, scheme + n, url.begin(), [](char a, char b) {
+          return a == static_cast<char>(std::tolower(static_cast<unsigned char>(b)));
+        })) {
+      return true;
+    }
+  }
+  return false;
+}
+
+fs::path DiskCacheStore::EntryPath(uint64_t key) const { return dir_ / (KeyName(key) + kEntryExtension); }
+
+fs::path DiskCacheStore::PartPath(uint64_t key) const { return dir_ / (KeyName(key) + kPartExtension); }
+
+std::string DiskCacheStore::Lookup(const std::string& url) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = entries_.find(HashUrl(url));
+  std::error_code ec;
+  if (it == entries_.end() || !fs::is_regular_file(it->second.path, ec)) {
+    if (it != entries_.end()) {
+      total_bytes_ -= it->second.bytes;
+      entries_.erase(it);
+    }
+    ++stats_.misses;
+    return {};
+  }
+  ++stats_.hits;
+  stats_.bytes_saved += it->second.bytes;
+  it->second.last_used = fs::file_time_type::clock::now();
+  fs::last_write_time(it->second.path, it->second.last_used, ec);
+  return it->second.path.u8string();
+}
+
+std::string DiskCacheStore::BeginStore(const std::string& url) {
+  const uint64_t key = HashUrl(url);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.count(key) || !storing_.insert(key).second) return {};
+  return PartPath(key).u8string();
+}
+
+void DiskCacheStore::FinishStore(const std::string& url, bool ok) {
+  const uint64_t key = HashUrl(url);
+  const fs::path part = PartPath(key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!storing_.erase(key)) return;
+
+  std::error_code ec;
+  const uint64_t bytes = ok ? fs::file_size(part, ec) : 0;
+  if (!ok || ec || bytes == 0 || bytes > options_.max_file_bytes) {
+    ++stats_.store_failures;
+    fs::remove(part, ec);
+    return;
+  }
+  const fs::path path = EntryPath(key);
+  fs::rename(part, path, ec);
+  if (ec) {
+    Logger::Instance().Write("[DiskCacheStore] Cannot commit " + path.u8string() + ": " + ec.message() + "\n");
+    ++stats_.store_failures;
+    fs::remove(part, ec);
+    return;
+  }
+
+  Entry entry;
+  entry.path = path;
+  entry.bytes = bytes;
+  entry.last_used = fs::file_time_type::clock::now();
+  total_bytes_ += bytes;
+  entries_[key] = std::move(entry);
+  stats_.bytes_stored += bytes;
+  EvictLocked();
+}
+
+void DiskCacheStore::EvictLocked() {
+  if (total_bytes_ <= options_.max_bytes) return;
+  std::vector<std::pair<fs::file_time_type, uint64_t>> order;
+  order.reserve(entries_.size());
+  for (const auto& [key, entry] : entries_) order.emplace_back(entry.last_used, key);
+  std::sort(order.begin(), order.end());
+
+  for (const auto& [last_used, key] : order) {
+    if (total_bytes_ <= options_.max_bytes) break;
+    const auto it = entries_.find(key);
+    std::error_code ec;
+    // A file a player is reading cannot be deleted on Windows; it goes on a
+    // later pass.
+    if (!fs::remove(it->second.path, ec) && fs::exists(it->second.path, ec)) continue;
+    total_bytes_ -= it->second.bytes;
+    entries_.erase(it);
+    ++stats_.evictions;
+  }
+}
+
+void DiskCacheStore::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    std::error_code ec;
+    if (!fs::remove(it->second.path, ec) && fs::exists(it->second.path, ec)) {
+      ++it;
+      continue;
+    }
+    total_bytes_ -= it->second.bytes;
+    it = entries_.erase(it);
+  }
+}
+
+DiskCacheStore::Stats DiskCacheStore::TakeStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.entries = entries_.size();
+  stats.total_bytes = total_bytes_;
+  return stats;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace mpv_native_texture {
+
+// Persistent cache of remote media files, shared by all players.
+//
+// A player streaming a remote URL keeps the whole file in mpv's demuxer
+// cache (spilled to |directory|\session by cache-on-disk). Once the demuxer
+// has read to the end and one seekable range covers the file, the player
+// writes it out with dump-cache and hands it to Commit(). Opening the URL
+// again is redirected to that file, so it plays without any network access.
+//
+// Entries are files named after a hash of the URL. The files' mtimes double
+// as the LRU order, which keeps the order across sessions; a hit refreshes
+// the mtime. Committing evicts the least recently used entries until the
+// total fits |max_bytes|. Thread safe.
+class DiskCacheStore {
+ public:
+  struct Options {
+    std::string directory;                   // empty: %TEMP%\mpv_native_texture_media
+    uint64_t max_bytes = 4ull << 30;         // all entries together
+    uint64_t max_file_bytes = 1ull << 30;    // larger files are streamed only
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t bytes_saved = 0;   // sizes of the entries served by hits
+    uint64_t bytes_stored = 0;  // committed this session
+    uint64_t evictions = 0;
+    uint64_t store_failures = 0;
+    size_t entries = 0;
+    uint64_t total_bytes = 0;
+  };
+
+  // Scans |options.directory| (created if missing) and drops leftovers of
+  // interrupted stores.
+  explicit DiskCacheStore(const Options& options);
+
+  DiskCacheStore(const DiskCacheStore&) = delete;
+  DiskCacheStore& operator=(const DiskCacheStore&) = delete;
+
+  const Options& options() const { return options_; }
+  // cache-dir for the players' live demuxer caches.
+  std::string session_dir() const;
+
+  // http(s), ftp and similar sources; local files and lavfi are never cached.
+  static bool IsRemote(const std::string& url);
+
+  // Path of the cached copy of |url|, or empty. Counts a hit or a miss.
+  std::string Lookup(const std::string& url);
+
+  // Returns the path to dump |url| to, or empty when it is cached already
+  // or another player is storing it.
+  std::string BeginStore(const std::string& url);
+  // Ends a BeginStore. On success the file becomes the entry for |url|;
+  // otherwise it is deleted.
+  void FinishStore(const std::string& url, bool ok);
+
+  // Deletes every entry not being stored right now.
+  void Clear();
+
+  Stats TakeStats();
+
+ private:
+  struct Entry {
+    std::filesystem::path path;
+    uint64_t bytes = 0;
+    std::filesystem::file_time_type last_used{};
+  };
+
+  std::filesystem::path EntryPath(uint64_t key) const;
+  std::filesystem::path PartPath(uint64_t key) const;
+  // Evicts LRU entries until the total fits max_bytes. mutex_ held.
+  void EvictLocked();
+
+  const Options options_;
+  const std::filesystem::path dir_;
+
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, Entry> entries_;
+  std::set<uint64_t> storing_;
+  uint64_t total_bytes_ = 0;
+  Stats stats_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,126 @@
+#include "frame_capturer.h"
+
+#include <objbase.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "trace.h"
+
+namespace mpv_native_texture {
+
+FrameCapturer::FrameCapturer() : worker_(&FrameCapturer::WorkerMain, this) {}
+
+FrameCapturer::~FrameCapturer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  if (worker_.joinable()) worker_.join();
+}
+
+void FrameCapturer::Submit(const Request& request, Source source, Done done) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(Job{request, std::move(source), std::move(done), SteadyClock::now()});
+  }
+  cv_.notify_one();
+}
+
+FrameCapturer::Snapshot FrameCapturer::TakeSnapshot() const {
+  Snapshot snap;
+  snap.source = source_hist_.Summarize();
+  snap.encode = encode_hist_.Summarize();
+  snap.total = total_hist_.Summarize();
+  snap.captured = captured_.load(std::memory_order_relaxed);
+  snap.failed = failed_.load(std::memory_order_relaxed);
+  return snap;
+}
+
+void FrameCapturer::WorkerMain() {
+  trace::SetThreadName("FrameCapture");
+  const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  ImageEncoder encoder;
+
+  for (;;) {
+    Job job;
+    bool stopping = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+      if (jobs_.empty()) break;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      stopping = stopping_;
+    }
+
+    Result result;
+    if (stopping) {
+      result.error = "Player disposed";
+    } else {
+      MPV_TRACE_SCOPE("capture", "captureFrame");
+      result = Run(job, &encoder);
+    }
+    if (result.ok) {
+      captured_.fetch_add(1, std::memory_order_relaxed);
+      total_hist_.Record(result.total_us);
+    } else {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (job.done) job.done(std::move(result));
+  }
+
+  if (SUCCEEDED(com)) CoUninitialize();
+}
+
+FrameCapturer::Result FrameCapturer::Run(Job& job, ImageEncoder* encoder) {
+  Result result;
+  result.format = job.request.format;
+
+  auto start = SteadyClock::now();
+  RgbaImage image;
+  if (!job.source(&image, &result.error)) return result;
+  result.source_us = MicrosBetween(start, SteadyClock::now());
+  source_hist_.Record(result.source_us);
+
+  // Resolve the output size, keeping the aspect ratio for a single side.
+  int w = job.request.width;
+  int h = job.request.height;
+  if (w <= 0 && h <= 0) {
+    w = image.width;
+    h = image.height;
+  } else if (w <= 0) {
+    w = static_cast<int>(std::lround(static_cast<double>(h) * image.width / image.height));
+  } else if (h <= 0) {
+    h = static_cast<int>(std::lround(static_cast<double>(w) * image.height / image.width));
+  }
+  result.width = std::max(1, w);
+  result.height = std::max(1, h);
+
+  start = SteadyClock::now();
+  if (!encoder->Encode(image, result.width, result.height, job.request.format, job.request.jpeg_quality,
+                       &result.bytes, &result.error)) {
+    return result;
+  }
+  if (!job.request.path.empty()) {
+    std::ofstream out(job.request.path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(result.bytes.data()), static_cast<std::streamsize>(result.bytes.size()));
+    if (!out) {
+      result.error = "Cannot write " + job.request.path;
+      return result;
+    }
+    result.path = job.request.path;
+    result.bytes.clear();
+  }
+  const auto end = SteadyClock::now();
+  result.encode_us = MicrosBetween(start, end);
+  encode_hist_.Record(result.encode_us);
+
+  result.total_us = MicrosBetween(job.submitted_at, end);
+  result.ok = true;
+  return result;
+}
+
+}  // namespace mpv_native_texture
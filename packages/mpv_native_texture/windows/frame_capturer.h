@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "image_encoder.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Encodes frame grabs on a dedicated worker thread.
+//
+// The caller only supplies a Source that produces the RGBA pixels; the source
+// itself, scaling, encoding and the optional file write all run on the worker,
+// so neither the platform thread nor the render thread waits on them.
+class FrameCapturer {
+ public:
+  struct Request {
+    ImageFormat format = ImageFormat::kPng;
+    // Output size; 0 keeps the source size, or the aspect ratio when only one
+    // side is given.
+    int width = 0;
+    int height = 0;
+    int jpeg_quality = 90;
+    // When set, the encoded image is written here instead of returned.
+    std::string path;
+  };
+
+  struct Result {
+    bool ok = false;
+    std::string error;
+    int width = 0;
+    int height = 0;
+    ImageFormat format = ImageFormat::kPng;
+    std::vector<uint8_t> bytes;  // empty when written to |path|
+    std::string path;
+    int64_t source_us = 0;  // producing the pixels (copy or screenshot-raw)
+    int64_t encode_us = 0;  // scaling + encoding + file write
+    int64_t total_us = 0;   // Submit -> done, including queueing
+  };
+
+  // Runs on the worker thread.
+  using Source = std::function<bool(RgbaImage* image, std::string* err_out)>;
+  // Runs on the worker thread.
+  using Done = std::function<void(Result result)>;
+
+  struct Snapshot {
+    LatencyHistogram::Summary source;
+    LatencyHistogram::Summary encode;
+    LatencyHistogram::Summary total;
+    uint64_t captured = 0;
+    uint64_t failed = 0;
+  };
+
+  FrameCapturer();
+  // Fails queued captures with "Player disposed" and joins the worker.
+  ~FrameCapturer();
+
+  FrameCapturer(const FrameCapturer&) = delete;
+  FrameCapturer& operator=(const FrameCapturer&) = delete;
+
+  void Submit(const Request& request, Source source, Done done);
+  Snapshot TakeSnapshot() const;
+
+ private:
+  struct Job {
+    Request request;
+    Source source;
+    Done done;
+    SteadyClock::time_point submitted_at;
+  };
+
+  void WorkerMain();
+  Result Run(Job& job, ImageEncoder* encoder);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Job> jobs_;
+  bool stopping_ = false;
+  std::thread worker_;
+
+  LatencyHistogram source_hist_;
+  LatencyHistogram encode_hist_;
+  LatencyHistogram total_hist_;
+  std::atomic<uint64_t> captured_{0};
+  std::atomic<uint64_t> failed_{0};
+};
+
+}  // namespace mpv_native_texture
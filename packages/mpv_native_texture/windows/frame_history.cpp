@@ -0,0 +1,114 @@
+#include "frame_history.h"
+
+#include <algorithm>
+
+#include "rgba_util.h"
+
+namespace mpv_native_texture {
+
+void FrameHistory::Configure(bool enabled, const Config& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_ = config;
+  config_.downscale = config.downscale >= 4 ? 4 : (config.downscale >= 2 ? 2 : 1);
+  frames_.clear();
+  bytes_ = 0;
+  cursor_ = 0;
+  browsing_.store(false);
+  enabled_.store(enabled);
+}
+
+void FrameHistory::Push(const uint8_t* rgba, int width, int height) {
+  if (!enabled_.load() || browsing_.load() || !rgba || width <= 0 || height <= 0) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // StepBack() may have started browsing since the unlocked check; pushing
+  // now would shift the frames under its cursor.
+  if (!enabled_.load() || browsing_.load()) return;
+  const int w = std::max(1, width / config_.downscale);
+  const int h = std::max(1, height / config_.downscale);
+  const size_t size = static_cast<size_t>(w) * static_cast<size_t>(h) * 4u;
+  if (size > config_.max_bytes) return;
+
+  // Reuse the evicted frame's buffer for the new one.
+  Frame frame;
+  while (!frames_.empty() && bytes_ + size > config_.max_bytes) {
+    bytes_ -= frames_.front().pixels.size();
+    frame = std::move(frames_.front());
+    frames_.pop_front();
+  }
+  frame.pixels.resize(size);
+  ResampleRgbaNearest(rgba, width, height, frame.pixels.data(), w, h);
+  frame.width = w;
+  frame.height = h;
+  frame.pts.reset();
+  bytes_ += size;
+  frames_.push_back(std::move(frame));
+}
+
+void FrameHistory::AssignPts(double pts) {
+  if (!enabled_.load()) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!frames_.empty() && !frames_.back().pts) frames_.back().pts = pts;
+}
+
+void FrameHistory::CopyOut(size_t index, Frame* out) const {
+  const Frame& f = frames_[index];
+  out->pixels = f.pixels;
+  out->width = f.width;
+  out->height = f.height;
+  out->pts = f.pts;
+}
+
+bool FrameHistory::StepBack(Frame* out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The newest entry is the live frame itself; step back from there.
+  const size_t from = browsing_.load() ? cursor_ : (frames_.empty() ? 0 : frames_.size() - 1);
+  if (!enabled_.load() || frames_.empty() || from == 0) {
+    ++misses_;
+    return false;
+  }
+  cursor_ = from - 1;
+  browsing_.store(true);
+  ++hits_;
+  CopyOut(cursor_, out);
+  return true;
+}
+
+bool FrameHistory::StepForward(Frame* out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!browsing_.load()) return false;
+  ++cursor_;
+  ++hits_;
+  CopyOut(cursor_, out);
+  if (cursor_ + 1 >= frames_.size()) browsing_.store(false);  // back at live
+  return true;
+}
+
+std::optional<double> FrameHistory::StopBrowsing() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!browsing_.exchange(false)) return std::nullopt;
+  return frames_[cursor_].pts;
+}
+
+void FrameHistory::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  frames_.clear();
+  bytes_ = 0;
+  cursor_ = 0;
+  browsing_.store(false);
+}
+
+FrameHistory::Snapshot FrameHistory::TakeSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snap;
+  snap.enabled = enabled_.load();
+  snap.frames = frames_.size();
+  snap.bytes = bytes_;
+  snap.max_bytes = config_.max_bytes;
+  snap.position = browsing_.load() ? static_cast<int>(frames_.size() - 1 - cursor_) : 0;
+  snap.hits = hits_;
+  snap.misses = misses_;
+  return snap;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace mpv_native_texture {
+
+// Ring of recently rendered frames for frame-accurate review.
+//
+// The render thread pushes every new video frame (not redraws), optionally
+// downscaled, while the total stays under a byte cap. Stepping back walks a
+// cursor into that history so the frame can be shown immediately instead of
+// mpv decoding forward from the previous keyframe; stepping forward walks it
+// back towards the live frame. Frame timestamps come from mpv's time-pos,
+// which is reported shortly after the frame was rendered (AssignPts).
+class FrameHistory {
+ public:
+  struct Config {
+    size_t max_bytes = 256u * 1024u * 1024u;
+    int downscale = 1;  // 1, 2 or 4: stored at 1/downscale per axis
+  };
+
+  struct Frame {
+    std::vector<uint8_t> pixels;  // RGBA
+    int width = 0;
+    int height = 0;
+    std::optional<double> pts;
+  };
+
+  struct Snapshot {
+    bool enabled = false;
+    size_t frames = 0;
+    size_t bytes = 0;
+    size_t max_bytes = 0;
+    int position = 0;  // frames behind live while browsing, else 0
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  // Clears the history.
+  void Configure(bool enabled, const Config& config);
+  bool enabled() const { return enabled_.load(); }
+
+  // Render thread. Ignored while browsing.
+  void Push(const uint8_t* rgba, int width, int height);
+  // Event thread: timestamps the newest frame that has none yet.
+  void AssignPts(double pts);
+
+  // Control thread. Copies the frame to show into |out| and returns true on a
+  // cache hit. StepBack misses at the oldest frame; StepForward "misses" when
+  // already live, meaning mpv has to decode the next frame.
+  bool StepBack(Frame* out);
+  bool StepForward(Frame* out);
+
+  // True while a cached (older than live) frame is shown.
+  bool browsing() const { return browsing_.load(); }
+  // Returns to live; yields the pts of the frame that was shown, if browsing,
+  // so the caller can resync mpv to it.
+  std::optional<double> StopBrowsing();
+  void Clear();
+
+  Snapshot TakeSnapshot() const;
+
+ private:
+  void CopyOut(size_t index, Frame* out) const;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> browsing_{false};
+
+  mutable std::mutex mutex_;
+  Config config_;
+  std::deque<Frame> frames_;  // oldest first
+  size_t bytes_ = 0;
+  size_t cursor_ = 0;  // index shown while browsing
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace mpv_native_texture
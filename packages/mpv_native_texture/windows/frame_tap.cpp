@@ -0,0 +1,169 @@
+#include "frame_tap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "rgba_util.h"
+
+namespace mpv_native_texture {
+
+namespace {
+
+std::mutex g_registry_mutex;
+std::map<uint64_t, std::shared_ptr<FrameTap>> g_registry;
+uint64_t g_next_id = 1;
+
+}  // namespace
+
+std::shared_ptr<FrameTap> FrameTap::Create(const Config& config) {
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  auto tap = std::make_shared<FrameTap>(g_next_id++, config);
+  g_registry[tap->id()] = tap;
+  return tap;
+}
+
+std::shared_ptr<FrameTap> FrameTap::Find(uint64_t id) {
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  auto it = g_registry.find(id);
+  return it == g_registry.end() ? nullptr : it->second;
+}
+
+FrameTap::FrameTap(uint64_t id, const Config& config)
+    : id_(id), config_(config), slots_(static_cast<size_t>(std::max(2, std::min(config.slots, 16)))) {}
+
+uint64_t FrameTap::Offer(const uint8_t* rgba, int width, int height) {
+  if (!rgba || width <= 0 || height <= 0) return 0;
+  const auto now = SteadyClock::now();
+
+  int out_w = config_.width;
+  int out_h = config_.height;
+  if (out_w <= 0 && out_h <= 0) {
+    out_w = width;
+    out_h = height;
+  } else if (out_w <= 0) {
+    out_w = static_cast<int>(std::lround(static_cast<double>(out_h) * width / height));
+  } else if (out_h <= 0) {
+    out_h = static_cast<int>(std::lround(static_cast<double>(out_w) * height / width));
+  }
+  out_w = std::max(1, std::min(out_w, width));
+  out_h = std::max(1, std::min(out_h, height));
+
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return 0;
+    if (config_.max_fps > 0 && now - last_offer_ < std::chrono::microseconds(1000000 / config_.max_fps)) return 0;
+
+    // Prefer a free slot; otherwise replace the oldest frame nobody took.
+    Slot* oldest_ready = nullptr;
+    for (Slot& s : slots_) {
+      if (s.state == SlotState::kFree) {
+        slot = &s;
+        break;
+      }
+      if (s.state == SlotState::kReady && (!oldest_ready || s.frame.sequence < oldest_ready->frame.sequence)) {
+        oldest_ready = &s;
+      }
+    }
+    if (!slot && oldest_ready) {
+      slot = oldest_ready;
+      ++overwritten_;
+    }
+    if (!slot) {
+      ++skipped_;
+      return 0;
+    }
+    slot->state = SlotState::kWriting;
+    last_offer_ = now;
+  }
+
+  // The slot is exclusively ours while kWriting.
+  slot->pixels.resize(static_cast<size_t>(out_w) * static_cast<size_t>(out_h) * 4u);
+  ResampleRgbaNearest(rgba, width, height, slot->pixels.data(), out_w, out_h);
+  const auto copied = SteadyClock::now();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  copy_hist_.Record(MicrosBetween(now, copied));
+  slot->frame.pixels = slot->pixels.data();
+  slot->frame.width = out_w;
+  slot->frame.height = out_h;
+  slot->frame.stride = out_w * 4;
+  slot->frame.slot = static_cast<int32_t>(slot - slots_.data());
+  slot->frame.sequence = ++sequence_;
+  slot->frame.timestamp_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(copied.time_since_epoch()).count();
+  if (closed_) {
+    slot->state = SlotState::kFree;
+    return 0;
+  }
+  ++published_;
+  slot->state = SlotState::kReady;
+  return slot->frame.sequence;
+}
+
+const MpvFrameTapFrame* FrameTap::Acquire(uint64_t after_sequence) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Slot* newest = nullptr;
+  for (Slot& s : slots_) {
+    if (s.state == SlotState::kReady && s.frame.sequence > after_sequence &&
+        (!newest || s.frame.sequence > newest->frame.sequence)) {
+      newest = &s;
+    }
+  }
+  if (!newest) return nullptr;
+  newest->state = SlotState::kHeld;
+  ++acquired_;
+  return &newest->frame;
+}
+
+void FrameTap::Release(int32_t slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (slot < 0 || static_cast<size_t>(slot) >= slots_.size()) return;
+  Slot& s = slots_[static_cast<size_t>(slot)];
+  if (s.state == SlotState::kHeld) s.state = SlotState::kFree;
+  if (closed_) UnregisterIfDoneLocked();
+}
+
+void FrameTap::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  for (Slot& s : slots_) {
+    if (s.state == SlotState::kReady) s.state = SlotState::kFree;
+  }
+  UnregisterIfDoneLocked();
+}
+
+void FrameTap::UnregisterIfDoneLocked() {
+  for (const Slot& s : slots_) {
+    if (s.state == SlotState::kHeld) return;
+  }
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  g_registry.erase(id_);
+}
+
+FrameTap::Snapshot FrameTap::TakeSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snap;
+  snap.published = published_;
+  snap.acquired = acquired_;
+  snap.overwritten = overwritten_;
+  snap.skipped = skipped_;
+  snap.copy = copy_hist_.Summarize();
+  return snap;
+}
+
+}  // namespace mpv_native_texture
+
+extern "C" {
+
+__declspec(dllexport) const MpvFrameTapFrame* MpvFrameTapAcquire(uint64_t tap_id, uint64_t after_sequence) {
+  auto tap = mpv_native_texture::FrameTap::Find(tap_id);
+  return tap ? tap->Acquire(after_sequence) : nullptr;
+}
+
+__declspec(dllexport) void MpvFrameTapRelease(uint64_t tap_id, int32_t slot) {
+  if (auto tap = mpv_native_texture::FrameTap::Find(tap_id)) tap->Release(slot);
+}
+
+}  // extern "C"
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "include/mpv_native_texture/mpv_frame_tap_c_api.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Opt-in raw frame feed for Dart analytics (motion detection, OCR, ...).
+//
+// The render thread copies (and downscales) rate-limited frames from
+// back_rgba_ into a small ring of slots. Dart acquires the newest ready slot
+// over FFI, reads the pixels in place and releases it; a slot is only reused
+// once released. With every slot held, new frames are skipped; ready frames
+// nobody acquired are overwritten by newer ones.
+//
+// Taps are looked up by id from the FFI entry points. A stopped tap stays
+// registered until Dart has released all of its slots, so pixels handed out
+// never dangle.
+class FrameTap {
+ public:
+  struct Config {
+    int slots = 3;
+    int max_fps = 10;  // <= 0: every rendered frame
+    // Output size; 0 keeps the frame size, or the aspect ratio when only one
+    // side is given.
+    int width = 0;
+    int height = 0;
+  };
+
+  struct Snapshot {
+    uint64_t published = 0;
+    uint64_t acquired = 0;
+    uint64_t overwritten = 0;  // ready, replaced before Dart acquired it
+    uint64_t skipped = 0;      // no free slot: all held by Dart
+    LatencyHistogram::Summary copy;
+  };
+
+  // Creates and registers a tap.
+  static std::shared_ptr<FrameTap> Create(const Config& config);
+  // Looks up a registered tap (FFI side).
+  static std::shared_ptr<FrameTap> Find(uint64_t id);
+
+  explicit FrameTap(uint64_t id, const Config& config);
+
+  uint64_t id() const { return id_; }
+
+  // Render thread: offers one RGBA frame (tightly packed).
+  // Returns the new sequence number, or 0 when the frame was not taken.
+  uint64_t Offer(const uint8_t* rgba, int width, int height);
+
+  const MpvFrameTapFrame* Acquire(uint64_t after_sequence);
+  void Release(int32_t slot);
+
+  // Stops accepting frames; unregisters once no slot is held.
+  void Close();
+
+  Snapshot TakeSnapshot() const;
+
+ private:
+  enum class SlotState { kFree, kWriting, kReady, kHeld };
+
+  struct Slot {
+    SlotState state = SlotState::kFree;
+    std::vector<uint8_t> pixels;
+    MpvFrameTapFrame frame{};
+  };
+
+  void UnregisterIfDoneLocked();
+
+  const uint64_t id_;
+  const Config config_;
+
+  mutable std::mutex mutex_;
+  std::vector<Slot> slots_;
+  uint64_t sequence_ = 0;
+  bool closed_ = false;
+  SteadyClock::time_point last_offer_{};
+
+  uint64_t published_ = 0;
+  uint64_t acquired_ = 0;
+  uint64_t overwritten_ = 0;
+  uint64_t skipped_ = 0;
+  LatencyHistogram copy_hist_;
+};
+
+}  // namespace mpv_native_texture
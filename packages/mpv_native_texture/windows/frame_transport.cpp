@@ -0,0 +1,73 @@
+#include "frame_transport.h"
+
+#include <algorithm>
+
+namespace mpv_native_texture {
+
+FrameTransport::FrameTransport(PipelineStats* stats, int width, int height) : stats_(stats) { Resize(width, height); }
+
+void FrameTransport::Resize(int width, int height) {
+  width_ = std::max(1, width);
+  height_ = std::max(1, height);
+  const size_t bytes = static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4u;
+  back_.assign(bytes, 0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  front_.assign(bytes, 0);
+  unconsumed_ = false;
+  has_frame_ = false;
+  buffer_.buffer = front_.data();
+  buffer_.width = static_cast<size_t>(width_);
+  buffer_.height = static_cast<size_t>(height_);
+}
+
+SteadyClock::time_point FrameTransport::Publish() {
+  const auto start = SteadyClock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  front_.swap(back_);
+  buffer_.buffer = front_.data();
+  buffer_.width = static_cast<size_t>(width_);
+  buffer_.height = static_cast<size_t>(height_);
+  stats_->CountPublished(unconsumed_);
+  unconsumed_ = true;
+  has_frame_ = true;
+  published_at_ = SteadyClock::now();
+  stats_->Record(PipelineStats::kPublish, MicrosBetween(start, published_at_));
+  return published_at_;
+}
+
+const FlutterDesktopPixelBuffer* FrameTransport::Acquire(SteadyClock::time_point* consumed_at) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *consumed_at = SteadyClock::time_point{};
+  if (unconsumed_) {
+    unconsumed_ = false;
+    *consumed_at = SteadyClock::now();
+    stats_->Record(PipelineStats::kConsume, MicrosBetween(published_at_, *consumed_at));
+    stats_->CountConsumed();
+  }
+  return &buffer_;
+}
+
+void FrameTransport::ShowStill(std::vector<uint8_t>* pixels, int width, int height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  still_.swap(*pixels);
+  buffer_.buffer = still_.data();
+  buffer_.width = static_cast<size_t>(width);
+  buffer_.height = static_cast<size_t>(height);
+  has_frame_ = true;
+}
+
+bool FrameTransport::CopyFront(std::vector<uint8_t>* pixels, int* width, int* height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!has_frame_ || !buffer_.buffer || buffer_.width == 0 || buffer_.height == 0) return false;
+  *width = static_cast<int>(buffer_.width);
+  *height = static_cast<int>(buffer_.height);
+  pixels->assign(buffer_.buffer, buffer_.buffer + buffer_.width * buffer_.height * 4u);
+  return true;
+}
+
+void FrameTransport::DropFrame() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  has_frame_ = false;
+}
+
+}  // namespace mpv_native_texture
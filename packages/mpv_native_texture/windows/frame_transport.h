@@ -0,0 +1,71 @@
+#pragma once
+
+#include <flutter_texture_registrar.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Hand-off of RGBA frames from the render thread to Flutter's raster thread.
+//
+// The render thread draws into the back buffer and Publish() swaps it to the
+// front under a mutex; Acquire() (CopyPixelBuffer) returns the front buffer
+// under the same mutex. Only pointers move, so neither side waits longer
+// than a swap. A still (a history frame) can replace the front until the
+// next publish. Timings and frame counts go to |stats| (kPublish, kConsume).
+//
+// Has no Flutter engine dependency beyond FlutterDesktopPixelBuffer, so the
+// benchmarks drive it with a fake texture registrar.
+class FrameTransport {
+ public:
+  FrameTransport(PipelineStats* stats, int width, int height);
+
+  FrameTransport(const FrameTransport&) = delete;
+  FrameTransport& operator=(const FrameTransport&) = delete;
+
+  // Render thread.
+  uint8_t* back() { return back_.data(); }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  // Reallocates both buffers (black) and drops an unconsumed frame; nothing
+  // counts as shown until the next Publish().
+  void Resize(int width, int height);
+  // Makes the back buffer the front one. Returns when it was published.
+  SteadyClock::time_point Publish();
+
+  // Raster thread (CopyPixelBuffer). |*consumed_at| is the time a newly
+  // published frame was taken, or a default time_point when the front had
+  // already been handed out.
+  const FlutterDesktopPixelBuffer* Acquire(SteadyClock::time_point* consumed_at);
+
+  // Any thread: puts |*pixels| on screen until the next Publish(), swapping
+  // the previous still into |*pixels|.
+  void ShowStill(std::vector<uint8_t>* pixels, int width, int height);
+  // Any thread: copies what is on screen. False before anything was
+  // published or shown since construction, Resize() or DropFrame().
+  bool CopyFront(std::vector<uint8_t>* pixels, int* width, int* height);
+  // Any thread: the frame on screen no longer belongs to the current file
+  // (a new one is opening). The texture keeps showing it, but CopyFront()
+  // fails until the next Publish() or ShowStill().
+  void DropFrame();
+
+ private:
+  PipelineStats* const stats_;
+  int width_ = 0;  // of back_; render thread
+  int height_ = 0;
+  std::vector<uint8_t> back_;
+
+  std::mutex mutex_;
+  std::vector<uint8_t> front_;
+  std::vector<uint8_t> still_;
+  FlutterDesktopPixelBuffer buffer_{};
+  bool unconsumed_ = false;  // front_ not handed to Flutter yet
+  bool has_frame_ = false;   // buffer_ holds a published frame or a still
+  SteadyClock::time_point published_at_{};
+};
+
+}  // namespace mpv_native_texture
@@ -31,6 +31,8 @@ bool GlExt::Load() {
   glFramebufferRenderbuffer = reinterpret_cast<PFNGLFRAMEBUFFERRENDERBUFFERPROC>(GetGLProc("glFramebufferRenderbuffer"));
   glDeleteRenderbuffers = reinterpret_cast<PFNGLDELETERENDERBUFFERSPROC>(GetGLProc("glDeleteRenderbuffers"));
 
+  glBlitFramebuffer = reinterpret_cast<PFNGLBLITFRAMEBUFFERPROC>(GetGLProc("glBlitFramebuffer"));
+
   return glGenFramebuffers && glBindFramebuffer && glDeleteFramebuffers && glCheckFramebufferStatus && glFramebufferTexture2D &&
          glGenTextures && glBindTexture && glDeleteTextures && glTexImage2D && glTexParameteri &&
          glGenRenderbuffers && glBindRenderbuffer && glRenderbufferStorage && glFramebufferRenderbuffer && glDeleteRenderbuffers;
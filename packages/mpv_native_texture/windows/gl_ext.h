@@ -28,6 +28,9 @@ typedef void (APIENTRY *PFNGLRENDERBUFFERSTORAGEPROC)(GLenum target, GLenum inte
 typedef void (APIENTRY *PFNGLFRAMEBUFFERRENDERBUFFERPROC)(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
 typedef void (APIENTRY *PFNGLDELETERENDERBUFFERSPROC)(GLsizei n, const GLuint* renderbuffers);
 
+typedef void (APIENTRY *PFNGLBLITFRAMEBUFFERPROC)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0,
+                                                  GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+
 struct GlExt {
   PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = nullptr;
   PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer = nullptr;
@@ -47,6 +50,10 @@ struct GlExt {
   PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer = nullptr;
   PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers = nullptr;
 
+  // Optional (GL 3.0 / ARB_framebuffer_object); only extra texture outputs
+  // need it, so Load() does not fail without it.
+  PFNGLBLITFRAMEBUFFERPROC glBlitFramebuffer = nullptr;
+
   bool Load();
 };
 
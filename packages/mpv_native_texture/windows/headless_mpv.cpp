@@ -0,0 +1,201 @@
+#include "headless_mpv.h"
+
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+
+namespace mpv_native_texture {
+
+static void SetMpvError(const MpvApi& api, const char* what, int code, std::string* out) {
+  if (!out) return;
+  const char* s = api.mpv_error_string ? api.mpv_error_string(code) : "unknown";
+  *out = std::string(what) + ": libmpv error " + std::to_string(code) + ": " + s;
+}
+
+HeadlessMpv::~HeadlessMpv() {
+  if (render_) api_.mpv_render_context_free(render_);
+  if (mpv_) api_.mpv_destroy(mpv_);
+}
+
+void HeadlessMpv::OnRenderUpdate(void* ctx) {
+  auto* self = static_cast<HeadlessMpv*>(ctx);
+  {
+    std::lock_guard<std::mutex> lock(self->update_mutex_);
+    self->update_pending_ = true;
+  }
+  self->update_cv_.notify_one();
+}
+
+void HeadlessMpv::Interrupt() {
+  {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    interrupted_.store(true);
+  }
+  update_cv_.notify_one();
+}
+
+bool HeadlessMpv::Init(int width, int height, std::string* err_out) {
+  width_ = std::max(16, std::min(width, 1920));
+  height_ = std::max(16, std::min(height, 1080));
+
+  if (!api_.Load()) {
+    if (err_out) *err_out = "Failed to load mpv-2.dll";
+    return false;
+  }
+  std::setlocale(LC_NUMERIC, "C");
+  mpv_ = api_.mpv_create();
+  if (!mpv_) {
+    if (err_out) *err_out = "mpv_create() failed";
+    return false;
+  }
+
+  // Video only, decoded as cheaply as possible: keyframes land at thumbnail
+  // size, so hardware decoding, deblocking and full-quality scaling buy
+  // nothing here.
+  api_.mpv_set_option_string(mpv_, "vo", "libmpv");
+  api_.mpv_set_option_string(mpv_, "config", "no");
+  api_.mpv_set_option_string(mpv_, "load-scripts", "no");
+  api_.mpv_set_option_string(mpv_, "ytdl", "no");
+  api_.mpv_set_option_string(mpv_, "audio", "no");
+  api_.mpv_set_option_string(mpv_, "sid", "no");
+  api_.mpv_set_option_string(mpv_, "osd-level", "0");
+  api_.mpv_set_option_string(mpv_, "pause", "yes");
+  api_.mpv_set_option_string(mpv_, "keep-open", "always");
+  api_.mpv_set_option_string(mpv_, "hr-seek", "no");
+  api_.mpv_set_option_string(mpv_, "hwdec", "no");
+  api_.mpv_set_option_string(mpv_, "vd-lavc-threads", "2");
+  api_.mpv_set_option_string(mpv_, "vd-lavc-skiploopfilter", "all");
+  api_.mpv_set_option_string(mpv_, "vd-lavc-fast", "yes");
+  api_.mpv_set_option_string(mpv_, "sw-fast", "yes");
+  api_.mpv_set_option_string(mpv_, "demuxer-readahead-secs", "0");
+
+  int rc = api_.mpv_initialize(mpv_);
+  if (rc < 0) {
+    SetMpvError(api_, "mpv_initialize", rc, err_out);
+    return false;
+  }
+
+  const char* api_type = MPV_RENDER_API_TYPE_SW;
+  mpv_render_param params[] = {
+      {MPV_RENDER_PARAM_API_TYPE, const_cast<char*>(api_type)},
+      {MPV_RENDER_PARAM_INVALID, nullptr},
+  };
+  rc = api_.mpv_render_context_create(&render_, mpv_, params);
+  if (rc < 0) {
+    render_ = nullptr;
+    SetMpvError(api_, "mpv_render_context_create(sw)", rc, err_out);
+    return false;
+  }
+  api_.mpv_render_context_set_update_callback(render_, &HeadlessMpv::OnRenderUpdate, this);
+  return true;
+}
+
+bool HeadlessMpv::WaitForEvent(mpv_event_id wanted, SteadyClock::time_point deadline, std::string* err_out) {
+  for (;;) {
+    if (interrupted_.load()) {
+      if (err_out) *err_out = "Interrupted";
+      return false;
+    }
+    const double left = std::chrono::duration<double>(deadline - SteadyClock::now()).count();
+    if (left <= 0) {
+      if (err_out) *err_out = std::string("Timed out waiting for ") + api_.mpv_event_name(wanted);
+      return false;
+    }
+    // Short slices so Interrupt() is noticed.
+    mpv_event* event = api_.mpv_wait_event(mpv_, std::min(left, 0.1));
+    if (!event || event->event_id == MPV_EVENT_NONE) continue;
+    if (event->event_id == wanted) return true;
+    if (event->event_id == MPV_EVENT_END_FILE) {
+      const auto* end = static_cast<const mpv_event_end_file*>(event->data);
+      if (end && end->reason == MPV_END_FILE_REASON_ERROR) {
+        SetMpvError(api_, "Playback failed", end->error, err_out);
+        return false;
+      }
+    }
+    if (event->event_id == MPV_EVENT_SHUTDOWN) {
+      if (err_out) *err_out = "mpv shut down";
+      return false;
+    }
+  }
+}
+
+bool HeadlessMpv::Load(const std::string& path, std::chrono::milliseconds timeout, std::string* err_out) {
+  if (!mpv_ || !render_) {
+    if (err_out) *err_out = "Not initialized";
+    return false;
+  }
+  const auto deadline = SteadyClock::now() + timeout;
+  const char* cmd[] = {"loadfile", path.c_str(), "replace", nullptr};
+  const int rc = api_.mpv_command(mpv_, cmd);
+  if (rc < 0) {
+    SetMpvError(api_, "loadfile", rc, err_out);
+    return false;
+  }
+  if (!WaitForEvent(MPV_EVENT_FILE_LOADED, deadline, err_out)) return false;
+  duration_ = 0.0;
+  api_.mpv_get_property(mpv_, "duration", MPV_FORMAT_DOUBLE, &duration_);
+  return true;
+}
+
+bool HeadlessMpv::RenderFrame(SteadyClock::time_point deadline, std::vector<uint8_t>* rgba, std::string* err_out) {
+  // The frame queued by the seek is announced through the update callback.
+  for (;;) {
+    if (api_.mpv_render_context_update(render_) & MPV_RENDER_UPDATE_FRAME) break;
+    std::unique_lock<std::mutex> lock(update_mutex_);
+    if (!update_cv_.wait_until(lock, deadline, [&] { return update_pending_ || interrupted_.load(); })) {
+      if (err_out) *err_out = "Timed out waiting for a video frame";
+      return false;
+    }
+    if (interrupted_.load()) {
+      if (err_out) *err_out = "Interrupted";
+      return false;
+    }
+    update_pending_ = false;
+  }
+
+  int size[2] = {width_, height_};
+  char format[] = "rgb0";
+  size_t stride = static_cast<size_t>(width_) * 4u;
+  rgba->resize(stride * static_cast<size_t>(height_));
+  mpv_render_param params[] = {
+      {MPV_RENDER_PARAM_SW_SIZE, size},
+      {MPV_RENDER_PARAM_SW_FORMAT, format},
+      {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+      {MPV_RENDER_PARAM_SW_POINTER, rgba->data()},
+      {MPV_RENDER_PARAM_INVALID, nullptr},
+  };
+  const int rc = api_.mpv_render_context_render(render_, params);
+  if (rc < 0) {
+    SetMpvError(api_, "mpv_render_context_render(sw)", rc, err_out);
+    return false;
+  }
+  // rgb0 leaves the fourth byte undefined.
+  for (size_t i = 3; i < rgba->size(); i += 4) (*rgba)[i] = 0xFF;
+  return true;
+}
+
+bool HeadlessMpv::SeekKeyframe(double seconds, std::chrono::milliseconds timeout, std::vector<uint8_t>* rgba,
+                               double* landed, std::string* err_out) {
+  if (!mpv_ || !render_) {
+    if (err_out) *err_out = "Not initialized";
+    return false;
+  }
+  const auto deadline = SteadyClock::now() + timeout;
+  char target[64] = {0};
+  std::snprintf(target, sizeof(target), "%0.3f", std::max(0.0, seconds));
+  const char* cmd[] = {"seek", target, "absolute+keyframes", nullptr};
+  const int rc = api_.mpv_command(mpv_, cmd);
+  if (rc < 0) {
+    SetMpvError(api_, "seek", rc, err_out);
+    return false;
+  }
+  if (!WaitForEvent(MPV_EVENT_PLAYBACK_RESTART, deadline, err_out)) return false;
+  if (!RenderFrame(deadline, rgba, err_out)) return false;
+  if (landed) {
+    *landed = seconds;
+    api_.mpv_get_property(mpv_, "time-pos", MPV_FORMAT_DOUBLE, landed);
+  }
+  return true;
+}
+
+}  // namespace mpv_native_texture
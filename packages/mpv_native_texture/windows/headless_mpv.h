@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mpv_dll.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// A small, audio-less mpv instance rendered with the software renderer into
+// memory. No GL context, no texture, no threads of its own: every call blocks
+// the calling thread until mpv answers or the timeout expires, so it belongs
+// on a worker thread. Used for previews and thumbnails, where a few keyframes
+// at thumbnail size are all that is ever decoded.
+class HeadlessMpv {
+ public:
+  HeadlessMpv() = default;
+  ~HeadlessMpv();
+
+  HeadlessMpv(const HeadlessMpv&) = delete;
+  HeadlessMpv& operator=(const HeadlessMpv&) = delete;
+
+  // Frames are rendered at |width| x |height|, letterboxed.
+  bool Init(int width, int height, std::string* err_out);
+
+  // Loads |path| paused and waits until it is ready to seek.
+  bool Load(const std::string& path, std::chrono::milliseconds timeout, std::string* err_out);
+  double duration() const { return duration_; }
+
+  // Keyframe seek to |seconds| and renders the frame landed on as RGBA.
+  // |*landed| is that frame's time-pos.
+  bool SeekKeyframe(double seconds, std::chrono::milliseconds timeout, std::vector<uint8_t>* rgba,
+                    double* landed, std::string* err_out);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+  // Any thread: makes the blocking call in progress (and all later ones)
+  // fail promptly, so the owner can join its worker.
+  void Interrupt();
+
+ private:
+  static void OnRenderUpdate(void* ctx);
+  // Drains mpv events until |wanted| arrives (true) or END_FILE / timeout.
+  bool WaitForEvent(mpv_event_id wanted, SteadyClock::time_point deadline, std::string* err_out);
+  bool RenderFrame(SteadyClock::time_point deadline, std::vector<uint8_t>* rgba, std::string* err_out);
+
+  MpvApi api_;
+  mpv_handle* mpv_ = nullptr;
+  mpv_render_context* render_ = nullptr;
+  int width_ = 0;
+  int height_ = 0;
+  double duration_ = 0.0;
+
+  std::atomic<bool> interrupted_{false};
+  std::mutex update_mutex_;
+  std::condition_variable update_cv_;
+  bool update_pending_ = false;
+};
+
+}  // namespace mpv_native_texture
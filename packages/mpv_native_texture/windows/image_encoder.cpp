@@ -0,0 +1,147 @@
+#include "image_encoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace mpv_native_texture {
+
+using Microsoft::WRL::ComPtr;
+
+static bool Check(HRESULT hr, const char* what, std::string* err_out) {
+  if (SUCCEEDED(hr)) return true;
+  if (err_out) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "WIC %s failed: 0x%08lx", what, static_cast<unsigned long>(hr));
+    *err_out = buf;
+  }
+  return false;
+}
+
+bool ParseImageFormat(const std::string& name, ImageFormat* out) {
+  if (name == "png") {
+    *out = ImageFormat::kPng;
+  } else if (name == "jpeg" || name == "jpg") {
+    *out = ImageFormat::kJpeg;
+  } else if (name == "raw") {
+    *out = ImageFormat::kRaw;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* ImageFormatName(ImageFormat format) {
+  switch (format) {
+    case ImageFormat::kPng: return "png";
+    case ImageFormat::kJpeg: return "jpeg";
+    case ImageFormat::kRaw: return "raw";
+    default: return "unknown";
+  }
+}
+
+bool ImageEncoder::Init(std::string* err_out) {
+  if (factory_) return true;
+  return Check(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory_)),
+               "CoCreateInstance(ImagingFactory)", err_out);
+}
+
+bool ImageEncoder::Encode(const RgbaImage& src, int dst_w, int dst_h, ImageFormat format, int jpeg_quality,
+                          std::vector<uint8_t>* out, std::string* err_out) {
+  if (!factory_ && !Init(err_out)) return false;
+  if (src.width <= 0 || src.height <= 0 ||
+      src.pixels.size() < static_cast<size_t>(src.width) * static_cast<size_t>(src.height) * 4u) {
+    if (err_out) *err_out = "Empty frame";
+    return false;
+  }
+
+  const UINT src_stride = static_cast<UINT>(src.width) * 4u;
+  ComPtr<IWICBitmap> bitmap;
+  if (!Check(factory_->CreateBitmapFromMemory(static_cast<UINT>(src.width), static_cast<UINT>(src.height),
+                                              GUID_WICPixelFormat32bppRGBA, src_stride,
+                                              static_cast<UINT>(src.pixels.size()),
+                                              const_cast<BYTE*>(src.pixels.data()), &bitmap),
+             "CreateBitmapFromMemory", err_out)) {
+    return false;
+  }
+
+  ComPtr<IWICBitmapSource> source = bitmap;
+  if (dst_w != src.width || dst_h != src.height) {
+    ComPtr<IWICBitmapScaler> scaler;
+    if (!Check(factory_->CreateBitmapScaler(&scaler), "CreateBitmapScaler", err_out) ||
+        !Check(scaler->Initialize(source.Get(), static_cast<UINT>(dst_w), static_cast<UINT>(dst_h),
+                                  WICBitmapInterpolationModeFant),
+               "IWICBitmapScaler::Initialize", err_out)) {
+      return false;
+    }
+    source = scaler;
+  }
+
+  if (format == ImageFormat::kRaw) {
+    const UINT stride = static_cast<UINT>(dst_w) * 4u;
+    out->resize(static_cast<size_t>(stride) * static_cast<size_t>(dst_h));
+    return Check(source->CopyPixels(nullptr, stride, static_cast<UINT>(out->size()), out->data()), "CopyPixels",
+                 err_out);
+  }
+
+  // Both encoders take 24bpp BGR; convert explicitly rather than relying on
+  // WriteSource to negotiate.
+  ComPtr<IWICFormatConverter> converter;
+  if (!Check(factory_->CreateFormatConverter(&converter), "CreateFormatConverter", err_out) ||
+      !Check(converter->Initialize(source.Get(), GUID_WICPixelFormat24bppBGR, WICBitmapDitherTypeNone, nullptr, 0.0,
+                                   WICBitmapPaletteTypeCustom),
+             "IWICFormatConverter::Initialize", err_out)) {
+    return false;
+  }
+
+  ComPtr<IStream> stream;
+  if (!Check(CreateStreamOnHGlobal(nullptr, TRUE, &stream), "CreateStreamOnHGlobal", err_out)) return false;
+
+  ComPtr<IWICBitmapEncoder> encoder;
+  const GUID container = format == ImageFormat::kJpeg ? GUID_ContainerFormatJpeg : GUID_ContainerFormatPng;
+  if (!Check(factory_->CreateEncoder(container, nullptr, &encoder), "CreateEncoder", err_out) ||
+      !Check(encoder->Initialize(stream.Get(), WICBitmapEncoderNoCache), "IWICBitmapEncoder::Initialize", err_out)) {
+    return false;
+  }
+
+  ComPtr<IWICBitmapFrameEncode> frame;
+  ComPtr<IPropertyBag2> props;
+  if (!Check(encoder->CreateNewFrame(&frame, &props), "CreateNewFrame", err_out)) return false;
+  if (format == ImageFormat::kJpeg && props) {
+    PROPBAG2 option{};
+    option.pstrName = const_cast<LPOLESTR>(L"ImageQuality");
+    VARIANT value;
+    VariantInit(&value);
+    value.vt = VT_R4;
+    value.fltVal = static_cast<float>(std::max(1, std::min(100, jpeg_quality))) / 100.0f;
+    props->Write(1, &option, &value);
+  }
+
+  WICPixelFormatGUID pixel_format = GUID_WICPixelFormat24bppBGR;
+  if (!Check(frame->Initialize(props.Get()), "IWICBitmapFrameEncode::Initialize", err_out) ||
+      !Check(frame->SetSize(static_cast<UINT>(dst_w), static_cast<UINT>(dst_h)), "SetSize", err_out) ||
+      !Check(frame->SetPixelFormat(&pixel_format), "SetPixelFormat", err_out) ||
+      !Check(frame->WriteSource(converter.Get(), nullptr), "WriteSource", err_out) ||
+      !Check(frame->Commit(), "IWICBitmapFrameEncode::Commit", err_out) ||
+      !Check(encoder->Commit(), "IWICBitmapEncoder::Commit", err_out)) {
+    return false;
+  }
+
+  HGLOBAL global = nullptr;
+  STATSTG stat{};
+  if (!Check(GetHGlobalFromStream(stream.Get(), &global), "GetHGlobalFromStream", err_out) ||
+      !Check(stream->Stat(&stat, STATFLAG_NONAME), "IStream::Stat", err_out)) {
+    return false;
+  }
+  const void* data = GlobalLock(global);
+  if (!data) {
+    if (err_out) *err_out = "GlobalLock failed";
+    return false;
+  }
+  out->resize(static_cast<size_t>(stat.cbSize.QuadPart));
+  std::memcpy(out->data(), data, out->size());
+  GlobalUnlock(global);
+  return true;
+}
+
+}  // namespace mpv_native_texture
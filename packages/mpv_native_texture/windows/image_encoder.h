@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Windows.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mpv_native_texture {
+
+enum class ImageFormat { kPng, kJpeg, kRaw };
+
+// "png", "jpeg"/"jpg" or "raw".
+bool ParseImageFormat(const std::string& name, ImageFormat* out);
+const char* ImageFormatName(ImageFormat format);
+
+// Tightly packed 8-bit RGBA.
+struct RgbaImage {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> pixels;
+};
+
+// Scales and encodes RGBA frames with WIC.
+//
+// Not thread safe: create one per worker thread, after COM has been
+// initialized on that thread.
+class ImageEncoder {
+ public:
+  bool Init(std::string* err_out);
+
+  // Scales |src| to |dst_w| x |dst_h| (Fant filter) and encodes it. PNG and
+  // JPEG drop alpha; kRaw returns the scaled RGBA pixels. |jpeg_quality| is
+  // 1..100.
+  bool Encode(const RgbaImage& src, int dst_w, int dst_h, ImageFormat format, int jpeg_quality,
+              std::vector<uint8_t>* out, std::string* err_out);
+
+ private:
+  Microsoft::WRL::ComPtr<IWICImagingFactory> factory_;
+};
+
+}  // namespace mpv_native_texture
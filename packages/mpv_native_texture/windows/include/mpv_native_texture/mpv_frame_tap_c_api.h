@@ -0,0 +1,35 @@
+#ifndef FLUTTER_PLUGIN_MPV_FRAME_TAP_C_API_H_
+#define FLUTTER_PLUGIN_MPV_FRAME_TAP_C_API_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One published frame of a frame tap, as seen through FFI.
+//
+// The descriptor and its pixels stay valid and unchanged from a successful
+// MpvFrameTapAcquire() until the matching MpvFrameTapRelease().
+typedef struct MpvFrameTapFrame {
+  const uint8_t* pixels;  // RGBA, |stride| bytes per row
+  int32_t width;
+  int32_t height;
+  int32_t stride;
+  int32_t slot;
+  uint64_t sequence;      // 1, 2, ... per tap; gaps mean frames were replaced
+  int64_t timestamp_us;   // steady clock at publication
+} MpvFrameTapFrame;
+
+// Returns the newest frame of tap |tap_id| with a sequence greater than
+// |after_sequence| and holds its slot, or NULL when there is none.
+__declspec(dllexport) const MpvFrameTapFrame* MpvFrameTapAcquire(uint64_t tap_id, uint64_t after_sequence);
+
+// Hands slot |slot| back to the tap for reuse.
+__declspec(dllexport) void MpvFrameTapRelease(uint64_t tap_id, int32_t slot);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // FLUTTER_PLUGIN_MPV_FRAME_TAP_C_API_H_
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+#include <ostream>
+
+namespace mpv_native_texture {
+
+// Writes |s| as a quoted JSON string.
+inline void WriteJsonString(std::ostream& out, const char* s) {
+  out << '"';
+  for (; s && *s; ++s) {
+    const char c = *s;
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+      out << buf;
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+}  // namespace mpv_native_texture
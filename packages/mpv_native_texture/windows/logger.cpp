@@ -0,0 +1,113 @@
+#include "logger.h"
+
+#include <Windows.h>
+
+#include <chrono>
+#include <cstdio>
+
+namespace mpv_native_texture {
+
+static constexpr size_t kFlushThreshold = 64 * 1024;
+static constexpr size_t kMaxPending = 4 * 1024 * 1024;
+static constexpr std::chrono::milliseconds kFlushInterval(100);
+
+static std::string GetEnv(const char* name) {
+  char buf[MAX_PATH];
+  const DWORD n = GetEnvironmentVariableA(name, buf, sizeof(buf));
+  return n > 0 && n < sizeof(buf) ? std::string(buf, n) : std::string();
+}
+
+// See logger.h; empty means file logging is off.
+static std::string ResolveLogPath() {
+  const std::string setting = GetEnv("MPV_NATIVE_TEXTURE_LOG");
+  if (setting.empty() || setting == "0") return {};
+  if (setting != "1") return setting;
+  const std::string local_app_data = GetEnv("LOCALAPPDATA");
+  if (local_app_data.empty()) return {};
+  const std::string dir = local_app_data + "\\mpv_native_texture";
+  CreateDirectoryA(dir.c_str(), nullptr);
+  return dir + "\\mpv_debug.log";
+}
+
+Logger& Logger::Instance() {
+  // Intentionally leaked: joining the writer from a static destructor would
+  // run under the loader lock at DLL unload.
+  static Logger* instance = new Logger();
+  return *instance;
+}
+
+Logger::Logger() : log_path_(ResolveLogPath()) {
+  writer_ = std::thread(&Logger::WriterMain, this);
+  writer_.detach();
+}
+
+void Logger::Write(const char* line) {
+  if (!line || !*line) return;
+  bool wake = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.size() >= kMaxPending) {
+      ++dropped_;
+      return;
+    }
+    if (pending_.empty()) ++queued_batches_;
+    pending_ += line;
+    wake = pending_.size() >= kFlushThreshold;
+  }
+  if (wake) cv_.notify_one();
+}
+
+void Logger::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const uint64_t target = queued_batches_;
+  if (written_batches_ >= target) return;
+  flush_requested_ = true;
+  cv_.notify_one();
+  flushed_cv_.wait_for(lock, std::chrono::seconds(2), [&] { return written_batches_ >= target; });
+}
+
+void Logger::WriterMain() {
+  std::string batch;
+  for (;;) {
+    size_t dropped = 0;
+    uint64_t batch_id = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_for(lock, kFlushInterval,
+                   [&] { return flush_requested_ || pending_.size() >= kFlushThreshold; });
+      flush_requested_ = false;
+      if (pending_.empty() && dropped_ == 0) continue;
+      batch.swap(pending_);
+      pending_.clear();
+      dropped = dropped_;
+      dropped_ = 0;
+      batch_id = queued_batches_;
+    }
+
+    if (dropped > 0) {
+      char buf[96];
+      std::snprintf(buf, sizeof(buf), "[Logger] dropped %zu lines (writer behind)\n", dropped);
+      batch += buf;
+    }
+    WriteOut(batch);
+    batch.clear();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      written_batches_ = batch_id;
+    }
+    flushed_cv_.notify_all();
+  }
+}
+
+void Logger::WriteOut(const std::string& text) {
+  OutputDebugStringA(text.c_str());
+  if (log_path_.empty()) return;
+  FILE* f = nullptr;
+  if (fopen_s(&f, log_path_.c_str(), "a") == 0 && f) {
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+  }
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mpv_native_texture {
+
+// Buffered, thread-safe log sink shared by all players.
+//
+// Write() only appends to an in-memory buffer; a background thread hands the
+// text to OutputDebugString and, if enabled, appends it to the log file every
+// 100 ms (or sooner once 64 KB are queued). The render and event threads can
+// therefore log without ever blocking on disk I/O. If the writer falls more
+// than 4 MB behind, new lines are dropped and counted.
+//
+// The log file is opt-in through the MPV_NATIVE_TEXTURE_LOG environment
+// variable, read once at startup: unset or "0" disables it, "1" logs to
+// %LOCALAPPDATA%\mpv_native_texture\mpv_debug.log and anything else is taken
+// as the file's path.
+class Logger {
+ public:
+  static Logger& Instance();
+
+  // |line| should end with a newline.
+  void Write(const char* line);
+  void Write(const std::string& line) { Write(line.c_str()); }
+
+  // Blocks until everything queued so far has been written.
+  void Flush();
+
+ private:
+  Logger();
+
+  void WriterMain();
+  void WriteOut(const std::string& text);
+
+  const std::string log_path_;  // empty: no log file
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable flushed_cv_;
+  std::string pending_;
+  size_t dropped_ = 0;
+  uint64_t queued_batches_ = 0;
+  uint64_t written_batches_ = 0;
+  // Set by Flush() so the writer wakes without waiting for the threshold.
+  bool flush_requested_ = false;
+  std::thread writer_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,110 @@
+#include "media_info.h"
+
+#include <cstring>
+
+namespace mpv_native_texture {
+
+static constexpr uint8_t kVersion = 1;
+
+namespace {
+
+class Writer {
+ public:
+  explicit Writer(std::string* out) : out_(out) {}
+
+  template <typename T>
+  void Put(T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out_->append(bytes, sizeof(T));
+  }
+  void PutString(const std::string& s) {
+    Put(static_cast<uint32_t>(s.size()));
+    out_->append(s);
+  }
+
+ private:
+  std::string* out_;
+};
+
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+  template <typename T>
+  bool Get(T* value) {
+    if (static_cast<size_t>(end_ - p_) < sizeof(T)) return false;
+    std::memcpy(value, p_, sizeof(T));
+    p_ += sizeof(T);
+    return true;
+  }
+  bool GetString(std::string* s) {
+    uint32_t size = 0;
+    if (!Get(&size) || static_cast<size_t>(end_ - p_) < size) return false;
+    s->assign(reinterpret_cast<const char*>(p_), size);
+    p_ += size;
+    return true;
+  }
+
+ private:
+  const uint8_t* p_;
+  const uint8_t* end_;
+};
+
+}  // namespace
+
+void SerializeMediaInfo(const MediaInfo& info, std::string* out) {
+  Writer w(out);
+  w.Put(kVersion);
+  w.Put(info.duration);
+  w.PutString(info.file_format);
+  w.Put(info.file_size);
+  w.Put(info.bitrate);
+  w.Put(info.width);
+  w.Put(info.height);
+  w.PutString(info.pixel_format);
+  w.Put(static_cast<uint32_t>(info.tracks.size()));
+  for (const MediaTrack& t : info.tracks) {
+    w.PutString(t.type);
+    w.Put(t.id);
+    w.PutString(t.codec);
+    w.PutString(t.lang);
+    w.PutString(t.title);
+    w.Put(static_cast<uint8_t>((t.is_default ? 1 : 0) | (t.external ? 2 : 0)));
+    w.Put(t.width);
+    w.Put(t.height);
+    w.Put(t.fps);
+    w.Put(t.channels);
+    w.Put(t.sample_rate);
+    w.Put(t.bitrate);
+  }
+}
+
+bool DeserializeMediaInfo(const uint8_t* data, size_t size, MediaInfo* out) {
+  Reader r(data, size);
+  uint8_t version = 0;
+  if (!r.Get(&version) || version != kVersion) return false;
+  MediaInfo info;
+  uint32_t tracks = 0;
+  if (!r.Get(&info.duration) || !r.GetString(&info.file_format) || !r.Get(&info.file_size) ||
+      !r.Get(&info.bitrate) || !r.Get(&info.width) || !r.Get(&info.height) || !r.GetString(&info.pixel_format) ||
+      !r.Get(&tracks)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < tracks; ++i) {
+    MediaTrack t;
+    uint8_t flags = 0;
+    if (!r.GetString(&t.type) || !r.Get(&t.id) || !r.GetString(&t.codec) || !r.GetString(&t.lang) ||
+        !r.GetString(&t.title) || !r.Get(&flags) || !r.Get(&t.width) || !r.Get(&t.height) || !r.Get(&t.fps) ||
+        !r.Get(&t.channels) || !r.Get(&t.sample_rate) || !r.Get(&t.bitrate)) {
+      return false;
+    }
+    t.is_default = (flags & 1) != 0;
+    t.external = (flags & 2) != 0;
+    info.tracks.push_back(std::move(t));
+  }
+  *out = std::move(info);
+  return true;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mpv_native_texture {
+
+// One entry of mpv's track-list. Fields a track type does not have stay 0 or
+// empty.
+struct MediaTrack {
+  std::string type;  // "video", "audio" or "sub"
+  int64_t id = 0;
+  std::string codec;
+  std::string lang;
+  std::string title;
+  bool is_default = false;
+  bool external = false;
+  int64_t width = 0;   // demux-w
+  int64_t height = 0;  // demux-h
+  double fps = 0.0;    // demux-fps
+  int64_t channels = 0;     // demux-channel-count
+  int64_t sample_rate = 0;  // demux-samplerate
+  int64_t bitrate = 0;      // demux-bitrate, bits/s
+};
+
+// What the probe learns about a file without playing it.
+struct MediaInfo {
+  double duration = 0.0;
+  std::string file_format;
+  int64_t file_size = 0;
+  int64_t bitrate = 0;  // file size over duration, bits/s
+  // From video-params when the probe decoded a frame, else the first video
+  // track's demuxer values.
+  int64_t width = 0;
+  int64_t height = 0;
+  std::string pixel_format;  // video-params only
+  std::vector<MediaTrack> tracks;
+};
+
+// Compact binary form used by the probe index: little-endian scalars and
+// length-prefixed strings, with a leading version byte.
+void SerializeMediaInfo(const MediaInfo& info, std::string* out);
+// False on truncated or foreign data.
+bool DeserializeMediaInfo(const uint8_t* data, size_t size, MediaInfo* out);
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,328 @@
+#include "media_probe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cstring>
+#include <filesystem>
+
+#include "mpv_dll.h"
+#include "probe_index.h"
+#include "trace.h"
+
+namespace mpv_native_texture {
+
+namespace fs = std::filesystem;
+
+static void SetMpvError(const MpvApi& api, const char* what, int code, std::string* out) {
+  if (!out) return;
+  const char* s = api.mpv_error_string ? api.mpv_error_string(code) : "unknown";
+  *out = std::string(what) + ": libmpv error " + std::to_string(code) + ": " + s;
+}
+
+static const mpv_node* MapGet(const mpv_node& map, const char* key) {
+  if (map.format != MPV_FORMAT_NODE_MAP || !map.u.list) return nullptr;
+  for (int i = 0; i < map.u.list->num; ++i) {
+    if (std::strcmp(map.u.list->keys[i], key) == 0) return &map.u.list->values[i];
+  }
+  return nullptr;
+}
+
+static std::string NodeString(const mpv_node* node) {
+  return node && node->format == MPV_FORMAT_STRING && node->u.string ? node->u.string : "";
+}
+
+static int64_t NodeInt(const mpv_node* node) {
+  if (!node) return 0;
+  if (node->format == MPV_FORMAT_INT64) return node->u.int64;
+  if (node->format == MPV_FORMAT_DOUBLE) return static_cast<int64_t>(node->u.double_);
+  return 0;
+}
+
+static double NodeDouble(const mpv_node* node) {
+  if (!node) return 0.0;
+  if (node->format == MPV_FORMAT_DOUBLE) return node->u.double_;
+  if (node->format == MPV_FORMAT_INT64) return static_cast<double>(node->u.int64);
+  return 0.0;
+}
+
+static bool NodeFlag(const mpv_node* node) { return node && node->format == MPV_FORMAT_FLAG && node->u.flag; }
+
+// One demux-only mpv instance, driven synchronously by its worker.
+class ProbeSession {
+ public:
+  ProbeSession() = default;
+  ~ProbeSession() {
+    if (mpv_) api_.mpv_destroy(mpv_);
+  }
+
+  ProbeSession(const ProbeSession&) = delete;
+  ProbeSession& operator=(const ProbeSession&) = delete;
+
+  bool Init(bool video_params, std::string* err_out) {
+    video_params_ = video_params;
+    if (!api_.Load()) {
+      if (err_out) *err_out = "Failed to load mpv-2.dll";
+      return false;
+    }
+    std::setlocale(LC_NUMERIC, "C");
+    mpv_ = api_.mpv_create();
+    if (!mpv_) {
+      if (err_out) *err_out = "mpv_create() failed";
+      return false;
+    }
+    api_.mpv_set_option_string(mpv_, "vo", "null");
+    api_.mpv_set_option_string(mpv_, "ao", "null");
+    api_.mpv_set_option_string(mpv_, "config", "no");
+    api_.mpv_set_option_string(mpv_, "load-scripts", "no");
+    api_.mpv_set_option_string(mpv_, "ytdl", "no");
+    api_.mpv_set_option_string(mpv_, "idle", "yes");
+    api_.mpv_set_option_string(mpv_, "pause", "yes");
+    api_.mpv_set_option_string(mpv_, "osd-level", "0");
+    // Tracks are listed whether or not they are selected; leaving them
+    // unselected keeps decoders closed.
+    api_.mpv_set_option_string(mpv_, "vid", video_params ? "auto" : "no");
+    api_.mpv_set_option_string(mpv_, "aid", "no");
+    api_.mpv_set_option_string(mpv_, "sid", "no");
+    api_.mpv_set_option_string(mpv_, "audio-display", "no");
+    api_.mpv_set_option_string(mpv_, "hwdec", "no");
+    api_.mpv_set_option_string(mpv_, "cache", "no");
+    api_.mpv_set_option_string(mpv_, "demuxer-readahead-secs", "0");
+    const int rc = api_.mpv_initialize(mpv_);
+    if (rc < 0) {
+      SetMpvError(api_, "mpv_initialize", rc, err_out);
+      return false;
+    }
+    return true;
+  }
+
+  // Any thread.
+  void Interrupt() { interrupted_.store(true); }
+
+  bool Probe(const std::string& path, std::chrono::milliseconds timeout, MediaInfo* info, std::string* err_out) {
+    const auto deadline = SteadyClock::now() + timeout;
+    const char* load[] = {"loadfile", path.c_str(), "replace", nullptr};
+    int rc = api_.mpv_command(mpv_, load);
+    if (rc < 0) {
+      SetMpvError(api_, "loadfile", rc, err_out);
+      return false;
+    }
+    bool ok = WaitForEvent(MPV_EVENT_FILE_LOADED, deadline, err_out);
+    if (ok) ReadInfo(deadline, info);
+    // Close the file now rather than at the next loadfile.
+    const char* stop[] = {"stop", nullptr};
+    api_.mpv_command(mpv_, stop);
+    return ok;
+  }
+
+ private:
+  void ReadInfo(SteadyClock::time_point deadline, MediaInfo* info) {
+    api_.mpv_get_property(mpv_, "duration", MPV_FORMAT_DOUBLE, &info->duration);
+    api_.mpv_get_property(mpv_, "file-size", MPV_FORMAT_INT64, &info->file_size);
+    char* format = nullptr;
+    if (api_.mpv_get_property(mpv_, "file-format", MPV_FORMAT_STRING, &format) >= 0 && format) {
+      info->file_format = format;
+      api_.mpv_free(format);
+    }
+    if (info->duration > 0 && info->file_size > 0) {
+      info->bitrate = static_cast<int64_t>(static_cast<double>(info->file_size) * 8.0 / info->duration);
+    }
+
+    mpv_node tracks{};
+    if (api_.mpv_get_property(mpv_, "track-list", MPV_FORMAT_NODE, &tracks) >= 0) {
+      if (tracks.format == MPV_FORMAT_NODE_ARRAY && tracks.u.list) {
+        for (int i = 0; i < tracks.u.list->num; ++i) {
+          const mpv_node& n = tracks.u.list->values[i];
+          MediaTrack t;
+          t.type = NodeString(MapGet(n, "type"));
+          t.id = NodeInt(MapGet(n, "id"));
+          t.codec = NodeString(MapGet(n, "codec"));
+          t.lang = NodeString(MapGet(n, "lang"));
+          t.title = NodeString(MapGet(n, "title"));
+          t.is_default = NodeFlag(MapGet(n, "default"));
+          t.external = NodeFlag(MapGet(n, "external"));
+          t.width = NodeInt(MapGet(n, "demux-w"));
+          t.height = NodeInt(MapGet(n, "demux-h"));
+          t.fps = NodeDouble(MapGet(n, "demux-fps"));
+          t.channels = NodeInt(MapGet(n, "demux-channel-count"));
+          t.sample_rate = NodeInt(MapGet(n, "demux-samplerate"));
+          t.bitrate = NodeInt(MapGet(n, "demux-bitrate"));
+          if (info->width == 0 && t.type == "video") {
+            info->width = t.width;
+            info->height = t.height;
+          }
+          info->tracks.push_back(std::move(t));
+        }
+      }
+      api_.mpv_free_node_contents(&tracks);
+    }
+
+    const bool has_video = std::any_of(info->tracks.begin(), info->tracks.end(),
+                                       [](const MediaTrack& t) { return t.type == "video"; });
+    if (!video_params_ || !has_video) return;
+    // video-params exists once the first frame is decoded. Without it the
+    // demuxer values above stand.
+    std::string ignored;
+    if (!WaitForEvent(MPV_EVENT_VIDEO_RECONFIG, deadline, &ignored)) return;
+    mpv_node params{};
+    if (api_.mpv_get_property(mpv_, "video-params", MPV_FORMAT_NODE, &params) >= 0) {
+      const int64_t w = NodeInt(MapGet(params, "w"));
+      const int64_t h = NodeInt(MapGet(params, "h"));
+      if (w > 0 && h > 0) {
+        info->width = w;
+        info->height = h;
+      }
+      info->pixel_format = NodeString(MapGet(params, "pixelformat"));
+      api_.mpv_free_node_contents(&params);
+    }
+  }
+
+  bool WaitForEvent(mpv_event_id wanted, SteadyClock::time_point deadline, std::string* err_out) {
+    for (;;) {
+      if (interrupted_.load()) {
+        if (err_out) *err_out = "Cancelled";
+        return false;
+      }
+      const double left = std::chrono::duration<double>(deadline - SteadyClock::now()).count();
+      if (left <= 0) {
+        if (err_out) *err_out = std::string("Timed out waiting for ") + api_.mpv_event_name(wanted);
+        return false;
+      }
+      // Short slices so Interrupt() is noticed.
+      mpv_event* event = api_.mpv_wait_event(mpv_, std::min(left, 0.1));
+      if (!event || event->event_id == MPV_EVENT_NONE) continue;
+      if (event->event_id == wanted) return true;
+      if (event->event_id == MPV_EVENT_END_FILE) {
+        const auto* end = static_cast<const mpv_event_end_file*>(event->data);
+        if (end && end->reason == MPV_END_FILE_REASON_ERROR) {
+          SetMpvError(api_, "Open failed", end->error, err_out);
+          return false;
+        }
+      }
+      if (event->event_id == MPV_EVENT_SHUTDOWN) {
+        if (err_out) *err_out = "mpv shut down";
+        return false;
+      }
+    }
+  }
+
+  MpvApi api_;
+  mpv_handle* mpv_ = nullptr;
+  bool video_params_ = false;
+  std::atomic<bool> interrupted_{false};
+};
+
+MediaProbeBatch::MediaProbeBatch(std::vector<std::string> paths, std::shared_ptr<ProbeIndex> index,
+                                 const Options& options, Progress progress, Done done)
+    : paths_(std::move(paths)),
+      index_(std::move(index)),
+      options_(options),
+      progress_(std::move(progress)),
+      done_(std::move(done)),
+      started_(SteadyClock::now()) {
+  const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  worker_count_ = std::max(1, std::min(options_.workers > 0 ? options_.workers : cores, 16));
+  worker_count_ = std::min(worker_count_, static_cast<int>(std::max<size_t>(1, paths_.size())));
+  summary_.total = paths_.size();
+  summary_.workers = worker_count_;
+  if (paths_.empty()) {
+    finished_.store(true);
+    done_(summary_);
+    return;
+  }
+  for (int i = 0; i < worker_count_; ++i) {
+    sessions_.push_back(std::make_unique<ProbeSession>());
+    ProbeSession* session = sessions_.back().get();
+    workers_.emplace_back([this, session] { WorkerMain(session); });
+  }
+}
+
+MediaProbeBatch::~MediaProbeBatch() {
+  cancelled_.store(true);
+  for (auto& session : sessions_) session->Interrupt();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+void MediaProbeBatch::WorkerMain(ProbeSession* session) {
+  trace::SetThreadName("MediaProbe");
+  std::string init_error;
+  bool session_ok = false;
+  bool session_tried = false;
+  // A record from a demux-only probe cannot answer a video-params request.
+  const uint32_t index_flags = options_.video_params ? ProbeIndex::kVideoParams : 0;
+
+  for (;;) {
+    const size_t i = next_.fetch_add(1);
+    if (i >= paths_.size()) break;
+    Result result;
+    result.path = paths_[i];
+    const auto start = SteadyClock::now();
+
+    int64_t file_size = -1;
+    int64_t mtime = 0;
+    std::error_code ec;
+    const fs::path file = fs::u8path(result.path);
+    if (index_ && fs::is_regular_file(file, ec)) {
+      file_size = static_cast<int64_t>(fs::file_size(file, ec));
+      mtime = static_cast<int64_t>(fs::last_write_time(file, ec).time_since_epoch().count());
+      if (ec) file_size = -1;
+    }
+
+    if (cancelled_.load()) {
+      result.error = "Cancelled";
+    } else if (file_size >= 0 && index_->Lookup(result.path, file_size, mtime, index_flags, &result.info)) {
+      result.ok = true;
+      result.cached = true;
+    } else {
+      // Workers that only ever see index hits never start mpv.
+      if (!session_tried) {
+        session_tried = true;
+        session_ok = session->Init(options_.video_params, &init_error);
+      }
+      if (!session_ok) {
+        result.error = init_error;
+      } else {
+        MPV_TRACE_SCOPE("probe", "file");
+        result.ok = session->Probe(result.path, std::chrono::milliseconds(std::max(100, options_.timeout_ms)),
+                                   &result.info, &result.error);
+        probe_.Record(MicrosBetween(start, SteadyClock::now()));
+        if (result.ok && file_size >= 0) index_->Store(result.path, file_size, mtime, index_flags, result.info);
+      }
+    }
+    result.elapsed_us = MicrosBetween(start, SteadyClock::now());
+
+    size_t done = 0;
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!result.ok) {
+        ++summary_.failed;
+      } else if (result.cached) {
+        ++summary_.cached;
+      } else {
+        ++summary_.probed;
+      }
+      done = ++done_count_;
+      last = done == paths_.size();
+    }
+    if (progress_) progress_(result, done, paths_.size());
+    if (!last) continue;
+
+    Summary summary;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      summary = summary_;
+    }
+    summary.elapsed_us = MicrosBetween(started_, SteadyClock::now());
+    if (summary.elapsed_us > 0) {
+      summary.files_per_second = static_cast<double>(summary.total) * 1e6 / static_cast<double>(summary.elapsed_us);
+    }
+    summary.probe = probe_.Summarize();
+    finished_.store(true);
+    done_(std::move(summary));
+  }
+}
+
+}  // namespace mpv_native_texture
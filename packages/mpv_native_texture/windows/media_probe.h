@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "media_info.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+class ProbeIndex;
+class ProbeSession;
+
+// Reads duration, container format, track list and video parameters for a
+// batch of media files without playing them.
+//
+// A pool of workers each owns one demux-only mpv instance (no video output,
+// no audio output, no decoders) and loads files one after another, reading
+// track-list, duration and friends as MPV_FORMAT_NODE once the file is
+// loaded. With |video_params| the video decoder stays on so video-params
+// (pixel format, decoded size) can be read after the first frame, at the
+// cost of decoding it.
+//
+// Local files are looked up in |index| by path, size and mtime first; only
+// new or changed files are opened, and their results are stored back. With
+// |video_params| a record written by a demux-only probe counts as a miss, so
+// the file is probed again and the record replaced.
+class MediaProbeBatch {
+ public:
+  struct Options {
+    int workers = 0;  // 0: one per core
+    bool video_params = false;
+    int timeout_ms = 10000;  // per file
+  };
+
+  struct Result {
+    std::string path;
+    bool ok = false;
+    bool cached = false;  // from the index, not opened
+    std::string error;
+    MediaInfo info;
+    int64_t elapsed_us = 0;
+  };
+
+  struct Summary {
+    size_t total = 0;
+    size_t probed = 0;
+    size_t cached = 0;
+    size_t failed = 0;
+    int workers = 0;
+    int64_t elapsed_us = 0;
+    double files_per_second = 0.0;
+    LatencyHistogram::Summary probe;  // files actually opened
+  };
+
+  // Both run on a worker thread; an empty batch calls Done from the constructor.
+  using Progress = std::function<void(const Result& result, size_t done, size_t total)>;
+  using Done = std::function<void(Summary summary)>;
+
+  // |index| may be null, which disables caching.
+  MediaProbeBatch(std::vector<std::string> paths, std::shared_ptr<ProbeIndex> index, const Options& options,
+                  Progress progress, Done done);
+  // Cancels outstanding work (remaining files report an error) and joins.
+  ~MediaProbeBatch();
+
+  MediaProbeBatch(const MediaProbeBatch&) = delete;
+  MediaProbeBatch& operator=(const MediaProbeBatch&) = delete;
+
+  bool finished() const { return finished_.load(); }
+
+ private:
+  void WorkerMain(ProbeSession* session);
+
+  const std::vector<std::string> paths_;
+  const std::shared_ptr<ProbeIndex> index_;
+  const Options options_;
+  const Progress progress_;
+  const Done done_;
+  const SteadyClock::time_point started_;
+
+  std::atomic<size_t> next_{0};
+  std::atomic<bool> cancelled_{false};
+  std::atomic<bool> finished_{false};
+
+  std::mutex mutex_;  // counters below
+  size_t done_count_ = 0;
+  Summary summary_;
+  LatencyHistogram probe_;
+
+  int worker_count_ = 1;
+  std::vector<std::unique_ptr<ProbeSession>> sessions_;  // one per worker
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,61 @@
+#include "mosaic_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace mpv_native_texture {
+
+MosaicLayout ComputeMosaicLayout(int count, int width, int height, int columns) {
+  MosaicLayout layout;
+  count = std::max(1, count);
+  layout.columns = columns > 0 ? columns : static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+  layout.rows = (count + layout.columns - 1) / layout.columns;
+
+  // Even tile sizes keep yuv420 chroma aligned through scale/pad.
+  const int tile_w = std::max(2, (width / layout.columns) & ~1);
+  const int tile_h = std::max(2, (height / layout.rows) & ~1);
+  layout.width = tile_w * layout.columns;
+  layout.height = tile_h * layout.rows;
+
+  for (int i = 0; i < count; ++i) {
+    MosaicTile tile;
+    tile.index = i;
+    tile.x = (i % layout.columns) * tile_w;
+    tile.y = (i / layout.columns) * tile_h;
+    tile.width = tile_w;
+    tile.height = tile_h;
+    layout.tiles.push_back(tile);
+  }
+  return layout;
+}
+
+std::string BuildMosaicGraph(const MosaicLayout& layout, const std::vector<int64_t>& track_ids) {
+  const size_t n = std::min(layout.tiles.size(), track_ids.size());
+  if (n == 0) return std::string();
+
+  std::ostringstream graph;
+  for (size_t i = 0; i < n; ++i) {
+    const MosaicTile& t = layout.tiles[i];
+    if (track_ids[i] > 0) {
+      graph << "[vid" << track_ids[i] << "]scale=" << t.width << ':' << t.height
+            << ":force_original_aspect_ratio=decrease:force_divisible_by=2,pad=" << t.width << ':' << t.height
+            << ":(ow-iw)/2:(oh-ih)/2,setsar=1";
+    } else {
+      graph << "color=c=black:s=" << t.width << 'x' << t.height << ",setsar=1";
+    }
+    graph << (n == 1 ? "[vo]" : "[t" + std::to_string(i) + "];");
+  }
+  if (n == 1) return graph.str();
+
+  for (size_t i = 0; i < n; ++i) graph << "[t" << i << ']';
+  graph << "xstack=inputs=" << n << ":fill=black:layout=";
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0) graph << '|';
+    graph << layout.tiles[i].x << '_' << layout.tiles[i].y;
+  }
+  graph << "[vo]";
+  return graph.str();
+}
+
+}  // namespace mpv_native_texture
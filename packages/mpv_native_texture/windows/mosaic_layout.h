@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mpv_native_texture {
+
+// Grid placement of mosaic inputs inside one output frame.
+struct MosaicTile {
+  int index = 0;
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+struct MosaicLayout {
+  int columns = 0;
+  int rows = 0;
+  int width = 0;   // output frame size the tiles were computed for
+  int height = 0;
+  std::vector<MosaicTile> tiles;
+};
+
+// Lays |count| equally sized tiles out row-major on a |columns| wide grid
+// (0 = smallest square grid that fits) covering |width| x |height|.
+MosaicLayout ComputeMosaicLayout(int count, int width, int height, int columns);
+
+// Builds an mpv lavfi-complex graph that scales (letterboxed) the video
+// tracks |track_ids|, one per tile, and stacks them into [vo]. A track id
+// <= 0 renders that tile black.
+std::string BuildMosaicGraph(const MosaicLayout& layout, const std::vector<int64_t>& track_ids);
+
+}  // namespace mpv_native_texture
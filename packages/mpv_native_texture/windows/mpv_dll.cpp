@@ -44,15 +44,30 @@ bool MpvApi::Load() {
   mpv_set_property = reinterpret_cast<decltype(mpv_set_property)>(Get("mpv_set_property"));
   mpv_get_property = reinterpret_cast<decltype(mpv_get_property)>(Get("mpv_get_property"));
   mpv_command = reinterpret_cast<decltype(mpv_command)>(Get("mpv_command"));
+  mpv_event_name = reinterpret_cast<decltype(mpv_event_name)>(Get("mpv_event_name"));
+  mpv_wait_event = reinterpret_cast<decltype(mpv_wait_event)>(Get("mpv_wait_event"));
+  mpv_wakeup = reinterpret_cast<decltype(mpv_wakeup)>(Get("mpv_wakeup"));
+  mpv_request_log_messages = reinterpret_cast<decltype(mpv_request_log_messages)>(Get("mpv_request_log_messages"));
+  mpv_free = reinterpret_cast<decltype(mpv_free)>(Get("mpv_free"));
+  mpv_command_node = reinterpret_cast<decltype(mpv_command_node)>(Get("mpv_command_node"));
+  mpv_free_node_contents = reinterpret_cast<decltype(mpv_free_node_contents)>(Get("mpv_free_node_contents"));
+  mpv_observe_property = reinterpret_cast<decltype(mpv_observe_property)>(Get("mpv_observe_property"));
+  mpv_command_async = reinterpret_cast<decltype(mpv_command_async)>(Get("mpv_command_async"));
+  mpv_hook_add = reinterpret_cast<decltype(mpv_hook_add)>(Get("mpv_hook_add"));
+  mpv_hook_continue = reinterpret_cast<decltype(mpv_hook_continue)>(Get("mpv_hook_continue"));
   mpv_render_context_create = reinterpret_cast<decltype(mpv_render_context_create)>(Get("mpv_render_context_create"));
   mpv_render_context_free = reinterpret_cast<decltype(mpv_render_context_free)>(Get("mpv_render_context_free"));
   mpv_render_context_set_update_callback = reinterpret_cast<decltype(mpv_render_context_set_update_callback)>(Get("mpv_render_context_set_update_callback"));
   mpv_render_context_render = reinterpret_cast<decltype(mpv_render_context_render)>(Get("mpv_render_context_render"));
+  mpv_render_context_update = reinterpret_cast<decltype(mpv_render_context_update)>(Get("mpv_render_context_update"));
 
   const bool ok = mpv_client_api_version && mpv_error_string && mpv_create && mpv_initialize && mpv_destroy &&
                   mpv_set_option_string && mpv_set_property && mpv_get_property && mpv_command &&
+                  mpv_event_name && mpv_wait_event && mpv_wakeup && mpv_request_log_messages && mpv_free &&
+                  mpv_command_node && mpv_free_node_contents && mpv_observe_property &&
+                  mpv_command_async && mpv_hook_add && mpv_hook_continue &&
                   mpv_render_context_create && mpv_render_context_free && mpv_render_context_set_update_callback &&
-                  mpv_render_context_render;
+                  mpv_render_context_render && mpv_render_context_update;
 
   if (!ok) {
     Unload();
@@ -72,10 +87,22 @@ void MpvApi::Unload() {
   mpv_set_property = nullptr;
   mpv_get_property = nullptr;
   mpv_command = nullptr;
+  mpv_event_name = nullptr;
+  mpv_wait_event = nullptr;
+  mpv_wakeup = nullptr;
+  mpv_request_log_messages = nullptr;
+  mpv_free = nullptr;
+  mpv_command_node = nullptr;
+  mpv_free_node_contents = nullptr;
+  mpv_observe_property = nullptr;
+  mpv_command_async = nullptr;
+  mpv_hook_add = nullptr;
+  mpv_hook_continue = nullptr;
   mpv_render_context_create = nullptr;
   mpv_render_context_free = nullptr;
   mpv_render_context_set_update_callback = nullptr;
   mpv_render_context_render = nullptr;
+  mpv_render_context_update = nullptr;
 
   if (dll) {
     FreeLibrary(dll);
@@ -23,12 +23,24 @@ struct MpvApi {
   int (*mpv_set_property)(mpv_handle*, const char*, mpv_format, void*) = nullptr;
   int (*mpv_get_property)(mpv_handle*, const char*, mpv_format, void*) = nullptr;
   int (*mpv_command)(mpv_handle*, const char* const*) = nullptr;
+  const char* (*mpv_event_name)(mpv_event_id) = nullptr;
+  mpv_event* (*mpv_wait_event)(mpv_handle*, double) = nullptr;
+  void (*mpv_wakeup)(mpv_handle*) = nullptr;
+  int (*mpv_request_log_messages)(mpv_handle*, const char*) = nullptr;
+  void (*mpv_free)(void*) = nullptr;
+  int (*mpv_command_node)(mpv_handle*, mpv_node*, mpv_node*) = nullptr;
+  void (*mpv_free_node_contents)(mpv_node*) = nullptr;
+  int (*mpv_observe_property)(mpv_handle*, uint64_t, const char*, mpv_format) = nullptr;
+  int (*mpv_command_async)(mpv_handle*, uint64_t, const char**) = nullptr;
+  int (*mpv_hook_add)(mpv_handle*, uint64_t, const char*, int) = nullptr;
+  int (*mpv_hook_continue)(mpv_handle*, uint64_t) = nullptr;
 
   // --- render.h
   int (*mpv_render_context_create)(mpv_render_context**, mpv_handle*, mpv_render_param*) = nullptr;
   void (*mpv_render_context_free)(mpv_render_context*) = nullptr;
   void (*mpv_render_context_set_update_callback)(mpv_render_context*, void (*)(void*), void*) = nullptr;
   int (*mpv_render_context_render)(mpv_render_context*, mpv_render_param*) = nullptr;
+  uint64_t (*mpv_render_context_update)(mpv_render_context*) = nullptr;
 
   bool Load();
   void Unload();
@@ -1,14 +1,26 @@
 #include "mpv_native_texture_plugin.h"
 
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <optional>
 
+#include "disk_cache_store.h"
+#include "logger.h"
+#include "media_probe.h"
 #include "mpv_player.h"
+#include "open_timing.h"
+#include "preview_engine.h"
+#include "probe_index.h"
+#include "sprite_sheet.h"
+#include "trace.h"
 
 namespace mpv_native_texture {
 
@@ -19,21 +31,140 @@ static std::optional<flutter::EncodableValue> GetArg(const flutter::EncodableMap
   return it->second;
 }
 
+static flutter::EncodableValue SummaryToValue(const LatencyHistogram::Summary& h) {
+  using flutter::EncodableValue;
+  return EncodableValue(flutter::EncodableMap{
+      {EncodableValue("count"), EncodableValue(static_cast<int64_t>(h.count))},
+      {EncodableValue("meanUs"), EncodableValue(h.mean_us)},
+      {EncodableValue("p50Us"), EncodableValue(h.p50_us)},
+      {EncodableValue("p95Us"), EncodableValue(h.p95_us)},
+      {EncodableValue("p99Us"), EncodableValue(h.p99_us)},
+      {EncodableValue("maxUs"), EncodableValue(h.max_us)},
+  });
+}
+
+static flutter::EncodableMap StatsToMap(const PipelineStats::Snapshot& snap) {
+  using flutter::EncodableValue;
+  flutter::EncodableMap stages;
+  for (int i = 0; i < PipelineStats::kStageCount; ++i) {
+    stages[EncodableValue(PipelineStats::StageName(static_cast<PipelineStats::Stage>(i)))] =
+        SummaryToValue(snap.stages[i]);
+  }
+
+  return flutter::EncodableMap{
+      {EncodableValue("stages"), EncodableValue(std::move(stages))},
+      {EncodableValue("fps"), EncodableValue(snap.fps)},
+      {EncodableValue("framesRendered"), EncodableValue(static_cast<int64_t>(snap.frames_rendered))},
+      {EncodableValue("framesSkipped"), EncodableValue(static_cast<int64_t>(snap.frames_skipped))},
+      {EncodableValue("framesPublished"), EncodableValue(static_cast<int64_t>(snap.frames_published))},
+      {EncodableValue("framesConsumed"), EncodableValue(static_cast<int64_t>(snap.frames_consumed))},
+      {EncodableValue("framesDropped"), EncodableValue(static_cast<int64_t>(snap.frames_dropped))},
+      {EncodableValue("mpvFrameDrops"), EncodableValue(snap.mpv_frame_drops)},
+      {EncodableValue("mpvDecoderFrameDrops"), EncodableValue(snap.mpv_decoder_frame_drops)},
+  };
+}
+
+static flutter::EncodableMap QualityToMap(const QualityGovernor::Snapshot& q) {
+  using flutter::EncodableValue;
+  flutter::EncodableList transitions;
+  for (const QualityGovernor::Transition& t : q.recent) {
+    transitions.emplace_back(flutter::EncodableMap{
+        {EncodableValue("timestampUs"), EncodableValue(t.timestamp_us)},
+        {EncodableValue("from"), EncodableValue(QualityGovernor::LevelName(t.from))},
+        {EncodableValue("to"), EncodableValue(QualityGovernor::LevelName(t.to))},
+        {EncodableValue("load"), EncodableValue(t.load)},
+    });
+  }
+  return flutter::EncodableMap{
+      {EncodableValue("enabled"), EncodableValue(q.enabled)},
+      {EncodableValue("level"), EncodableValue(QualityGovernor::LevelName(q.level))},
+      {EncodableValue("load"), EncodableValue(q.load)},
+      {EncodableValue("stepDowns"), EncodableValue(static_cast<int64_t>(q.step_downs))},
+      {EncodableValue("stepUps"), EncodableValue(static_cast<int64_t>(q.step_ups))},
+      {EncodableValue("transitions"), EncodableValue(std::move(transitions))},
+  };
+}
+
+static flutter::EncodableMap CaptureStatsToMap(const FrameCapturer::Snapshot& c) {
+  using flutter::EncodableValue;
+  return flutter::EncodableMap{
+      {EncodableValue("captured"), EncodableValue(static_cast<int64_t>(c.captured))},
+      {EncodableValue("failed"), EncodableValue(static_cast<int64_t>(c.failed))},
+      {EncodableValue("source"), SummaryToValue(c.source)},
+      {EncodableValue("encode"), SummaryToValue(c.encode)},
+      {EncodableValue("total"), SummaryToValue(c.total)},
+  };
+}
+
+static flutter::EncodableMap MosaicLayoutToMap(const MosaicLayout& layout) {
+  using flutter::EncodableValue;
+  flutter::EncodableList tiles;
+  for (const MosaicTile& t : layout.tiles) {
+    tiles.emplace_back(flutter::EncodableMap{
+        {EncodableValue("index"), EncodableValue(t.index)},
+        {EncodableValue("x"), EncodableValue(t.x)},
+        {EncodableValue("y"), EncodableValue(t.y)},
+        {EncodableValue("width"), EncodableValue(t.width)},
+        {EncodableValue("height"), EncodableValue(t.height)},
+    });
+  }
+  return flutter::EncodableMap{
+      {EncodableValue("columns"), EncodableValue(layout.columns)},
+      {EncodableValue("rows"), EncodableValue(layout.rows)},
+      {EncodableValue("width"), EncodableValue(layout.width)},
+      {EncodableValue("height"), EncodableValue(layout.height)},
+      {EncodableValue("tiles"), EncodableValue(std::move(tiles))},
+  };
+}
+
+static flutter::EncodableMap MediaInfoToMap(const MediaInfo& info) {
+  using flutter::EncodableValue;
+  flutter::EncodableList tracks;
+  for (const MediaTrack& t : info.tracks) {
+    tracks.emplace_back(flutter::EncodableMap{
+        {EncodableValue("type"), EncodableValue(t.type)},
+        {EncodableValue("id"), EncodableValue(t.id)},
+        {EncodableValue("codec"), EncodableValue(t.codec)},
+        {EncodableValue("lang"), EncodableValue(t.lang)},
+        {EncodableValue("title"), EncodableValue(t.title)},
+        {EncodableValue("default"), EncodableValue(t.is_default)},
+        {EncodableValue("external"), EncodableValue(t.external)},
+        {EncodableValue("width"), EncodableValue(t.width)},
+        {EncodableValue("height"), EncodableValue(t.height)},
+        {EncodableValue("fps"), EncodableValue(t.fps)},
+        {EncodableValue("channels"), EncodableValue(t.channels)},
+        {EncodableValue("sampleRate"), EncodableValue(t.sample_rate)},
+        {EncodableValue("bitrate"), EncodableValue(t.bitrate)},
+    });
+  }
+  return flutter::EncodableMap{
+      {EncodableValue("duration"), EncodableValue(info.duration)},
+      {EncodableValue("fileFormat"), EncodableValue(info.file_format)},
+      {EncodableValue("fileSize"), EncodableValue(info.file_size)},
+      {EncodableValue("bitrate"), EncodableValue(info.bitrate)},
+      {EncodableValue("width"), EncodableValue(info.width)},
+      {EncodableValue("height"), EncodableValue(info.height)},
+      {EncodableValue("pixelFormat"), EncodableValue(info.pixel_format)},
+      {EncodableValue("tracks"), EncodableValue(std::move(tracks))},
+  };
+}
+
 MpvNativeTexturePlugin::MpvNativeTexturePlugin(flutter::PluginRegistrarWindows* registrar)
-    : registrar_(registrar), texture_registrar_(registrar->texture_registrar()) {}
+    : registrar_(registrar),
+      texture_registrar_(registrar->texture_registrar()),
+      task_runner_(std::make_unique<PlatformTaskRunner>(registrar)) {}
 
-MpvNativeTexturePlugin::~MpvNativeTexturePlugin() = default;
+MpvNativeTexturePlugin::~MpvNativeTexturePlugin() {
+  probe_batches_.clear();
+  sprite_batches_.clear();
+  previews_.clear();
+  players_.clear();
+  Logger::Instance().Flush();
+}
 
 void MpvNativeTexturePlugin::RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar) {
-  {
-    FILE* f = nullptr;
-    if (fopen_s(&f, "C:\\Users\\User\\Documents\\a\\mpv_debug.log", "a") == 0 && f) {
-      fputs("[Plugin] RegisterWithRegistrar called\n", f);
-      fflush(f);
-      fclose(f);
-    }
-  }
-  
+  Logger::Instance().Write("[Plugin] RegisterWithRegistrar called\n");
+
   auto plugin = std::make_unique<MpvNativeTexturePlugin>(registrar);
 
   auto channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
@@ -42,33 +173,40 @@ void MpvNativeTexturePlugin::RegisterWithRegistrar(flutter::PluginRegistrarWindo
   channel->SetMethodCallHandler(
       [plugin_ptr = plugin.get()](const auto& call, auto result) { plugin_ptr->HandleMethodCall(call, std::move(result)); });
 
+  auto event_channel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(), "mpv_native_texture/events", &flutter::StandardMethodCodec::GetInstance());
+
+  event_channel->SetStreamHandler(std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+      [plugin_ptr = plugin.get()](const flutter::EncodableValue* /*arguments*/,
+                                  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+          -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+        plugin_ptr->event_sink_ = std::move(events);
+        return nullptr;
+      },
+      [plugin_ptr = plugin.get()](const flutter::EncodableValue* /*arguments*/)
+          -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+        plugin_ptr->event_sink_.reset();
+        return nullptr;
+      }));
+
   registrar->AddPlugin(std::move(plugin));
-  
-  {
-    FILE* f = nullptr;
-    if (fopen_s(&f, "C:\\Users\\User\\Documents\\a\\mpv_debug.log", "a") == 0 && f) {
-      fputs("[Plugin] RegisterWithRegistrar completed\n", f);
-      fflush(f);
-      fclose(f);
-    }
-  }
+
+  Logger::Instance().Write("[Plugin] RegisterWithRegistrar completed\n");
+}
+
+void MpvNativeTexturePlugin::PostEvent(flutter::EncodableMap event) {
+  task_runner_->PostTask([this, event = std::move(event)]() mutable {
+    if (event_sink_) event_sink_->Success(flutter::EncodableValue(std::move(event)));
+  });
 }
 
 void MpvNativeTexturePlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  {
-    FILE* f = nullptr;
-    if (fopen_s(&f, "C:\\Users\\User\\Documents\\a\\mpv_debug.log", "a") == 0 && f) {
-      fputs("[Plugin] HandleMethodCall: ENTERED\n", f);
-      fputs("[Plugin] HandleMethodCall: method=", f);
-      fputs(method_call.method_name().c_str(), f);
-      fputs("\n", f);
-      fflush(f);
-      fclose(f);
-    }
-  }
   const std::string& method = method_call.method_name();
+  Logger::Instance().Write("[Plugin] HandleMethodCall: method=" + method + "\n");
+  if (trace::Enabled()) trace::SetThreadName("Platform");
+  MPV_TRACE_SCOPE("method", method.c_str());
 
   const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
   flutter::EncodableMap empty;
@@ -88,30 +226,17 @@ void MpvNativeTexturePlugin::HandleMethodCall(
     }
 
     try {
-      OutputDebugStringA("[Plugin] Creating MpvPlayer...\n");
-      {
-        FILE* f = nullptr;
-        if (fopen_s(&f, "C:\\Users\\User\\Documents\\a\\mpv_debug.log", "a") == 0 && f) {
-          fputs("[Plugin] About to create MpvPlayer\n", f);
-          fflush(f);
-          fclose(f);
-        }
-      }
-      auto player = std::make_unique<MpvPlayer>(texture_registrar_, width, height);
-      OutputDebugStringA("[Plugin] MpvPlayer constructor returned\n");
-      {
-        FILE* f = nullptr;
-        if (fopen_s(&f, "C:\\Users\\User\\Documents\\a\\mpv_debug.log", "a") == 0 && f) {
-          fputs("[Plugin] MpvPlayer constructor returned\n", f);
-          fflush(f);
-          fclose(f);
-        }
-      }
+      Logger::Instance().Write("[Plugin] About to create MpvPlayer\n");
+      auto player = std::make_unique<MpvPlayer>(texture_registrar_, width, height,
+                                                [this](flutter::EncodableMap event) { PostEvent(std::move(event)); });
+      Logger::Instance().Write("[Plugin] MpvPlayer constructor returned\n");
       if (!player->ok()) {
         result->Error("init_failed", player->init_error());
         return;
       }
 
+      player->SetDiskCache(disk_cache_);
+
       const int64_t id = player->texture_id();
       players_[id] = std::move(player);
       result->Success(flutter::EncodableValue(id));
@@ -125,6 +250,394 @@ void MpvNativeTexturePlugin::HandleMethodCall(
     }
   }
 
+  if (method == "startTrace") {
+    trace::Start();
+    result->Success();
+    return;
+  }
+
+  if (method == "stopTrace") {
+    std::string path;
+    if (auto v = GetArg(a, "path")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) path = *s;
+    }
+    if (path.empty()) {
+      result->Error("bad_args", "Missing path");
+      return;
+    }
+    std::string err;
+    if (!trace::StopAndWrite(path, &err)) {
+      result->Error("trace_failed", err);
+      return;
+    }
+    result->Success();
+    return;
+  }
+
+  if (method == "createPreview") {
+    std::string path;
+    PreviewEngine::Config config;
+    if (auto v = GetArg(a, "path")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) path = *s;
+    }
+    if (path.empty()) {
+      result->Error("bad_args", "Missing path");
+      return;
+    }
+    if (auto v = GetArg(a, "width")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.width = *i;
+    }
+    if (auto v = GetArg(a, "height")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.height = *i;
+    }
+    if (auto v = GetArg(a, "quantum")) {
+      if (const auto* d = std::get_if<double>(&*v)) config.quantum = *d;
+    }
+    if (auto v = GetArg(a, "cacheEntries")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.cache_entries = static_cast<size_t>(std::max(1, *i));
+    }
+    auto preview = std::make_unique<PreviewEngine>(texture_registrar_, path, config);
+    const int64_t id = preview->texture_id();
+    previews_[id] = std::move(preview);
+    result->Success(flutter::EncodableValue(id));
+    return;
+  }
+
+  if (method == "previewAt" || method == "disposePreview" || method == "getPreviewStats") {
+    int64_t preview_id = -1;
+    if (auto v = GetArg(a, "previewId")) {
+      if (const auto* p = std::get_if<int64_t>(&*v)) preview_id = *p;
+      if (const auto* p32 = std::get_if<int32_t>(&*v)) preview_id = static_cast<int64_t>(*p32);
+    }
+    auto preview_it = previews_.find(preview_id);
+    if (preview_it == previews_.end()) {
+      result->Error("not_found", "Unknown previewId");
+      return;
+    }
+    PreviewEngine* preview = preview_it->second.get();
+
+    if (method == "disposePreview") {
+      previews_.erase(preview_it);
+      result->Success();
+      return;
+    }
+
+    if (method == "getPreviewStats") {
+      using flutter::EncodableValue;
+      const PreviewEngine::Snapshot snap = preview->TakeSnapshot();
+      result->Success(EncodableValue(flutter::EncodableMap{
+          {EncodableValue("hits"), EncodableValue(static_cast<int64_t>(snap.hits))},
+          {EncodableValue("misses"), EncodableValue(static_cast<int64_t>(snap.misses))},
+          {EncodableValue("superseded"), EncodableValue(static_cast<int64_t>(snap.superseded))},
+          {EncodableValue("entries"), EncodableValue(static_cast<int64_t>(snap.entries))},
+          {EncodableValue("decode"), SummaryToValue(snap.decode)},
+      }));
+      return;
+    }
+
+    double seconds = 0.0;
+    if (auto v = GetArg(a, "seconds")) {
+      if (const auto* d = std::get_if<double>(&*v)) seconds = *d;
+      if (const auto* i = std::get_if<int32_t>(&*v)) seconds = static_cast<double>(*i);
+    }
+    // Cache hits complete right here; misses on the preview worker.
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> pending(std::move(result));
+    preview->Request(seconds, [this, pending](PreviewEngine::Result r) {
+      task_runner_->PostTask([pending, r = std::move(r)]() mutable {
+        if (!r.ok && !r.superseded) {
+          pending->Error("preview_failed", r.error);
+          return;
+        }
+        using flutter::EncodableValue;
+        pending->Success(EncodableValue(flutter::EncodableMap{
+            {EncodableValue("superseded"), EncodableValue(r.superseded)},
+            {EncodableValue("cached"), EncodableValue(r.cached)},
+            {EncodableValue("time"), EncodableValue(r.time)},
+            {EncodableValue("latencyUs"), EncodableValue(r.latency_us)},
+        }));
+      });
+    });
+    return;
+  }
+
+  if (method == "generateSpriteSheets") {
+    std::vector<std::string> paths;
+    if (auto v = GetArg(a, "paths")) {
+      if (const auto* list = std::get_if<flutter::EncodableList>(&*v)) {
+        for (const auto& item : *list) {
+          if (const auto* s = std::get_if<std::string>(&item)) paths.push_back(*s);
+        }
+      }
+    }
+    SpriteSheetBatch::Options options;
+    if (auto v = GetArg(a, "count")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.count = *i;
+    }
+    if (auto v = GetArg(a, "tileWidth")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.tile_width = *i;
+    }
+    if (auto v = GetArg(a, "tileHeight")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.tile_height = *i;
+    }
+    if (auto v = GetArg(a, "columns")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.columns = *i;
+    }
+    if (auto v = GetArg(a, "workers")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.workers = *i;
+    }
+    if (auto v = GetArg(a, "format")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) {
+        if (!ParseImageFormat(*s, &options.format) || options.format == ImageFormat::kRaw) {
+          result->Error("bad_args", "Sprite sheet format must be jpeg or png");
+          return;
+        }
+      }
+    }
+    if (auto v = GetArg(a, "quality")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.jpeg_quality = *i;
+    }
+    if (auto v = GetArg(a, "cacheDir")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) options.cache_dir = *s;
+    }
+
+    for (auto batch_it = sprite_batches_.begin(); batch_it != sprite_batches_.end();) {
+      batch_it = batch_it->second->finished() ? sprite_batches_.erase(batch_it) : std::next(batch_it);
+    }
+
+    using flutter::EncodableValue;
+    const int64_t batch_id = next_batch_id_++;
+    const auto sheet_to_map = [](const SpriteSheetBatch::Sheet& sheet) {
+      return flutter::EncodableMap{
+          {EncodableValue("source"), EncodableValue(sheet.source)},
+          {EncodableValue("ok"), EncodableValue(sheet.ok)},
+          {EncodableValue("cached"), EncodableValue(sheet.cached)},
+          {EncodableValue("error"), EncodableValue(sheet.error)},
+          {EncodableValue("imagePath"), EncodableValue(sheet.image_path)},
+          {EncodableValue("indexPath"), EncodableValue(sheet.index_path)},
+          {EncodableValue("count"), EncodableValue(sheet.count)},
+          {EncodableValue("columns"), EncodableValue(sheet.columns)},
+          {EncodableValue("rows"), EncodableValue(sheet.rows)},
+          {EncodableValue("elapsedUs"), EncodableValue(sheet.elapsed_us)},
+      };
+    };
+    // Replies with the batch id right away; per-file progress and the final
+    // summary arrive as "spriteSheet" / "spriteSheetsDone" events.
+    auto progress = [this, batch_id, sheet_to_map](const SpriteSheetBatch::Sheet& sheet, size_t done, size_t total) {
+      flutter::EncodableMap event = sheet_to_map(sheet);
+      event[EncodableValue("type")] = EncodableValue("spriteSheet");
+      event[EncodableValue("batchId")] = EncodableValue(batch_id);
+      event[EncodableValue("done")] = EncodableValue(static_cast<int64_t>(done));
+      event[EncodableValue("total")] = EncodableValue(static_cast<int64_t>(total));
+      PostEvent(std::move(event));
+    };
+    auto done = [this, batch_id, sheet_to_map](SpriteSheetBatch::Summary summary) {
+      flutter::EncodableList sheets;
+      for (const auto& sheet : summary.sheets) sheets.emplace_back(sheet_to_map(sheet));
+      PostEvent(flutter::EncodableMap{
+          {EncodableValue("type"), EncodableValue("spriteSheetsDone")},
+          {EncodableValue("batchId"), EncodableValue(batch_id)},
+          {EncodableValue("sheets"), EncodableValue(std::move(sheets))},
+          {EncodableValue("workers"), EncodableValue(summary.workers)},
+          {EncodableValue("elapsedUs"), EncodableValue(summary.elapsed_us)},
+          {EncodableValue("filesPerMinute"), EncodableValue(summary.files_per_minute)},
+      });
+    };
+    sprite_batches_[batch_id] =
+        std::make_unique<SpriteSheetBatch>(std::move(paths), options, std::move(progress), std::move(done));
+    result->Success(EncodableValue(batch_id));
+    return;
+  }
+
+  if (method == "cancelSpriteSheets") {
+    int64_t batch_id = -1;
+    if (auto v = GetArg(a, "batchId")) {
+      if (const auto* p = std::get_if<int64_t>(&*v)) batch_id = *p;
+      if (const auto* p32 = std::get_if<int32_t>(&*v)) batch_id = static_cast<int64_t>(*p32);
+    }
+    // Destroying the batch cancels it; pending files complete as "Cancelled".
+    sprite_batches_.erase(batch_id);
+    result->Success();
+    return;
+  }
+
+  if (method == "probeMedia") {
+    std::vector<std::string> paths;
+    if (auto v = GetArg(a, "paths")) {
+      if (const auto* list = std::get_if<flutter::EncodableList>(&*v)) {
+        for (const auto& item : *list) {
+          if (const auto* s = std::get_if<std::string>(&item)) paths.push_back(*s);
+        }
+      }
+    }
+    MediaProbeBatch::Options options;
+    if (auto v = GetArg(a, "workers")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.workers = *i;
+    }
+    if (auto v = GetArg(a, "videoParams")) {
+      if (const auto* b = std::get_if<bool>(&*v)) options.video_params = *b;
+    }
+    if (auto v = GetArg(a, "timeoutMs")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.timeout_ms = *i;
+    }
+    std::string index_path;
+    if (auto v = GetArg(a, "indexPath")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) index_path = *s;
+    }
+    if (index_path.empty()) {
+      std::error_code ec;
+      index_path = (std::filesystem::temp_directory_path(ec) / "mpv_native_texture_probe.idx").u8string();
+    }
+    // Running batches keep the previous index alive until they finish.
+    if (!probe_index_ || probe_index_->path() != index_path) {
+      auto index = std::make_shared<ProbeIndex>();
+      std::string err;
+      if (!index->Open(index_path, &err)) {
+        result->Error("index_failed", err);
+        return;
+      }
+      probe_index_ = std::move(index);
+    }
+
+    for (auto batch_it = probe_batches_.begin(); batch_it != probe_batches_.end();) {
+      batch_it = batch_it->second->finished() ? probe_batches_.erase(batch_it) : std::next(batch_it);
+    }
+
+    using flutter::EncodableValue;
+    const int64_t batch_id = next_batch_id_++;
+    // Replies with the batch id right away; results stream as "mediaProbe"
+    // events, followed by one "mediaProbeDone".
+    auto progress = [this, batch_id](const MediaProbeBatch::Result& r, size_t done, size_t total) {
+      PostEvent(flutter::EncodableMap{
+          {EncodableValue("type"), EncodableValue("mediaProbe")},
+          {EncodableValue("batchId"), EncodableValue(batch_id)},
+          {EncodableValue("path"), EncodableValue(r.path)},
+          {EncodableValue("ok"), EncodableValue(r.ok)},
+          {EncodableValue("cached"), EncodableValue(r.cached)},
+          {EncodableValue("error"), EncodableValue(r.error)},
+          {EncodableValue("info"), EncodableValue(MediaInfoToMap(r.info))},
+          {EncodableValue("elapsedUs"), EncodableValue(r.elapsed_us)},
+          {EncodableValue("done"), EncodableValue(static_cast<int64_t>(done))},
+          {EncodableValue("total"), EncodableValue(static_cast<int64_t>(total))},
+      });
+    };
+    std::shared_ptr<ProbeIndex> index = probe_index_;
+    auto done = [this, batch_id, index](MediaProbeBatch::Summary summary) {
+      const ProbeIndex::Stats stats = index->TakeStats();
+      PostEvent(flutter::EncodableMap{
+          {EncodableValue("type"), EncodableValue("mediaProbeDone")},
+          {EncodableValue("batchId"), EncodableValue(batch_id)},
+          {EncodableValue("total"), EncodableValue(static_cast<int64_t>(summary.total))},
+          {EncodableValue("probed"), EncodableValue(static_cast<int64_t>(summary.probed))},
+          {EncodableValue("cached"), EncodableValue(static_cast<int64_t>(summary.cached))},
+          {EncodableValue("failed"), EncodableValue(static_cast<int64_t>(summary.failed))},
+          {EncodableValue("workers"), EncodableValue(summary.workers)},
+          {EncodableValue("elapsedUs"), EncodableValue(summary.elapsed_us)},
+          {EncodableValue("filesPerSecond"), EncodableValue(summary.files_per_second)},
+          {EncodableValue("probe"), SummaryToValue(summary.probe)},
+          {EncodableValue("indexRecords"), EncodableValue(static_cast<int64_t>(stats.records))},
+          {EncodableValue("indexBytes"), EncodableValue(static_cast<int64_t>(stats.bytes))},
+      });
+    };
+    probe_batches_[batch_id] =
+        std::make_unique<MediaProbeBatch>(std::move(paths), index, options, std::move(progress), std::move(done));
+    result->Success(EncodableValue(batch_id));
+    return;
+  }
+
+  if (method == "cancelProbe") {
+    int64_t batch_id = -1;
+    if (auto v = GetArg(a, "batchId")) {
+      if (const auto* p = std::get_if<int64_t>(&*v)) batch_id = *p;
+      if (const auto* p32 = std::get_if<int32_t>(&*v)) batch_id = static_cast<int64_t>(*p32);
+    }
+    // Destroying the batch cancels it; remaining files report "Cancelled".
+    probe_batches_.erase(batch_id);
+    result->Success();
+    return;
+  }
+
+  if (method == "configureDiskCache") {
+    bool enabled = true;
+    DiskCacheStore::Options options;
+    if (auto v = GetArg(a, "enabled")) {
+      if (const auto* b = std::get_if<bool>(&*v)) enabled = *b;
+    }
+    if (auto v = GetArg(a, "directory")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) options.directory = *s;
+    }
+    const auto get_bytes = [&a](const char* key, uint64_t* out) {
+      if (auto v = GetArg(a, key)) {
+        if (const auto* i = std::get_if<int32_t>(&*v)) *out = static_cast<uint64_t>(std::max(0, *i));
+        if (const auto* p = std::get_if<int64_t>(&*v)) *out = static_cast<uint64_t>(std::max<int64_t>(0, *p));
+      }
+    };
+    get_bytes("maxBytes", &options.max_bytes);
+    get_bytes("maxFileBytes", &options.max_file_bytes);
+    // Players finish recordings into the store they started with.
+    disk_cache_ = enabled ? std::make_shared<DiskCacheStore>(options) : nullptr;
+    for (auto& [id, p] : players_) p->SetDiskCache(disk_cache_);
+    result->Success();
+    return;
+  }
+
+  if (method == "getDiskCacheStats") {
+    if (!disk_cache_) {
+      result->Success();
+      return;
+    }
+    using flutter::EncodableValue;
+    const DiskCacheStore::Stats stats = disk_cache_->TakeStats();
+    const uint64_t lookups = stats.hits + stats.misses;
+    result->Success(EncodableValue(flutter::EncodableMap{
+        {EncodableValue("directory"), EncodableValue(disk_cache_->options().directory)},
+        {EncodableValue("hits"), EncodableValue(static_cast<int64_t>(stats.hits))},
+        {EncodableValue("misses"), EncodableValue(static_cast<int64_t>(stats.misses))},
+        {EncodableValue("hitRate"),
+         EncodableValue(lookups ? static_cast<double>(stats.hits) / static_cast<double>(lookups) : 0.0)},
+        {EncodableValue("bytesSaved"), EncodableValue(static_cast<int64_t>(stats.bytes_saved))},
+        {EncodableValue("bytesStored"), EncodableValue(static_cast<int64_t>(stats.bytes_stored))},
+        {EncodableValue("evictions"), EncodableValue(static_cast<int64_t>(stats.evictions))},
+        {EncodableValue("storeFailures"), EncodableValue(static_cast<int64_t>(stats.store_failures))},
+        {EncodableValue("entries"), EncodableValue(static_cast<int64_t>(stats.entries))},
+        {EncodableValue("totalBytes"), EncodableValue(static_cast<int64_t>(stats.total_bytes))},
+    }));
+    return;
+  }
+
+  if (method == "getOpenStats") {
+    bool reset = false;
+    if (auto v = GetArg(a, "reset")) {
+      if (const auto* b = std::get_if<bool>(&*v)) reset = *b;
+    }
+    using flutter::EncodableValue;
+    const OpenTimingStats::Snapshot snap = OpenTimingStats::Instance().TakeSnapshot(reset);
+    flutter::EncodableMap create;
+    for (int i = 0; i < CreateTiming::kPhaseCount; ++i) {
+      create[EncodableValue(CreateTiming::PhaseName(static_cast<CreateTiming::Phase>(i)))] =
+          SummaryToValue(snap.create[i]);
+    }
+    create[EncodableValue("total")] = SummaryToValue(snap.create_total);
+    flutter::EncodableMap open;
+    for (int i = OpenTimeline::kOpen + 1; i < OpenTimeline::kPhaseCount; ++i) {
+      open[EncodableValue(OpenTimeline::PhaseName(static_cast<OpenTimeline::Phase>(i)))] =
+          SummaryToValue(snap.open[i]);
+    }
+    open[EncodableValue("total")] = SummaryToValue(snap.open_total);
+    result->Success(EncodableValue(flutter::EncodableMap{
+        {EncodableValue("create"), EncodableValue(std::move(create))},
+        {EncodableValue("open"), EncodableValue(std::move(open))},
+        {EncodableValue("opensCompleted"), EncodableValue(static_cast<int64_t>(snap.opens_completed))},
+        {EncodableValue("opensFailed"), EncodableValue(static_cast<int64_t>(snap.opens_failed))},
+    }));
+    return;
+  }
+
+  if (method == "clearDiskCache") {
+    if (disk_cache_) disk_cache_->Clear();
+    result->Success();
+    return;
+  }
+
   // All other methods require a textureId.
   int64_t tid = -1;
   if (auto v = GetArg(a, "textureId")) {
@@ -158,9 +671,32 @@ void MpvNativeTexturePlugin::HandleMethodCall(
       result->Error("bad_args", "Missing path");
       return;
     }
+    MpvPlayer::OpenOptions options;
+    if (auto v = GetArg(a, "start")) {
+      if (const auto* d = std::get_if<double>(&*v)) options.start = *d;
+      if (const auto* i = std::get_if<int32_t>(&*v)) options.start = static_cast<double>(*i);
+    }
+    if (auto v = GetArg(a, "pause")) {
+      if (const auto* b = std::get_if<bool>(&*v)) options.pause = *b;
+    }
+    if (auto v = GetArg(a, "fastStart")) {
+      if (const auto* b = std::get_if<bool>(&*v)) options.fast_start = *b;
+    }
+    if (auto v = GetArg(a, "benchmark")) {
+      if (const auto* b = std::get_if<bool>(&*v)) options.benchmark = *b;
+    }
+    if (auto v = GetArg(a, "options")) {
+      if (const auto* m = std::get_if<flutter::EncodableMap>(&*v)) {
+        for (const auto& [key, value] : *m) {
+          const auto* name = std::get_if<std::string>(&key);
+          const auto* str = std::get_if<std::string>(&value);
+          if (name && str) options.file_options.emplace_back(*name, *str);
+        }
+      }
+    }
     try {
       std::string err;
-      if (!player->Open(path, &err)) {
+      if (!player->Open(path, options, &err)) {
         result->Error("open_failed", err);
         return;
       }
@@ -175,6 +711,47 @@ void MpvNativeTexturePlugin::HandleMethodCall(
     }
   }
 
+  if (method == "openMosaic") {
+    std::vector<std::string> inputs;
+    int columns = 0;
+    if (auto v = GetArg(a, "inputs")) {
+      if (const auto* list = std::get_if<flutter::EncodableList>(&*v)) {
+        for (const auto& item : *list) {
+          if (const auto* s = std::get_if<std::string>(&item)) inputs.push_back(*s);
+        }
+      }
+    }
+    if (auto v = GetArg(a, "columns")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) columns = *i;
+    }
+    MosaicLayout layout;
+    std::string err;
+    if (!player->OpenMosaic(inputs, columns, &layout, &err)) {
+      result->Error("open_failed", err);
+      return;
+    }
+    result->Success(flutter::EncodableValue(MosaicLayoutToMap(layout)));
+    return;
+  }
+
+  if (method == "swapMosaicInput") {
+    int tile = -1;
+    std::string url;
+    if (auto v = GetArg(a, "tile")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) tile = *i;
+    }
+    if (auto v = GetArg(a, "url")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) url = *s;
+    }
+    std::string err;
+    if (url.empty() || !player->SwapMosaicInput(tile, url, &err)) {
+      result->Error("bad_args", err.empty() ? "Missing url" : err);
+      return;
+    }
+    result->Success();
+    return;
+  }
+
   if (method == "play") {
     player->Play();
     result->Success();
@@ -252,6 +829,407 @@ void MpvNativeTexturePlugin::HandleMethodCall(
     return;
   }
 
+  if (method == "getStats") {
+    bool reset = false;
+    if (auto v = GetArg(a, "reset")) {
+      if (const auto* b = std::get_if<bool>(&*v)) reset = *b;
+    }
+    flutter::EncodableMap stats = StatsToMap(player->GetStats(reset));
+    stats[flutter::EncodableValue("quality")] = flutter::EncodableValue(QualityToMap(player->GetQuality()));
+    stats[flutter::EncodableValue("capture")] = flutter::EncodableValue(CaptureStatsToMap(player->GetCaptureStats()));
+    FrameTap::Snapshot tap;
+    if (player->GetFrameTapStats(&tap)) {
+      using flutter::EncodableValue;
+      stats[EncodableValue("frameTap")] = EncodableValue(flutter::EncodableMap{
+          {EncodableValue("published"), EncodableValue(static_cast<int64_t>(tap.published))},
+          {EncodableValue("acquired"), EncodableValue(static_cast<int64_t>(tap.acquired))},
+          {EncodableValue("overwritten"), EncodableValue(static_cast<int64_t>(tap.overwritten))},
+          {EncodableValue("skipped"), EncodableValue(static_cast<int64_t>(tap.skipped))},
+          {EncodableValue("copy"), SummaryToValue(tap.copy)},
+      });
+    }
+    const FrameHistory::Snapshot cache = player->GetFrameCacheStats();
+    if (cache.enabled) {
+      using flutter::EncodableValue;
+      const uint64_t lookups = cache.hits + cache.misses;
+      stats[EncodableValue("frameCache")] = EncodableValue(flutter::EncodableMap{
+          {EncodableValue("frames"), EncodableValue(static_cast<int64_t>(cache.frames))},
+          {EncodableValue("bytes"), EncodableValue(static_cast<int64_t>(cache.bytes))},
+          {EncodableValue("maxBytes"), EncodableValue(static_cast<int64_t>(cache.max_bytes))},
+          {EncodableValue("position"), EncodableValue(cache.position)},
+          {EncodableValue("hits"), EncodableValue(static_cast<int64_t>(cache.hits))},
+          {EncodableValue("misses"), EncodableValue(static_cast<int64_t>(cache.misses))},
+          {EncodableValue("hitRate"),
+           EncodableValue(lookups ? static_cast<double>(cache.hits) / static_cast<double>(lookups) : 0.0)},
+      });
+    }
+    const TrickPlay::Snapshot trick = player->GetTrickPlayStats();
+    if (trick.active || trick.seeks > 0) {
+      using flutter::EncodableValue;
+      stats[EncodableValue("trickPlay")] = EncodableValue(flutter::EncodableMap{
+          {EncodableValue("active"), EncodableValue(trick.active)},
+          {EncodableValue("rate"), EncodableValue(trick.rate)},
+          {EncodableValue("visualFps"), EncodableValue(trick.visual_fps)},
+          {EncodableValue("seeks"), EncodableValue(static_cast<int64_t>(trick.seeks))},
+          {EncodableValue("coalesced"), EncodableValue(static_cast<int64_t>(trick.coalesced))},
+          {EncodableValue("seek"), SummaryToValue(trick.seek)},
+          {EncodableValue("cpuPercent"), EncodableValue(trick.cpu_percent)},
+      });
+    }
+    const LatencyHistogram::Summary gap = player->GetPlaylistGapStats();
+    if (gap.count > 0) stats[flutter::EncodableValue("playlistGap")] = SummaryToValue(gap);
+    const LatencyHistogram::Summary zap = player->GetZapStats();
+    if (zap.count > 0) stats[flutter::EncodableValue("zap")] = SummaryToValue(zap);
+    result->Success(flutter::EncodableValue(std::move(stats)));
+    return;
+  }
+
+  if (method == "startTrickPlay") {
+    TrickPlay::Config config;
+    if (auto v = GetArg(a, "rate")) {
+      if (const auto* d = std::get_if<double>(&*v)) config.rate = *d;
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.rate = static_cast<double>(*i);
+    }
+    if (auto v = GetArg(a, "visualFps")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.visual_fps = *i;
+    }
+    const TrickPlay::Config applied = player->StartTrickPlay(config);
+    result->Success(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("rate"), flutter::EncodableValue(applied.rate)},
+        {flutter::EncodableValue("visualFps"), flutter::EncodableValue(applied.visual_fps)},
+    }));
+    return;
+  }
+
+  if (method == "stopTrickPlay") {
+    player->StopTrickPlay();
+    result->Success();
+    return;
+  }
+
+  if (method == "setFrameCache") {
+    bool enabled = true;
+    FrameHistory::Config config;
+    if (auto v = GetArg(a, "enabled")) {
+      if (const auto* b = std::get_if<bool>(&*v)) enabled = *b;
+    }
+    if (auto v = GetArg(a, "maxBytes")) {
+      if (const auto* p = std::get_if<int64_t>(&*v)) config.max_bytes = static_cast<size_t>(std::max<int64_t>(0, *p));
+      if (const auto* p32 = std::get_if<int32_t>(&*v)) config.max_bytes = static_cast<size_t>(std::max(0, *p32));
+    }
+    if (auto v = GetArg(a, "downscale")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) {
+        if (*i != 1 && *i != 2 && *i != 4) {
+          result->Error("bad_args", "downscale must be 1, 2 or 4");
+          return;
+        }
+        config.downscale = *i;
+      }
+    }
+    player->SetFrameCache(enabled, config);
+    result->Success();
+    return;
+  }
+
+  if (method == "frameStep") {
+    result->Success(flutter::EncodableValue(player->FrameStep()));
+    return;
+  }
+
+  if (method == "frameBackStep") {
+    result->Success(flutter::EncodableValue(player->FrameBackStep()));
+    return;
+  }
+
+  if (method == "playlistAppend" || method == "playlistInsert" || method == "playlistMove" ||
+      method == "playlistRemove" || method == "playlistPlay") {
+    std::string url;
+    int64_t index = -1;
+    int64_t from = -1;
+    int64_t to = -1;
+    if (auto v = GetArg(a, "url")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) url = *s;
+    }
+    if (auto v = GetArg(a, "index")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) index = *i;
+    }
+    if (auto v = GetArg(a, "from")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) from = *i;
+    }
+    if (auto v = GetArg(a, "to")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) to = *i;
+    }
+    std::string err;
+    bool ok = false;
+    if (method == "playlistAppend") {
+      ok = !url.empty() && player->PlaylistAppend(url, &err);
+    } else if (method == "playlistInsert") {
+      ok = !url.empty() && player->PlaylistInsert(index, url, &err);
+    } else if (method == "playlistMove") {
+      ok = player->PlaylistMove(from, to, &err);
+    } else if (method == "playlistRemove") {
+      ok = player->PlaylistRemove(index, &err);
+    } else {
+      ok = player->PlaylistPlayIndex(index, &err);
+    }
+    if (!ok) {
+      result->Error("playlist_failed", err.empty() ? "Missing url" : err);
+      return;
+    }
+    result->Success();
+    return;
+  }
+
+  if (method == "setStandby") {
+    bool standby = true;
+    if (auto v = GetArg(a, "standby")) {
+      if (const auto* b = std::get_if<bool>(&*v)) standby = *b;
+    }
+    player->SetStandby(standby);
+    result->Success();
+    return;
+  }
+
+  if (method == "playlistNext") {
+    result->Success(flutter::EncodableValue(player->PlaylistNext()));
+    return;
+  }
+
+  if (method == "playlistPrev") {
+    result->Success(flutter::EncodableValue(player->PlaylistPrev()));
+    return;
+  }
+
+  if (method == "addOutput") {
+    int width = 320;
+    int height = 180;
+    int max_fps = 0;
+    if (auto v = GetArg(a, "width")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) width = *i;
+    }
+    if (auto v = GetArg(a, "height")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) height = *i;
+    }
+    if (auto v = GetArg(a, "maxFps")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) max_fps = *i;
+    }
+    std::string err;
+    const int64_t output_id = player->AddOutput(width, height, max_fps, &err);
+    if (output_id < 0) {
+      result->Error("output_failed", err);
+      return;
+    }
+    result->Success(flutter::EncodableValue(output_id));
+    return;
+  }
+
+  if (method == "removeOutput") {
+    int64_t output_id = -1;
+    if (auto v = GetArg(a, "outputId")) {
+      if (const auto* p = std::get_if<int64_t>(&*v)) output_id = *p;
+      if (const auto* p32 = std::get_if<int32_t>(&*v)) output_id = static_cast<int64_t>(*p32);
+    }
+    result->Success(flutter::EncodableValue(player->RemoveOutput(output_id)));
+    return;
+  }
+
+  if (method == "startFrameTap") {
+    FrameTap::Config config;
+    if (auto v = GetArg(a, "maxFps")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.max_fps = *i;
+    }
+    if (auto v = GetArg(a, "width")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.width = *i;
+    }
+    if (auto v = GetArg(a, "height")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.height = *i;
+    }
+    if (auto v = GetArg(a, "slots")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) config.slots = *i;
+    }
+    const uint64_t tap_id = player->StartFrameTap(config);
+    result->Success(flutter::EncodableValue(static_cast<int64_t>(tap_id)));
+    return;
+  }
+
+  if (method == "stopFrameTap") {
+    player->StopFrameTap();
+    result->Success();
+    return;
+  }
+
+  if (method == "captureFrame") {
+    FrameCapturer::Request request;
+    bool from_video = false;
+    if (auto v = GetArg(a, "format")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) {
+        if (!ParseImageFormat(*s, &request.format)) {
+          result->Error("bad_args", "Unknown capture format: " + *s);
+          return;
+        }
+      }
+    }
+    if (auto v = GetArg(a, "source")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) from_video = *s == "video";
+    }
+    if (auto v = GetArg(a, "width")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) request.width = *i;
+    }
+    if (auto v = GetArg(a, "height")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) request.height = *i;
+    }
+    if (auto v = GetArg(a, "quality")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) request.jpeg_quality = *i;
+    }
+    if (auto v = GetArg(a, "path")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) request.path = *s;
+    }
+
+    // Completes on the capture worker; the reply is sent from the platform thread.
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> pending(std::move(result));
+    player->CaptureFrame(request, from_video, [this, pending](FrameCapturer::Result r) {
+      task_runner_->PostTask([pending, r = std::move(r)]() mutable {
+        if (!r.ok) {
+          pending->Error("capture_failed", r.error);
+          return;
+        }
+        using flutter::EncodableValue;
+        flutter::EncodableMap reply{
+            {EncodableValue("width"), EncodableValue(r.width)},
+            {EncodableValue("height"), EncodableValue(r.height)},
+            {EncodableValue("format"), EncodableValue(ImageFormatName(r.format))},
+            {EncodableValue("sourceUs"), EncodableValue(r.source_us)},
+            {EncodableValue("encodeUs"), EncodableValue(r.encode_us)},
+            {EncodableValue("totalUs"), EncodableValue(r.total_us)},
+        };
+        if (r.path.empty()) {
+          reply[EncodableValue("bytes")] = EncodableValue(std::move(r.bytes));
+        } else {
+          reply[EncodableValue("path")] = EncodableValue(r.path);
+        }
+        pending->Success(EncodableValue(std::move(reply)));
+      });
+    });
+    return;
+  }
+
+  if (method == "setAdaptiveQuality") {
+    bool enabled = true;
+    if (auto v = GetArg(a, "enabled")) {
+      if (const auto* b = std::get_if<bool>(&*v)) enabled = *b;
+    }
+    player->SetAdaptiveQuality(enabled);
+    result->Success();
+    return;
+  }
+
+  if (method == "getTelemetry") {
+    result->Success(flutter::EncodableValue(TelemetryToMap(player->GetTelemetry())));
+    return;
+  }
+
+  if (method == "setTelemetryInterval") {
+    int interval_ms = 0;
+    if (auto v = GetArg(a, "intervalMs")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) interval_ms = *i;
+    }
+    player->SetTelemetryInterval(interval_ms);
+    result->Success();
+    return;
+  }
+
+  if (method == "setCacheOptions") {
+    MpvPlayer::CacheOptions options;
+    const auto get_seconds = [&a](const char* key, std::optional<double>* out) {
+      if (auto v = GetArg(a, key)) {
+        if (const auto* d = std::get_if<double>(&*v)) *out = *d;
+        if (const auto* i = std::get_if<int32_t>(&*v)) *out = static_cast<double>(*i);
+      }
+    };
+    const auto get_bytes = [&a](const char* key, std::optional<std::string>* out) {
+      if (auto v = GetArg(a, key)) {
+        if (const auto* s = std::get_if<std::string>(&*v)) *out = *s;
+        if (const auto* i = std::get_if<int32_t>(&*v)) *out = std::to_string(*i);
+        if (const auto* p = std::get_if<int64_t>(&*v)) *out = std::to_string(*p);
+      }
+    };
+    if (auto v = GetArg(a, "cache")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) options.cache = *s;
+    }
+    get_seconds("cacheSecs", &options.cache_secs);
+    get_bytes("demuxerMaxBytes", &options.demuxer_max_bytes);
+    get_bytes("demuxerMaxBackBytes", &options.demuxer_max_back_bytes);
+    get_seconds("demuxerReadaheadSecs", &options.demuxer_readahead_secs);
+    std::string err;
+    if (!player->SetCacheOptions(options, &err)) {
+      result->Error("bad_args", err);
+      return;
+    }
+    result->Success();
+    return;
+  }
+
+  if (method == "getCacheState") {
+    MpvPlayer::CacheState state;
+    if (!player->GetCacheState(&state)) {
+      result->Success();
+      return;
+    }
+    result->Success(flutter::EncodableValue(CacheStateToMap(state)));
+    return;
+  }
+
+  if (method == "setCacheStateInterval") {
+    int interval_ms = 0;
+    if (auto v = GetArg(a, "intervalMs")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) interval_ms = *i;
+    }
+    player->SetCacheStateInterval(interval_ms);
+    result->Success();
+    return;
+  }
+
+  if (method == "setLogLevel") {
+    std::string level = "warn";
+    bool stream = false;
+    int max_per_second = 20;
+    if (auto v = GetArg(a, "level")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) level = *s;
+    }
+    if (auto v = GetArg(a, "stream")) {
+      if (const auto* b = std::get_if<bool>(&*v)) stream = *b;
+    }
+    if (auto v = GetArg(a, "maxPerSecond")) {
+      if (const auto* i = std::get_if<int32_t>(&*v)) max_per_second = *i;
+    }
+    std::string err;
+    if (!player->SetLogLevel(level, stream, max_per_second, &err)) {
+      result->Error("bad_args", err);
+      return;
+    }
+    result->Success();
+    return;
+  }
+
+  if (method == "setVisibility") {
+    std::string visibility;
+    if (auto v = GetArg(a, "visibility")) {
+      if (const auto* s = std::get_if<std::string>(&*v)) visibility = *s;
+    }
+    if (visibility == "hidden") {
+      player->SetVisibility(MpvPlayer::Visibility::kHidden);
+    } else if (visibility == "thumbnail") {
+      player->SetVisibility(MpvPlayer::Visibility::kThumbnail);
+    } else if (visibility == "visible") {
+      player->SetVisibility(MpvPlayer::Visibility::kVisible);
+    } else {
+      result->Error("bad_args", "visibility must be hidden, thumbnail or visible");
+      return;
+    }
+    result->Success();
+    return;
+  }
+
   result->NotImplemented();
 }
 
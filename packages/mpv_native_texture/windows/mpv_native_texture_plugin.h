@@ -1,6 +1,7 @@
 #ifndef FLUTTER_PLUGIN_MPV_NATIVE_TEXTURE_PLUGIN_H_
 #define FLUTTER_PLUGIN_MPV_NATIVE_TEXTURE_PLUGIN_H_
 
+#include <flutter/event_sink.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/texture_registrar.h>
@@ -8,9 +9,16 @@
 #include <map>
 #include <memory>
 
+#include "platform_task_runner.h"
+
 namespace mpv_native_texture {
 
+class DiskCacheStore;
+class MediaProbeBatch;
 class MpvPlayer;
+class PreviewEngine;
+class ProbeIndex;
+class SpriteSheetBatch;
 
 class MpvNativeTexturePlugin : public flutter::Plugin {
  public:
@@ -26,10 +34,28 @@ class MpvNativeTexturePlugin : public flutter::Plugin {
   void HandleMethodCall(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // Thread safe: forwards a player event to the Dart event stream.
+  void PostEvent(flutter::EncodableMap event);
+
   flutter::PluginRegistrarWindows *registrar_ = nullptr;
   flutter::TextureRegistrar *texture_registrar_ = nullptr;
 
+  // Declared before players_ so it outlives them: their threads post events.
+  std::unique_ptr<PlatformTaskRunner> task_runner_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> event_sink_;
+
   std::map<int64_t, std::unique_ptr<MpvPlayer>> players_;
+  // Seek-bar preview engines, keyed by their texture id.
+  std::map<int64_t, std::unique_ptr<PreviewEngine>> previews_;
+  // Running sprite-sheet batches by batch id; finished ones are dropped when
+  // the next batch starts.
+  std::map<int64_t, std::unique_ptr<SpriteSheetBatch>> sprite_batches_;
+  // Media probe batches, same lifetime rules. Batches share the open index.
+  std::shared_ptr<ProbeIndex> probe_index_;
+  std::map<int64_t, std::unique_ptr<MediaProbeBatch>> probe_batches_;
+  int64_t next_batch_id_ = 1;  // sprite-sheet and probe batches
+  // Persistent remote-media cache shared by all players; null when off.
+  std::shared_ptr<DiskCacheStore> disk_cache_;
 };
 
 }  // namespace mpv_native_texture
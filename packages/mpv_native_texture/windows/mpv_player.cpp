@@ -4,28 +4,86 @@
 #include "mpv_player.h"
 
 #include <flutter/texture_registrar.h>
+#include <psapi.h>
 
 #include <algorithm>
 #include <clocale>
 #include <cstdio>
+#include <cstring>
 #include <sstream>
+#include <utility>
 
-// Debug output helper - writes to both OutputDebugString and a file
-static void DebugLog(const char* msg) {
-  OutputDebugStringA(msg);
-  // Also write to a file for crash debugging
-  FILE* f = nullptr;
-  if (fopen_s(&f, "C:\\Users\\User\\Documents\\a\\mpv_debug.log", "a") == 0 && f) {
-    fputs(msg, f);
-    fflush(f);
-    fclose(f);
-  }
-}
+#include "logger.h"
+#include "rgba_util.h"
+#include "trace.h"
+
+// Debug output helper - queued to the buffered plugin log (debugger + file).
+static void DebugLog(const char* msg) { mpv_native_texture::Logger::Instance().Write(msg); }
 
 namespace mpv_native_texture {
 
 static int ClampInt(int v, int lo, int hi) { return std::max(lo, std::min(v, hi)); }
 
+// Level requested from mpv_request_log_messages() until setLogLevel says otherwise.
+static const char kDefaultMpvLogLevel[] = "warn";
+
+// How long a hidden player keeps decoding video before its track is disabled.
+static constexpr std::chrono::seconds kHiddenGracePeriod(3);
+// Minimum spacing between rendered frames in thumbnail mode (~5 fps).
+static constexpr std::chrono::milliseconds kThumbnailFrameInterval(200);
+// Kernel + user CPU time of the whole process.
+static int64_t ProcessCpuMicros() {
+  FILETIME creation, exit, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+  const auto micros = [](const FILETIME& ft) {
+    return static_cast<int64_t>(((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 10);
+  };
+  return micros(kernel) + micros(user);
+}
+
+// Working set peak and current size, and private bytes; zeros on failure.
+static void ProcessMemory(int64_t* peak_working_set, int64_t* working_set, int64_t* private_bytes) {
+  PROCESS_MEMORY_COUNTERS_EX pmc{};
+  pmc.cb = sizeof(pmc);
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
+    pmc = PROCESS_MEMORY_COUNTERS_EX{};
+  }
+  *peak_working_set = static_cast<int64_t>(pmc.PeakWorkingSetSize);
+  *working_set = static_cast<int64_t>(pmc.WorkingSetSize);
+  *private_bytes = static_cast<int64_t>(pmc.PrivateUsage);
+}
+
+// reply_userdata of the time-pos observer that timestamps history frames.
+static constexpr uint64_t kTimePosObserver = 1;
+static constexpr uint64_t kPlaylistObserver = 2;
+// reply_userdata of the on_load hook and of dump-cache requests.
+static constexpr uint64_t kDiskCacheHook = 3;
+static constexpr uint64_t kDiskCacheDump = 4;
+// reply_userdata of the on_preloaded hook that stamps OpenTimeline::kPreloaded.
+static constexpr uint64_t kOpenTimingHook = 5;
+// How often a recording is checked for having the whole file cached.
+static constexpr std::chrono::seconds kRecordingCheckInterval(1);
+
+// OpenOptions::fast_start: start on whatever the first packets give instead
+// of probing deeply, filling the cache or syncing audio first.
+static const std::pair<const char*, const char*> kFastStartOptions[] = {
+    {"cache-pause-initial", "no"},
+    {"demuxer-readahead-secs", "0.5"},
+    {"demuxer-lavf-probesize", "1048576"},
+    {"demuxer-lavf-analyzeduration", "0.5"},
+    {"initial-audio-sync", "no"},
+};
+
+// OpenOptions::benchmark: decode and render as fast as possible, without
+// audio, and end the file at EOF so the run has an end.
+static const std::pair<const char*, const char*> kBenchmarkOptions[] = {
+    {"untimed", "yes"},
+    {"video-sync", "desync"},
+    {"ao", "null"},
+    {"pause", "no"},
+    {"keep-open", "no"},
+};
+
 #ifndef GL_FRAMEBUFFER
 #define GL_FRAMEBUFFER 0x8D40
 #endif
@@ -58,20 +116,22 @@ void* MpvPlayer::GetProcAddress(void* /*ctx*/, const char* name) {
   return reinterpret_cast<void*>(::GetProcAddress(ogl, name));
 }
 
-MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height)
-    : registrar_(registrar), frame_w_(std::max(16, width)), frame_h_(std::max(16, height)) {
+MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height, EventCallback on_event)
+    : registrar_(registrar),
+      on_event_(std::move(on_event)),
+      frame_w_(std::max(16, width)),
+      frame_h_(std::max(16, height)),
+      base_w_(frame_w_),
+      base_h_(frame_h_),
+      transport_(&stats_, frame_w_, frame_h_) {
   DebugLog("[MpvPlayer] Constructor started\n");
-
-  // Allocate texture + pixel buffers.
-  front_rgba_.resize(static_cast<size_t>(frame_w_) * static_cast<size_t>(frame_h_) * 4u, 0);
-  back_rgba_.resize(front_rgba_.size(), 0);
-
-  {
-    std::lock_guard<std::mutex> lock(pixel_mutex_);
-    pixel_buffer_.width = frame_w_;
-    pixel_buffer_.height = frame_h_;
-    pixel_buffer_.buffer = front_rgba_.data();
-  }
+  const auto created_at = SteadyClock::now();
+  auto phase_start = created_at;
+  const auto end_phase = [&](CreateTiming::Phase phase) {
+    const auto now = SteadyClock::now();
+    create_timing_.phase_us[phase] = MicrosBetween(phase_start, now);
+    phase_start = now;
+  };
 
   DebugLog("[MpvPlayer] Creating PixelBufferTexture\n");
 
@@ -91,6 +151,7 @@ MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height
   DebugLog("[MpvPlayer] Registering texture\n");
 
   texture_id_ = registrar_->RegisterTexture(texture_variant_.get());
+  end_phase(CreateTiming::kRegisterTexture);
 
   DebugLog("[MpvPlayer] Texture registered, initializing OpenGL\n");
 
@@ -119,6 +180,7 @@ MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height
     return;
   }
   DebugLog("[MpvPlayer] glx_.Load() succeeded\n");
+  end_phase(CreateTiming::kGlInit);
 
   if (!api_.Load()) {
     init_error_ = "Failed to load mpv-2.dll. Put mpv-2.dll next to Runner.exe or in PATH.";
@@ -127,6 +189,7 @@ MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height
   }
 
   DebugLog("[MpvPlayer] mpv-2.dll loaded successfully\n");
+  end_phase(CreateTiming::kLoadDll);
 
   // Check API version for compatibility
   if (api_.mpv_client_api_version) {
@@ -184,12 +247,28 @@ MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height
   api_.mpv_set_option_string(mpv_, "terminal", "no");
   api_.mpv_set_option_string(mpv_, "msg-level", "all=warn");
 
+  // Playlists: open the next entry while the current one plays, and keep
+  // audio running across items whose formats match.
+  api_.mpv_set_option_string(mpv_, "prefetch-playlist", "yes");
+  api_.mpv_set_option_string(mpv_, "gapless-audio", "weak");
+
+  end_phase(CreateTiming::kMpvCreate);
   int rc = api_.mpv_initialize(mpv_);
   if (rc < 0) {
     FormatMpvError(api_, rc, &init_error_);
     gl_.DoneCurrent();
     return;
   }
+  end_phase(CreateTiming::kMpvInitialize);
+
+  // Route mpv's own diagnostics to the event thread (see HandleLogMessage).
+  api_.mpv_request_log_messages(mpv_, kDefaultMpvLogLevel);
+  api_.mpv_observe_property(mpv_, kTimePosObserver, "time-pos", MPV_FORMAT_DOUBLE);
+  // Either one changing re-reads the whole list (EmitPlaylist).
+  api_.mpv_observe_property(mpv_, kPlaylistObserver, "playlist", MPV_FORMAT_NONE);
+  api_.mpv_observe_property(mpv_, kPlaylistObserver, "playlist-pos", MPV_FORMAT_NONE);
+  // Runs once the stream is open and probed, before decoders are set up.
+  api_.mpv_hook_add(mpv_, kOpenTimingHook, "on_preloaded", 0);
 
   mpv_opengl_init_params gl_init{};
   gl_init.get_proc_address = &MpvPlayer::GetProcAddress;
@@ -217,13 +296,25 @@ MpvPlayer::MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height
   }
 
   gl_.DoneCurrent();
+  end_phase(CreateTiming::kRenderContext);
+  create_timing_.total_us = MicrosBetween(created_at, phase_start);
+  OpenTimingStats::Instance().RecordCreate(create_timing_);
 
   ok_ = true;
+  visibility_cpu_start_us_ = ProcessCpuMicros();
+  visibility_wall_start_ = SteadyClock::now();
   render_thread_ = std::thread(&MpvPlayer::RenderThreadMain, this);
+  event_thread_ = std::thread(&MpvPlayer::EventThreadMain, this);
 }
 
 MpvPlayer::~MpvPlayer() {
   DebugLog("[MpvPlayer] Destructor starting\n");
+
+  // screenshot-raw needs the render thread, so finish captures first.
+  {
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    capturer_.reset();
+  }
   destroying_.store(true);
 
   running_.store(false);
@@ -234,12 +325,28 @@ MpvPlayer::~MpvPlayer() {
   render_cv_.notify_all();
   if (render_thread_.joinable()) render_thread_.join();
   DebugLog("[MpvPlayer] Render thread joined\n");
+  StopFrameTap();
+
+  if (event_thread_.joinable()) {
+    api_.mpv_wakeup(mpv_);
+    event_thread_.join();
+  }
 
   if (registrar_ && texture_id_ >= 0) {
     registrar_->UnregisterTexture(texture_id_);
   }
 
+  std::vector<std::shared_ptr<TextureOutput>> outputs;
+  {
+    std::lock_guard<std::mutex> lock(outputs_mutex_);
+    outputs.swap(outputs_);
+    outputs.insert(outputs.end(), retired_outputs_.begin(), retired_outputs_.end());
+    retired_outputs_.clear();
+  }
+  for (auto& output : outputs) output->Unregister();
+
   if (gl_.MakeCurrent()) {
+    for (auto& output : outputs) output->DestroyGl(glx_);
     DestroyFbo();
     gl_.DoneCurrent();
   }
@@ -259,15 +366,23 @@ MpvPlayer::~MpvPlayer() {
 }
 
 const FlutterDesktopPixelBuffer* MpvPlayer::CopyPixelBuffer(size_t /*width*/, size_t /*height*/) {
+  if (trace::Enabled()) trace::SetThreadName("FlutterRaster");
+  MPV_TRACE_SCOPE("flutter", "CopyPixelBuffer");
   if (destroying_.load()) {
     DebugLog("[MpvPlayer] CopyPixelBuffer called during destruction, returning nullptr\n");
     return nullptr;
   }
-  std::lock_guard<std::mutex> lock(pixel_mutex_);
-  return &pixel_buffer_;
+  SteadyClock::time_point consumed_at;
+  const FlutterDesktopPixelBuffer* buffer = transport_.Acquire(&consumed_at);
+  if (consumed_at != SteadyClock::time_point{} && open_timeline_.Mark(OpenTimeline::kFirstCopy, consumed_at)) {
+    ReportOpen(true, {});
+  }
+  return buffer;
 }
 
 void MpvPlayer::RequestRender() {
+  int64_t none = 0;
+  render_requested_ticks_.compare_exchange_strong(none, SteadyClock::now().time_since_epoch().count());
   {
     std::lock_guard<std::mutex> lk(render_mutex_);
     needs_render_.store(true);
@@ -307,16 +422,9 @@ bool MpvPlayer::EnsureFbo(int w, int h, std::string* err_out) {
     return false;
   }
 
-  // Resize buffers.
-  front_rgba_.assign(static_cast<size_t>(frame_w_) * static_cast<size_t>(frame_h_) * 4u, 0);
-  back_rgba_.assign(front_rgba_.size(), 0);
-
-  {
-    std::lock_guard<std::mutex> lock(pixel_mutex_);
-    pixel_buffer_.width = frame_w_;
-    pixel_buffer_.height = frame_h_;
-    pixel_buffer_.buffer = front_rgba_.data();
-  }
+  // Also runs mid-playback when the quality governor changes the render
+  // resolution.
+  transport_.Resize(frame_w_, frame_h_);
 
   return true;
 }
@@ -333,6 +441,10 @@ void MpvPlayer::DestroyFbo() {
 }
 
 bool MpvPlayer::Open(const std::string& path_or_url, std::string* err_out) {
+  return Open(path_or_url, OpenOptions{}, err_out);
+}
+
+bool MpvPlayer::Open(const std::string& path_or_url, const OpenOptions& options, std::string* err_out) {
   DebugLog("[MpvPlayer::Open] Called\n");
 
   if (!ok_ || !mpv_) {
@@ -340,21 +452,286 @@ bool MpvPlayer::Open(const std::string& path_or_url, std::string* err_out) {
     return false;
   }
 
+  history_.Clear();
+  transport_.DropFrame();
+  {
+    std::lock_guard<std::mutex> lock(mosaic_mutex_);
+    if (mosaic_active_) {
+      mosaic_active_ = false;
+      mosaic_attach_pending_ = false;
+      mosaic_swaps_.clear();
+      const char* empty = "";
+      api_.mpv_set_property(mpv_, "lavfi-complex", MPV_FORMAT_STRING, &empty);
+    }
+  }
+
   DebugLog("[MpvPlayer::Open] Sending loadfile command\n");
+  loading_.store(true);
+  open_timeline_.Begin(SteadyClock::now());
+
+  // Named arguments: the position of loadfile's options argument changed
+  // between mpv releases.
+  std::vector<std::pair<std::string, std::string>> file_options;
+  if (options.fast_start) {
+    for (const auto& [name, value] : kFastStartOptions) file_options.emplace_back(name, value);
+  }
+  if (options.start) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6f", *options.start);
+    file_options.emplace_back("start", buf);
+  }
+  if (options.pause) file_options.emplace_back("pause", *options.pause ? "yes" : "no");
+  file_options.insert(file_options.end(), options.file_options.begin(), options.file_options.end());
+  if (options.benchmark) {
+    for (const auto& [name, value] : kBenchmarkOptions) file_options.emplace_back(name, value);
+  }
+
+  std::vector<char*> option_keys;
+  std::vector<mpv_node> option_values(file_options.size());
+  for (size_t i = 0; i < file_options.size(); ++i) {
+    option_keys.push_back(const_cast<char*>(file_options[i].first.c_str()));
+    option_values[i].format = MPV_FORMAT_STRING;
+    option_values[i].u.string = const_cast<char*>(file_options[i].second.c_str());
+  }
+  mpv_node_list option_list{};
+  option_list.num = static_cast<int>(file_options.size());
+  option_list.keys = option_keys.data();
+  option_list.values = option_values.data();
+
+  const char* keys[] = {"name", "url", "flags", "options"};
+  const char* strings[] = {"loadfile", path_or_url.c_str(), "replace"};
+  mpv_node values[4]{};
+  for (int i = 0; i < 3; ++i) {
+    values[i].format = MPV_FORMAT_STRING;
+    values[i].u.string = const_cast<char*>(strings[i]);
+  }
+  values[3].format = MPV_FORMAT_NODE_MAP;
+  values[3].u.list = &option_list;
+  mpv_node_list args{};
+  args.num = file_options.empty() ? 3 : 4;
+  args.keys = const_cast<char**>(keys);
+  args.values = values;
+  mpv_node cmd{};
+  cmd.format = MPV_FORMAT_NODE_MAP;
+  cmd.u.list = &args;
+
+  if (options.benchmark) {
+    // Baseline before loadfile: the first frame can be rendered before the
+    // event thread gets to FILE_LOADED.
+    stats_.TakeSnapshot(true);
+    std::lock_guard<std::mutex> lock(benchmark_mutex_);
+    benchmark_next_.counters = stats_.counters();
+    benchmark_next_.cpu_us = ProcessCpuMicros();
+    benchmark_next_.issued = SteadyClock::now();
+    benchmark_first_frame_ticks_.store(-1);
+  }
+  benchmark_pending_.store(options.benchmark);
+
+  const int rc = api_.mpv_command_node(mpv_, &cmd, nullptr);
+  if (rc < 0) {
+    // No END_FILE follows a rejected loadfile; undo what was set up above.
+    std::string msg;
+    FormatMpvError(api_, rc, &msg);
+    loading_.store(false);
+    benchmark_pending_.store(false);
+    benchmark_first_frame_ticks_.store(0);
+    if (open_timeline_.Fail()) ReportOpen(false, msg);
+    if (err_out) *err_out = msg;
+    return false;
+  }
+
+  RequestRender();
+  return true;
+}
+
+bool MpvPlayer::OpenMosaic(const std::vector<std::string>& inputs, int columns, MosaicLayout* layout_out,
+                           std::string* err_out) {
+  if (!ok_ || !mpv_) {
+    if (err_out) *err_out = init_error_.empty() ? "Player not initialized" : init_error_;
+    return false;
+  }
+  if (inputs.empty() || inputs.size() > 25) {
+    if (err_out) *err_out = "A mosaic needs 1 to 25 inputs";
+    return false;
+  }
+  history_.Clear();
+  transport_.DropFrame();
 
-  const char* cmd[] = {"loadfile", path_or_url.c_str(), nullptr};
+  const MosaicLayout layout = ComputeMosaicLayout(static_cast<int>(inputs.size()), base_w_, base_h_, columns);
+  {
+    std::lock_guard<std::mutex> lock(mosaic_mutex_);
+    mosaic_active_ = true;
+    mosaic_attach_pending_ = true;
+    mosaic_layout_ = layout;
+    mosaic_inputs_ = inputs;
+    mosaic_tracks_.assign(inputs.size(), -1);
+    mosaic_swaps_.clear();
+    const char* empty = "";
+    api_.mpv_set_property(mpv_, "lavfi-complex", MPV_FORMAT_STRING, &empty);
+  }
+
+  // The blank main file only provides the timeline; FILE_LOADED then attaches
+  // the real inputs (AttachMosaicInputs).
+  const std::string blank = "av://lavfi:color=c=black:s=" + std::to_string(layout.width) + "x" +
+                            std::to_string(layout.height) + ":r=25";
+  const char* cmd[] = {"loadfile", blank.c_str(), nullptr};
   const int rc = api_.mpv_command(mpv_, cmd);
   if (rc < 0) {
     FormatMpvError(api_, rc, err_out);
+    std::lock_guard<std::mutex> lock(mosaic_mutex_);
+    mosaic_active_ = false;
+    mosaic_attach_pending_ = false;
     return false;
   }
-
+  if (layout_out) *layout_out = layout;
   RequestRender();
   return true;
 }
 
+bool MpvPlayer::SwapMosaicInput(int tile, const std::string& url, std::string* err_out) {
+  {
+    std::lock_guard<std::mutex> lock(mosaic_mutex_);
+    if (!mosaic_active_) {
+      if (err_out) *err_out = "Not in mosaic mode";
+      return false;
+    }
+    if (tile < 0 || static_cast<size_t>(tile) >= mosaic_inputs_.size()) {
+      if (err_out) *err_out = "Tile index out of range";
+      return false;
+    }
+    mosaic_swaps_.emplace_back(tile, url);
+  }
+  api_.mpv_wakeup(mpv_);
+  return true;
+}
+
+int64_t MpvPlayer::AddVideoTrack(const std::string& url, std::string* err_out) {
+  const char* cmd[] = {"video-add", url.c_str(), "auto", nullptr};
+  const int rc = api_.mpv_command(mpv_, cmd);
+  if (rc < 0) {
+    FormatMpvError(api_, rc, err_out);
+    return -1;
+  }
+  // video-add appends the new track to track-list.
+  int64_t count = 0;
+  int64_t id = -1;
+  if (api_.mpv_get_property(mpv_, "track-list/count", MPV_FORMAT_INT64, &count) < 0 || count <= 0) return -1;
+  const std::string key = "track-list/" + std::to_string(count - 1) + "/id";
+  if (api_.mpv_get_property(mpv_, key.c_str(), MPV_FORMAT_INT64, &id) < 0) return -1;
+  return id;
+}
+
+bool MpvPlayer::SetMosaicGraph(const MosaicLayout& layout, const std::vector<int64_t>& tracks,
+                               std::string* err_out) {
+  const std::string graph = BuildMosaicGraph(layout, tracks);
+  const char* value = graph.c_str();
+  const int rc = api_.mpv_set_property(mpv_, "lavfi-complex", MPV_FORMAT_STRING, &value);
+  if (rc < 0) {
+    FormatMpvError(api_, rc, err_out);
+    return false;
+  }
+  return true;
+}
+
+void MpvPlayer::AttachMosaicInputs() {
+  MosaicLayout layout;
+  std::vector<std::string> inputs;
+  {
+    std::lock_guard<std::mutex> lock(mosaic_mutex_);
+    if (!mosaic_attach_pending_) return;
+    mosaic_attach_pending_ = false;
+    layout = mosaic_layout_;
+    inputs = mosaic_inputs_;
+  }
+
+  // Inputs that fail to open stay black instead of failing the whole wall.
+  std::vector<int64_t> tracks(inputs.size(), -1);
+  flutter::EncodableList errors;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::string err;
+    tracks[i] = AddVideoTrack(inputs[i], &err);
+    if (tracks[i] < 0) {
+      DebugLog(("[MpvPlayer] Mosaic input " + std::to_string(i) + " failed: " + err + "\n").c_str());
+      errors.emplace_back(flutter::EncodableMap{
+          {flutter::EncodableValue("tile"), flutter::EncodableValue(static_cast<int32_t>(i))},
+          {flutter::EncodableValue("error"), flutter::EncodableValue(err)},
+      });
+    }
+  }
+
+  std::string err;
+  const bool ok = SetMosaicGraph(layout, tracks, &err);
+  {
+    std::lock_guard<std::mutex> lock(mosaic_mutex_);
+    mosaic_tracks_ = tracks;
+  }
+  EmitEvent(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue("mosaic")},
+      {flutter::EncodableValue("ok"), flutter::EncodableValue(ok)},
+      {flutter::EncodableValue("error"), flutter::EncodableValue(err)},
+      {flutter::EncodableValue("failedInputs"), flutter::EncodableValue(std::move(errors))},
+  });
+}
+
+void MpvPlayer::ProcessMosaicSwaps() {
+  for (;;) {
+    std::pair<int, std::string> swap;
+    MosaicLayout layout;
+    std::vector<int64_t> tracks;
+    {
+      std::lock_guard<std::mutex> lock(mosaic_mutex_);
+      // Swaps wait until the initial tracks are attached.
+      if (mosaic_swaps_.empty() || mosaic_attach_pending_) return;
+      swap = std::move(mosaic_swaps_.front());
+      mosaic_swaps_.pop_front();
+      layout = mosaic_layout_;
+      tracks = mosaic_tracks_;
+    }
+    const size_t tile = static_cast<size_t>(swap.first);
+
+    // Add the new track first and only drop the old one once the graph uses
+    // the replacement, so the other tiles keep playing throughout.
+    std::string err;
+    const int64_t old_track = tracks[tile];
+    const int64_t new_track = AddVideoTrack(swap.second, &err);
+    bool ok = new_track > 0;
+    if (ok) {
+      tracks[tile] = new_track;
+      ok = SetMosaicGraph(layout, tracks, &err);
+      const int64_t drop = ok ? old_track : new_track;
+      if (drop > 0) {
+        const std::string id = std::to_string(drop);
+        const char* cmd[] = {"video-remove", id.c_str(), nullptr};
+        api_.mpv_command(mpv_, cmd);
+      }
+    }
+    if (ok) {
+      std::lock_guard<std::mutex> lock(mosaic_mutex_);
+      if (tile < mosaic_tracks_.size()) {
+        mosaic_tracks_[tile] = new_track;
+        mosaic_inputs_[tile] = swap.second;
+      }
+    }
+    EmitEvent(flutter::EncodableMap{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("mosaicSwap")},
+        {flutter::EncodableValue("tile"), flutter::EncodableValue(swap.first)},
+        {flutter::EncodableValue("url"), flutter::EncodableValue(swap.second)},
+        {flutter::EncodableValue("ok"), flutter::EncodableValue(ok)},
+        {flutter::EncodableValue("error"), flutter::EncodableValue(err)},
+    });
+  }
+}
+
 void MpvPlayer::Play() {
   if (!ok_ || !mpv_) return;
+  StopTrickPlay("stopped", false);
+  // mpv is still parked on the live frame; resume from the cached one shown.
+  if (const std::optional<double> pts = history_.StopBrowsing()) {
+    char buf[64] = {0};
+    std::snprintf(buf, sizeof(buf), "%0.6f", *pts);
+    const char* cmd[] = {"seek", buf, "absolute+exact", nullptr};
+    api_.mpv_command(mpv_, cmd);
+  }
   int flag = 0;
   api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
   RequestRender();
@@ -362,6 +739,7 @@ void MpvPlayer::Play() {
 
 void MpvPlayer::Pause() {
   if (!ok_ || !mpv_) return;
+  StopTrickPlay("stopped", false);
   int flag = 1;
   api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
   RequestRender();
@@ -369,6 +747,7 @@ void MpvPlayer::Pause() {
 
 void MpvPlayer::SeekRelative(double seconds) {
   if (!ok_ || !mpv_) return;
+  history_.Clear();
   char buf[64] = {0};
   std::snprintf(buf, sizeof(buf), "%0.3f", seconds);
   const char* cmd[] = {"seek", buf, "relative", nullptr};
@@ -413,6 +792,7 @@ double MpvPlayer::GetDuration() {
 
 void MpvPlayer::SeekAbsolute(double seconds) {
   if (!ok_ || !mpv_) return;
+  history_.Clear();
   api_.mpv_set_property(mpv_, "time-pos", MPV_FORMAT_DOUBLE, &seconds);
   RequestRender();
 }
@@ -421,9 +801,1235 @@ void MpvPlayer::SetSpeed(double speed) {
   if (!ok_ || !mpv_) return;
   speed = std::max(0.1, std::min(4.0, speed));
   api_.mpv_set_property(mpv_, "speed", MPV_FORMAT_DOUBLE, &speed);
+  UpdateFrameBudget();
+}
+
+void MpvPlayer::SetFrameCache(bool enabled, const FrameHistory::Config& config) {
+  history_.Configure(enabled, config);
+  RequestRender();
+}
+
+bool MpvPlayer::FrameStep() {
+  if (!ok_ || !mpv_) return false;
+  FrameHistory::Frame frame;
+  if (history_.StepForward(&frame)) {
+    ShowHistoryFrame(&frame);
+    // Back at live: let the render thread republish at full resolution.
+    if (!history_.browsing()) RequestRender();
+    return true;
+  }
+  const char* cmd[] = {"frame-step", nullptr};
+  api_.mpv_command(mpv_, cmd);
+  RequestRender();
+  return false;
+}
+
+bool MpvPlayer::FrameBackStep() {
+  if (!ok_ || !mpv_) return false;
+  FrameHistory::Frame frame;
+  if (history_.StepBack(&frame)) {
+    int flag = 1;
+    api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
+    ShowHistoryFrame(&frame);
+    return true;
+  }
+  // Miss: mpv seeks to the previous keyframe and decodes forward. The history
+  // restarts from the frame it lands on.
+  history_.Clear();
+  const char* cmd[] = {"frame-back-step", nullptr};
+  api_.mpv_command(mpv_, cmd);
+  RequestRender();
+  return false;
+}
+
+FrameHistory::Snapshot MpvPlayer::GetFrameCacheStats() const { return history_.TakeSnapshot(); }
+
+TrickPlay::Config MpvPlayer::StartTrickPlay(const TrickPlay::Config& config) {
+  if (!ok_ || !mpv_) return {};
+  std::lock_guard<std::mutex> lock(trick_mutex_);
+  const auto now = SteadyClock::now();
+  double position = 0.0;
+  if (!trick_.active()) {
+    api_.mpv_get_property(mpv_, "time-pos", MPV_FORMAT_DOUBLE, &position);
+    int pause = 1;
+    int mute = 1;
+    trick_resume_ = api_.mpv_get_property(mpv_, "pause", MPV_FORMAT_FLAG, &pause) >= 0 && !pause;
+    trick_unmute_ = api_.mpv_get_property(mpv_, "mute", MPV_FORMAT_FLAG, &mute) >= 0 && !mute;
+    int flag = 1;
+    api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
+    api_.mpv_set_property(mpv_, "mute", MPV_FORMAT_FLAG, &flag);
+    history_.Clear();
+    trick_cpu_start_us_ = ProcessCpuMicros();
+    trick_started_ = now;
+  }
+  const TrickPlay::Config applied = trick_.Start(config, position, now);
+  EmitEvent(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue("trickPlay")},
+      {flutter::EncodableValue("active"), flutter::EncodableValue(true)},
+      {flutter::EncodableValue("rate"), flutter::EncodableValue(applied.rate)},
+      {flutter::EncodableValue("visualFps"), flutter::EncodableValue(applied.visual_fps)},
+  });
+  // The event thread drives the seeks.
+  api_.mpv_wakeup(mpv_);
+  return applied;
+}
+
+void MpvPlayer::StopTrickPlay(const char* reason, bool restore_pause) {
+  if (!ok_ || !mpv_) return;
+  std::lock_guard<std::mutex> lock(trick_mutex_);
+  if (!trick_.Stop()) return;
+  const int64_t wall_us = MicrosBetween(trick_started_, SteadyClock::now());
+  if (wall_us > 0) {
+    trick_cpu_percent_ =
+        static_cast<double>(ProcessCpuMicros() - trick_cpu_start_us_) * 100.0 / static_cast<double>(wall_us);
+  }
+  int flag = 0;
+  if (trick_unmute_) api_.mpv_set_property(mpv_, "mute", MPV_FORMAT_FLAG, &flag);
+  if (trick_resume_ && restore_pause) api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
+  EmitEvent(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue("trickPlay")},
+      {flutter::EncodableValue("active"), flutter::EncodableValue(false)},
+      {flutter::EncodableValue("reason"), flutter::EncodableValue(reason)},
+  });
+}
+
+TrickPlay::Snapshot MpvPlayer::GetTrickPlayStats() {
+  TrickPlay::Snapshot snap = trick_.TakeSnapshot();
+  std::lock_guard<std::mutex> lock(trick_mutex_);
+  snap.cpu_percent = trick_cpu_percent_;
+  if (snap.active) {
+    const int64_t wall_us = MicrosBetween(trick_started_, SteadyClock::now());
+    if (wall_us > 0) {
+      snap.cpu_percent =
+          static_cast<double>(ProcessCpuMicros() - trick_cpu_start_us_) * 100.0 / static_cast<double>(wall_us);
+    }
+  }
+  return snap;
+}
+
+bool MpvPlayer::PlaylistCommand(const char* const* cmd, std::string* err_out) {
+  if (!ok_ || !mpv_) {
+    if (err_out) *err_out = init_error_.empty() ? "Player not initialized" : init_error_;
+    return false;
+  }
+  const int rc = api_.mpv_command(mpv_, cmd);
+  if (rc < 0) {
+    FormatMpvError(api_, rc, err_out);
+    return false;
+  }
+  RequestRender();
+  return true;
+}
+
+bool MpvPlayer::PlaylistAppend(const std::string& url, std::string* err_out) {
+  // append-play starts it right away when nothing is playing.
+  const char* cmd[] = {"loadfile", url.c_str(), "append-play", nullptr};
+  return PlaylistCommand(cmd, err_out);
+}
+
+bool MpvPlayer::PlaylistInsert(int64_t index, const std::string& url, std::string* err_out) {
+  // Append and move into place: loadfile insert-at needs mpv 0.38.
+  if (!PlaylistAppend(url, err_out)) return false;
+  int64_t count = 0;
+  api_.mpv_get_property(mpv_, "playlist-count", MPV_FORMAT_INT64, &count);
+  if (index < 0 || index >= count - 1) return true;
+  return PlaylistMove(count - 1, index, err_out);
+}
+
+bool MpvPlayer::PlaylistMove(int64_t from, int64_t to, std::string* err_out) {
+  // playlist-move puts |from| in front of the entry at |to|; moving down
+  // therefore targets the slot after it.
+  const std::string from_s = std::to_string(from);
+  const std::string to_s = std::to_string(to > from ? to + 1 : to);
+  const char* cmd[] = {"playlist-move", from_s.c_str(), to_s.c_str(), nullptr};
+  return PlaylistCommand(cmd, err_out);
+}
+
+bool MpvPlayer::PlaylistRemove(int64_t index, std::string* err_out) {
+  const std::string index_s = std::to_string(index);
+  const char* cmd[] = {"playlist-remove", index_s.c_str(), nullptr};
+  return PlaylistCommand(cmd, err_out);
+}
+
+bool MpvPlayer::PlaylistPlayIndex(int64_t index, std::string* err_out) {
+  if (!ok_ || !mpv_) {
+    if (err_out) *err_out = init_error_.empty() ? "Player not initialized" : init_error_;
+    return false;
+  }
+  history_.Clear();
+  const int rc = api_.mpv_set_property(mpv_, "playlist-pos", MPV_FORMAT_INT64, &index);
+  if (rc < 0) {
+    FormatMpvError(api_, rc, err_out);
+    return false;
+  }
+  RequestRender();
+  return true;
+}
+
+bool MpvPlayer::PlaylistNext() {
+  const char* cmd[] = {"playlist-next", "weak", nullptr};
+  return PlaylistCommand(cmd, nullptr);
+}
+
+bool MpvPlayer::PlaylistPrev() {
+  const char* cmd[] = {"playlist-prev", "weak", nullptr};
+  return PlaylistCommand(cmd, nullptr);
+}
+
+void MpvPlayer::ReportBenchmark(const mpv_event_end_file* end) {
+  using flutter::EncodableValue;
+  benchmark_active_ = false;
+  const PipelineStats::Counters now = stats_.counters();
+  const PipelineStats::Counters& start = benchmark_run_.counters;
+  const uint64_t rendered = now.frames_rendered - start.frames_rendered;
+  const uint64_t published = now.frames_published - start.frames_published;
+  // From the first new frame to the last: END_FILE can trail the last one by
+  // the decoder drain. CPU is charged from loadfile, open included.
+  const auto until = rendered > 0 ? SteadyClock::time_point(SteadyClock::duration(last_frame_ticks_.load()))
+                                  : SteadyClock::now();
+  const int64_t first_ticks = benchmark_first_frame_ticks_.load();
+  const auto started =
+      first_ticks > 0 ? SteadyClock::time_point(SteadyClock::duration(first_ticks)) : benchmark_run_.issued;
+  const int64_t elapsed_us = std::max<int64_t>(1, MicrosBetween(started, until));
+  const double seconds = static_cast<double>(elapsed_us) / 1e6;
+  const int64_t cpu_wall_us = std::max<int64_t>(1, MicrosBetween(benchmark_run_.issued, until));
+  const double cpu_percent =
+      static_cast<double>(ProcessCpuMicros() - benchmark_run_.cpu_us) * 100.0 / static_cast<double>(cpu_wall_us);
+  int64_t peak_working_set = 0, working_set = 0, private_bytes = 0;
+  ProcessMemory(&peak_working_set, &working_set, &private_bytes);
+
+  const bool ok = end && end->reason == MPV_END_FILE_REASON_EOF;
+  flutter::EncodableMap event{
+      {EncodableValue("type"), EncodableValue("benchmark")},
+      {EncodableValue("ok"), EncodableValue(ok)},
+      {EncodableValue("width"), EncodableValue(base_w_)},
+      {EncodableValue("height"), EncodableValue(base_h_)},
+      {EncodableValue("elapsedUs"), EncodableValue(elapsed_us)},
+      {EncodableValue("framesRendered"), EncodableValue(static_cast<int64_t>(rendered))},
+      {EncodableValue("framesPublished"), EncodableValue(static_cast<int64_t>(published))},
+      {EncodableValue("framesConsumed"),
+       EncodableValue(static_cast<int64_t>(now.frames_consumed - start.frames_consumed))},
+      {EncodableValue("framesDropped"),
+       EncodableValue(static_cast<int64_t>(now.frames_dropped - start.frames_dropped))},
+      {EncodableValue("renderFps"), EncodableValue(static_cast<double>(rendered) / seconds)},
+      {EncodableValue("publishFps"), EncodableValue(static_cast<double>(published) / seconds)},
+      {EncodableValue("cpuPercent"), EncodableValue(cpu_percent)},
+      {EncodableValue("peakWorkingSetBytes"), EncodableValue(peak_working_set)},
+      {EncodableValue("workingSetBytes"), EncodableValue(working_set)},
+      {EncodableValue("privateBytes"), EncodableValue(private_bytes)},
+  };
+  if (!ok) {
+    std::string msg = "interrupted";
+    if (end && end->reason == MPV_END_FILE_REASON_ERROR) FormatMpvError(api_, end->error, &msg);
+    event[EncodableValue("error")] = EncodableValue(msg);
+  }
+  EmitEvent(std::move(event));
+}
+
+void MpvPlayer::ReportOpen(bool ok, const std::string& error) {
+  using flutter::EncodableValue;
+  const auto offsets = open_timeline_.Offsets();
+  flutter::EncodableMap phases;
+  for (int i = OpenTimeline::kOpen + 1; i < OpenTimeline::kPhaseCount; ++i) {
+    if (offsets[i] < 0) continue;
+    phases[EncodableValue(OpenTimeline::PhaseName(static_cast<OpenTimeline::Phase>(i)))] = EncodableValue(offsets[i]);
+  }
+  flutter::EncodableMap event{
+      {EncodableValue("type"), EncodableValue("opened")},
+      {EncodableValue("ok"), EncodableValue(ok)},
+      {EncodableValue("phasesUs"), EncodableValue(std::move(phases))},
+  };
+  if (ok) {
+    event[EncodableValue("totalUs")] = EncodableValue(offsets[OpenTimeline::kFirstCopy]);
+    OpenTimingStats::Instance().RecordOpen(offsets);
+  } else {
+    event[EncodableValue("error")] = EncodableValue(error);
+    OpenTimingStats::Instance().CountFailedOpen();
+  }
+  if (!create_reported_.exchange(true)) {
+    flutter::EncodableMap create;
+    for (int i = 0; i < CreateTiming::kPhaseCount; ++i) {
+      create[EncodableValue(CreateTiming::PhaseName(static_cast<CreateTiming::Phase>(i)))] =
+          EncodableValue(create_timing_.phase_us[i]);
+    }
+    create[EncodableValue("total")] = EncodableValue(create_timing_.total_us);
+    event[EncodableValue("createUs")] = EncodableValue(std::move(create));
+  }
+  EmitEvent(std::move(event));
+}
+
+void MpvPlayer::EmitPlaylist() {
+  mpv_node playlist{};
+  if (api_.mpv_get_property(mpv_, "playlist", MPV_FORMAT_NODE, &playlist) < 0) return;
+  using flutter::EncodableValue;
+  flutter::EncodableList entries;
+  int64_t pos = -1;
+  if (playlist.format == MPV_FORMAT_NODE_ARRAY && playlist.u.list) {
+    for (int i = 0; i < playlist.u.list->num; ++i) {
+      const mpv_node& entry = playlist.u.list->values[i];
+      std::string filename;
+      std::string title;
+      bool current = false;
+      if (entry.format == MPV_FORMAT_NODE_MAP && entry.u.list) {
+        for (int k = 0; k < entry.u.list->num; ++k) {
+          const char* key = entry.u.list->keys[k];
+          const mpv_node& value = entry.u.list->values[k];
+          if (value.format == MPV_FORMAT_STRING && std::strcmp(key, "filename") == 0) filename = value.u.string;
+          if (value.format == MPV_FORMAT_STRING && std::strcmp(key, "title") == 0) title = value.u.string;
+          if (value.format == MPV_FORMAT_FLAG && std::strcmp(key, "current") == 0) current = value.u.flag != 0;
+        }
+      }
+      if (current) pos = i;
+      entries.emplace_back(flutter::EncodableMap{
+          {EncodableValue("filename"), EncodableValue(filename)},
+          {EncodableValue("title"), EncodableValue(title)},
+      });
+    }
+  }
+  api_.mpv_free_node_contents(&playlist);
+  EmitEvent(flutter::EncodableMap{
+      {EncodableValue("type"), EncodableValue("playlist")},
+      {EncodableValue("pos"), EncodableValue(pos)},
+      {EncodableValue("entries"), EncodableValue(std::move(entries))},
+  });
+}
+
+void MpvPlayer::PollTrickPlay(double* timeout) {
+  if (!trick_.active()) return;
+  const auto now = SteadyClock::now();
+  SteadyClock::time_point next = now;
+  double target = 0.0;
+  if (trick_.Poll(now, &target, &next)) {
+    // Absolute keyframe seeks while paused: only the keyframe landed on is
+    // decoded, and its snapping error does not carry into the next target.
+    char buf[64] = {0};
+    std::snprintf(buf, sizeof(buf), "%0.3f", target);
+    const char* cmd[] = {"seek", buf, "absolute+keyframes", nullptr};
+    api_.mpv_command(mpv_, cmd);
+  }
+  const double wait = std::max(0.0, std::chrono::duration<double>(next - now).count());
+  *timeout = *timeout < 0 ? wait : std::min(*timeout, wait);
+}
+
+void MpvPlayer::CheckTrickPlayBounds() {
+  const double rate = trick_.rate();
+  double pos = 0.0;
+  if (rate == 0.0 || api_.mpv_get_property(mpv_, "time-pos", MPV_FORMAT_DOUBLE, &pos) < 0) return;
+  if (rate < 0 && pos <= 0.05) {
+    StopTrickPlay("start");
+    return;
+  }
+  double duration = 0.0;
+  if (rate > 0 && api_.mpv_get_property(mpv_, "duration", MPV_FORMAT_DOUBLE, &duration) >= 0 && duration > 0 &&
+      pos >= duration - 0.5) {
+    StopTrickPlay("end");
+  }
+}
+
+void MpvPlayer::ShowHistoryFrame(FrameHistory::Frame* frame) {
+  transport_.ShowStill(&frame->pixels, frame->width, frame->height);
+  registrar_->MarkTextureFrameAvailable(texture_id_);
+}
+
+void MpvPlayer::CaptureFrame(const FrameCapturer::Request& request, bool from_video, FrameCapturer::Done done) {
+  if (!ok_ || !mpv_) {
+    FrameCapturer::Result result;
+    result.error = init_error_.empty() ? "Player not initialized" : init_error_;
+    done(std::move(result));
+    return;
+  }
+  std::lock_guard<std::mutex> lock(capture_mutex_);
+  if (!capturer_) capturer_ = std::make_unique<FrameCapturer>();
+  FrameCapturer::Source source;
+  if (from_video) {
+    source = [this](RgbaImage* image, std::string* err_out) { return ScreenshotRaw(image, err_out); };
+  } else {
+    source = [this](RgbaImage* image, std::string* err_out) { return CopyPublishedFrame(image, err_out); };
+  }
+  capturer_->Submit(request, std::move(source), std::move(done));
+}
+
+FrameCapturer::Snapshot MpvPlayer::GetCaptureStats() {
+  std::lock_guard<std::mutex> lock(capture_mutex_);
+  return capturer_ ? capturer_->TakeSnapshot() : FrameCapturer::Snapshot{};
+}
+
+bool MpvPlayer::CopyPublishedFrame(RgbaImage* image, std::string* err_out) {
+  // The only part of a capture that can delay the render thread: publishing
+  // waits on the transport's lock for the length of this copy.
+  if (!transport_.CopyFront(&image->pixels, &image->width, &image->height)) {
+    if (err_out) *err_out = "No frame published yet";
+    return false;
+  }
+  return true;
+}
+
+bool MpvPlayer::ScreenshotRaw(RgbaImage* image, std::string* err_out) {
+  const char* args[] = {"screenshot-raw", "video", nullptr};
+  mpv_node cmd{};
+  std::vector<mpv_node> items(2);
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].format = MPV_FORMAT_STRING;
+    items[i].u.string = const_cast<char*>(args[i]);
+  }
+  mpv_node_list list{};
+  list.num = static_cast<int>(items.size());
+  list.values = items.data();
+  cmd.format = MPV_FORMAT_NODE_ARRAY;
+  cmd.u.list = &list;
+
+  mpv_node res{};
+  const int rc = api_.mpv_command_node(mpv_, &cmd, &res);
+  if (rc < 0) {
+    FormatMpvError(api_, rc, err_out);
+    return false;
+  }
+
+  int64_t w = 0, h = 0, stride = 0;
+  std::string format;
+  const mpv_byte_array* data = nullptr;
+  if (res.format == MPV_FORMAT_NODE_MAP) {
+    for (int i = 0; i < res.u.list->num; ++i) {
+      const std::string key = res.u.list->keys[i];
+      const mpv_node& v = res.u.list->values[i];
+      if (key == "w" && v.format == MPV_FORMAT_INT64) w = v.u.int64;
+      if (key == "h" && v.format == MPV_FORMAT_INT64) h = v.u.int64;
+      if (key == "stride" && v.format == MPV_FORMAT_INT64) stride = v.u.int64;
+      if (key == "format" && v.format == MPV_FORMAT_STRING) format = v.u.string;
+      if (key == "data" && v.format == MPV_FORMAT_BYTE_ARRAY) data = v.u.ba;
+    }
+  }
+
+  // mpv hands out packed 32-bit BGR0/BGRA (or RGB0/RGBA on some builds).
+  const bool bgr = format == "bgr0" || format == "bgra";
+  const bool rgb = format == "rgb0" || format == "rgba";
+  bool ok = false;
+  if (data && w > 0 && h > 0 && stride >= w * 4 && (bgr || rgb) &&
+      data->size >= static_cast<size_t>(stride) * static_cast<size_t>(h)) {
+    image->width = static_cast<int>(w);
+    image->height = static_cast<int>(h);
+    image->pixels.resize(static_cast<size_t>(w) * static_cast<size_t>(h) * 4u);
+    PackedToRgba(static_cast<const uint8_t*>(data->data), static_cast<size_t>(stride), image->width, image->height,
+                 bgr, image->pixels.data());
+    ok = true;
+  } else if (err_out) {
+    *err_out = "Unexpected screenshot-raw result (format '" + format + "')";
+  }
+  api_.mpv_free_node_contents(&res);
+  return ok;
+}
+
+int64_t MpvPlayer::AddOutput(int width, int height, int max_fps, std::string* err_out) {
+  if (!ok_) {
+    if (err_out) *err_out = init_error_.empty() ? "Player not initialized" : init_error_;
+    return -1;
+  }
+  if (!glx_.glBlitFramebuffer) {
+    if (err_out) *err_out = "Extra outputs need glBlitFramebuffer (OpenGL 3.0)";
+    return -1;
+  }
+  auto output = std::make_shared<TextureOutput>(registrar_, width, height, max_fps);
+  const int64_t id = output->texture_id();
+  {
+    std::lock_guard<std::mutex> lock(outputs_mutex_);
+    outputs_.push_back(std::move(output));
+  }
+  // A hidden player may have dropped its video track; the output needs it.
+  ResumeVideoTrack();
+  RequestRender();
+  return id;
+}
+
+bool MpvPlayer::RemoveOutput(int64_t texture_id) {
+  std::shared_ptr<TextureOutput> output;
+  {
+    std::lock_guard<std::mutex> lock(outputs_mutex_);
+    auto it = std::find_if(outputs_.begin(), outputs_.end(),
+                           [&](const auto& o) { return o->texture_id() == texture_id; });
+    if (it == outputs_.end()) return false;
+    output = *it;
+    outputs_.erase(it);
+    retired_outputs_.push_back(output);
+  }
+  output->Unregister();
+  // Without outputs a hidden player may suspend its video track again.
+  if (mpv_) api_.mpv_wakeup(mpv_);
+  RequestRender();
+  return true;
+}
+
+bool MpvPlayer::HasOutputs() {
+  std::lock_guard<std::mutex> lock(outputs_mutex_);
+  return !outputs_.empty();
+}
+
+uint64_t MpvPlayer::StartFrameTap(const FrameTap::Config& config) {
+  std::shared_ptr<FrameTap> tap = FrameTap::Create(config);
+  std::shared_ptr<FrameTap> previous;
+  {
+    std::lock_guard<std::mutex> lock(tap_mutex_);
+    previous = std::exchange(frame_tap_, tap);
+  }
+  if (previous) previous->Close();
+  return tap->id();
+}
+
+void MpvPlayer::StopFrameTap() {
+  std::shared_ptr<FrameTap> previous;
+  {
+    std::lock_guard<std::mutex> lock(tap_mutex_);
+    previous = std::move(frame_tap_);
+  }
+  if (previous) previous->Close();
+}
+
+bool MpvPlayer::GetFrameTapStats(FrameTap::Snapshot* out) {
+  std::lock_guard<std::mutex> lock(tap_mutex_);
+  if (!frame_tap_) return false;
+  *out = frame_tap_->TakeSnapshot();
+  return true;
+}
+
+void MpvPlayer::SetAdaptiveQuality(bool enabled) {
+  if (!ok_ || !mpv_) return;
+  governor_.SetEnabled(enabled);
+  // The governor returns to full quality on the next rendered frame.
+  RequestRender();
+}
+
+void MpvPlayer::UpdateFrameBudget() {
+  double fps = 0.0;
+  if (api_.mpv_get_property(mpv_, "container-fps", MPV_FORMAT_DOUBLE, &fps) < 0 || fps <= 0.0) {
+    if (api_.mpv_get_property(mpv_, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &fps) < 0 || fps <= 0.0) return;
+  }
+  double speed = 1.0;
+  if (api_.mpv_get_property(mpv_, "speed", MPV_FORMAT_DOUBLE, &speed) < 0 || speed <= 0.0) speed = 1.0;
+  frame_budget_us_.store(static_cast<int64_t>(1e6 / (fps * speed)));
+}
+
+void MpvPlayer::OnQualityLevelChanged(QualityGovernor::Level level) {
+  DebugLog((std::string("[MpvPlayer] Quality level -> ") + QualityGovernor::LevelName(level) + "\n").c_str());
+  // Resolution and fps cap are picked up by the render loop itself.
+  quality_options_dirty_.store(true);
+  api_.mpv_wakeup(mpv_);
+}
+
+void MpvPlayer::ApplyQualityOptions() {
+  const auto get_string = [&](const char* name, std::string* out) {
+    char* value = nullptr;
+    if (api_.mpv_get_property(mpv_, name, MPV_FORMAT_STRING, &value) < 0 || !value) return;
+    *out = value;
+    api_.mpv_free(value);
+  };
+  const auto set_string = [&](const char* name, const std::string& value) {
+    if (value.empty()) return;
+    const char* v = value.c_str();
+    api_.mpv_set_property(mpv_, name, MPV_FORMAT_STRING, &v);
+  };
+
+  // The first change happens before anything was touched, so this captures
+  // the configured values to restore later.
+  if (!quality_defaults_saved_) {
+    get_string("interpolation", &default_interpolation_);
+    get_string("scale", &default_scale_);
+    get_string("cscale", &default_cscale_);
+    get_string("dscale", &default_dscale_);
+    quality_defaults_saved_ = true;
+  }
+
+  const QualityGovernor::Snapshot quality = governor_.TakeSnapshot();
+  const bool bilinear = quality.level >= QualityGovernor::kBilinearScaling;
+  set_string("interpolation", quality.level >= QualityGovernor::kNoInterpolation ? "no" : default_interpolation_);
+  set_string("scale", bilinear ? "bilinear" : default_scale_);
+  set_string("cscale", bilinear ? "bilinear" : default_cscale_);
+  set_string("dscale", bilinear ? "bilinear" : default_dscale_);
+
+  EmitEvent(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue("quality")},
+      {flutter::EncodableValue("level"), flutter::EncodableValue(QualityGovernor::LevelName(quality.level))},
+      {flutter::EncodableValue("load"), flutter::EncodableValue(quality.load)},
+  });
+}
+
+PipelineStats::Snapshot MpvPlayer::GetStats(bool reset) {
+  PipelineStats::Snapshot snap = stats_.TakeSnapshot(reset);
+  if (ok_ && mpv_) {
+    int64_t v = 0;
+    if (api_.mpv_get_property(mpv_, "frame-drop-count", MPV_FORMAT_INT64, &v) >= 0) {
+      snap.mpv_frame_drops = v;
+    }
+    if (api_.mpv_get_property(mpv_, "decoder-frame-drop-count", MPV_FORMAT_INT64, &v) >= 0) {
+      snap.mpv_decoder_frame_drops = v;
+    }
+  }
+  return snap;
+}
+
+MpvPlayer::Telemetry MpvPlayer::GetTelemetry() {
+  const PipelineStats::Counters c = stats_.counters();
+  Telemetry t;
+  t.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       SteadyClock::now().time_since_epoch())
+                       .count();
+  t.frames_rendered = c.frames_rendered;
+  t.frames_published = c.frames_published;
+  t.frames_consumed = c.frames_consumed;
+  t.frames_overwritten = c.frames_dropped;
+  if (!ok_ || !mpv_) return t;
+
+  int64_t i = 0;
+  if (api_.mpv_get_property(mpv_, "frame-drop-count", MPV_FORMAT_INT64, &i) >= 0) t.mpv_frame_drops = i;
+  if (api_.mpv_get_property(mpv_, "decoder-frame-drop-count", MPV_FORMAT_INT64, &i) >= 0) {
+    t.mpv_decoder_frame_drops = i;
+  }
+  if (api_.mpv_get_property(mpv_, "vo-delayed-frame-count", MPV_FORMAT_INT64, &i) >= 0) {
+    t.mpv_vo_delayed_frames = i;
+  }
+  double d = 0.0;
+  if (api_.mpv_get_property(mpv_, "avsync", MPV_FORMAT_DOUBLE, &d) >= 0) t.avsync = d;
+  if (api_.mpv_get_property(mpv_, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &d) >= 0) t.estimated_vf_fps = d;
+  t.process_cpu_us = ProcessCpuMicros();
+  {
+    std::lock_guard<std::mutex> lock(visibility_cpu_mutex_);
+    t.hidden_cpu_percent = hidden_cpu_percent_;
+    t.shown_cpu_percent = shown_cpu_percent_;
+  }
+  return t;
+}
+
+void MpvPlayer::SetTelemetryInterval(int interval_ms) {
+  if (!ok_ || !mpv_) return;
+  telemetry_interval_ms_.store(std::max(0, interval_ms));
+  // Let the event thread pick up the new wait timeout.
+  api_.mpv_wakeup(mpv_);
+}
+
+bool MpvPlayer::SetCacheOptions(const CacheOptions& options, std::string* err_out) {
+  if (!ok_ || !mpv_) {
+    if (err_out) *err_out = init_error_.empty() ? "Player not initialized" : init_error_;
+    return false;
+  }
+  const auto set = [this, err_out](const char* name, const std::string& value) {
+    const char* s = value.c_str();
+    const int rc = api_.mpv_set_property(mpv_, name, MPV_FORMAT_STRING, &s);
+    if (rc < 0) {
+      FormatMpvError(api_, rc, err_out);
+      if (err_out) *err_out = std::string(name) + ": " + *err_out;
+      return false;
+    }
+    return true;
+  };
+  const auto seconds = [](double v) {
+    char buf[32] = {0};
+    std::snprintf(buf, sizeof(buf), "%0.3f", std::max(0.0, v));
+    return std::string(buf);
+  };
+
+  if (options.cache && !set("cache", *options.cache)) return false;
+  if (options.cache_secs && !set("cache-secs", seconds(*options.cache_secs))) return false;
+  if (options.demuxer_readahead_secs && !set("demuxer-readahead-secs", seconds(*options.demuxer_readahead_secs))) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(standby_mutex_);
+  if (standby_.load()) {
+    // Standby keeps its own small limits; these apply on leaving it.
+    if (options.demuxer_max_bytes) standby_saved_max_bytes_ = *options.demuxer_max_bytes;
+    if (options.demuxer_max_back_bytes) standby_saved_back_bytes_ = *options.demuxer_max_back_bytes;
+    return true;
+  }
+  if (options.demuxer_max_bytes && !set("demuxer-max-bytes", *options.demuxer_max_bytes)) return false;
+  if (options.demuxer_max_back_bytes && !set("demuxer-max-back-bytes", *options.demuxer_max_back_bytes)) {
+    return false;
+  }
+  return true;
+}
+
+bool MpvPlayer::GetCacheState(CacheState* out) {
+  if (!ok_ || !mpv_) return false;
+  mpv_node node{};
+  if (api_.mpv_get_property(mpv_, "demuxer-cache-state", MPV_FORMAT_NODE, &node) < 0) return false;
+  CacheState state;
+  if (node.format == MPV_FORMAT_NODE_MAP && node.u.list) {
+    const auto as_double = [](const mpv_node& v) {
+      if (v.format == MPV_FORMAT_DOUBLE) return v.u.double_;
+      if (v.format == MPV_FORMAT_INT64) return static_cast<double>(v.u.int64);
+      return 0.0;
+    };
+    const auto as_int = [](const mpv_node& v) {
+      if (v.format == MPV_FORMAT_INT64) return v.u.int64;
+      if (v.format == MPV_FORMAT_DOUBLE) return static_cast<int64_t>(v.u.double_);
+      return int64_t{0};
+    };
+    const auto as_flag = [](const mpv_node& v) { return v.format == MPV_FORMAT_FLAG && v.u.flag != 0; };
+    for (int i = 0; i < node.u.list->num; ++i) {
+      const std::string key = node.u.list->keys[i];
+      const mpv_node& v = node.u.list->values[i];
+      if (key == "seekable-ranges" && v.format == MPV_FORMAT_NODE_ARRAY && v.u.list) {
+        for (int r = 0; r < v.u.list->num; ++r) {
+          const mpv_node& range = v.u.list->values[r];
+          if (range.format != MPV_FORMAT_NODE_MAP || !range.u.list) continue;
+          double start = 0.0;
+          double end = 0.0;
+          for (int k = 0; k < range.u.list->num; ++k) {
+            if (std::strcmp(range.u.list->keys[k], "start") == 0) start = as_double(range.u.list->values[k]);
+            if (std::strcmp(range.u.list->keys[k], "end") == 0) end = as_double(range.u.list->values[k]);
+          }
+          state.seekable_ranges.emplace_back(start, end);
+        }
+      } else if (key == "cache-end") {
+        state.cache_end = as_double(v);
+      } else if (key == "reader-pts") {
+        state.reader_pts = as_double(v);
+      } else if (key == "cache-duration") {
+        state.cache_duration = as_double(v);
+      } else if (key == "fw-bytes") {
+        state.forward_bytes = as_int(v);
+      } else if (key == "total-bytes") {
+        state.total_bytes = as_int(v);
+      } else if (key == "raw-input-rate") {
+        state.raw_input_rate = as_int(v);
+      } else if (key == "eof") {
+        state.eof = as_flag(v);
+      } else if (key == "underrun") {
+        state.underrun = as_flag(v);
+      } else if (key == "idle") {
+        state.idle = as_flag(v);
+      }
+    }
+  }
+  api_.mpv_free_node_contents(&node);
+  *out = std::move(state);
+  return true;
+}
+
+void MpvPlayer::SetCacheStateInterval(int interval_ms) {
+  if (!ok_ || !mpv_) return;
+  cache_state_interval_ms_.store(std::max(0, interval_ms));
+  api_.mpv_wakeup(mpv_);
+}
+
+void MpvPlayer::SetDiskCache(std::shared_ptr<DiskCacheStore> store) {
+  if (!ok_ || !mpv_) return;
+  std::lock_guard<std::mutex> lock(disk_cache_mutex_);
+  disk_cache_ = std::move(store);
+  // Hooks cannot be removed; with no store the handler just continues.
+  if (disk_cache_ && !disk_cache_hooked_) {
+    disk_cache_hooked_ = api_.mpv_hook_add(mpv_, kDiskCacheHook, "on_load", 0) >= 0;
+  }
+}
+
+void MpvPlayer::OnLoadHook() {
+  std::shared_ptr<DiskCacheStore> store;
+  {
+    std::lock_guard<std::mutex> lock(disk_cache_mutex_);
+    store = disk_cache_;
+  }
+  if (!store) return;
+
+  char* path = nullptr;
+  if (api_.mpv_get_property(mpv_, "stream-open-filename", MPV_FORMAT_STRING, &path) < 0 || !path) return;
+  const std::string url = path;
+  api_.mpv_free(path);
+  if (!DiskCacheStore::IsRemote(url)) return;
+
+  const std::string cached = store->Lookup(url);
+  if (!cached.empty()) {
+    DebugLog(("[MpvPlayer] Disk cache hit: " + url + "\n").c_str());
+    const char* s = cached.c_str();
+    api_.mpv_set_property(mpv_, "stream-open-filename", MPV_FORMAT_STRING, &s);
+    return;
+  }
+  if (recording_dump_pending_) return;  // one recording per player at a time
+
+  // Keep everything read, ahead of and behind the reader, on disk until the
+  // file is complete. File-local, so the next file starts from the defaults.
+  const std::string limit = std::to_string(store->options().max_file_bytes);
+  const std::string dir = store->session_dir();
+  const std::pair<const char*, const char*> options[] = {
+      {"file-local-options/cache", "yes"},
+      {"file-local-options/cache-on-disk", "yes"},
+      {"file-local-options/cache-dir", dir.c_str()},
+      {"file-local-options/demuxer-max-bytes", limit.c_str()},
+      {"file-local-options/demuxer-max-back-bytes", limit.c_str()},
+  };
+  for (const auto& [name, value] : options) {
+    const char* v = value;
+    if (api_.mpv_set_property(mpv_, name, MPV_FORMAT_STRING, &v) < 0) {
+      DebugLog((std::string("[MpvPlayer] Disk cache: cannot set ") + name + "\n").c_str());
+    }
+  }
+  recording_store_ = std::move(store);
+  recording_url_ = url;
+  next_recording_check_ = SteadyClock::now() + kRecordingCheckInterval;
+}
+
+void MpvPlayer::PollDiskCache(double* timeout) {
+  if (recording_url_.empty() || recording_dump_pending_) return;
+  const auto now = SteadyClock::now();
+  if (now >= next_recording_check_) {
+    next_recording_check_ = now + kRecordingCheckInterval;
+    CacheState state;
+    if (GetCacheState(&state)) {
+      if (static_cast<uint64_t>(std::max<int64_t>(0, state.total_bytes)) >
+          recording_store_->options().max_file_bytes) {
+        recording_url_.clear();  // too large to keep; streams as usual
+        recording_store_.reset();
+        return;
+      }
+      double start = 0.0;
+      double duration = 0.0;
+      api_.mpv_get_property(mpv_, "start-time", MPV_FORMAT_DOUBLE, &start);
+      // Complete: the demuxer hit EOF and one range spans the whole file.
+      if (state.eof && state.seekable_ranges.size() == 1 &&
+          api_.mpv_get_property(mpv_, "duration", MPV_FORMAT_DOUBLE, &duration) >= 0 && duration > 0 &&
+          state.seekable_ranges[0].first <= start + 1.0 &&
+          state.seekable_ranges[0].second >= start + duration - 1.0) {
+        const std::string part = recording_store_->BeginStore(recording_url_);
+        if (part.empty()) {
+          recording_url_.clear();
+          recording_store_.reset();
+          return;
+        }
+        const char* cmd[] = {"dump-cache", "no", "no", part.c_str(), nullptr};
+        if (api_.mpv_command_async(mpv_, kDiskCacheDump, cmd) < 0) {
+          FinishDiskCacheDump(false);
+          return;
+        }
+        recording_dump_pending_ = true;
+        return;
+      }
+    }
+  }
+  const double wait = std::chrono::duration<double>(next_recording_check_ - now).count();
+  *timeout = *timeout < 0 ? wait : std::min(*timeout, wait);
+}
+
+void MpvPlayer::FinishDiskCacheDump(bool ok) {
+  if (!recording_store_) return;
+  recording_store_->FinishStore(recording_url_, ok);
+  EmitEvent(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue("diskCacheStore")},
+      {flutter::EncodableValue("url"), flutter::EncodableValue(recording_url_)},
+      {flutter::EncodableValue("ok"), flutter::EncodableValue(ok)},
+  });
+  recording_dump_pending_ = false;
+  recording_url_.clear();
+  recording_store_.reset();
+}
+
+flutter::EncodableMap CacheStateToMap(const MpvPlayer::CacheState& c) {
+  using flutter::EncodableValue;
+  flutter::EncodableList ranges;
+  for (const auto& range : c.seekable_ranges) {
+    ranges.emplace_back(flutter::EncodableMap{
+        {EncodableValue("start"), EncodableValue(range.first)},
+        {EncodableValue("end"), EncodableValue(range.second)},
+    });
+  }
+  return flutter::EncodableMap{
+      {EncodableValue("seekableRanges"), EncodableValue(std::move(ranges))},
+      {EncodableValue("cacheEnd"), EncodableValue(c.cache_end)},
+      {EncodableValue("readerPts"), EncodableValue(c.reader_pts)},
+      {EncodableValue("cacheDuration"), EncodableValue(c.cache_duration)},
+      {EncodableValue("forwardBytes"), EncodableValue(c.forward_bytes)},
+      {EncodableValue("totalBytes"), EncodableValue(c.total_bytes)},
+      {EncodableValue("rawInputRate"), EncodableValue(c.raw_input_rate)},
+      {EncodableValue("eof"), EncodableValue(c.eof)},
+      {EncodableValue("underrun"), EncodableValue(c.underrun)},
+      {EncodableValue("idle"), EncodableValue(c.idle)},
+  };
+}
+
+flutter::EncodableMap TelemetryToMap(const MpvPlayer::Telemetry& t) {
+  using flutter::EncodableValue;
+  const auto optional_double = [](const std::optional<double>& v) {
+    return v ? EncodableValue(*v) : EncodableValue();
+  };
+  return flutter::EncodableMap{
+      {EncodableValue("timestampUs"), EncodableValue(t.timestamp_us)},
+      {EncodableValue("framesRendered"), EncodableValue(static_cast<int64_t>(t.frames_rendered))},
+      {EncodableValue("framesPublished"), EncodableValue(static_cast<int64_t>(t.frames_published))},
+      {EncodableValue("framesConsumed"), EncodableValue(static_cast<int64_t>(t.frames_consumed))},
+      {EncodableValue("framesOverwritten"), EncodableValue(static_cast<int64_t>(t.frames_overwritten))},
+      {EncodableValue("mpvFrameDrops"), EncodableValue(t.mpv_frame_drops)},
+      {EncodableValue("mpvDecoderFrameDrops"), EncodableValue(t.mpv_decoder_frame_drops)},
+      {EncodableValue("mpvVoDelayedFrames"), EncodableValue(t.mpv_vo_delayed_frames)},
+      {EncodableValue("avsync"), optional_double(t.avsync)},
+      {EncodableValue("estimatedVfFps"), optional_double(t.estimated_vf_fps)},
+      {EncodableValue("processCpuUs"), EncodableValue(t.process_cpu_us)},
+      {EncodableValue("hiddenCpuPercent"),
+       t.hidden_cpu_percent < 0 ? EncodableValue() : EncodableValue(t.hidden_cpu_percent)},
+      {EncodableValue("shownCpuPercent"),
+       t.shown_cpu_percent < 0 ? EncodableValue() : EncodableValue(t.shown_cpu_percent)},
+  };
+}
+
+void MpvPlayer::SetVisibility(Visibility visibility) {
+  if (!ok_ || !mpv_) return;
+  const int next = static_cast<int>(visibility);
+  const int previous = visibility_.load();
+  if (previous == next) return;
+
+  const bool was_hidden = previous == static_cast<int>(Visibility::kHidden);
+  if (was_hidden != (visibility == Visibility::kHidden)) SampleVisibilityCpu(was_hidden);
+  if (visibility == Visibility::kHidden) {
+    hidden_since_ticks_.store(std::chrono::steady_clock::now().time_since_epoch().count());
+  }
+  visibility_.store(next);
+
+  if (visibility == Visibility::kHidden) {
+    // Let the event thread pick up the grace-period deadline.
+    api_.mpv_wakeup(mpv_);
+  } else {
+    ResumeVideoTrack();
+  }
+  RequestRender();
+}
+
+void MpvPlayer::SampleVisibilityCpu(bool was_hidden) {
+  const int64_t cpu_us = ProcessCpuMicros();
+  const auto now = SteadyClock::now();
+  std::lock_guard<std::mutex> lock(visibility_cpu_mutex_);
+  const int64_t wall_us = MicrosBetween(visibility_wall_start_, now);
+  if (wall_us > 0) {
+    const double percent =
+        static_cast<double>(cpu_us - visibility_cpu_start_us_) * 100.0 / static_cast<double>(wall_us);
+    (was_hidden ? hidden_cpu_percent_ : shown_cpu_percent_) = percent;
+  }
+  visibility_cpu_start_us_ = cpu_us;
+  visibility_wall_start_ = now;
+}
+
+void MpvPlayer::SetStandby(bool standby) {
+  if (!ok_ || !mpv_) return;
+  std::lock_guard<std::mutex> lock(standby_mutex_);
+  if (standby_.load() == standby) return;
+
+  const auto get_string = [this](const char* name) {
+    std::string value;
+    char* s = nullptr;
+    if (api_.mpv_get_property(mpv_, name, MPV_FORMAT_STRING, &s) >= 0 && s) {
+      value = s;
+      api_.mpv_free(s);
+    }
+    return value;
+  };
+
+  if (standby) {
+    StopTrickPlay("standby");
+    int mute = 1;
+    standby_unmute_ = api_.mpv_get_property(mpv_, "mute", MPV_FORMAT_FLAG, &mute) >= 0 && !mute;
+    standby_saved_max_bytes_ = get_string("demuxer-max-bytes");
+    standby_saved_back_bytes_ = get_string("demuxer-max-back-bytes");
+    int flag = 1;
+    api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
+    api_.mpv_set_property(mpv_, "mute", MPV_FORMAT_FLAG, &flag);
+    // Enough for the first keyframe of a typical stream, and little else.
+    const char* max_bytes = "4MiB";
+    const char* back_bytes = "0";
+    api_.mpv_set_property(mpv_, "demuxer-max-bytes", MPV_FORMAT_STRING, &max_bytes);
+    api_.mpv_set_property(mpv_, "demuxer-max-back-bytes", MPV_FORMAT_STRING, &back_bytes);
+    zap_started_ticks_.store(0);
+    standby_.store(true);
+    return;
+  }
+
+  if (!standby_saved_max_bytes_.empty()) {
+    const char* value = standby_saved_max_bytes_.c_str();
+    api_.mpv_set_property(mpv_, "demuxer-max-bytes", MPV_FORMAT_STRING, &value);
+  }
+  if (!standby_saved_back_bytes_.empty()) {
+    const char* value = standby_saved_back_bytes_.c_str();
+    api_.mpv_set_property(mpv_, "demuxer-max-back-bytes", MPV_FORMAT_STRING, &value);
+  }
+  zap_started_ticks_.store(SteadyClock::now().time_since_epoch().count());
+  standby_.store(false);
+  int flag = 0;
+  if (standby_unmute_) api_.mpv_set_property(mpv_, "mute", MPV_FORMAT_FLAG, &flag);
+  api_.mpv_set_property(mpv_, "pause", MPV_FORMAT_FLAG, &flag);
+  RequestRender();
+}
+
+void MpvPlayer::PollHiddenTrack(double* timeout) {
+  if (visibility_.load() != static_cast<int>(Visibility::kHidden) || video_suspended_.load()) return;
+  if (HasOutputs()) return;
+  const auto deadline =
+      SteadyClock::time_point(SteadyClock::duration(hidden_since_ticks_.load())) + kHiddenGracePeriod;
+  const auto now = SteadyClock::now();
+  if (now >= deadline) {
+    SuspendVideoTrack();
+    return;
+  }
+  const double wait = std::chrono::duration<double>(deadline - now).count();
+  *timeout = *timeout < 0 ? wait : std::min(*timeout, wait);
+}
+
+void MpvPlayer::SuspendVideoTrack() {
+  std::lock_guard<std::mutex> lock(vid_mutex_);
+  // Re-check under the lock: SetVisibility or AddOutput may have raced us.
+  if (video_suspended_.load() || visibility_.load() != static_cast<int>(Visibility::kHidden) || HasOutputs()) {
+    return;
+  }
+
+  int64_t vid = -1;
+  if (api_.mpv_get_property(mpv_, "vid", MPV_FORMAT_INT64, &vid) < 0) {
+    vid = -1;
+  }
+  const char* no = "no";
+  if (api_.mpv_set_property(mpv_, "vid", MPV_FORMAT_STRING, &no) < 0) return;
+
+  suspended_vid_ = vid;
+  video_suspended_.store(true);
+  DebugLog("[MpvPlayer] Hidden past grace period, video track suspended\n");
+}
+
+void MpvPlayer::ResumeVideoTrack() {
+  std::lock_guard<std::mutex> lock(vid_mutex_);
+  if (!video_suspended_.load()) return;
+  video_suspended_.store(false);
+
+  if (suspended_vid_ >= 0) {
+    api_.mpv_set_property(mpv_, "vid", MPV_FORMAT_INT64, &suspended_vid_);
+  } else {
+    const char* autosel = "auto";
+    api_.mpv_set_property(mpv_, "vid", MPV_FORMAT_STRING, &autosel);
+  }
+
+  // Re-enabling the track would otherwise decode from the previous keyframe up
+  // to the exact audio position; a keyframe seek gets a fresh frame up fast.
+  double pos = 0.0;
+  if (api_.mpv_get_property(mpv_, "time-pos", MPV_FORMAT_DOUBLE, &pos) >= 0) {
+    char buf[64] = {0};
+    std::snprintf(buf, sizeof(buf), "%0.3f", pos);
+    const char* cmd[] = {"seek", buf, "absolute+keyframes", nullptr};
+    api_.mpv_command(mpv_, cmd);
+  }
+  DebugLog("[MpvPlayer] Visible again, video track resumed\n");
+}
+
+bool MpvPlayer::NextThrottleDeadline(std::chrono::steady_clock::time_point* deadline) const {
+  const auto vis = static_cast<Visibility>(visibility_.load());
+  if (vis == Visibility::kThumbnail && thumbnail_pending_) {
+    *deadline = last_thumbnail_frame_ + kThumbnailFrameInterval;
+    return true;
+  }
+  return false;
+}
+
+void MpvPlayer::EventThreadMain() {
+  trace::SetThreadName("MpvEvents");
+  DebugLog("[MpvPlayer] Event thread started\n");
+
+  while (running_.load()) {
+    double timeout = -1.0;
+    const int telemetry_ms = telemetry_interval_ms_.load();
+    if (telemetry_ms > 0) {
+      const auto now = SteadyClock::now();
+      if (now >= next_telemetry_) {
+        flutter::EncodableMap event = TelemetryToMap(GetTelemetry());
+        event[flutter::EncodableValue("type")] = flutter::EncodableValue("telemetry");
+        EmitEvent(std::move(event));
+        next_telemetry_ = now + std::chrono::milliseconds(telemetry_ms);
+      }
+      timeout = std::chrono::duration<double>(next_telemetry_ - now).count();
+    }
+    const int cache_state_ms = cache_state_interval_ms_.load();
+    if (cache_state_ms > 0) {
+      const auto now = SteadyClock::now();
+      if (now >= next_cache_state_) {
+        CacheState state;
+        if (GetCacheState(&state)) {
+          flutter::EncodableMap event = CacheStateToMap(state);
+          event[flutter::EncodableValue("type")] = flutter::EncodableValue("cacheState");
+          EmitEvent(std::move(event));
+        }
+        next_cache_state_ = now + std::chrono::milliseconds(cache_state_ms);
+      }
+      const double wait = std::chrono::duration<double>(next_cache_state_ - now).count();
+      timeout = timeout < 0 ? wait : std::min(timeout, wait);
+    }
+
+    if (quality_options_dirty_.exchange(false)) ApplyQualityOptions();
+    ProcessMosaicSwaps();
+    PollTrickPlay(&timeout);
+    PollDiskCache(&timeout);
+    PollHiddenTrack(&timeout);
+
+    mpv_event* event = api_.mpv_wait_event(mpv_, timeout);
+    if (!event || event->event_id == MPV_EVENT_NONE) continue;
+    if (event->event_id == MPV_EVENT_SHUTDOWN) break;
+
+    MPV_TRACE_SCOPE("mpv", api_.mpv_event_name(event->event_id));
+    HandleMpvEvent(*event);
+  }
+
+  if (recording_dump_pending_) FinishDiskCacheDump(false);
+  DebugLog("[MpvPlayer] Event thread exiting\n");
+}
+
+void MpvPlayer::HandleMpvEvent(const mpv_event& event) {
+  switch (event.event_id) {
+    case MPV_EVENT_LOG_MESSAGE:
+      HandleLogMessage(*static_cast<const mpv_event_log_message*>(event.data));
+      break;
+    case MPV_EVENT_VIDEO_RECONFIG:
+      UpdateFrameBudget();
+      break;
+    case MPV_EVENT_START_FILE:
+      open_timeline_.Mark(OpenTimeline::kStartFile, SteadyClock::now());
+      break;
+    case MPV_EVENT_FILE_LOADED:
+      open_timeline_.Mark(OpenTimeline::kFileLoaded, SteadyClock::now());
+      if (benchmark_pending_.exchange(false)) {
+        benchmark_active_ = true;
+        std::lock_guard<std::mutex> lock(benchmark_mutex_);
+        benchmark_run_ = benchmark_next_;
+      }
+      history_.Clear();
+      awaiting_first_frame_.store(true);
+      AttachMosaicInputs();
+      break;
+    case MPV_EVENT_PLAYBACK_RESTART:
+      if (trick_.active()) {
+        trick_.OnSeekDone(SteadyClock::now());
+        CheckTrickPlayBounds();
+      }
+      break;
+    case MPV_EVENT_PROPERTY_CHANGE: {
+      const auto* prop = static_cast<const mpv_event_property*>(event.data);
+      if (event.reply_userdata == kTimePosObserver && prop && prop->format == MPV_FORMAT_DOUBLE) {
+        history_.AssignPts(*static_cast<const double*>(prop->data));
+      } else if (event.reply_userdata == kPlaylistObserver) {
+        EmitPlaylist();
+      }
+      break;
+    }
+    case MPV_EVENT_HOOK: {
+      const auto* hook = static_cast<const mpv_event_hook*>(event.data);
+      if (event.reply_userdata == kDiskCacheHook) OnLoadHook();
+      if (event.reply_userdata == kOpenTimingHook) {
+        open_timeline_.Mark(OpenTimeline::kPreloaded, SteadyClock::now());
+      }
+      api_.mpv_hook_continue(mpv_, hook->id);
+      break;
+    }
+    case MPV_EVENT_COMMAND_REPLY:
+      if (event.reply_userdata == kDiskCacheDump) FinishDiskCacheDump(event.error >= 0);
+      break;
+    case MPV_EVENT_END_FILE: {
+      StopTrickPlay("end");
+      // An unfinished recording is dropped; a running dump still replies.
+      if (!recording_dump_pending_) {
+        recording_url_.clear();
+        recording_store_.reset();
+      }
+      const auto* end = static_cast<const mpv_event_end_file*>(event.data);
+      // keep-open=yes only lets an item end at EOF when another one follows.
+      if (end && end->reason == MPV_END_FILE_REASON_EOF) {
+        transition_from_ticks_.store(last_frame_ticks_.load());
+      } else {
+        transition_from_ticks_.store(0);
+      }
+      if (end && end->reason == MPV_END_FILE_REASON_ERROR) {
+        loading_.store(false);
+        std::string msg;
+        FormatMpvError(api_, end->error, &msg);
+        DebugLog(("[MpvPlayer] Playback ended with error: " + msg + "\n").c_str());
+        if (open_timeline_.Fail()) ReportOpen(false, msg);
+      }
+      if (benchmark_active_) ReportBenchmark(end);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+bool MpvPlayer::SetLogLevel(const std::string& level, bool stream_to_dart, int max_per_second,
+                            std::string* err_out) {
+  if (!ok_ || !mpv_) {
+    if (err_out) *err_out = "Player not initialized";
+    return false;
+  }
+  const int rc = api_.mpv_request_log_messages(mpv_, level.c_str());
+  if (rc < 0) {
+    FormatMpvError(api_, rc, err_out);
+    return false;
+  }
+  log_stream_max_per_second_.store(std::max(1, max_per_second));
+  log_stream_enabled_.store(stream_to_dart);
+  return true;
+}
+
+void MpvPlayer::HandleLogMessage(const mpv_event_log_message& msg) {
+  // Runs on the event thread: the logger only queues, so mpv's log buffer is
+  // drained without waiting on disk or Dart.
+  std::string line = "[mpv/";
+  line += msg.prefix ? msg.prefix : "?";
+  line += "] ";
+  line += msg.level ? msg.level : "?";
+  line += ": ";
+  line += msg.text ? msg.text : "";
+  if (line.empty() || line.back() != '\n') line += '\n';
+  Logger::Instance().Write(line);
+
+  if (!log_stream_enabled_.load()) return;
+
+  // Fixed one-second window; excess lines are counted and reported once the
+  // next window opens.
+  const auto now = SteadyClock::now();
+  if (now - log_window_start_ >= std::chrono::seconds(1)) {
+    if (log_window_suppressed_ > 0) {
+      EmitEvent(flutter::EncodableMap{
+          {flutter::EncodableValue("type"), flutter::EncodableValue("log")},
+          {flutter::EncodableValue("prefix"), flutter::EncodableValue("mpv_native_texture")},
+          {flutter::EncodableValue("level"), flutter::EncodableValue("warn")},
+          {flutter::EncodableValue("text"),
+           flutter::EncodableValue(std::to_string(log_window_suppressed_) + " log messages suppressed by rate limit")},
+      });
+    }
+    log_window_start_ = now;
+    log_window_count_ = 0;
+    log_window_suppressed_ = 0;
+  }
+  if (log_window_count_ >= log_stream_max_per_second_.load()) {
+    ++log_window_suppressed_;
+    return;
+  }
+  ++log_window_count_;
+
+  std::string text = msg.text ? msg.text : "";
+  if (!text.empty() && text.back() == '\n') text.pop_back();
+  EmitEvent(flutter::EncodableMap{
+      {flutter::EncodableValue("type"), flutter::EncodableValue("log")},
+      {flutter::EncodableValue("prefix"), flutter::EncodableValue(msg.prefix ? msg.prefix : "")},
+      {flutter::EncodableValue("level"), flutter::EncodableValue(msg.level ? msg.level : "")},
+      {flutter::EncodableValue("text"), flutter::EncodableValue(std::move(text))},
+  });
+}
+
+void MpvPlayer::EmitEvent(flutter::EncodableMap event) {
+  if (!on_event_) return;
+  event[flutter::EncodableValue("textureId")] = flutter::EncodableValue(texture_id_);
+  on_event_(std::move(event));
+}
+
+void MpvPlayer::UpdateOutputs(const std::vector<std::shared_ptr<TextureOutput>>& outputs,
+                              SteadyClock::time_point now) {
+  // GPU downscale of the main FBO, each output at its own rate.
+  for (const auto& output : outputs) {
+    if (!output->Due(now)) continue;
+    MPV_TRACE_SCOPE("render", "output");
+    std::string output_err;
+    if (!output->Update(glx_, fbo_, frame_w_, frame_h_, now, &output_err)) {
+      DebugLog(("[MpvPlayer] Render thread: output update failed: " + output_err + "\n").c_str());
+    }
+  }
 }
 
 void MpvPlayer::RenderThreadMain() {
+  trace::SetThreadName("MpvRender");
   DebugLog("[MpvPlayer] Render thread started\n");
 
   try {
@@ -436,17 +2042,79 @@ void MpvPlayer::RenderThreadMain() {
 
     while (running_.load() && !destroying_.load()) {
       std::unique_lock<std::mutex> lk(render_mutex_);
-      render_cv_.wait(lk, [&] { return !running_.load() || needs_render_.load(); });
+      const auto wake = [&] { return !running_.load() || needs_render_.load(); };
+      std::chrono::steady_clock::time_point deadline;
+      if (NextThrottleDeadline(&deadline)) {
+        render_cv_.wait_until(lk, deadline, wake);
+      } else {
+        render_cv_.wait(lk, wake);
+      }
       if (!running_.load() || destroying_.load()) break;
       needs_render_.store(false);
       lk.unlock();
 
+      MPV_TRACE_SCOPE("render", "frame");
+      const int64_t requested = render_requested_ticks_.exchange(0);
+      if (requested != 0) {
+        const SteadyClock::time_point requested_at{SteadyClock::duration(requested)};
+        stats_.Record(PipelineStats::kWakeup, MicrosBetween(requested_at, SteadyClock::now()));
+      }
+
+      // Hidden players only advance mpv's frame queue; thumbnails are paced.
+      const auto vis = static_cast<Visibility>(visibility_.load());
+      const auto now = std::chrono::steady_clock::now();
+      int skip_rendering = 0;
+      if (standby_.load()) {
+        // Decode keeps up with the (paused) timeline; nothing is drawn.
+        skip_rendering = 1;
+      } else if (vis == Visibility::kHidden) {
+        // The event thread disables the track after the grace period.
+        skip_rendering = 1;
+      } else if (vis == Visibility::kThumbnail) {
+        thumbnail_pending_ = now - last_thumbnail_frame_ < kThumbnailFrameInterval;
+        if (thumbnail_pending_) {
+          skip_rendering = 1;
+        } else {
+          last_thumbnail_frame_ = now;
+        }
+      } else {
+        thumbnail_pending_ = false;
+      }
+
+      // Quality governor at kFpsCap: draw every other frame
+      // (QualityGovernor::kFpsCapDivisor).
+      const QualityGovernor::Level quality = governor_.level();
+      if (quality >= QualityGovernor::kFpsCap && !skip_rendering) {
+        fps_cap_drop_ = !fps_cap_drop_;
+        if (fps_cap_drop_) skip_rendering = 1;
+      }
+
       DebugLog("[MpvPlayer] Render thread processing frame\n");
 
-      if (!gl_.MakeCurrent()) {
+      auto stage_start = SteadyClock::now();
+      bool made_current;
+      {
+        MPV_TRACE_SCOPE("render", "MakeCurrent");
+        made_current = gl_.MakeCurrent();
+      }
+      if (!made_current) {
         DebugLog("[MpvPlayer] Render thread: MakeCurrent failed\n");
         continue;
       }
+      auto stage_end = SteadyClock::now();
+      stats_.Record(PipelineStats::kMakeCurrent, MicrosBetween(stage_start, stage_end));
+
+      // Follow the governor's render resolution.
+      const double scale =
+          quality >= QualityGovernor::kReducedResolution ? QualityGovernor::kReducedResolutionScale : 1.0;
+      const int want_w = std::max(16, static_cast<int>(base_w_ * scale));
+      const int want_h = std::max(16, static_cast<int>(base_h_ * scale));
+      if (fbo_ != 0 && (want_w != frame_w_ || want_h != frame_h_)) {
+        std::string fbo_err;
+        if (!EnsureFbo(want_w, want_h, &fbo_err)) {
+          DebugLog(("[MpvPlayer] Render thread: resizing FBO failed: " + fbo_err + "\n").c_str());
+        }
+      }
 
       // Safety checks before rendering
       if (fbo_ == 0) {
@@ -474,15 +2142,38 @@ void MpvPlayer::RenderThreadMain() {
       mpv_render_param rparams[] = {
           {MPV_RENDER_PARAM_OPENGL_FBO, &fbo},
           {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
+          {MPV_RENDER_PARAM_SKIP_RENDERING, &skip_rendering},
           {MPV_RENDER_PARAM_INVALID, nullptr},
       };
 
+      const uint64_t update_flags = api_.mpv_render_context_update(mpv_gl_);
+
+      // Extra outputs are blitted from the main FBO. When the main view
+      // skips a new frame (hidden, standby, thumbnail pacing, fps cap) but an
+      // output is due, mpv still draws it, for the outputs only.
+      std::vector<std::shared_ptr<TextureOutput>> outputs;
+      std::vector<std::shared_ptr<TextureOutput>> retired;
+      {
+        std::lock_guard<std::mutex> lock(outputs_mutex_);
+        outputs = outputs_;
+        retired.swap(retired_outputs_);
+      }
+      for (auto& output : retired) output->DestroyGl(glx_);
+      bool outputs_only = false;
+      if (skip_rendering && (update_flags & MPV_RENDER_UPDATE_FRAME)) {
+        const auto due_at = SteadyClock::now();
+        outputs_only = std::any_of(outputs.begin(), outputs.end(), [&](const auto& o) { return o->Due(due_at); });
+        if (outputs_only) skip_rendering = 0;
+      }
+
       DebugLog("[MpvPlayer] Render thread: Calling glViewport\n");
       glViewport(0, 0, frame_w_, frame_h_);
       
       // Wrap render call in try-catch
       DebugLog("[MpvPlayer] Render thread: Calling mpv_render_context_render\n");
+      stage_start = SteadyClock::now();
       try {
+        MPV_TRACE_SCOPE("render", skip_rendering ? "mpv_render(skip)" : "mpv_render");
         api_.mpv_render_context_render(mpv_gl_, rparams);
       } catch (...) {
         DebugLog("[MpvPlayer] Render thread: Exception during mpv_render_context_render\n");
@@ -491,27 +2182,118 @@ void MpvPlayer::RenderThreadMain() {
       }
       DebugLog("[MpvPlayer] Render thread: mpv_render_context_render completed\n");
 
+      // Only new video frames go into the step-back history, not redraws.
+      const bool new_frame = (update_flags & MPV_RENDER_UPDATE_FRAME) != 0;
+      if (new_frame) {
+        const auto now = SteadyClock::now();
+        last_frame_ticks_.store(now.time_since_epoch().count());
+        int64_t armed = -1;
+        if (benchmark_first_frame_ticks_.load(std::memory_order_relaxed) == armed) {
+          benchmark_first_frame_ticks_.compare_exchange_strong(armed, now.time_since_epoch().count());
+        }
+        open_timeline_.Mark(OpenTimeline::kFirstRender, now);
+        const bool first_of_file = awaiting_first_frame_.exchange(false);
+        if (first_of_file) loading_.store(false);
+        const int64_t from_ticks = first_of_file ? transition_from_ticks_.exchange(0) : 0;
+        if (from_ticks != 0) {
+          const int64_t gap_us =
+              MicrosBetween(SteadyClock::time_point(SteadyClock::duration(from_ticks)), now);
+          transition_gap_.Record(gap_us);
+          EmitEvent(flutter::EncodableMap{
+              {flutter::EncodableValue("type"), flutter::EncodableValue("playlistTransition")},
+              {flutter::EncodableValue("gapUs"), flutter::EncodableValue(gap_us)},
+          });
+        }
+      }
+
+      if (skip_rendering || outputs_only) {
+        // Nothing was drawn for the main view: skip readback and keep the
+        // last published frame.
+        if (outputs_only) UpdateOutputs(outputs, SteadyClock::now());
+        stats_.CountSkipped();
+        gl_.DoneCurrent();
+        continue;
+      }
+      const int64_t render_us = MicrosBetween(stage_start, SteadyClock::now());
+      stats_.Record(PipelineStats::kRender, render_us);
+      stats_.CountRendered();
+
       // Ensure our FBO is bound for reading
       glx_.glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
       
       // Read back RGBA.
       DebugLog("[MpvPlayer] Render thread: Calling glReadPixels\n");
-      glReadPixels(0, 0, frame_w_, frame_h_, GL_RGBA, GL_UNSIGNED_BYTE, back_rgba_.data());
+      stage_start = SteadyClock::now();
+      {
+        MPV_TRACE_SCOPE("render", "glReadPixels");
+        glReadPixels(0, 0, frame_w_, frame_h_, GL_RGBA, GL_UNSIGNED_BYTE, transport_.back());
+      }
+      stage_end = SteadyClock::now();
+      const int64_t readback_us = MicrosBetween(stage_start, stage_end);
+      stats_.Record(PipelineStats::kReadback, readback_us);
+
+      UpdateOutputs(outputs, stage_end);
+
+      QualityGovernor::Level next_quality;
+      if (governor_.OnFrame(render_us + readback_us, frame_budget_us_.load(), stage_end, &next_quality)) {
+        OnQualityLevelChanged(next_quality);
+      }
       DebugLog("[MpvPlayer] Render thread: glReadPixels completed\n");
 
       gl_.DoneCurrent();
 
-      // Swap buffers.
+      // Feed the frame tap from the back buffer before it becomes the front.
+      std::shared_ptr<FrameTap> tap;
+      {
+        std::lock_guard<std::mutex> lock(tap_mutex_);
+        tap = frame_tap_;
+      }
+      if (tap) {
+        MPV_TRACE_SCOPE("render", "frameTap");
+        if (const uint64_t sequence = tap->Offer(transport_.back(), frame_w_, frame_h_)) {
+          EmitEvent(flutter::EncodableMap{
+              {flutter::EncodableValue("type"), flutter::EncodableValue("frameTap")},
+              {flutter::EncodableValue("tapId"), flutter::EncodableValue(static_cast<int64_t>(tap->id()))},
+              {flutter::EncodableValue("sequence"), flutter::EncodableValue(static_cast<int64_t>(sequence))},
+          });
+        }
+      }
+
+      if (new_frame && history_.enabled()) {
+        MPV_TRACE_SCOPE("render", "frameHistory");
+        history_.Push(transport_.back(), frame_w_, frame_h_);
+      }
+      // A frame from the step-back history is on screen; keep it there until
+      // the user steps forward to live or resumes playback.
+      if (history_.browsing()) continue;
+
+      // Swap buffers. Stamped first, so CopyPixelBuffer cannot take the
+      // file's first frame unstamped.
+      open_timeline_.Mark(OpenTimeline::kFirstPublish, SteadyClock::now());
+      SteadyClock::time_point published_at;
       {
-        std::lock_guard<std::mutex> lock(pixel_mutex_);
-        front_rgba_.swap(back_rgba_);
-        pixel_buffer_.buffer = front_rgba_.data();
-        pixel_buffer_.width = frame_w_;
-        pixel_buffer_.height = frame_h_;
+        MPV_TRACE_SCOPE("render", "publish");
+        published_at = transport_.Publish();
       }
 
       // Notify Flutter a new frame is available.
-      registrar_->MarkTextureFrameAvailable(texture_id_);
+      {
+        MPV_TRACE_SCOPE("render", "MarkTextureFrameAvailable");
+        registrar_->MarkTextureFrameAvailable(texture_id_);
+      }
+
+      if (zap_started_ticks_.load() != 0 && !loading_.load()) {
+        const int64_t zap_ticks = zap_started_ticks_.exchange(0);
+        if (zap_ticks != 0) {
+          const int64_t zap_us =
+              MicrosBetween(SteadyClock::time_point(SteadyClock::duration(zap_ticks)), published_at);
+          zap_latency_.Record(zap_us);
+          EmitEvent(flutter::EncodableMap{
+              {flutter::EncodableValue("type"), flutter::EncodableValue("zap")},
+              {flutter::EncodableValue("zapUs"), flutter::EncodableValue(zap_us)},
+          });
+        }
+      }
     }
   } catch (const std::exception& e) {
     char buf[512];
@@ -1,33 +1,140 @@
 #pragma once
 
+#include <flutter/encodable_value.h>
 #include <flutter/texture_registrar.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "disk_cache_store.h"
+#include "frame_capturer.h"
+#include "frame_history.h"
+#include "frame_tap.h"
+#include "frame_transport.h"
 #include "gl_ext.h"
+#include "mosaic_layout.h"
 #include "mpv_dll.h"
+#include "open_timing.h"
+#include "pipeline_stats.h"
+#include "quality_governor.h"
+#include "texture_output.h"
+#include "trick_play.h"
 #include "wgl_offscreen.h"
 
 namespace mpv_native_texture {
 
 class MpvPlayer {
  public:
-  MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height);
+  // How much of the player's output is currently on screen.
+  //  - kVisible:   every frame is rendered, read back and published.
+  //  - kThumbnail: frames are rendered at a reduced rate (small previews).
+  //  - kHidden:    frames are skipped; after a grace period the video track is
+  //                disabled so only audio keeps decoding.
+  enum class Visibility { kHidden = 0, kThumbnail = 1, kVisible = 2 };
+
+  // Frame delivery and A/V sync counters, from mpv and from our own pipeline.
+  // Comparing them shows where frames get lost: decode (decoder drops), VO
+  // timing (drops / delayed), render, or Flutter never consuming a frame
+  // before the next one replaced it (frames_overwritten).
+  struct Telemetry {
+    int64_t timestamp_us = 0;  // steady clock
+    uint64_t frames_rendered = 0;
+    uint64_t frames_published = 0;
+    uint64_t frames_consumed = 0;
+    uint64_t frames_overwritten = 0;
+    int64_t mpv_frame_drops = -1;
+    int64_t mpv_decoder_frame_drops = -1;
+    int64_t mpv_vo_delayed_frames = -1;
+    std::optional<double> avsync;
+    std::optional<double> estimated_vf_fps;
+    int64_t process_cpu_us = 0;  // kernel + user time of the whole process
+    // Process CPU (% of one core) over this player's last completed hidden
+    // and shown intervals; -1 until there was one. Their difference is about
+    // what hiding the player saves.
+    double hidden_cpu_percent = -1.0;
+    double shown_cpu_percent = -1.0;
+  };
+
+  // Demuxer cache settings; unset fields are left alone. Byte sizes accept
+  // mpv's suffixes ("150MiB"), times are seconds.
+  struct CacheOptions {
+    std::optional<std::string> cache;  // "auto", "yes" or "no"
+    std::optional<double> cache_secs;
+    std::optional<std::string> demuxer_max_bytes;
+    std::optional<std::string> demuxer_max_back_bytes;
+    std::optional<double> demuxer_readahead_secs;
+  };
+
+  // demuxer-cache-state, flattened. Times are in stream seconds; ranges are
+  // the parts that can be seeked to without network access. Times mpv does not
+  // report are -1.
+  struct CacheState {
+    std::vector<std::pair<double, double>> seekable_ranges;
+    double cache_end = -1.0;
+    double reader_pts = -1.0;
+    double cache_duration = -1.0;
+    int64_t forward_bytes = 0;
+    int64_t total_bytes = 0;
+    int64_t raw_input_rate = 0;  // bytes/s
+    bool eof = false;
+    bool underrun = false;
+    bool idle = false;
+  };
+
+  // Per-file settings for Open(), passed as loadfile options so they apply
+  // from the first demux/decode instead of after it. |start| is in seconds
+  // (negative: from the end). |fast_start| adds kFastStartOptions ahead of
+  // |file_options|, which hold any other mpv option=value pairs.
+  // |benchmark| plays the file untimed (kBenchmarkOptions) and reports the
+  // run as a "benchmark" event when it ends; the pipeline histograms are
+  // reset first, so getStats then covers just the run.
+  struct OpenOptions {
+    std::optional<double> start;
+    std::optional<bool> pause;
+    bool fast_start = false;
+    bool benchmark = false;
+    std::vector<std::pair<std::string, std::string>> file_options;
+  };
+
+  // Receives asynchronous player events (log lines, ...) as maps tagged with
+  // "textureId" and "type". Called from the player's own threads.
+  using EventCallback = std::function<void(flutter::EncodableMap event)>;
+
+  MpvPlayer(flutter::TextureRegistrar* registrar, int width, int height,
+            EventCallback on_event = nullptr);
   ~MpvPlayer();
 
   bool ok() const { return ok_; }
   const std::string& init_error() const { return init_error_; }
   int64_t texture_id() const { return texture_id_; }
 
-  // Control thread safe (called from method channel thread).
+  // Control thread safe (called from method channel thread). Each Open() is
+  // timed phase by phase (see OpenTimeline) up to the first frame Flutter
+  // copies, then reported as an "opened" event and to OpenTimingStats. The
+  // first one also carries the player's CreateTiming.
   bool Open(const std::string& path_or_url, std::string* err_out = nullptr);
+  bool Open(const std::string& path_or_url, const OpenOptions& options, std::string* err_out = nullptr);
+
+  // Mosaic mode: plays |inputs| as tiles of one texture through a single mpv
+  // instance (external video tracks stacked by lavfi-complex). |columns| 0
+  // picks a square-ish grid. The tracks are attached asynchronously; a
+  // "mosaic" event reports the outcome. Open() leaves mosaic mode.
+  bool OpenMosaic(const std::vector<std::string>& inputs, int columns, MosaicLayout* layout_out,
+                  std::string* err_out = nullptr);
+  // Replaces the input of one tile without touching the others; completes
+  // with a "mosaicSwap" event.
+  bool SwapMosaicInput(int tile, const std::string& url, std::string* err_out = nullptr);
+
   void Play();
   void Pause();
   void SeekRelative(double seconds);
@@ -37,36 +144,197 @@ class MpvPlayer {
   void SetVolume01(double volume01);
   void SetSpeed(double speed);  // Set playback speed (0.1 to 4.0)
   void ToggleMute();
+  void SetVisibility(Visibility visibility);
+
+  Telemetry GetTelemetry();
+  // Emits a "telemetry" event every |interval_ms| (0 stops the stream).
+  void SetTelemetryInterval(int interval_ms);
+
+  // Selects the minimum mpv log level (no, fatal, error, warn, info, v, debug,
+  // trace). Messages always go to the plugin log; with |stream_to_dart| they
+  // are also emitted as "log" events, at most |max_per_second| per second.
+  bool SetLogLevel(const std::string& level, bool stream_to_dart, int max_per_second,
+                   std::string* err_out = nullptr);
+
+  // Frame pipeline timings and counters; |reset| clears the histograms.
+  PipelineStats::Snapshot GetStats(bool reset);
+
+  // Grabs a frame off-thread. |from_video| asks mpv for screenshot-raw at video
+  // resolution; otherwise the currently published texture frame is copied.
+  // |done| runs on the capture worker thread.
+  void CaptureFrame(const FrameCapturer::Request& request, bool from_video, FrameCapturer::Done done);
+  FrameCapturer::Snapshot GetCaptureStats();
+
+  // Extra texture outputs rendered from the same decode (platform thread).
+  // AddOutput returns the new texture id, or -1 with |err_out| set.
+  int64_t AddOutput(int width, int height, int max_fps, std::string* err_out);
+  bool RemoveOutput(int64_t texture_id);
+
+  // Raw frame feed for Dart over FFI (see FrameTap). Starting replaces any
+  // running tap. Returns the tap id.
+  uint64_t StartFrameTap(const FrameTap::Config& config);
+  void StopFrameTap();
+  // False when no tap is running.
+  bool GetFrameTapStats(FrameTap::Snapshot* out);
+
+  // Adaptive quality: on by default. Disabling restores full quality.
+  void SetAdaptiveQuality(bool enabled);
+  QualityGovernor::Snapshot GetQuality() const { return governor_.TakeSnapshot(); }
+
+  // Frame-accurate review. Stepping back is served from a history of recently
+  // rendered frames when possible; FrameStep walks that history back to live
+  // before asking mpv for the next frame. Both return true on a cache hit.
+  // The cache is off by default; configuring it clears it.
+  void SetFrameCache(bool enabled, const FrameHistory::Config& config);
+  bool FrameStep();
+  bool FrameBackStep();
+  FrameHistory::Snapshot GetFrameCacheStats() const;
+
+  // Keyframe-seek fast-forward / rewind (see TrickPlay). Pauses and mutes the
+  // player; stopping (or Play/Pause) restores both. Starting while active
+  // changes the rate in place. Returns the clamped settings.
+  TrickPlay::Config StartTrickPlay(const TrickPlay::Config& config);
+  void StopTrickPlay() { StopTrickPlay("stopped"); }
+  TrickPlay::Snapshot GetTrickPlayStats();
+
+  // Playlist, on top of mpv's own (Open() replaces it with one item). The
+  // next entry is opened and buffered ahead (prefetch-playlist) and audio
+  // runs on gaplessly when formats allow. Changes are reported as "playlist"
+  // events. Each automatic advance is timed from the last new frame of one
+  // item to the first of the next and reported as "playlistTransition".
+  bool PlaylistAppend(const std::string& url, std::string* err_out = nullptr);
+  bool PlaylistInsert(int64_t index, const std::string& url, std::string* err_out = nullptr);
+  bool PlaylistMove(int64_t from, int64_t to, std::string* err_out = nullptr);
+  bool PlaylistRemove(int64_t index, std::string* err_out = nullptr);
+  bool PlaylistPlayIndex(int64_t index, std::string* err_out = nullptr);
+  // False at either end of the playlist.
+  bool PlaylistNext();
+  bool PlaylistPrev();
+  LatencyHistogram::Summary GetPlaylistGapStats() const { return transition_gap_.Summarize(); }
+
+  // Channel-zapping standby: paused, muted, every frame skipped (without
+  // ever suspending the video track) and a small demuxer cache, so several
+  // pre-opened players stay cheap. Leaving standby unpauses and times how
+  // long until the texture shows this player's picture, reported as a "zap"
+  // event. If Open() was called meanwhile, that is the file's first frame.
+  void SetStandby(bool standby);
+
+  // Applies |options| at runtime. On standby the byte limits are stored and
+  // take effect when the player leaves it.
+  bool SetCacheOptions(const CacheOptions& options, std::string* err_out = nullptr);
+  // False while nothing is loaded.
+  bool GetCacheState(CacheState* out);
+  // Emits a "cacheState" event every |interval_ms| while a file is loaded
+  // (0 stops the stream).
+  void SetCacheStateInterval(int interval_ms);
+  LatencyHistogram::Summary GetZapStats() const { return zap_latency_.Summarize(); }
+
+  // Persistent cache for remote files (null turns it off). Cached URLs are
+  // opened from disk; others are recorded while they play and stored once
+  // the demuxer has read all of them, reported as a "diskCacheStore" event.
+  void SetDiskCache(std::shared_ptr<DiskCacheStore> store);
 
  private:
   static void OnMpvRenderUpdate(void* ctx);
+  // Any thread; |reason| goes into the "trickPlay" event. Play()/Pause() pass
+  // |restore_pause| false and set pause themselves, so the player stays
+  // paused instead of briefly resuming unmuted.
+  void StopTrickPlay(const char* reason, bool restore_pause = true);
+  // Event thread: issues due trick-play seeks and shortens |*timeout| to the
+  // next tick.
+  void PollTrickPlay(double* timeout);
+  // Event thread, after a trick-play seek landed: stops at either end.
+  void CheckTrickPlayBounds();
+
+  // Event thread: the on_load hook redirects cached URLs and sets up
+  // recording of the others; PollDiskCache dumps a recording once complete
+  // and shortens |*timeout| to the next check.
+  void OnLoadHook();
+  void PollDiskCache(double* timeout);
+  void FinishDiskCacheDump(bool ok);
+
+  // Event thread: disables the video track once the hidden grace period is
+  // over, and shortens |*timeout| to that deadline until then. Not while
+  // extra outputs exist: they keep rendering.
+  void PollHiddenTrack(double* timeout);
+  void SuspendVideoTrack();
+
+  // Event thread: emits the "benchmark" event of the run that just ended.
+  void ReportBenchmark(const mpv_event_end_file* end);
+
+  // Emits the "opened" event of a completed (|ok|) or failed timeline and
+  // records it. Event, render or raster thread.
+  void ReportOpen(bool ok, const std::string& error);
+
+  // Event thread: emits the current playlist as a "playlist" event.
+  void EmitPlaylist();
+  // Control thread: runs a playlist command and wakes the renderer.
+  bool PlaylistCommand(const char* const* cmd, std::string* err_out);
+
+  // Control thread: puts a history frame on the texture.
+  void ShowHistoryFrame(FrameHistory::Frame* frame);
   static void* GetProcAddress(void* ctx, const char* name);
 
   // Render thread entry point.
   void RenderThreadMain();
   void RequestRender();
 
+  // Event thread: drains mpv_wait_event() until shutdown.
+  void EventThreadMain();
+  void HandleMpvEvent(const mpv_event& event);
+  void HandleLogMessage(const mpv_event_log_message& msg);
+  void EmitEvent(flutter::EncodableMap event);
+  void ApplyQualityOptions();
+  void AttachMosaicInputs();
+  void ProcessMosaicSwaps();
+  int64_t AddVideoTrack(const std::string& url, std::string* err_out);
+  bool SetMosaicGraph(const MosaicLayout& layout, const std::vector<int64_t>& tracks, std::string* err_out);
+  void UpdateFrameBudget();
+
   // Texture callback (called by Flutter raster thread).
   const FlutterDesktopPixelBuffer* CopyPixelBuffer(size_t width, size_t height);
 
   // Helpers (render thread only).
   bool EnsureFbo(int w, int h, std::string* err_out);
   void DestroyFbo();
+  void OnQualityLevelChanged(QualityGovernor::Level level);
+  // Blits the main FBO into each due output.
+  void UpdateOutputs(const std::vector<std::shared_ptr<TextureOutput>>& outputs, SteadyClock::time_point now);
+  // Thumbnail pacing only; the render thread never touches the core API.
+  bool NextThrottleDeadline(std::chrono::steady_clock::time_point* deadline) const;
+
+  // Helpers (control thread).
+  void ResumeVideoTrack();
+  bool HasOutputs();
+  // Closes the hidden or shown interval that just ended (see Telemetry).
+  void SampleVisibilityCpu(bool was_hidden);
+
+  // Capture sources (capture worker thread).
+  bool CopyPublishedFrame(RgbaImage* image, std::string* err_out);
+  bool ScreenshotRaw(RgbaImage* image, std::string* err_out);
 
   std::string init_error_;
   bool ok_ = false;
 
   flutter::TextureRegistrar* registrar_ = nullptr;
+  EventCallback on_event_;
   int64_t texture_id_ = -1;
   std::unique_ptr<flutter::TextureVariant> texture_variant_;
 
-  // Shared pixel buffer (double-buffered).
-  std::mutex pixel_mutex_;
-  FlutterDesktopPixelBuffer pixel_buffer_{};
-  std::vector<uint8_t> front_rgba_;
-  std::vector<uint8_t> back_rgba_;
+  // FBO size (render thread).
   int frame_w_ = 0;
   int frame_h_ = 0;
+  // Requested output size; the FBO is smaller when quality is reduced.
+  int base_w_ = 0;
+  int base_h_ = 0;
+
+  // Pipeline instrumentation. render_requested_ticks_ holds the steady_clock
+  // time of the oldest unserviced RequestRender (0 when none is pending).
+  PipelineStats stats_;
+  std::atomic<int64_t> render_requested_ticks_{0};
+
+  // Frames on their way to CopyPixelBuffer, sized like the FBO.
+  FrameTransport transport_;
 
   // MPV + GL (render thread owned).
   MpvApi api_;
@@ -85,6 +353,147 @@ class MpvPlayer {
   std::mutex render_mutex_;
   std::condition_variable render_cv_;
   std::thread render_thread_;
+  std::thread event_thread_;
+
+  // Visibility throttling. hidden_since_ticks_ is the steady_clock time taken
+  // when the player became hidden; suspended_vid_ is the track to restore.
+  // visibility_cpu_* mark the start of the current hidden/shown interval.
+  std::atomic<int> visibility_{static_cast<int>(Visibility::kVisible)};
+  std::atomic<int64_t> hidden_since_ticks_{0};
+  std::mutex vid_mutex_;
+  std::atomic<bool> video_suspended_{false};
+  int64_t suspended_vid_ = -1;
+  std::mutex visibility_cpu_mutex_;
+  int64_t visibility_cpu_start_us_ = 0;
+  SteadyClock::time_point visibility_wall_start_{};
+  double hidden_cpu_percent_ = -1.0;
+  double shown_cpu_percent_ = -1.0;
+  std::chrono::steady_clock::time_point last_thumbnail_frame_{};
+  bool thumbnail_pending_ = false;
+
+  // mpv log forwarding to Dart. The window counters are event-thread only.
+  std::atomic<bool> log_stream_enabled_{false};
+  std::atomic<int> log_stream_max_per_second_{20};
+  SteadyClock::time_point log_window_start_{};
+  int log_window_count_ = 0;
+  int log_window_suppressed_ = 0;
+
+  // Adaptive quality. The render thread feeds governor_ and applies resolution
+  // and fps cap itself; mpv option changes are flagged through
+  // quality_options_dirty_ and applied on the event thread so the render
+  // thread never blocks on the mpv core. frame_budget_us_ follows
+  // container-fps / speed.
+  QualityGovernor governor_;
+  std::atomic<int64_t> frame_budget_us_{33333};
+  std::atomic<bool> quality_options_dirty_{false};
+  bool fps_cap_drop_ = false;            // render thread
+  bool quality_defaults_saved_ = false;  // event thread from here on
+  std::string default_interpolation_ = "yes";
+  std::string default_scale_;
+  std::string default_cscale_;
+  std::string default_dscale_;
+
+  // Mosaic mode. The main file is a blank lavfi source so that every tile is
+  // an external track and can be swapped; attaching tracks (which opens the
+  // inputs) happens on the event thread.
+  std::mutex mosaic_mutex_;
+  bool mosaic_active_ = false;
+  bool mosaic_attach_pending_ = false;
+  MosaicLayout mosaic_layout_;
+  std::vector<std::string> mosaic_inputs_;
+  std::vector<int64_t> mosaic_tracks_;
+  std::deque<std::pair<int, std::string>> mosaic_swaps_;
+
+  // Extra outputs. Removed ones wait in retired_outputs_ until the render
+  // thread has released their GL objects.
+  std::mutex outputs_mutex_;
+  std::vector<std::shared_ptr<TextureOutput>> outputs_;
+  std::vector<std::shared_ptr<TextureOutput>> retired_outputs_;
+
+  // Active frame tap; read by the render thread once per frame.
+  std::mutex tap_mutex_;
+  std::shared_ptr<FrameTap> frame_tap_;
+
+  // Step-back history. A cached frame being shown is the transport's still
+  // until the render thread publishes again.
+  FrameHistory history_;
+
+  // Trick play. trick_mutex_ serializes start/stop and guards what to
+  // restore afterwards.
+  TrickPlay trick_;
+  std::mutex trick_mutex_;
+  bool trick_resume_ = false;
+  bool trick_unmute_ = false;
+  int64_t trick_cpu_start_us_ = 0;
+  SteadyClock::time_point trick_started_{};
+  double trick_cpu_percent_ = 0.0;  // of the last finished session
+
+  // Playlist transitions. The render thread stamps every new frame; an EOF
+  // advance remembers the last one of the finished item, and the first new
+  // frame after the next FILE_LOADED closes the gap.
+  std::atomic<int64_t> last_frame_ticks_{0};
+  std::atomic<int64_t> transition_from_ticks_{0};
+  std::atomic<bool> awaiting_first_frame_{false};
+  LatencyHistogram transition_gap_;
+
+  // Zapping standby. standby_mutex_ serializes enter/leave and guards the
+  // options to restore. zap_started_ticks_ is set on leaving standby and
+  // cleared by the first publish once loading_ (Open() until the file's first
+  // new frame) is false.
+  std::atomic<bool> standby_{false};
+  std::mutex standby_mutex_;
+  std::string standby_saved_max_bytes_;
+  std::string standby_saved_back_bytes_;
+  bool standby_unmute_ = false;
+  std::atomic<int64_t> zap_started_ticks_{0};
+  std::atomic<bool> loading_{false};
+  LatencyHistogram zap_latency_;
+
+  // Open-phase timing. create_reported_ turns true once the constructor's
+  // timings went out with an "opened" event.
+  OpenTimeline open_timeline_;
+  CreateTiming create_timing_;
+  std::atomic<bool> create_reported_{false};
+
+  // Benchmark runs. Open() takes the baseline into benchmark_next_ right
+  // before loadfile and sets benchmark_pending_; the event thread starts the
+  // run on FILE_LOADED and owns the rest. Open() also arms
+  // benchmark_first_frame_ticks_ (-1) for the render thread to stamp with
+  // the next new frame, where the run's clock starts.
+  struct BenchmarkBaseline {
+    PipelineStats::Counters counters;
+    int64_t cpu_us = 0;
+    SteadyClock::time_point issued{};
+  };
+  std::atomic<bool> benchmark_pending_{false};
+  std::mutex benchmark_mutex_;  // guards benchmark_next_
+  BenchmarkBaseline benchmark_next_;
+  std::atomic<int64_t> benchmark_first_frame_ticks_{0};
+  bool benchmark_active_ = false;
+  BenchmarkBaseline benchmark_run_;
+
+  // Frame grabs; the worker is started on first use.
+  std::mutex capture_mutex_;
+  std::unique_ptr<FrameCapturer> capturer_;
+
+  // Disk cache. disk_cache_ is what new files use; the rest is event-thread
+  // only: the store, URL and check time of the file being recorded, and
+  // whether its dump-cache is running.
+  std::mutex disk_cache_mutex_;
+  std::shared_ptr<DiskCacheStore> disk_cache_;
+  bool disk_cache_hooked_ = false;  // guarded by disk_cache_mutex_
+  std::shared_ptr<DiskCacheStore> recording_store_;
+  std::string recording_url_;
+  bool recording_dump_pending_ = false;
+  SteadyClock::time_point next_recording_check_{};
+
+  // Cache-state stream; next_cache_state_ is event-thread only.
+  std::atomic<int> cache_state_interval_ms_{0};
+  SteadyClock::time_point next_cache_state_{};
+
+  // Telemetry stream; next_telemetry_ is event-thread only.
+  std::atomic<int> telemetry_interval_ms_{0};
+  SteadyClock::time_point next_telemetry_{};
 
   // Pending open request (consumed by render thread to avoid gl/mpv races).
   std::mutex cmd_mutex_;
@@ -92,4 +501,7 @@ class MpvPlayer {
   std::atomic<bool> has_pending_open_{false};
 };
 
+flutter::EncodableMap TelemetryToMap(const MpvPlayer::Telemetry& t);
+flutter::EncodableMap CacheStateToMap(const MpvPlayer::CacheState& c);
+
 }  // namespace mpv_native_texture
@@ -0,0 +1,117 @@
+#include "open_timing.h"
+
+namespace mpv_native_texture {
+
+const char* OpenTimeline::PhaseName(Phase phase) {
+  switch (phase) {
+    case kOpen:
+      return "open";
+    case kStartFile:
+      return "startFile";
+    case kPreloaded:
+      return "preloaded";
+    case kFileLoaded:
+      return "fileLoaded";
+    case kFirstRender:
+      return "firstRender";
+    case kFirstPublish:
+      return "firstPublish";
+    case kFirstCopy:
+      return "firstCopy";
+    default:
+      return "unknown";
+  }
+}
+
+void OpenTimeline::Begin(SteadyClock::time_point now) {
+  running_.store(false);
+  for (int i = kPhaseCount - 1; i > kOpen; --i) ticks_[i].store(0);
+  ticks_[kOpen].store(now.time_since_epoch().count());
+  running_.store(true);
+}
+
+bool OpenTimeline::Mark(Phase phase, SteadyClock::time_point now) {
+  if (phase <= kOpen || phase >= kPhaseCount || !running_.load()) return false;
+  if (ticks_[phase - 1].load() == 0) return false;
+  int64_t unset = 0;
+  if (!ticks_[phase].compare_exchange_strong(unset, now.time_since_epoch().count())) return false;
+  if (phase != kFirstCopy) return true;
+  return running_.exchange(false);
+}
+
+bool OpenTimeline::Fail() {
+  if (ticks_[kStartFile].load() == 0) return false;
+  return running_.exchange(false);
+}
+
+std::array<int64_t, OpenTimeline::kPhaseCount> OpenTimeline::Offsets() const {
+  std::array<int64_t, kPhaseCount> out;
+  const int64_t open = ticks_[kOpen].load();
+  for (int i = 0; i < kPhaseCount; ++i) {
+    const int64_t t = ticks_[i].load();
+    out[i] = (open == 0 || t == 0)
+                 ? -1
+                 : MicrosBetween(SteadyClock::time_point(SteadyClock::duration(open)),
+                                 SteadyClock::time_point(SteadyClock::duration(t)));
+  }
+  return out;
+}
+
+const char* CreateTiming::PhaseName(Phase phase) {
+  switch (phase) {
+    case kRegisterTexture:
+      return "registerTexture";
+    case kGlInit:
+      return "glInit";
+    case kLoadDll:
+      return "loadDll";
+    case kMpvCreate:
+      return "mpvCreate";
+    case kMpvInitialize:
+      return "mpvInitialize";
+    case kRenderContext:
+      return "renderContext";
+    default:
+      return "unknown";
+  }
+}
+
+OpenTimingStats& OpenTimingStats::Instance() {
+  static OpenTimingStats stats;
+  return stats;
+}
+
+void OpenTimingStats::RecordCreate(const CreateTiming& timing) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int i = 0; i < CreateTiming::kPhaseCount; ++i) create_[i].Record(timing.phase_us[i]);
+  create_total_.Record(timing.total_us);
+}
+
+void OpenTimingStats::RecordOpen(const std::array<int64_t, OpenTimeline::kPhaseCount>& offsets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int i = OpenTimeline::kOpen + 1; i < OpenTimeline::kPhaseCount; ++i) {
+    if (offsets[i] >= 0 && offsets[i - 1] >= 0) open_[i].Record(offsets[i] - offsets[i - 1]);
+  }
+  open_total_.Record(offsets[OpenTimeline::kFirstCopy]);
+  opens_completed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+OpenTimingStats::Snapshot OpenTimingStats::TakeSnapshot(bool reset) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snap;
+  for (int i = 0; i < CreateTiming::kPhaseCount; ++i) snap.create[i] = create_[i].Summarize();
+  snap.create_total = create_total_.Summarize();
+  for (int i = 0; i < OpenTimeline::kPhaseCount; ++i) snap.open[i] = open_[i].Summarize();
+  snap.open_total = open_total_.Summarize();
+  snap.opens_completed = opens_completed_.load();
+  snap.opens_failed = opens_failed_.load();
+  if (reset) {
+    for (auto& h : create_) h.Reset();
+    create_total_.Reset();
+    for (auto& h : open_) h.Reset();
+    open_total_.Reset();
+  }
+  return snap;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Where the time goes between Open() and the first frame on screen.
+//
+// Each phase is stamped by the thread that sees it happen: the control
+// thread (open), the event thread (start, preloaded, loaded), the render
+// thread (first new frame rendered, first publish) and the raster thread
+// (first CopyPixelBuffer). A phase only counts once the one before it has,
+// so late events of the previous file and playlist advances never stamp
+// the current open.
+class OpenTimeline {
+ public:
+  enum Phase {
+    kOpen = 0,      // Open() issued loadfile
+    kStartFile,     // MPV_EVENT_START_FILE
+    kPreloaded,     // on_preloaded hook: connected, probed, tracks known
+    kFileLoaded,    // MPV_EVENT_FILE_LOADED
+    kFirstRender,   // first new video frame rendered (first decoded frame)
+    kFirstPublish,  // first MarkTextureFrameAvailable of the file
+    kFirstCopy,     // first CopyPixelBuffer after that publish
+    kPhaseCount
+  };
+
+  static const char* PhaseName(Phase phase);
+
+  // Starts a new timeline at |now|, dropping any unfinished one.
+  void Begin(SteadyClock::time_point now);
+  // Stamps |phase| if the timeline is running, the previous phase is
+  // stamped and this one is not. Stamping kFirstCopy completes the
+  // timeline; true means the caller should report it.
+  bool Mark(Phase phase, SteadyClock::time_point now);
+  // Ends a running timeline that got as far as kStartFile without
+  // completing. True means the caller should report the failure.
+  bool Fail();
+
+  // Microseconds from kOpen to each phase; -1 for phases not reached.
+  std::array<int64_t, kPhaseCount> Offsets() const;
+
+ private:
+  std::array<std::atomic<int64_t>, kPhaseCount> ticks_{};
+  std::atomic<bool> running_{false};
+};
+
+// Player construction, split the same way.
+struct CreateTiming {
+  enum Phase {
+    kRegisterTexture = 0,  // PixelBufferTexture + RegisterTexture
+    kGlInit,               // WGL context, MakeCurrent, GL function pointers
+    kLoadDll,              // mpv-2.dll
+    kMpvCreate,            // mpv_create + options
+    kMpvInitialize,        // mpv_initialize
+    kRenderContext,        // mpv_render_context_create + FBO
+    kPhaseCount
+  };
+
+  static const char* PhaseName(Phase phase);
+
+  std::array<int64_t, kPhaseCount> phase_us{};
+  int64_t total_us = 0;
+};
+
+// Open and create timings of all players in the process, for getOpenStats.
+// Open histograms hold the duration of each phase (from the previous one)
+// plus "total", Open() to first CopyPixelBuffer.
+class OpenTimingStats {
+ public:
+  static OpenTimingStats& Instance();
+
+  struct Snapshot {
+    std::array<LatencyHistogram::Summary, CreateTiming::kPhaseCount> create;
+    LatencyHistogram::Summary create_total;
+    std::array<LatencyHistogram::Summary, OpenTimeline::kPhaseCount> open;  // [kOpen] unused
+    LatencyHistogram::Summary open_total;
+    uint64_t opens_completed = 0;
+    uint64_t opens_failed = 0;
+  };
+
+  void RecordCreate(const CreateTiming& timing);
+  // |offsets| as returned by OpenTimeline::Offsets() for a completed open.
+  void RecordOpen(const std::array<int64_t, OpenTimeline::kPhaseCount>& offsets);
+  void CountFailedOpen() { opens_failed_.fetch_add(1, std::memory_order_relaxed); }
+
+  Snapshot TakeSnapshot(bool reset);
+
+ private:
+  OpenTimingStats() = default;
+
+  // Players record from their own threads; LatencyHistogram wants one
+  // writer at a time.
+  std::mutex mutex_;
+  std::array<LatencyHistogram, CreateTiming::kPhaseCount> create_;
+  LatencyHistogram create_total_;
+  std::array<LatencyHistogram, OpenTimeline::kPhaseCount> open_;
+  LatencyHistogram open_total_;
+  std::atomic<uint64_t> opens_completed_{0};
+  std::atomic<uint64_t> opens_failed_{0};
+};
+
+}  // namespace mpv_native_texture
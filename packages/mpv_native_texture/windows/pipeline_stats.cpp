@@ -0,0 +1,135 @@
+#include "pipeline_stats.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace mpv_native_texture {
+
+static int HighestBit(uint64_t v) {
+#ifdef _MSC_VER
+  unsigned long index = 0;
+  _BitScanReverse64(&index, v);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(v);
+#endif
+}
+
+int LatencyHistogram::BucketFor(uint64_t micros) {
+  if (micros < static_cast<uint64_t>(kSubBuckets)) return static_cast<int>(micros);
+  const int octave = HighestBit(micros);
+  const int sub = static_cast<int>((micros >> (octave - kSubBucketBits)) & (kSubBuckets - 1));
+  const int index = (octave - kSubBucketBits + 1) * kSubBuckets + sub;
+  return std::min(index, kBucketCount - 1);
+}
+
+int64_t LatencyHistogram::BucketUpperBound(int index) {
+  if (index < kSubBuckets) return index;
+  const int octave = index / kSubBuckets + kSubBucketBits - 1;
+  const int sub = index % kSubBuckets;
+  const int shift = octave - kSubBucketBits;
+  const int64_t lower = static_cast<int64_t>(kSubBuckets + sub) << shift;
+  return lower + (int64_t{1} << shift) - 1;
+}
+
+void LatencyHistogram::Record(int64_t micros) {
+  if (micros < 0) micros = 0;
+  buckets_[BucketFor(static_cast<uint64_t>(micros))].fetch_add(1, std::memory_order_relaxed);
+  sum_us_.fetch_add(static_cast<uint64_t>(micros), std::memory_order_relaxed);
+  if (micros > max_us_.load(std::memory_order_relaxed)) {
+    max_us_.store(micros, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+  sum_us_.store(0, std::memory_order_relaxed);
+  max_us_.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const {
+  std::array<uint32_t, kBucketCount> counts{};
+  uint64_t total = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  Summary s;
+  s.count = total;
+  s.max_us = max_us_.load(std::memory_order_relaxed);
+  if (total == 0) return s;
+  s.mean_us = static_cast<double>(sum_us_.load(std::memory_order_relaxed)) / static_cast<double>(total);
+
+  // Percentiles report the bucket's upper bound, clamped to the observed max.
+  const auto percentile = [&](double q) -> int64_t {
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+      seen += counts[i];
+      if (seen >= rank) return std::min(BucketUpperBound(i), s.max_us);
+    }
+    return s.max_us;
+  };
+  s.p50_us = percentile(0.50);
+  s.p95_us = percentile(0.95);
+  s.p99_us = percentile(0.99);
+  return s;
+}
+
+const char* PipelineStats::StageName(Stage stage) {
+  switch (stage) {
+    case kWakeup: return "wakeup";
+    case kMakeCurrent: return "makeCurrent";
+    case kRender: return "render";
+    case kReadback: return "readback";
+    case kPublish: return "publish";
+    case kConsume: return "consume";
+    default: return "unknown";
+  }
+}
+
+void PipelineStats::CountPublished(bool overwrote_unconsumed) {
+  frames_published_.fetch_add(1, std::memory_order_relaxed);
+  if (overwrote_unconsumed) frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+PipelineStats::Counters PipelineStats::counters() const {
+  Counters c;
+  c.frames_rendered = frames_rendered_.load(std::memory_order_relaxed);
+  c.frames_skipped = frames_skipped_.load(std::memory_order_relaxed);
+  c.frames_published = frames_published_.load(std::memory_order_relaxed);
+  c.frames_consumed = frames_consumed_.load(std::memory_order_relaxed);
+  c.frames_dropped = frames_dropped_.load(std::memory_order_relaxed);
+  return c;
+}
+
+PipelineStats::Snapshot PipelineStats::TakeSnapshot(bool reset) {
+  Snapshot snap;
+  for (int i = 0; i < kStageCount; ++i) {
+    snap.stages[i] = stages_[i].Summarize();
+    if (reset) stages_[i].Reset();
+  }
+  const Counters c = counters();
+  snap.frames_rendered = c.frames_rendered;
+  snap.frames_skipped = c.frames_skipped;
+  snap.frames_published = c.frames_published;
+  snap.frames_consumed = c.frames_consumed;
+  snap.frames_dropped = c.frames_dropped;
+
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  const auto now = SteadyClock::now();
+  const int64_t elapsed_us = MicrosBetween(last_snapshot_time_, now);
+  if (elapsed_us > 0) {
+    snap.fps = static_cast<double>(snap.frames_published - last_snapshot_published_) * 1e6 /
+               static_cast<double>(elapsed_us);
+  }
+  last_snapshot_time_ = now;
+  last_snapshot_published_ = snap.frames_published;
+  return snap;
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace mpv_native_texture {
+
+using SteadyClock = std::chrono::steady_clock;
+
+inline int64_t MicrosBetween(SteadyClock::time_point from, SteadyClock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+// Fixed-bucket latency histogram in microseconds.
+//
+// Buckets are log-linear (4 sub-buckets per power of two, ~25% resolution) and
+// cover 0 us .. ~67 s. Recording is a bit scan plus relaxed atomic adds, so it
+// is cheap enough to stay enabled in production. One writer thread at a time;
+// any thread may summarize.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 2;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kBucketCount = kSubBuckets * 26;
+
+  struct Summary {
+    uint64_t count = 0;
+    double mean_us = 0.0;
+    int64_t p50_us = 0;
+    int64_t p95_us = 0;
+    int64_t p99_us = 0;
+    int64_t max_us = 0;
+  };
+
+  void Record(int64_t micros);
+  void Reset();
+  Summary Summarize() const;
+
+ private:
+  static int BucketFor(uint64_t micros);
+  static int64_t BucketUpperBound(int index);
+
+  std::array<std::atomic<uint32_t>, kBucketCount> buckets_{};
+  std::atomic<uint64_t> sum_us_{0};
+  std::atomic<int64_t> max_us_{0};
+};
+
+// Per-player frame pipeline timings and counters, recorded by the render
+// thread and CopyPixelBuffer and read back through getStats.
+class PipelineStats {
+ public:
+  enum Stage {
+    kWakeup = 0,   // RequestRender -> render thread wakes up
+    kMakeCurrent,  // wglMakeCurrent
+    kRender,       // mpv_render_context_render
+    kReadback,     // glReadPixels into the back buffer
+    kPublish,      // pixel_mutex_ wait + front/back swap
+    kConsume,      // publish -> CopyPixelBuffer picks the frame up
+    kStageCount
+  };
+
+  static const char* StageName(Stage stage);
+
+  struct Snapshot {
+    std::array<LatencyHistogram::Summary, kStageCount> stages;
+    uint64_t frames_rendered = 0;
+    uint64_t frames_skipped = 0;
+    uint64_t frames_published = 0;
+    uint64_t frames_consumed = 0;
+    uint64_t frames_dropped = 0;  // published, then overwritten unconsumed
+    double fps = 0.0;             // published frames/s since the last snapshot
+    // mpv's own drop counters (frame-drop-count, decoder-frame-drop-count);
+    // -1 when unavailable.
+    int64_t mpv_frame_drops = -1;
+    int64_t mpv_decoder_frame_drops = -1;
+  };
+
+  struct Counters {
+    uint64_t frames_rendered = 0;
+    uint64_t frames_skipped = 0;
+    uint64_t frames_published = 0;
+    uint64_t frames_consumed = 0;
+    uint64_t frames_dropped = 0;
+  };
+
+  void Record(Stage stage, int64_t micros) { stages_[stage].Record(micros); }
+  Counters counters() const;
+
+  void CountRendered() { frames_rendered_.fetch_add(1, std::memory_order_relaxed); }
+  void CountSkipped() { frames_skipped_.fetch_add(1, std::memory_order_relaxed); }
+  // Call under the publish lock; |overwrote_unconsumed| when the previous
+  // frame never reached CopyPixelBuffer.
+  void CountPublished(bool overwrote_unconsumed);
+  void CountConsumed() { frames_consumed_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Builds a snapshot and, if |reset|, clears the histograms afterwards.
+  // Counters are monotonic and never reset.
+  Snapshot TakeSnapshot(bool reset);
+
+ private:
+  std::array<LatencyHistogram, kStageCount> stages_;
+  std::atomic<uint64_t> frames_rendered_{0};
+  std::atomic<uint64_t> frames_skipped_{0};
+  std::atomic<uint64_t> frames_published_{0};
+  std::atomic<uint64_t> frames_consumed_{0};
+  std::atomic<uint64_t> frames_dropped_{0};
+
+  std::mutex snapshot_mutex_;
+  SteadyClock::time_point last_snapshot_time_ = SteadyClock::now();
+  uint64_t last_snapshot_published_ = 0;
+};
+
+}  // namespace mpv_native_texture
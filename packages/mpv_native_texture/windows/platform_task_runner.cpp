@@ -0,0 +1,49 @@
+#include "platform_task_runner.h"
+
+#include <Windows.h>
+
+#include <optional>
+#include <utility>
+
+namespace mpv_native_texture {
+
+// Private window message used to wake the platform thread.
+static constexpr UINT kRunTasksMessage = WM_APP + 0x4D50;  // 'MP'
+
+PlatformTaskRunner::PlatformTaskRunner(flutter::PluginRegistrarWindows* registrar) : registrar_(registrar) {
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [this](HWND /*hwnd*/, UINT message, WPARAM /*wparam*/, LPARAM /*lparam*/) -> std::optional<LRESULT> {
+        if (message != kRunTasksMessage) return std::nullopt;
+        RunPendingTasks();
+        return 0;
+      });
+}
+
+PlatformTaskRunner::~PlatformTaskRunner() {
+  if (window_proc_id_ >= 0) {
+    registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+  }
+}
+
+void PlatformTaskRunner::PostTask(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+  flutter::FlutterView* view = registrar_->GetView();
+  HWND child = view ? view->GetNativeWindow() : nullptr;
+  HWND top = child ? GetAncestor(child, GA_ROOT) : nullptr;
+  if (top) PostMessage(top, kRunTasksMessage, 0, 0);
+}
+
+void PlatformTaskRunner::RunPendingTasks() {
+  std::deque<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks.swap(tasks_);
+  }
+  for (auto& task : tasks) task();
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <flutter/plugin_registrar_windows.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace mpv_native_texture {
+
+// Runs closures on the Flutter platform thread.
+//
+// Method results and event sinks may only be used from the platform thread,
+// but player events and async work complete on worker threads. PostTask()
+// queues the closure and posts a private message to the top-level Flutter
+// window; the registered WindowProc delegate drains the queue there.
+class PlatformTaskRunner {
+ public:
+  explicit PlatformTaskRunner(flutter::PluginRegistrarWindows* registrar);
+  ~PlatformTaskRunner();
+
+  PlatformTaskRunner(const PlatformTaskRunner&) = delete;
+  PlatformTaskRunner& operator=(const PlatformTaskRunner&) = delete;
+
+  // Thread safe. Tasks posted before a window exists are run with the next
+  // successful post.
+  void PostTask(std::function<void()> task);
+
+ private:
+  void RunPendingTasks();
+
+  flutter::PluginRegistrarWindows* registrar_ = nullptr;
+  int window_proc_id_ = -1;
+
+  std::mutex mutex_;
+  std::deque<std::function<void()>> tasks_;
+};
+
+}  // namespace mpv_native_texture
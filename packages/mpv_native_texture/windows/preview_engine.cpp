@@ -0,0 +1,198 @@
+#include "preview_engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "logger.h"
+#include "trace.h"
+
+namespace mpv_native_texture {
+
+// Generous: the first request also waits for the file to open.
+static constexpr std::chrono::milliseconds kOpenTimeout(10000);
+static constexpr std::chrono::milliseconds kSeekTimeout(3000);
+
+static PreviewEngine::Config Clamped(PreviewEngine::Config config) {
+  config.width = std::max(16, std::min(config.width, 1920));
+  config.height = std::max(16, std::min(config.height, 1080));
+  if (!(config.quantum > 0)) config.quantum = 1.0;
+  config.cache_entries = std::max<size_t>(1, config.cache_entries);
+  return config;
+}
+
+PreviewEngine::PreviewEngine(flutter::TextureRegistrar* registrar, const std::string& path, const Config& config)
+    : registrar_(registrar), path_(path), config_(Clamped(config)) {
+  front_rgba_.assign(static_cast<size_t>(config_.width) * static_cast<size_t>(config_.height) * 4u, 0);
+  for (size_t i = 3; i < front_rgba_.size(); i += 4) front_rgba_[i] = 0xFF;
+  pixel_buffer_.width = static_cast<size_t>(config_.width);
+  pixel_buffer_.height = static_cast<size_t>(config_.height);
+  pixel_buffer_.buffer = front_rgba_.data();
+
+  flutter::PixelBufferTexture::CopyBufferCallback copy_callback =
+      [this](size_t /*w*/, size_t /*h*/) -> const FlutterDesktopPixelBuffer* { return CopyPixelBuffer(); };
+  texture_variant_ = std::unique_ptr<flutter::TextureVariant>(
+      new flutter::TextureVariant(std::in_place_type<flutter::PixelBufferTexture>, copy_callback));
+  texture_id_ = registrar_->RegisterTexture(texture_variant_.get());
+
+  worker_ = std::thread([this] { WorkerMain(); });
+}
+
+PreviewEngine::~PreviewEngine() {
+  std::optional<Pending> pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    pending.swap(pending_);
+  }
+  cv_.notify_all();
+  mpv_.Interrupt();
+  if (worker_.joinable()) worker_.join();
+  if (pending) {
+    Result result;
+    result.superseded = true;
+    pending->done(std::move(result));
+  }
+  if (!unregistered_.exchange(true) && registrar_ && texture_id_ >= 0) {
+    registrar_->UnregisterTexture(texture_id_);
+  }
+}
+
+const FlutterDesktopPixelBuffer* PreviewEngine::CopyPixelBuffer() {
+  if (unregistered_.load()) return nullptr;
+  std::lock_guard<std::mutex> lock(pixel_mutex_);
+  return &pixel_buffer_;
+}
+
+void PreviewEngine::Show(const std::vector<uint8_t>& pixels) {
+  {
+    std::lock_guard<std::mutex> lock(pixel_mutex_);
+    if (pixels.size() != front_rgba_.size()) return;
+    std::copy(pixels.begin(), pixels.end(), front_rgba_.begin());
+  }
+  if (!unregistered_.load()) registrar_->MarkTextureFrameAvailable(texture_id_);
+}
+
+const PreviewEngine::Entry* PreviewEngine::Lookup(int64_t key) {
+  const auto it = index_.find(key);
+  if (it == index_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return &*it->second;
+}
+
+void PreviewEngine::Insert(Entry entry) {
+  const auto it = index_.find(entry.key);
+  if (it != index_.end()) {
+    lru_.erase(it->second);
+    index_.erase(it);
+  }
+  while (!lru_.empty() && lru_.size() >= config_.cache_entries) {
+    index_.erase(lru_.back().key);
+    lru_.pop_back();
+  }
+  lru_.push_front(std::move(entry));
+  index_[lru_.front().key] = lru_.begin();
+}
+
+void PreviewEngine::Request(double seconds, Done done) {
+  const auto now = SteadyClock::now();
+  const int64_t key = std::llround(std::max(0.0, seconds) / config_.quantum);
+
+  std::optional<Pending> replaced;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t seq = ++last_seq_;
+    if (const Entry* entry = Lookup(key)) {
+      ++hits_;
+      Result result;
+      result.ok = true;
+      result.cached = true;
+      result.time = entry->time;
+      const std::vector<uint8_t> pixels = entry->pixels;
+      lock.unlock();
+      Show(pixels);
+      result.latency_us = MicrosBetween(now, SteadyClock::now());
+      done(std::move(result));
+      return;
+    }
+    ++misses_;
+    if (pending_) {
+      ++superseded_;
+      replaced.swap(pending_);
+    }
+    pending_ = Pending{seq, key, now, std::move(done)};
+  }
+  cv_.notify_one();
+  if (replaced) {
+    Result result;
+    result.superseded = true;
+    replaced->done(std::move(result));
+  }
+}
+
+void PreviewEngine::WorkerMain() {
+  trace::SetThreadName("MpvPreview");
+  std::string open_error;
+  bool opened = false;
+  if (!mpv_.Init(config_.width, config_.height, &open_error) || !mpv_.Load(path_, kOpenTimeout, &open_error)) {
+    Logger::Instance().Write("[PreviewEngine] Open failed: " + open_error + "\n");
+  } else {
+    opened = true;
+  }
+
+  for (;;) {
+    Pending job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || pending_.has_value(); });
+      if (stopping_) return;
+      job = std::move(*pending_);
+      pending_.reset();
+    }
+
+    Result result;
+    if (!opened) {
+      result.error = open_error;
+      job.done(std::move(result));
+      continue;
+    }
+
+    Entry entry;
+    entry.key = job.key;
+    double target = static_cast<double>(job.key) * config_.quantum;
+    if (mpv_.duration() > 0) target = std::min(target, mpv_.duration());
+    const auto decode_start = SteadyClock::now();
+    {
+      MPV_TRACE_SCOPE("preview", "seek");
+      result.ok = mpv_.SeekKeyframe(target, kSeekTimeout, &entry.pixels, &entry.time, &result.error);
+    }
+    const auto decoded = SteadyClock::now();
+    if (result.ok) {
+      result.time = entry.time;
+      bool latest;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest = job.seq == last_seq_;
+        decode_.Record(MicrosBetween(decode_start, decoded));
+      }
+      // A cache hit requested meanwhile is already on screen; keep it.
+      if (latest) Show(entry.pixels);
+      std::lock_guard<std::mutex> lock(mutex_);
+      Insert(std::move(entry));
+    }
+    result.latency_us = MicrosBetween(job.requested_at, SteadyClock::now());
+    job.done(std::move(result));
+  }
+}
+
+PreviewEngine::Snapshot PreviewEngine::TakeSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snap;
+  snap.hits = hits_;
+  snap.misses = misses_;
+  snap.superseded = superseded_;
+  snap.entries = lru_.size();
+  snap.decode = decode_.Summarize();
+  return snap;
+}
+
+}  // namespace mpv_native_texture
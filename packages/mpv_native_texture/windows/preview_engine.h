@@ -0,0 +1,123 @@
+#pragma once
+
+#include <flutter/texture_registrar.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "headless_mpv.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Seek-bar hover previews for one media file.
+//
+// A HeadlessMpv on a worker thread decodes keyframes at thumbnail size, so
+// the main player is never seeked. Requests are quantized to |quantum|
+// seconds and decoded thumbnails kept in an LRU cache keyed by that bucket;
+// cache hits are shown immediately on the calling thread. Misses go to the
+// worker latest-wins: while the pointer moves, only the newest position is
+// decoded and older pending requests complete as superseded. The preview is
+// shown on a texture of its own.
+class PreviewEngine {
+ public:
+  struct Config {
+    int width = 160;
+    int height = 90;
+    double quantum = 2.0;          // seconds per cache bucket
+    size_t cache_entries = 256;    // ~14 MB at 160x90
+  };
+
+  struct Result {
+    bool ok = false;
+    bool cached = false;
+    bool superseded = false;  // a newer request replaced this one
+    double time = 0.0;        // time-pos of the frame shown
+    int64_t latency_us = 0;
+    std::string error;
+  };
+  // Called on the worker thread, or the requesting thread for cache hits.
+  using Done = std::function<void(Result)>;
+
+  struct Snapshot {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t superseded = 0;
+    size_t entries = 0;
+    LatencyHistogram::Summary decode;
+  };
+
+  // Platform thread: registers the texture and starts the worker, which
+  // opens |path| in the background.
+  PreviewEngine(flutter::TextureRegistrar* registrar, const std::string& path, const Config& config);
+  ~PreviewEngine();
+
+  PreviewEngine(const PreviewEngine&) = delete;
+  PreviewEngine& operator=(const PreviewEngine&) = delete;
+
+  int64_t texture_id() const { return texture_id_; }
+  const Config& config() const { return config_; }
+
+  void Request(double seconds, Done done);
+  Snapshot TakeSnapshot() const;
+
+ private:
+  struct Entry {
+    int64_t key = 0;
+    double time = 0.0;
+    std::vector<uint8_t> pixels;
+  };
+  struct Pending {
+    uint64_t seq = 0;
+    int64_t key = 0;
+    SteadyClock::time_point requested_at{};
+    Done done;
+  };
+
+  void WorkerMain();
+  // Under mutex_: looks |key| up and marks it most recently used.
+  const Entry* Lookup(int64_t key);
+  // Under mutex_.
+  void Insert(Entry entry);
+  void Show(const std::vector<uint8_t>& pixels);
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer();
+
+  flutter::TextureRegistrar* registrar_ = nullptr;
+  std::unique_ptr<flutter::TextureVariant> texture_variant_;
+  int64_t texture_id_ = -1;
+  std::atomic<bool> unregistered_{false};
+
+  const std::string path_;
+  const Config config_;  // clamped
+
+  std::mutex pixel_mutex_;
+  FlutterDesktopPixelBuffer pixel_buffer_{};
+  std::vector<uint8_t> front_rgba_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+  std::optional<Pending> pending_;
+  uint64_t last_seq_ = 0;  // newest request; older results are not shown
+  std::list<Entry> lru_;  // most recently used first
+  std::unordered_map<int64_t, std::list<Entry>::iterator> index_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t superseded_ = 0;
+  LatencyHistogram decode_;
+
+  HeadlessMpv mpv_;  // worker thread only, apart from Interrupt()
+  std::thread worker_;
+};
+
+}  // namespace mpv_native_texture
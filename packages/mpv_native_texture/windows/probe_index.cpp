@@ -0,0 +1,252 @@
+#include "probe_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include "logger.h"
+
+namespace mpv_native_texture {
+
+static constexpr char kMagic[8] = {'M', 'P', 'V', 'P', 'R', 'O', 'B', 'E'};
+// 2: records carry flags.
+static constexpr uint32_t kFormatVersion = 2;
+// magic, u32 version, u32 reserved, u64 used bytes
+static constexpr uint64_t kHeaderBytes = 24;
+static constexpr uint64_t kUsedOffset = 16;
+static constexpr uint64_t kMinCapacity = 1 << 20;
+// Fixed part of a record: size, flags, file size, mtime, path length, info
+// length.
+static constexpr uint64_t kRecordFixedBytes = 4 + 4 + 8 + 8 + 4 + 4;
+static constexpr uint64_t kRecordPathOffset = 28;
+
+template <typename T>
+static T Load(const uint8_t* p) {
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  return value;
+}
+
+template <typename T>
+static uint8_t* Put(uint8_t* p, T value) {
+  std::memcpy(p, &value, sizeof(T));
+  return p + sizeof(T);
+}
+
+static std::string LastErrorMessage(const char* what) {
+  return std::string(what) + " failed: " + std::to_string(GetLastError());
+}
+
+ProbeIndex::~ProbeIndex() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Close();
+}
+
+void ProbeIndex::Close() {
+  if (view_) FlushViewOfFile(view_, 0);
+  Unmap();
+  if (file_ != INVALID_HANDLE_VALUE) {
+    // Give back the growth slack; the next Open maps it again as needed.
+    if (used_ >= kHeaderBytes) {
+      LARGE_INTEGER end;
+      end.QuadPart = static_cast<LONGLONG>(used_);
+      if (SetFilePointerEx(file_, end, nullptr, FILE_BEGIN)) SetEndOfFile(file_);
+    }
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+  entries_.clear();
+  capacity_ = used_ = stale_bytes_ = 0;
+}
+
+void ProbeIndex::Unmap() {
+  if (view_) UnmapViewOfFile(view_);
+  if (mapping_) CloseHandle(mapping_);
+  view_ = nullptr;
+  mapping_ = nullptr;
+  capacity_ = 0;
+}
+
+bool ProbeIndex::Map(uint64_t capacity, std::string* err_out) {
+  Unmap();
+  // Mapping past the end of the file grows it.
+  mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(capacity >> 32),
+                                static_cast<DWORD>(capacity & 0xFFFFFFFFu), nullptr);
+  if (!mapping_) {
+    if (err_out) *err_out = LastErrorMessage("CreateFileMapping");
+    return false;
+  }
+  view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+  if (!view_) {
+    if (err_out) *err_out = LastErrorMessage("MapViewOfFile");
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+    return false;
+  }
+  capacity_ = capacity;
+  return true;
+}
+
+void ProbeIndex::SetUsed(uint64_t used) {
+  used_ = used;
+  Put(view_ + kUsedOffset, used);
+}
+
+bool ProbeIndex::Open(const std::string& path, std::string* err_out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Close();
+  path_ = path;
+
+  const std::wstring wide = std::filesystem::u8path(path).wstring();
+  file_ = CreateFileW(wide.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                      FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    if (err_out) *err_out = LastErrorMessage("CreateFile");
+    return false;
+  }
+  LARGE_INTEGER size{};
+  GetFileSizeEx(file_, &size);
+  const uint64_t file_bytes = static_cast<uint64_t>(size.QuadPart);
+  if (!Map(std::max(kMinCapacity, file_bytes), err_out)) {
+    Close();
+    return false;
+  }
+
+  uint64_t used = 0;
+  if (file_bytes >= kHeaderBytes && std::memcmp(view_, kMagic, sizeof(kMagic)) == 0 &&
+      Load<uint32_t>(view_ + 8) == kFormatVersion) {
+    used = std::min(Load<uint64_t>(view_ + kUsedOffset), file_bytes);
+  } else {
+    if (file_bytes > 0) Logger::Instance().Write("[ProbeIndex] Discarding unrecognized " + path + "\n");
+    std::memcpy(view_, kMagic, sizeof(kMagic));
+    Put(view_ + 8, kFormatVersion);
+    Put(view_ + 12, uint32_t{0});
+  }
+  SetUsed(Scan(std::max(used, kHeaderBytes)));
+  if (stale_bytes_ > kMinCapacity && stale_bytes_ > used_ - kHeaderBytes - stale_bytes_) Compact();
+  return true;
+}
+
+uint64_t ProbeIndex::Scan(uint64_t used) {
+  entries_.clear();
+  stale_bytes_ = 0;
+  uint64_t offset = kHeaderBytes;
+  while (offset + kRecordFixedBytes <= used) {
+    const uint8_t* p = view_ + offset;
+    const uint32_t bytes = Load<uint32_t>(p);
+    if (bytes < kRecordFixedBytes || offset + bytes > used) break;
+    const uint32_t path_len = Load<uint32_t>(p + 24);
+    if (kRecordFixedBytes + path_len > bytes) break;
+    if (kRecordFixedBytes + path_len + Load<uint32_t>(p + kRecordPathOffset + path_len) != bytes) break;
+
+    Entry entry;
+    entry.offset = offset;
+    entry.bytes = bytes;
+    entry.flags = Load<uint32_t>(p + 4);
+    entry.file_size = Load<int64_t>(p + 8);
+    entry.mtime = Load<int64_t>(p + 16);
+    std::string media_path(reinterpret_cast<const char*>(p + kRecordPathOffset), path_len);
+    auto it = entries_.find(media_path);
+    if (it != entries_.end()) {
+      stale_bytes_ += it->second.bytes;
+      it->second = entry;
+    } else {
+      entries_.emplace(std::move(media_path), entry);
+    }
+    offset += bytes;
+  }
+  return offset;
+}
+
+void ProbeIndex::Compact() {
+  std::vector<Entry*> live;
+  live.reserve(entries_.size());
+  for (auto& kv : entries_) live.push_back(&kv.second);
+  std::sort(live.begin(), live.end(), [](const Entry* a, const Entry* b) { return a->offset < b->offset; });
+
+  // Records only ever move towards the header, so this can slide them down
+  // in place. Until it is done the header claims an empty index.
+  const uint64_t before = used_;
+  SetUsed(kHeaderBytes);
+  uint64_t offset = kHeaderBytes;
+  for (Entry* entry : live) {
+    if (entry->offset != offset) std::memmove(view_ + offset, view_ + entry->offset, entry->bytes);
+    entry->offset = offset;
+    offset += entry->bytes;
+  }
+  SetUsed(offset);
+  stale_bytes_ = 0;
+  Logger::Instance().Write("[ProbeIndex] Compacted " + std::to_string(before) + " -> " + std::to_string(offset) +
+                           " bytes\n");
+}
+
+bool ProbeIndex::Lookup(const std::string& media_path, int64_t file_size, int64_t mtime, uint32_t required,
+                        MediaInfo* info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!view_) return false;
+  const auto it = entries_.find(media_path);
+  if (it == entries_.end()) return false;
+  const Entry& entry = it->second;
+  if (entry.file_size != file_size || entry.mtime != mtime) return false;
+  if ((entry.flags & required) != required) return false;
+  const uint8_t* p = view_ + entry.offset + kRecordPathOffset + media_path.size();
+  const uint32_t info_len = Load<uint32_t>(p);
+  return DeserializeMediaInfo(p + 4, info_len, info);
+}
+
+bool ProbeIndex::Store(const std::string& media_path, int64_t file_size, int64_t mtime, uint32_t flags,
+                       const MediaInfo& info) {
+  std::string blob;
+  SerializeMediaInfo(info, &blob);
+  const uint64_t bytes = kRecordFixedBytes + media_path.size() + blob.size();
+  if (bytes > 0xFFFFFFFFu) return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!view_) return false;
+  if (used_ + bytes > capacity_) {
+    std::string err;
+    if (!Map(std::max(capacity_ * 2, used_ + bytes), &err)) {
+      Logger::Instance().Write("[ProbeIndex] Grow failed: " + err + "\n");
+      return false;
+    }
+  }
+
+  uint8_t* p = view_ + used_;
+  p = Put(p, static_cast<uint32_t>(bytes));
+  p = Put(p, flags);
+  p = Put(p, file_size);
+  p = Put(p, mtime);
+  p = Put(p, static_cast<uint32_t>(media_path.size()));
+  std::memcpy(p, media_path.data(), media_path.size());
+  p += media_path.size();
+  p = Put(p, static_cast<uint32_t>(blob.size()));
+  std::memcpy(p, blob.data(), blob.size());
+
+  Entry entry;
+  entry.offset = used_;
+  entry.bytes = static_cast<uint32_t>(bytes);
+  entry.flags = flags;
+  entry.file_size = file_size;
+  entry.mtime = mtime;
+  auto it = entries_.find(media_path);
+  if (it != entries_.end()) {
+    stale_bytes_ += it->second.bytes;
+    it->second = entry;
+  } else {
+    entries_.emplace(media_path, entry);
+  }
+  SetUsed(used_ + bytes);
+  return true;
+}
+
+ProbeIndex::Stats ProbeIndex::TakeStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.records = entries_.size();
+  stats.bytes = used_;
+  stats.stale_bytes = stale_bytes_;
+  return stats;
+}
+
+}  // namespace mpv_native_texture
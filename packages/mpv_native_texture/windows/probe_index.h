@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Windows.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "media_info.h"
+
+namespace mpv_native_texture {
+
+// Persistent probe results, memory-mapped from one file.
+//
+// The file is a 24-byte header followed by append-only records
+//
+//   u32 record_bytes, u32 flags, i64 file_size, i64 mtime, u32 path_len,
+//   path, u32 info_len, SerializeMediaInfo() blob
+//
+// A path maps to its newest record; the result is reused only while the
+// file's size and mtime still match, so a rescan re-probes just the files
+// that changed. |flags| says which optional parts the probe read; a lookup
+// that needs a part the record lacks is a miss, and the fuller probe result
+// then replaces the record. The header's used-bytes count is bumped after a record is
+// complete, so a crash mid-append loses at most that record. Superseded
+// records are dropped by compacting in place when the index is opened and
+// they outweigh the live ones. Thread safe.
+class ProbeIndex {
+ public:
+  // Record flags.
+  static constexpr uint32_t kVideoParams = 1u << 0;  // video-params were read
+
+  struct Stats {
+    size_t records = 0;
+    uint64_t bytes = 0;        // used, header included
+    uint64_t stale_bytes = 0;  // superseded records
+  };
+
+  ProbeIndex() = default;
+  ~ProbeIndex();
+
+  ProbeIndex(const ProbeIndex&) = delete;
+  ProbeIndex& operator=(const ProbeIndex&) = delete;
+
+  // Opens or creates the index file at |path| (UTF-8). A file that is not
+  // an index, or a damaged tail, is discarded rather than reported.
+  bool Open(const std::string& path, std::string* err_out);
+  const std::string& path() const { return path_; }
+
+  // Hits only when the record has every flag in |required|.
+  bool Lookup(const std::string& media_path, int64_t file_size, int64_t mtime, uint32_t required, MediaInfo* info);
+  bool Store(const std::string& media_path, int64_t file_size, int64_t mtime, uint32_t flags, const MediaInfo& info);
+  Stats TakeStats();
+
+ private:
+  struct Entry {
+    uint64_t offset = 0;
+    uint32_t bytes = 0;
+    uint32_t flags = 0;
+    int64_t file_size = 0;
+    int64_t mtime = 0;
+  };
+
+  void Close();
+  bool Map(uint64_t capacity, std::string* err_out);
+  void Unmap();
+  void SetUsed(uint64_t used);
+  // Rebuilds entries_ from the records; returns the end of the last valid one.
+  uint64_t Scan(uint64_t used);
+  void Compact();
+
+  std::mutex mutex_;
+  std::string path_;
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+  uint8_t* view_ = nullptr;
+  uint64_t capacity_ = 0;
+  uint64_t used_ = 0;
+  uint64_t stale_bytes_ = 0;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,97 @@
+#include "quality_governor.h"
+
+#include <algorithm>
+
+namespace mpv_native_texture {
+
+const char* QualityGovernor::LevelName(Level level) {
+  switch (level) {
+    case kFull: return "full";
+    case kNoInterpolation: return "noInterpolation";
+    case kBilinearScaling: return "bilinearScaling";
+    case kReducedResolution: return "reducedResolution";
+    case kFpsCap: return "fpsCap";
+    default: return "unknown";
+  }
+}
+
+bool QualityGovernor::OnFrame(int64_t cost_us, int64_t budget_us, SteadyClock::time_point now, Level* next) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Level current = level();
+
+  if (!enabled_.load()) {
+    if (current == kFull) return false;
+    MoveTo(kFull, now);
+    *next = kFull;
+    return true;
+  }
+  if (budget_us <= 0) return false;
+  if (current >= kFpsCap) budget_us *= kFpsCapDivisor;
+
+  const double sample = static_cast<double>(cost_us) / static_cast<double>(budget_us);
+  load_ = has_load_ ? load_ + kEwmaAlpha * (sample - load_) : sample;
+  has_load_ = true;
+
+  // Track how long the smoothed load has stayed on either side.
+  const bool over = load_ > kOverloadRatio;
+  const bool under = load_ < kHeadroomRatio;
+  if (over && !over_) over_since_ = now;
+  if (under && !under_) under_since_ = now;
+  over_ = over;
+  under_ = under;
+
+  if (now - last_transition_ < kSettleTime) return false;
+
+  if (over_ && now - over_since_ >= kStepDownAfter && current + 1 < kLevelCount) {
+    // Undoing a recent step-up: make the next one wait longer.
+    if (step_ups_ > 0 && now - last_step_up_ < kFlapWindow) {
+      step_up_after_ = std::min(step_up_after_ * 2, kMaxStepUpAfter);
+    }
+    MoveTo(static_cast<Level>(current + 1), now);
+    ++step_downs_;
+    *next = level();
+    return true;
+  }
+
+  if (under_ && now - under_since_ >= step_up_after_ && current > kFull) {
+    // Stable for a whole flap window since the last step-up: forgive.
+    if (now - last_step_up_ >= kFlapWindow + step_up_after_) step_up_after_ = kStepUpAfter;
+    MoveTo(static_cast<Level>(current - 1), now);
+    ++step_ups_;
+    last_step_up_ = now;
+    *next = level();
+    return true;
+  }
+  return false;
+}
+
+void QualityGovernor::MoveTo(Level to, SteadyClock::time_point now) {
+  Transition t;
+  t.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+  t.from = level();
+  t.to = to;
+  t.load = load_;
+  recent_.push_back(t);
+  if (recent_.size() > kRecentTransitions) recent_.pop_front();
+
+  level_.store(to);
+  last_transition_ = now;
+  // The new level changes the cost per frame; measure it from scratch.
+  has_load_ = false;
+  over_ = false;
+  under_ = false;
+}
+
+QualityGovernor::Snapshot QualityGovernor::TakeSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snap;
+  snap.enabled = enabled_.load();
+  snap.level = level();
+  snap.load = load_;
+  snap.step_downs = step_downs_;
+  snap.step_ups = step_ups_;
+  snap.recent.assign(recent_.begin(), recent_.end());
+  return snap;
+}
+
+}  // namespace mpv_native_texture
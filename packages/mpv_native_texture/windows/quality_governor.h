@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Adaptive render quality for one player.
+//
+// The render thread reports what each rendered frame cost (render + readback)
+// against the frame budget (1 / video fps). The load ratio is smoothed with an
+// EWMA; sustained overload steps quality down one level at a time, sustained
+// headroom steps it back up. Step-ups need a longer quiet period than
+// step-downs, and that period doubles whenever a step-up is undone soon
+// after, so a player sitting on the edge does not oscillate.
+class QualityGovernor {
+ public:
+  enum Level {
+    kFull = 0,
+    kNoInterpolation,    // interpolation=no
+    kBilinearScaling,    // scale/cscale/dscale=bilinear
+    kReducedResolution,  // FBO rendered at kReducedResolutionScale
+    kFpsCap,             // every other video frame skipped
+    kLevelCount
+  };
+
+  // Video frames per rendered frame at kFpsCap.
+  static constexpr int kFpsCapDivisor = 2;
+
+  static const char* LevelName(Level level);
+
+  // Per-axis FBO scale at kReducedResolution and above.
+  static constexpr double kReducedResolutionScale = 0.5;
+
+  struct Transition {
+    int64_t timestamp_us = 0;  // steady clock
+    Level from = kFull;
+    Level to = kFull;
+    double load = 0.0;  // smoothed cost / budget that triggered it
+  };
+
+  struct Snapshot {
+    bool enabled = true;
+    Level level = kFull;
+    double load = 0.0;
+    uint64_t step_downs = 0;
+    uint64_t step_ups = 0;
+    std::vector<Transition> recent;  // oldest first
+  };
+
+  // Render thread. |budget_us| is the time per video frame; at kFpsCap each
+  // rendered frame has kFpsCapDivisor of them, so the load reflects the
+  // relief the cap gives. Returns true and sets |*next| when the level
+  // changes.
+  bool OnFrame(int64_t cost_us, int64_t budget_us, SteadyClock::time_point now, Level* next);
+
+  // Any thread. Disabling returns to kFull on the next OnFrame.
+  void SetEnabled(bool enabled) { enabled_.store(enabled); }
+  bool enabled() const { return enabled_.load(); }
+
+  Level level() const { return static_cast<Level>(level_.load()); }
+  Snapshot TakeSnapshot() const;
+
+ private:
+  // Overload: smoothed load above kOverloadRatio for kStepDownAfter.
+  // Headroom: below kHeadroomRatio for step_up_after_ (starts at
+  // kStepUpAfter, doubles up to kMaxStepUpAfter when a step-up is reverted
+  // within kFlapWindow). No decision within kSettleTime of a transition.
+  static constexpr double kEwmaAlpha = 0.1;
+  static constexpr double kOverloadRatio = 0.9;
+  static constexpr double kHeadroomRatio = 0.5;
+  static constexpr std::chrono::milliseconds kStepDownAfter{1000};
+  static constexpr std::chrono::milliseconds kStepUpAfter{5000};
+  static constexpr std::chrono::milliseconds kMaxStepUpAfter{60000};
+  static constexpr std::chrono::milliseconds kFlapWindow{10000};
+  static constexpr std::chrono::milliseconds kSettleTime{1000};
+  static constexpr size_t kRecentTransitions = 16;
+
+  void MoveTo(Level to, SteadyClock::time_point now);
+
+  std::atomic<bool> enabled_{true};
+  std::atomic<int> level_{kFull};
+
+  mutable std::mutex mutex_;
+  double load_ = 0.0;
+  bool has_load_ = false;
+  SteadyClock::time_point over_since_{};
+  SteadyClock::time_point under_since_{};
+  bool over_ = false;
+  bool under_ = false;
+  SteadyClock::time_point last_transition_{};
+  SteadyClock::time_point last_step_up_{};
+  std::chrono::milliseconds step_up_after_{kStepUpAfter};
+  uint64_t step_downs_ = 0;
+  uint64_t step_ups_ = 0;
+  std::deque<Transition> recent_;
+};
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace mpv_native_texture {
+
+// Nearest-neighbour resample of tightly packed RGBA; a straight copy when the
+// size matches. Cheap enough for the render thread at preview sizes.
+inline void ResampleRgbaNearest(const uint8_t* src, int src_w, int src_h, uint8_t* dst, int dst_w, int dst_h) {
+  const size_t src_stride = static_cast<size_t>(src_w) * 4u;
+  const size_t dst_stride = static_cast<size_t>(dst_w) * 4u;
+  if (src_w == dst_w && src_h == dst_h) {
+    std::memcpy(dst, src, dst_stride * static_cast<size_t>(dst_h));
+    return;
+  }
+  std::vector<size_t> src_x(static_cast<size_t>(dst_w));
+  for (int x = 0; x < dst_w; ++x) {
+    src_x[static_cast<size_t>(x)] = static_cast<size_t>(static_cast<int64_t>(x) * src_w / dst_w) * 4u;
+  }
+  for (int y = 0; y < dst_h; ++y) {
+    const uint8_t* row = src + static_cast<size_t>(static_cast<int64_t>(y) * src_h / dst_h) * src_stride;
+    uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+    for (int x = 0; x < dst_w; ++x, out += 4) std::memcpy(out, row + src_x[static_cast<size_t>(x)], 4);
+  }
+}
+
+// Packed 32-bit pixels (|src_stride| bytes per row) to tightly packed opaque
+// RGBA; |swap_rb| for BGR0/BGRA input.
+inline void PackedToRgba(const uint8_t* src, size_t src_stride, int w, int h, bool swap_rb, uint8_t* dst) {
+  for (int y = 0; y < h; ++y) {
+    const uint8_t* row = src + static_cast<size_t>(y) * src_stride;
+    for (int x = 0; x < w; ++x, dst += 4, row += 4) {
+      dst[0] = swap_rb ? row[2] : row[0];
+      dst[1] = row[1];
+      dst[2] = swap_rb ? row[0] : row[2];
+      dst[3] = 255;
+    }
+  }
+}
+
+}  // namespace mpv_native_texture
@@ -0,0 +1,382 @@
+#include "sprite_sheet.h"
+
+#include <objbase.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "headless_mpv.h"
+#include "json_util.h"
+#include "trace.h"
+
+namespace mpv_native_texture {
+
+namespace fs = std::filesystem;
+
+static constexpr std::chrono::milliseconds kLoadTimeout(10000);
+static constexpr std::chrono::milliseconds kSeekTimeout(3000);
+// Bytes of the file mixed into the cache key besides size and mtime.
+static constexpr size_t kHashPrefixBytes = 64 * 1024;
+
+struct SpriteSheetBatch::File {
+  size_t index = 0;
+  std::string path;
+  std::string key;
+  int columns = 0;
+  int rows = 0;
+  bool cached = false;
+  std::vector<uint8_t> atlas;  // RGBA; chunks write disjoint tiles
+  std::vector<double> times;
+  std::atomic<int> chunks_left{0};
+  SteadyClock::time_point started{};
+
+  std::mutex mutex;  // duration and error
+  double duration = 0.0;
+  std::string error;
+
+  void Fail(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error.empty()) error = message;
+  }
+  bool failed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !error.empty();
+  }
+};
+
+// 64-bit FNV-1a.
+static void HashBytes(uint64_t* h, const void* data, size_t size) {
+  const auto* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    *h ^= p[i];
+    *h *= 1099511628211ull;
+  }
+}
+
+template <typename T>
+static void HashValue(uint64_t* h, T value) {
+  HashBytes(h, &value, sizeof(value));
+}
+
+// Content key: path, size, mtime and the first bytes of local files (URLs
+// hash their path only) plus every parameter that changes the output.
+static std::string CacheKey(const std::string& path, const SpriteSheetBatch::Options& options) {
+  uint64_t h = 14695981039346656037ull;
+  HashBytes(&h, path.data(), path.size());
+  std::error_code ec;
+  const fs::path file = fs::u8path(path);
+  if (fs::is_regular_file(file, ec)) {
+    HashValue(&h, static_cast<uint64_t>(fs::file_size(file, ec)));
+    HashValue(&h, static_cast<int64_t>(fs::last_write_time(file, ec).time_since_epoch().count()));
+    std::ifstream in(file, std::ios::binary);
+    std::vector<char> prefix(kHashPrefixBytes);
+    in.read(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+    HashBytes(&h, prefix.data(), static_cast<size_t>(in.gcount()));
+  }
+  HashValue(&h, options.count);
+  HashValue(&h, options.tile_width);
+  HashValue(&h, options.tile_height);
+  HashValue(&h, options.columns);
+  HashValue(&h, static_cast<int>(options.format));
+  HashValue(&h, options.jpeg_quality);
+
+  char hex[17] = {0};
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+  return hex;
+}
+
+static SpriteSheetBatch::Options Clamped(SpriteSheetBatch::Options options) {
+  options.count = std::max(1, std::min(options.count, 1000));
+  options.tile_width = std::max(16, std::min(options.tile_width, 640));
+  options.tile_height = std::max(16, std::min(options.tile_height, 360));
+  options.columns = std::max(1, std::min(options.columns, options.count));
+  if (options.format == ImageFormat::kRaw) options.format = ImageFormat::kJpeg;
+  options.jpeg_quality = std::max(1, std::min(options.jpeg_quality, 100));
+  if (options.cache_dir.empty()) {
+    std::error_code ec;
+    options.cache_dir = (fs::temp_directory_path(ec) / "mpv_native_texture_sprites").u8string();
+  }
+  return options;
+}
+
+SpriteSheetBatch::SpriteSheetBatch(std::vector<std::string> paths, const Options& options, Progress progress,
+                                   Done done)
+    : options_(Clamped(options)),
+      progress_(std::move(progress)),
+      done_(std::move(done)),
+      started_(SteadyClock::now()) {
+  const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  worker_count_ = std::max(1, std::min(options_.workers > 0 ? options_.workers : cores, 16));
+
+  std::error_code ec;
+  fs::create_directories(fs::u8path(options_.cache_dir), ec);
+
+  sheets_.resize(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    auto file = std::make_shared<File>();
+    file->index = i;
+    file->path = std::move(paths[i]);
+    sheets_[i].source = file->path;
+    tasks_.push_back(Task{std::move(file), -1, -1});
+  }
+  if (sheets_.empty()) {
+    finished_.store(true);
+    Summary summary;
+    summary.workers = worker_count_;
+    done_(std::move(summary));
+    return;
+  }
+
+  for (int i = 0; i < worker_count_; ++i) {
+    mpvs_.push_back(std::make_unique<HeadlessMpv>());
+    HeadlessMpv* mpv = mpvs_.back().get();
+    workers_.emplace_back([this, mpv] { WorkerMain(mpv); });
+  }
+}
+
+SpriteSheetBatch::~SpriteSheetBatch() {
+  cancelled_.store(true);
+  for (auto& mpv : mpvs_) mpv->Interrupt();
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+void SpriteSheetBatch::WorkerMain(HeadlessMpv* mpv) {
+  trace::SetThreadName("SpriteSheet");
+  const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  ImageEncoder encoder;
+  std::string encoder_error;
+  const bool encoder_ok = encoder.Init(&encoder_error);
+  std::string init_error;
+  const bool mpv_ok = mpv->Init(options_.tile_width, options_.tile_height, &init_error);
+  std::string loaded;
+
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) break;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    if (task.begin < 0) {
+      Prepare(task.file);
+      continue;
+    }
+    if (!mpv_ok) task.file->Fail(init_error);
+    if (!encoder_ok) task.file->Fail(encoder_error);
+    RunChunk(task, mpv, &loaded);
+    if (task.file->chunks_left.fetch_sub(1) == 1) Finish(task.file, &encoder);
+  }
+
+  if (SUCCEEDED(com)) CoUninitialize();
+}
+
+void SpriteSheetBatch::Prepare(const std::shared_ptr<File>& file) {
+  if (cancelled_.load()) {
+    file->Fail("Cancelled");
+    Complete(file);
+    return;
+  }
+  file->key = CacheKey(file->path, options_);
+  file->columns = options_.columns;
+  file->rows = (options_.count + options_.columns - 1) / options_.columns;
+
+  std::error_code ec;
+  const fs::path dir = fs::u8path(options_.cache_dir);
+  if (fs::exists(dir / (file->key + ".json"), ec)) {
+    file->cached = true;
+    Complete(file);
+    return;
+  }
+
+  file->atlas.assign(static_cast<size_t>(file->columns) * static_cast<size_t>(options_.tile_width) *
+                         static_cast<size_t>(file->rows) * static_cast<size_t>(options_.tile_height) * 4u,
+                     0);
+  for (size_t i = 3; i < file->atlas.size(); i += 4) file->atlas[i] = 0xFF;
+  file->times.assign(static_cast<size_t>(options_.count), 0.0);
+  file->started = SteadyClock::now();
+
+  // Contiguous chunks keep each worker's seeks moving forward.
+  const int chunks = std::min(worker_count_, options_.count);
+  file->chunks_left.store(chunks);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int c = 0; c < chunks; ++c) {
+      tasks_.push_back(Task{file, c * options_.count / chunks, (c + 1) * options_.count / chunks});
+    }
+  }
+  cv_.notify_all();
+}
+
+void SpriteSheetBatch::RunChunk(const Task& task, HeadlessMpv* mpv, std::string* loaded) {
+  File& file = *task.file;
+  if (file.failed()) return;
+  MPV_TRACE_SCOPE("sprites", "chunk");
+
+  std::string err;
+  if (*loaded != file.path) {
+    loaded->clear();
+    if (!mpv->Load(file.path, kLoadTimeout, &err)) {
+      file.Fail(err);
+      return;
+    }
+    *loaded = file.path;
+  }
+  const double duration = mpv->duration();
+  if (duration <= 0) {
+    file.Fail("Unknown duration");
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(file.mutex);
+    file.duration = duration;
+  }
+
+  const size_t tile_stride = static_cast<size_t>(options_.tile_width) * 4u;
+  const size_t atlas_stride = tile_stride * static_cast<size_t>(file.columns);
+  std::vector<uint8_t> tile;
+  for (int i = task.begin; i < task.end; ++i) {
+    if (cancelled_.load()) {
+      file.Fail("Cancelled");
+      return;
+    }
+    const double target = (i + 0.5) * duration / options_.count;
+    double landed = target;
+    // A frame that fails to decode stays black; the sheet is still useful.
+    if (!mpv->SeekKeyframe(target, kSeekTimeout, &tile, &landed, &err)) continue;
+    file.times[static_cast<size_t>(i)] = landed;
+
+    const size_t col = static_cast<size_t>(i % file.columns);
+    const size_t row = static_cast<size_t>(i / file.columns);
+    uint8_t* dst = file.atlas.data() + row * static_cast<size_t>(options_.tile_height) * atlas_stride +
+                   col * tile_stride;
+    for (int y = 0; y < options_.tile_height; ++y) {
+      std::memcpy(dst + static_cast<size_t>(y) * atlas_stride, tile.data() + static_cast<size_t>(y) * tile_stride,
+                  tile_stride);
+    }
+  }
+}
+
+void SpriteSheetBatch::Finish(const std::shared_ptr<File>& file, ImageEncoder* encoder) {
+  if (file->failed()) {
+    Complete(file);
+    return;
+  }
+  MPV_TRACE_SCOPE("sprites", "encode");
+  RgbaImage image;
+  image.width = file->columns * options_.tile_width;
+  image.height = file->rows * options_.tile_height;
+  image.pixels = std::move(file->atlas);
+  std::vector<uint8_t> encoded;
+  std::string err;
+  if (!encoder->Encode(image, image.width, image.height, options_.format, options_.jpeg_quality, &encoded, &err)) {
+    file->Fail(err);
+    Complete(file);
+    return;
+  }
+
+  const fs::path dir = fs::u8path(options_.cache_dir);
+  const std::string image_name = file->key + (options_.format == ImageFormat::kPng ? ".png" : ".jpg");
+  {
+    std::ofstream out(dir / image_name, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+    if (!out) {
+      file->Fail("Cannot write " + (dir / image_name).u8string());
+      Complete(file);
+      return;
+    }
+  }
+
+  // The index is written last: its presence marks a complete cache entry.
+  std::ostringstream index;
+  index << "{\"version\":1,\"source\":";
+  WriteJsonString(index, file->path.c_str());
+  index << ",\"duration\":" << file->duration << ",\"count\":" << options_.count << ",\"columns\":" << file->columns
+        << ",\"rows\":" << file->rows << ",\"tileWidth\":" << options_.tile_width
+        << ",\"tileHeight\":" << options_.tile_height << ",\"image\":";
+  WriteJsonString(index, image_name.c_str());
+  index << ",\"frames\":[";
+  for (int i = 0; i < options_.count; ++i) {
+    if (i) index << ',';
+    index << "{\"t\":" << file->times[static_cast<size_t>(i)] << ",\"x\":" << (i % file->columns) * options_.tile_width
+          << ",\"y\":" << (i / file->columns) * options_.tile_height << '}';
+  }
+  index << "]}";
+  const fs::path index_path = dir / (file->key + ".json");
+  const fs::path partial = dir / (file->key + ".json.part");
+  {
+    std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+    out << index.str();
+    if (!out) {
+      file->Fail("Cannot write " + partial.u8string());
+      Complete(file);
+      return;
+    }
+  }
+  std::error_code ec;
+  fs::rename(partial, index_path, ec);
+  if (ec) file->Fail("Cannot write " + index_path.u8string() + ": " + ec.message());
+  Complete(file);
+}
+
+void SpriteSheetBatch::Complete(const std::shared_ptr<File>& file) {
+  Sheet sheet;
+  sheet.source = file->path;
+  {
+    std::lock_guard<std::mutex> lock(file->mutex);
+    sheet.error = file->error;
+  }
+  sheet.ok = sheet.error.empty();
+  sheet.cached = sheet.ok && file->cached;
+  if (sheet.ok) {
+    const fs::path dir = fs::u8path(options_.cache_dir);
+    sheet.index_path = (dir / (file->key + ".json")).u8string();
+    sheet.image_path =
+        (dir / (file->key + (options_.format == ImageFormat::kPng ? ".png" : ".jpg"))).u8string();
+    sheet.count = options_.count;
+    sheet.columns = file->columns;
+    sheet.rows = file->rows;
+  }
+  if (!sheet.cached && file->started != SteadyClock::time_point{}) {
+    sheet.elapsed_us = MicrosBetween(file->started, SteadyClock::now());
+  }
+
+  size_t done = 0;
+  size_t total = 0;
+  bool last = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sheets_[file->index] = sheet;
+    done = ++files_done_;
+    total = sheets_.size();
+    last = done == total;
+    if (last) stopping_ = true;
+  }
+  if (last) cv_.notify_all();
+  if (progress_) progress_(sheet, done, total);
+  if (!last) return;
+
+  Summary summary;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    summary.sheets = sheets_;
+  }
+  summary.workers = worker_count_;
+  summary.elapsed_us = MicrosBetween(started_, SteadyClock::now());
+  if (summary.elapsed_us > 0) {
+    summary.files_per_minute = static_cast<double>(total) * 60e6 / static_cast<double>(summary.elapsed_us);
+  }
+  finished_.store(true);
+  done_(std::move(summary));
+}
+
+}  // namespace mpv_native_texture
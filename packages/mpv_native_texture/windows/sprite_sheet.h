@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "image_encoder.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+class HeadlessMpv;
+
+// Timeline sprite sheets for a batch of media files.
+//
+// Each sheet is |count| keyframe thumbnails spread evenly over the file,
+// packed row-major into one atlas image, with a JSON index next to it:
+//
+//   {"version":1,"source":"...","duration":..,"count":..,"columns":..,
+//    "rows":..,"tileWidth":..,"tileHeight":..,"image":"<hash>.jpg",
+//    "frames":[{"t":12.5,"x":0,"y":0},...]}
+//
+// A pool of workers, each with its own HeadlessMpv, splits every file's
+// thumbnails into contiguous chunks, so one file already uses all workers
+// and the next file's chunks queue up behind it. Sheets are cached in
+// |cache_dir| by a hash of the path, size, mtime, the first 64 KB and the
+// sheet parameters; a cached sheet costs one small read.
+class SpriteSheetBatch {
+ public:
+  struct Options {
+    int count = 100;
+    int tile_width = 160;
+    int tile_height = 90;
+    int columns = 10;
+    int workers = 0;  // 0: one per core
+    ImageFormat format = ImageFormat::kJpeg;
+    int jpeg_quality = 80;
+    std::string cache_dir;  // empty: %TEMP%\mpv_native_texture_sprites
+  };
+
+  struct Sheet {
+    std::string source;
+    bool ok = false;
+    bool cached = false;
+    std::string error;
+    std::string image_path;
+    std::string index_path;
+    int count = 0;
+    int columns = 0;
+    int rows = 0;
+    int64_t elapsed_us = 0;  // first chunk started -> files written
+  };
+
+  struct Summary {
+    std::vector<Sheet> sheets;  // in request order
+    int workers = 0;
+    int64_t elapsed_us = 0;
+    double files_per_minute = 0.0;
+  };
+
+  // Both run on a worker thread; an empty batch calls Done from the constructor.
+  using Progress = std::function<void(const Sheet& sheet, size_t done, size_t total)>;
+  using Done = std::function<void(Summary summary)>;
+
+  SpriteSheetBatch(std::vector<std::string> paths, const Options& options, Progress progress, Done done);
+  // Cancels outstanding work (files not finished report an error) and joins.
+  ~SpriteSheetBatch();
+
+  SpriteSheetBatch(const SpriteSheetBatch&) = delete;
+  SpriteSheetBatch& operator=(const SpriteSheetBatch&) = delete;
+
+  bool finished() const { return finished_.load(); }
+
+ private:
+  struct File;
+  struct Task {
+    std::shared_ptr<File> file;
+    int begin = 0;  // thumbnail range; begin < 0 is the prepare step
+    int end = 0;
+  };
+
+  void WorkerMain(HeadlessMpv* mpv);
+  void Prepare(const std::shared_ptr<File>& file);
+  void RunChunk(const Task& task, HeadlessMpv* mpv, std::string* loaded);
+  void Finish(const std::shared_ptr<File>& file, ImageEncoder* encoder);
+  void Complete(const std::shared_ptr<File>& file);
+
+  const Options options_;
+  const Progress progress_;
+  const Done done_;
+  const SteadyClock::time_point started_;
+
+  std::vector<Sheet> sheets_;  // indexed like the request; guarded by mutex_
+  size_t files_done_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> tasks_;
+  bool stopping_ = false;  // all files done or cancelled: workers exit
+  std::atomic<bool> cancelled_{false};
+  std::atomic<bool> finished_{false};
+  int worker_count_ = 1;
+  std::vector<std::unique_ptr<HeadlessMpv>> mpvs_;  // one per worker
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace mpv_native_texture
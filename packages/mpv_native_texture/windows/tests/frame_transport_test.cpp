@@ -0,0 +1,54 @@
+#include "frame_transport.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace mpv_native_texture {
+namespace {
+
+class FrameTransportTest : public ::testing::Test {
+ protected:
+  PipelineStats stats_;
+  FrameTransport transport_{&stats_, 4, 2};
+  std::vector<uint8_t> pixels_;
+  int width_ = 0;
+  int height_ = 0;
+};
+
+TEST_F(FrameTransportTest, CaptureFailsBeforeTheFirstPublish) {
+  EXPECT_FALSE(transport_.CopyFront(&pixels_, &width_, &height_));
+  EXPECT_TRUE(pixels_.empty());
+}
+
+TEST_F(FrameTransportTest, CapturesThePublishedFrame) {
+  transport_.back()[0] = 0x7f;
+  transport_.Publish();
+  ASSERT_TRUE(transport_.CopyFront(&pixels_, &width_, &height_));
+  EXPECT_EQ(width_, 4);
+  EXPECT_EQ(height_, 2);
+  ASSERT_EQ(pixels_.size(), 4u * 2u * 4u);
+  EXPECT_EQ(pixels_[0], 0x7f);
+}
+
+TEST_F(FrameTransportTest, ResizeAndDropFrameClearTheFrame) {
+  transport_.Publish();
+  transport_.Resize(8, 8);
+  EXPECT_FALSE(transport_.CopyFront(&pixels_, &width_, &height_));
+
+  transport_.Publish();
+  EXPECT_TRUE(transport_.CopyFront(&pixels_, &width_, &height_));
+  transport_.DropFrame();
+  EXPECT_FALSE(transport_.CopyFront(&pixels_, &width_, &height_));
+}
+
+TEST_F(FrameTransportTest, AStillCountsAsShown) {
+  std::vector<uint8_t> still(2u * 2u * 4u, 0x10);
+  transport_.ShowStill(&still, 2, 2);
+  ASSERT_TRUE(transport_.CopyFront(&pixels_, &width_, &height_));
+  EXPECT_EQ(width_, 2);
+  EXPECT_EQ(pixels_[0], 0x10);
+}
+
+}  // namespace
+}  // namespace mpv_native_texture
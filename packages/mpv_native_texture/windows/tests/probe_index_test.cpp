@@ -0,0 +1,97 @@
+#include "probe_index.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+namespace mpv_native_texture {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kMedia[] = "C:\\media\\clip.mkv";
+constexpr int64_t kSize = 1 << 20;
+constexpr int64_t kMtime = 1234567;
+
+class ProbeIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    path_ = (fs::temp_directory_path() / ("probe_index_test_" + name + ".bin")).u8string();
+    fs::remove(fs::u8path(path_));
+  }
+  void TearDown() override { fs::remove(fs::u8path(path_)); }
+
+  std::string path_;
+};
+
+MediaInfo DemuxOnlyInfo() {
+  MediaInfo info;
+  info.duration = 60.0;
+  info.file_format = "matroska";
+  info.width = 1920;
+  info.height = 1080;
+  return info;
+}
+
+MediaInfo VideoParamsInfo() {
+  MediaInfo info = DemuxOnlyInfo();
+  info.height = 1088;
+  info.pixel_format = "yuv420p";
+  return info;
+}
+
+TEST_F(ProbeIndexTest, DemuxOnlyRecordMissesAVideoParamsLookup) {
+  ProbeIndex index;
+  ASSERT_TRUE(index.Open(path_, nullptr));
+
+  // First probe without video params.
+  MediaInfo info;
+  EXPECT_FALSE(index.Lookup(kMedia, kSize, kMtime, 0, &info));
+  ASSERT_TRUE(index.Store(kMedia, kSize, kMtime, 0, DemuxOnlyInfo()));
+  EXPECT_TRUE(index.Lookup(kMedia, kSize, kMtime, 0, &info));
+  EXPECT_TRUE(info.pixel_format.empty());
+
+  // Then with them: the demux-only record must not answer.
+  EXPECT_FALSE(index.Lookup(kMedia, kSize, kMtime, ProbeIndex::kVideoParams, &info));
+  ASSERT_TRUE(index.Store(kMedia, kSize, kMtime, ProbeIndex::kVideoParams, VideoParamsInfo()));
+  ASSERT_TRUE(index.Lookup(kMedia, kSize, kMtime, ProbeIndex::kVideoParams, &info));
+  EXPECT_EQ(info.pixel_format, "yuv420p");
+  EXPECT_EQ(info.height, 1088);
+
+  // The fuller record also serves demux-only lookups, and replaced the old one.
+  MediaInfo plain;
+  ASSERT_TRUE(index.Lookup(kMedia, kSize, kMtime, 0, &plain));
+  EXPECT_EQ(plain.pixel_format, "yuv420p");
+  const ProbeIndex::Stats stats = index.TakeStats();
+  EXPECT_EQ(stats.records, 1u);
+  EXPECT_GT(stats.stale_bytes, 0u);
+}
+
+TEST_F(ProbeIndexTest, FlagsSurviveReopen) {
+  {
+    ProbeIndex index;
+    ASSERT_TRUE(index.Open(path_, nullptr));
+    ASSERT_TRUE(index.Store(kMedia, kSize, kMtime, 0, DemuxOnlyInfo()));
+    ASSERT_TRUE(index.Store("C:\\media\\other.mkv", kSize, kMtime, ProbeIndex::kVideoParams, VideoParamsInfo()));
+  }
+  ProbeIndex index;
+  ASSERT_TRUE(index.Open(path_, nullptr));
+  MediaInfo info;
+  EXPECT_FALSE(index.Lookup(kMedia, kSize, kMtime, ProbeIndex::kVideoParams, &info));
+  EXPECT_TRUE(index.Lookup(kMedia, kSize, kMtime, 0, &info));
+  ASSERT_TRUE(index.Lookup("C:\\media\\other.mkv", kSize, kMtime, ProbeIndex::kVideoParams, &info));
+  EXPECT_EQ(info.pixel_format, "yuv420p");
+}
+
+TEST_F(ProbeIndexTest, ChangedFileMisses) {
+  ProbeIndex index;
+  ASSERT_TRUE(index.Open(path_, nullptr));
+  ASSERT_TRUE(index.Store(kMedia, kSize, kMtime, ProbeIndex::kVideoParams, VideoParamsInfo()));
+  MediaInfo info;
+  EXPECT_FALSE(index.Lookup(kMedia, kSize + 1, kMtime, 0, &info));
+  EXPECT_FALSE(index.Lookup(kMedia, kSize, kMtime + 1, 0, &info));
+}
+
+}  // namespace
+}  // namespace mpv_native_texture
@@ -0,0 +1,70 @@
+#include "quality_governor.h"
+
+#include <gtest/gtest.h>
+
+namespace mpv_native_texture {
+namespace {
+
+constexpr int64_t kBudgetUs = 16667;  // 60 fps
+constexpr auto kFrameInterval = std::chrono::microseconds(kBudgetUs);
+
+// Feeds |governor| frames costing |load| of the per-video-frame budget for
+// |duration| of simulated time; returns the levels it moved to.
+std::vector<QualityGovernor::Level> Feed(QualityGovernor* governor, double load, std::chrono::milliseconds duration,
+                                         SteadyClock::time_point* now) {
+  std::vector<QualityGovernor::Level> moves;
+  const auto end = *now + duration;
+  for (; *now < end; *now += kFrameInterval) {
+    QualityGovernor::Level next;
+    if (governor->OnFrame(static_cast<int64_t>(load * kBudgetUs), kBudgetUs, *now, &next)) moves.push_back(next);
+  }
+  return moves;
+}
+
+TEST(QualityGovernorTest, StepsDownOneLevelAtATimeUnderOverload) {
+  QualityGovernor governor;
+  auto now = SteadyClock::now();
+  const auto moves = Feed(&governor, 1.2, std::chrono::seconds(20), &now);
+  ASSERT_EQ(moves.size(), 4u);
+  for (size_t i = 0; i < moves.size(); ++i) EXPECT_EQ(moves[i], static_cast<QualityGovernor::Level>(i + 1));
+  EXPECT_EQ(governor.level(), QualityGovernor::kFpsCap);
+}
+
+// At kFpsCap only every other frame is rendered, so a per-frame cost of 80%
+// of the video frame time is 40% of the time the cap allows: headroom.
+TEST(QualityGovernorTest, StepsUpFromFpsCapWhenTheCappedBudgetHasHeadroom) {
+  QualityGovernor governor;
+  auto now = SteadyClock::now();
+  Feed(&governor, 1.2, std::chrono::seconds(20), &now);
+  ASSERT_EQ(governor.level(), QualityGovernor::kFpsCap);
+
+  const auto moves = Feed(&governor, 0.8, std::chrono::seconds(7), &now);
+  ASSERT_EQ(moves.size(), 1u);
+  EXPECT_EQ(moves[0], QualityGovernor::kReducedResolution);
+  EXPECT_EQ(governor.TakeSnapshot().step_ups, 1u);
+}
+
+TEST(QualityGovernorTest, StaysAtFpsCapWhileTheCappedBudgetIsTight) {
+  QualityGovernor governor;
+  auto now = SteadyClock::now();
+  Feed(&governor, 1.2, std::chrono::seconds(20), &now);
+  ASSERT_EQ(governor.level(), QualityGovernor::kFpsCap);
+
+  EXPECT_TRUE(Feed(&governor, 1.5, std::chrono::seconds(30), &now).empty());
+  EXPECT_EQ(governor.level(), QualityGovernor::kFpsCap);
+  EXPECT_NEAR(governor.TakeSnapshot().load, 0.75, 0.01);
+}
+
+TEST(QualityGovernorTest, DisablingReturnsToFull) {
+  QualityGovernor governor;
+  auto now = SteadyClock::now();
+  Feed(&governor, 1.2, std::chrono::seconds(5), &now);
+  ASSERT_NE(governor.level(), QualityGovernor::kFull);
+  governor.SetEnabled(false);
+  QualityGovernor::Level next;
+  EXPECT_TRUE(governor.OnFrame(kBudgetUs, kBudgetUs, now, &next));
+  EXPECT_EQ(next, QualityGovernor::kFull);
+}
+
+}  // namespace
+}  // namespace mpv_native_texture
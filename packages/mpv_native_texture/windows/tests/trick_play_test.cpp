@@ -0,0 +1,87 @@
+#include "trick_play.h"
+
+#include <gtest/gtest.h>
+
+namespace mpv_native_texture {
+namespace {
+
+constexpr auto kTick = std::chrono::milliseconds(125);  // 8 fps
+
+// Runs ticks for |duration|, acknowledging each seek at once; returns the
+// targets in order.
+std::vector<double> Scan(TrickPlay* trick, std::chrono::milliseconds duration, SteadyClock::time_point* now) {
+  std::vector<double> targets;
+  const auto end = *now + duration;
+  for (; *now < end; *now += kTick) {
+    double target = 0.0;
+    SteadyClock::time_point next;
+    if (trick->Poll(*now, &target, &next)) {
+      targets.push_back(target);
+      trick->OnSeekDone(*now);
+    }
+  }
+  return targets;
+}
+
+TEST(TrickPlayTest, TargetsFollowTheAnchorNotTheLandingPoints) {
+  TrickPlay trick;
+  const auto start = SteadyClock::now();
+  auto now = start;
+  trick.Start({16.0, 8}, 100.0, now);
+  const auto targets = Scan(&trick, std::chrono::seconds(60), &now);
+  ASSERT_EQ(targets.size(), 480u);
+  // Each target is anchor + rate * elapsed, independent of earlier seeks.
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const double elapsed = std::chrono::duration<double>(kTick * i).count();
+    EXPECT_DOUBLE_EQ(targets[i], 100.0 + 16.0 * elapsed);
+  }
+}
+
+TEST(TrickPlayTest, CoalescedTicksDoNotShiftTheTarget) {
+  TrickPlay trick;
+  auto now = SteadyClock::now();
+  trick.Start({8.0, 8}, 10.0, now);
+  double target = 0.0;
+  SteadyClock::time_point next;
+  ASSERT_TRUE(trick.Poll(now, &target, &next));
+  EXPECT_DOUBLE_EQ(target, 10.0);
+  // The seek is still in flight for the next three ticks.
+  for (int i = 0; i < 3; ++i) {
+    now += kTick;
+    EXPECT_FALSE(trick.Poll(now, &target, &next));
+  }
+  trick.OnSeekDone(now);
+  now += kTick;
+  ASSERT_TRUE(trick.Poll(now, &target, &next));
+  EXPECT_DOUBLE_EQ(target, 10.0 + 8.0 * 0.5);
+  EXPECT_EQ(trick.TakeSnapshot().coalesced, 3u);
+}
+
+TEST(TrickPlayTest, RateChangeReanchorsAtTheCurrentTarget) {
+  TrickPlay trick;
+  auto now = SteadyClock::now();
+  trick.Start({16.0, 8}, 50.0, now);
+  Scan(&trick, std::chrono::seconds(2), &now);
+  // The position argument is ignored while active.
+  trick.Start({-4.0, 8}, 0.0, now);
+  double target = 0.0;
+  SteadyClock::time_point next;
+  ASSERT_TRUE(trick.Poll(now, &target, &next));
+  EXPECT_DOUBLE_EQ(target, 50.0 + 16.0 * 2.0);
+  trick.OnSeekDone(now);
+  now += std::chrono::seconds(1);
+  ASSERT_TRUE(trick.Poll(now, &target, &next));
+  EXPECT_DOUBLE_EQ(target, 82.0 - 4.0);
+}
+
+TEST(TrickPlayTest, RewindTargetStopsAtZero) {
+  TrickPlay trick;
+  auto now = SteadyClock::now();
+  trick.Start({-16.0, 8}, 3.0, now);
+  const auto targets = Scan(&trick, std::chrono::seconds(2), &now);
+  ASSERT_FALSE(targets.empty());
+  EXPECT_DOUBLE_EQ(targets.back(), 0.0);
+}
+
+}  // namespace
+}  // namespace mpv_native_texture
@@ -0,0 +1,121 @@
+#include "texture_output.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace mpv_native_texture {
+
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+
+TextureOutput::TextureOutput(flutter::TextureRegistrar* registrar, int width, int height, int max_fps)
+    : registrar_(registrar),
+      width_(std::max(16, std::min(width, 4096))),
+      height_(std::max(16, std::min(height, 4096))),
+      max_fps_(max_fps) {
+  front_rgba_.assign(static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4u, 0);
+  back_rgba_.assign(front_rgba_.size(), 0);
+  pixel_buffer_.width = static_cast<size_t>(width_);
+  pixel_buffer_.height = static_cast<size_t>(height_);
+  pixel_buffer_.buffer = front_rgba_.data();
+
+  flutter::PixelBufferTexture::CopyBufferCallback copy_callback =
+      [this](size_t /*w*/, size_t /*h*/) -> const FlutterDesktopPixelBuffer* { return CopyPixelBuffer(); };
+  texture_variant_ = std::unique_ptr<flutter::TextureVariant>(
+      new flutter::TextureVariant(std::in_place_type<flutter::PixelBufferTexture>, copy_callback));
+  texture_id_ = registrar_->RegisterTexture(texture_variant_.get());
+}
+
+void TextureOutput::Unregister() {
+  if (unregistered_.exchange(true)) return;
+  if (registrar_ && texture_id_ >= 0) registrar_->UnregisterTexture(texture_id_);
+}
+
+const FlutterDesktopPixelBuffer* TextureOutput::CopyPixelBuffer() {
+  if (unregistered_.load()) return nullptr;
+  std::lock_guard<std::mutex> lock(pixel_mutex_);
+  return &pixel_buffer_;
+}
+
+bool TextureOutput::Due(SteadyClock::time_point now) const {
+  if (unregistered_.load()) return false;
+  return max_fps_ <= 0 || now - last_frame_ >= std::chrono::microseconds(1000000 / max_fps_);
+}
+
+bool TextureOutput::EnsureGl(const GlExt& glx, std::string* err_out) {
+  if (fbo_ && tex_) return true;
+
+  glx.glGenTextures(1, &tex_);
+  glx.glBindTexture(GL_TEXTURE_2D, tex_);
+  glx.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glx.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glx.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+  glx.glGenFramebuffers(1, &fbo_);
+  glx.glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glx.glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_, 0);
+
+  const GLenum status = glx.glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    if (err_out) {
+      std::ostringstream oss;
+      oss << "OpenGL output framebuffer incomplete: 0x" << std::hex << status;
+      *err_out = oss.str();
+    }
+    DestroyGl(glx);
+    return false;
+  }
+  return true;
+}
+
+void TextureOutput::DestroyGl(const GlExt& glx) {
+  if (fbo_) {
+    glx.glDeleteFramebuffers(1, &fbo_);
+    fbo_ = 0;
+  }
+  if (tex_) {
+    glx.glDeleteTextures(1, &tex_);
+    tex_ = 0;
+  }
+}
+
+bool TextureOutput::Update(const GlExt& glx, GLuint src_fbo, int src_w, int src_h, SteadyClock::time_point now,
+                           std::string* err_out) {
+  if (!glx.glBlitFramebuffer) {
+    if (err_out) *err_out = "glBlitFramebuffer not available";
+    return false;
+  }
+  if (!EnsureGl(glx, err_out)) return false;
+  last_frame_ = now;
+
+  // GPU downscale from the main FBO, then read back only the small image.
+  glx.glBindFramebuffer(GL_READ_FRAMEBUFFER, src_fbo);
+  glx.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo_);
+  glx.glBlitFramebuffer(0, 0, src_w, src_h, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  glx.glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, back_rgba_.data());
+
+  {
+    std::lock_guard<std::mutex> lock(pixel_mutex_);
+    front_rgba_.swap(back_rgba_);
+    pixel_buffer_.buffer = front_rgba_.data();
+  }
+  frames_published_.fetch_add(1, std::memory_order_relaxed);
+  if (!unregistered_.load()) registrar_->MarkTextureFrameAvailable(texture_id_);
+  return true;
+}
+
+}  // namespace mpv_native_texture
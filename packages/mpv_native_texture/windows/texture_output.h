@@ -0,0 +1,73 @@
+#pragma once
+
+#include <flutter/texture_registrar.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gl_ext.h"
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// An extra Flutter texture fed from a player's main render.
+//
+// After mpv has drawn the main FBO, the render thread blits it on the GPU
+// into this output's own (usually smaller) FBO and reads that back, so one
+// decode and one mpv render serve several widgets (main view + PiP / preview).
+// Each output has its own fps cap. Outputs larger than the main size are
+// upscaled from it.
+class TextureOutput {
+ public:
+  // Platform thread: registers the texture. GL objects are created lazily on
+  // the render thread.
+  TextureOutput(flutter::TextureRegistrar* registrar, int width, int height, int max_fps);
+
+  TextureOutput(const TextureOutput&) = delete;
+  TextureOutput& operator=(const TextureOutput&) = delete;
+
+  int64_t texture_id() const { return texture_id_; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  uint64_t frames_published() const { return frames_published_.load(std::memory_order_relaxed); }
+
+  // Platform thread: stops serving frames and unregisters the texture. GL
+  // cleanup still has to happen through DestroyGl() on the render thread.
+  void Unregister();
+
+  // Render thread, GL context current.
+  bool Due(SteadyClock::time_point now) const;
+  bool Update(const GlExt& glx, GLuint src_fbo, int src_w, int src_h, SteadyClock::time_point now,
+              std::string* err_out);
+  void DestroyGl(const GlExt& glx);
+
+ private:
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer();
+  bool EnsureGl(const GlExt& glx, std::string* err_out);
+
+  flutter::TextureRegistrar* registrar_ = nullptr;
+  std::unique_ptr<flutter::TextureVariant> texture_variant_;
+  int64_t texture_id_ = -1;
+  std::atomic<bool> unregistered_{false};
+
+  const int width_;
+  const int height_;
+  const int max_fps_;
+  SteadyClock::time_point last_frame_{};
+  std::atomic<uint64_t> frames_published_{0};
+
+  // Render thread owned.
+  GLuint fbo_ = 0;
+  GLuint tex_ = 0;
+  std::vector<uint8_t> back_rgba_;
+
+  std::mutex pixel_mutex_;
+  FlutterDesktopPixelBuffer pixel_buffer_{};
+  std::vector<uint8_t> front_rgba_;
+};
+
+}  // namespace mpv_native_texture
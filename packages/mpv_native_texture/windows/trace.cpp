@@ -0,0 +1,184 @@
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "json_util.h"
+
+namespace mpv_native_texture {
+namespace trace {
+
+std::atomic<bool> g_enabled{false};
+
+namespace {
+
+// Spans kept per thread; older ones are overwritten (~1.2 MB per thread,
+// allocated the first time the thread records while tracing is on).
+constexpr uint64_t kRingCapacity = 16384;
+constexpr size_t kMaxNameLength = 48;
+
+struct Event {
+  char name[kMaxNameLength];
+  const char* category;
+  int64_t ts_us;
+  int64_t dur_us;
+};
+
+struct ThreadRing {
+  uint32_t tid = 0;
+  std::atomic<const char*> thread_name{nullptr};
+  std::vector<Event> events;
+  std::atomic<uint64_t> written{0};
+  std::atomic<bool> alive{true};
+  // Set while the owning thread fills a slot. Set before and cleared after
+  // it checks g_enabled, so once tracing is switched off and this reads
+  // false, the ring stays untouched until the next Start().
+  std::atomic<bool> writing{false};
+};
+
+std::mutex g_registry_mutex;
+std::vector<std::shared_ptr<ThreadRing>> g_rings;
+uint32_t g_next_tid = 1;
+
+thread_local const char* t_thread_name = nullptr;
+
+struct ThreadSlot {
+  std::shared_ptr<ThreadRing> ring;
+  ~ThreadSlot() {
+    if (ring) ring->alive.store(false);
+  }
+};
+thread_local ThreadSlot t_slot;
+
+// Called with g_enabled off and g_registry_mutex held: waits for spans that
+// were already past the enabled check.
+void WaitForWritersLocked() {
+  for (const auto& ring : g_rings) {
+    while (ring->writing.load(std::memory_order_acquire)) std::this_thread::yield();
+  }
+}
+
+ThreadRing* CurrentRing() {
+  if (!t_slot.ring) {
+    auto ring = std::make_shared<ThreadRing>();
+    ring->events.resize(kRingCapacity);
+    ring->thread_name.store(t_thread_name);
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    ring->tid = g_next_tid++;
+    g_rings.push_back(ring);
+    t_slot.ring = std::move(ring);
+  }
+  return t_slot.ring.get();
+}
+
+}  // namespace
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SetThreadName(const char* name) {
+  t_thread_name = name;
+  if (t_slot.ring) t_slot.ring->thread_name.store(name);
+}
+
+void RecordComplete(const char* category, const char* name, int64_t start_us, int64_t dur_us) {
+  ThreadRing* ring = CurrentRing();
+  // seq_cst pairs with the exchange in Start()/StopAndWrite(): either they
+  // see |writing| or this sees tracing off.
+  ring->writing.store(true);
+  if (!g_enabled.load()) {
+    ring->writing.store(false, std::memory_order_release);
+    return;
+  }
+  const uint64_t index = ring->written.load(std::memory_order_relaxed);
+  Event& e = ring->events[index % kRingCapacity];
+  size_t i = 0;
+  for (; name && name[i] && i + 1 < kMaxNameLength; ++i) e.name[i] = name[i];
+  e.name[i] = '\0';
+  e.category = category;
+  e.ts_us = start_us;
+  e.dur_us = dur_us;
+  ring->written.store(index + 1, std::memory_order_release);
+  ring->writing.store(false, std::memory_order_release);
+}
+
+void Start() {
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  // A restart discards the running trace; no thread may be mid-span while
+  // the rings are reset.
+  g_enabled.store(false);
+  WaitForWritersLocked();
+  // Drop buffers of threads that have exited since the last trace.
+  std::vector<std::shared_ptr<ThreadRing>> live;
+  for (auto& ring : g_rings) {
+    if (!ring->alive.load()) continue;
+    ring->written.store(0);
+    live.push_back(ring);
+  }
+  g_rings.swap(live);
+  g_enabled.store(true);
+}
+
+bool StopAndWrite(const std::string& path, std::string* err_out) {
+  if (!g_enabled.exchange(false)) {
+    if (err_out) *err_out = "Tracing is not running";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  WaitForWritersLocked();
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    if (err_out) *err_out = "Cannot open trace file: " + path;
+    return false;
+  }
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  const auto separator = [&] {
+    if (!first) out << ",\n";
+    first = false;
+  };
+
+  for (const auto& ring : g_rings) {
+    const uint64_t written = ring->written.load(std::memory_order_acquire);
+    if (written == 0) continue;
+
+    const char* thread_name = ring->thread_name.load();
+    separator();
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+        << ",\"args\":{\"name\":";
+    WriteJsonString(out, thread_name ? thread_name : "thread");
+    out << "}}";
+
+    const uint64_t begin = written > kRingCapacity ? written - kRingCapacity : 0;
+    for (uint64_t i = begin; i < written; ++i) {
+      const Event& e = ring->events[i % kRingCapacity];
+      separator();
+      out << "{\"name\":";
+      WriteJsonString(out, e.name);
+      out << ",\"cat\":";
+      WriteJsonString(out, e.category);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid << ",\"ts\":" << e.ts_us
+          << ",\"dur\":" << e.dur_us << "}";
+    }
+  }
+  out << "]}\n";
+
+  if (!out) {
+    if (err_out) *err_out = "Failed writing trace file: " + path;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace trace
+}  // namespace mpv_native_texture
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace mpv_native_texture {
+namespace trace {
+
+// Process-wide tracing switch. Spans are recorded into per-thread ring
+// buffers only while it is set; otherwise a Scope costs one relaxed load and
+// one branch.
+extern std::atomic<bool> g_enabled;
+
+inline bool Enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+// Clears all ring buffers and starts recording.
+void Start();
+
+// Stops recording and writes the buffered spans to |path| as Chrome
+// trace-event JSON (loadable in Perfetto / chrome://tracing).
+bool StopAndWrite(const std::string& path, std::string* err_out);
+
+// Names the calling thread in future traces. |name| must be a literal.
+void SetThreadName(const char* name);
+
+int64_t NowMicros();
+
+// Records a finished span on the calling thread. |category| must be a
+// literal; |name| is copied (truncated to 47 bytes).
+void RecordComplete(const char* category, const char* name, int64_t start_us, int64_t dur_us);
+
+class Scope {
+ public:
+  Scope(const char* category, const char* name) : active_(Enabled()) {
+    if (active_) {
+      category_ = category;
+      name_ = name;
+      start_us_ = NowMicros();
+    }
+  }
+  ~Scope() {
+    if (active_) RecordComplete(category_, name_, start_us_, NowMicros() - start_us_);
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  bool active_;
+  const char* category_ = nullptr;
+  const char* name_ = nullptr;
+  int64_t start_us_ = 0;
+};
+
+}  // namespace trace
+}  // namespace mpv_native_texture
+
+#define MPV_TRACE_CONCAT_INNER(a, b) a##b
+#define MPV_TRACE_CONCAT(a, b) MPV_TRACE_CONCAT_INNER(a, b)
+
+// Traces the enclosing block as one span.
+#define MPV_TRACE_SCOPE(category, name) \
+  ::mpv_native_texture::trace::Scope MPV_TRACE_CONCAT(mpv_trace_scope_, __LINE__)(category, name)
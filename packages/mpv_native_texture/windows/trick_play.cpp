@@ -0,0 +1,90 @@
+#include "trick_play.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mpv_native_texture {
+
+TrickPlay::Config TrickPlay::Start(const Config& config, double position, SteadyClock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Restarting while active carries on from where the scan is now.
+  anchor_pos_ = active_ ? TargetAt(now) : std::max(0.0, position);
+  anchor_time_ = now;
+  const double magnitude = std::max(kMinRate, std::min(std::fabs(config.rate), kMaxRate));
+  config_.rate = config.rate < 0 ? -magnitude : magnitude;
+  config_.visual_fps = std::max(1, std::min(config.visual_fps, kMaxVisualFps));
+  interval_ = std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::duration<double>(1.0 / config_.visual_fps));
+  if (!active_) {
+    last_seek_ = now;
+    seek_pending_ = false;
+  }
+  next_tick_ = now;
+  active_ = true;
+  return config_;
+}
+
+bool TrickPlay::Stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const bool was_active = active_;
+  active_ = false;
+  seek_pending_ = false;
+  return was_active;
+}
+
+bool TrickPlay::active() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_;
+}
+
+double TrickPlay::rate() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_ ? config_.rate : 0.0;
+}
+
+double TrickPlay::TargetAt(SteadyClock::time_point now) const {
+  const double elapsed = std::chrono::duration<double>(now - anchor_time_).count();
+  return std::max(0.0, anchor_pos_ + config_.rate * elapsed);
+}
+
+bool TrickPlay::Poll(SteadyClock::time_point now, double* target, SteadyClock::time_point* next) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!active_) return false;
+  if (now < next_tick_) {
+    *next = next_tick_;
+    return false;
+  }
+  next_tick_ = std::max(next_tick_ + interval_, now);
+  *next = next_tick_;
+
+  if (seek_pending_ && now - last_seek_ < kSeekTimeout) {
+    ++coalesced_;
+    return false;
+  }
+  *target = TargetAt(now);
+  last_seek_ = now;
+  seek_pending_ = true;
+  ++seeks_;
+  return true;
+}
+
+void TrickPlay::OnSeekDone(SteadyClock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!seek_pending_) return;
+  seek_pending_ = false;
+  seek_latency_.Record(MicrosBetween(last_seek_, now));
+}
+
+TrickPlay::Snapshot TrickPlay::TakeSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Snapshot snap;
+  snap.active = active_;
+  snap.rate = active_ ? config_.rate : 0.0;
+  snap.visual_fps = active_ ? config_.visual_fps : 0;
+  snap.seeks = seeks_;
+  snap.coalesced = coalesced_;
+  snap.seek = seek_latency_.Summarize();
+  return snap;
+}
+
+}  // namespace mpv_native_texture
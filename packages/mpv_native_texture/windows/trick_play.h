@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "pipeline_stats.h"
+
+namespace mpv_native_texture {
+
+// Fast-forward / rewind by keyframe seeks.
+//
+// Instead of raising mpv's playback speed (which decodes every frame), the
+// player stays paused and muted and is moved by absolute keyframe seeks at a
+// fixed visual rate. Every target is computed from the position and time the
+// scan started at (anchor + rate * elapsed), not from where the previous seek
+// landed, so keyframe snapping never compounds: the shown frame is at most one
+// GOP off the ideal position however long the scan runs. Ticks that land while
+// a seek is still in flight are coalesced into the next one. Only the keyframe
+// each seek lands on is decoded.
+class TrickPlay {
+ public:
+  static constexpr double kMinRate = 2.0;
+  static constexpr double kMaxRate = 64.0;
+  static constexpr int kMaxVisualFps = 30;
+
+  struct Config {
+    double rate = 16.0;  // media seconds per second; negative rewinds
+    int visual_fps = 8;  // seeks (and so displayed frames) per second
+  };
+
+  struct Snapshot {
+    bool active = false;
+    double rate = 0.0;
+    int visual_fps = 0;
+    uint64_t seeks = 0;
+    uint64_t coalesced = 0;             // ticks folded into a later seek
+    LatencyHistogram::Summary seek;     // seek issued -> playback restart
+    double cpu_percent = 0.0;           // process CPU over the session (player)
+  };
+
+  // Clamps |config| to the supported range and returns what was applied.
+  // |position| (media seconds) anchors a new scan; restarting while active
+  // re-anchors at the current target instead so a rate change stays
+  // continuous.
+  Config Start(const Config& config, double position, SteadyClock::time_point now);
+  // Returns false when it was not running.
+  bool Stop();
+  bool active() const;
+  double rate() const;
+
+  // Event thread. Returns true with the absolute target (media seconds, never
+  // negative) when a seek is due. |*next| is set to the next tick while active.
+  bool Poll(SteadyClock::time_point now, double* target, SteadyClock::time_point* next);
+  // Event thread, on MPV_EVENT_PLAYBACK_RESTART.
+  void OnSeekDone(SteadyClock::time_point now);
+
+  Snapshot TakeSnapshot() const;
+
+ private:
+  // A seek that never reports back does not stall the scan forever.
+  static constexpr std::chrono::milliseconds kSeekTimeout{1000};
+
+  double TargetAt(SteadyClock::time_point now) const;
+
+  mutable std::mutex mutex_;
+  bool active_ = false;
+  Config config_;
+  SteadyClock::duration interval_{};
+  SteadyClock::time_point next_tick_{};
+  double anchor_pos_ = 0.0;
+  SteadyClock::time_point anchor_time_{};
+  SteadyClock::time_point last_seek_{};
+  bool seek_pending_ = false;
+  uint64_t seeks_ = 0;
+  uint64_t coalesced_ = 0;
+  LatencyHistogram seek_latency_;
+};
+
+}  // namespace mpv_native_texture